@@ -0,0 +1,137 @@
+//
+//  LogSinks.swift
+//  RealReachability2
+//
+//  Created by RealReachability2 on 2026.
+//
+
+import Foundation
+#if canImport(os)
+import os.log
+#endif
+
+/// Keeps the most recent records in memory, for attaching to bug reports
+public final class RingBufferLogSink: LogSink, @unchecked Sendable {
+    /// Records kept before the oldest is overwritten
+    public let capacity: Int
+
+    private let lock = NSLock()
+    private var slots: [LogRecord?]
+    private var nextIndex = 0
+    private var written = 0
+
+    /// Creates a ring with a fixed number of slots, all allocated up front
+    /// - Parameter capacity: Records kept (default: 256)
+    public init(capacity: Int = 256) {
+        self.capacity = max(1, capacity)
+        self.slots = Array(repeating: nil, count: self.capacity)
+    }
+
+    public func write(_ record: LogRecord) {
+        lock.lock()
+        slots[nextIndex] = record
+        nextIndex = (nextIndex + 1) % capacity
+        written += 1
+        lock.unlock()
+    }
+
+    /// Retained records, oldest first
+    public var records: [LogRecord] {
+        lock.lock()
+        defer { lock.unlock() }
+        guard written >= capacity else {
+            return slots[..<nextIndex].compactMap { $0 }
+        }
+        return (slots[nextIndex...] + slots[..<nextIndex]).compactMap { $0 }
+    }
+}
+
+/// Writes formatted records to standard error
+public final class StandardErrorLogSink: LogSink, @unchecked Sendable {
+    private let lock = NSLock()
+
+    public init() {}
+
+    public func write(_ record: LogRecord) {
+        let line = Data((record.formatted + "\n").utf8)
+        lock.lock()
+        FileHandle.standardError.write(line)
+        lock.unlock()
+    }
+}
+
+/// Appends formatted records to a file on a background queue
+public final class FileLogSink: LogSink, @unchecked Sendable {
+    /// The file written to
+    public let url: URL
+
+    private let handle: FileHandle
+    private let queue = DispatchQueue(label: "com.realreachability2.filelog")
+
+    /// Opens (creating if needed) a file for appending
+    /// - Parameter url: Local file URL
+    /// - Returns: `nil` if the file cannot be opened for writing
+    public init?(url: URL) {
+        if !FileManager.default.fileExists(atPath: url.path) {
+            guard FileManager.default.createFile(atPath: url.path, contents: nil) else {
+                return nil
+            }
+        }
+        guard let handle = try? FileHandle(forWritingTo: url) else {
+            return nil
+        }
+        handle.seekToEndOfFile()
+        self.url = url
+        self.handle = handle
+    }
+
+    deinit {
+        handle.closeFile()
+    }
+
+    public func write(_ record: LogRecord) {
+        let line = Data((record.formatted + "\n").utf8)
+        queue.async { [handle] in
+            handle.write(line)
+        }
+    }
+
+    /// Waits until every record written so far is in the file
+    public func flush() {
+        queue.sync {}
+    }
+}
+
+#if canImport(os)
+/// Forwards records to the unified logging system, one category per subsystem
+public final class OSLogSink: LogSink, @unchecked Sendable {
+    /// Subsystem identifier shown in Console
+    public let subsystem: String
+
+    private let lock = NSLock()
+    private var logs: [LogSubsystem: OSLog] = [:]
+
+    /// - Parameter subsystem: Unified logging subsystem (default: "com.realreachability2")
+    public init(subsystem: String = "com.realreachability2") {
+        self.subsystem = subsystem
+    }
+
+    public func write(_ record: LogRecord) {
+        lock.lock()
+        let log = logs[record.subsystem] ?? OSLog(subsystem: subsystem, category: record.subsystem.name)
+        logs[record.subsystem] = log
+        lock.unlock()
+
+        os_log("%{public}@", log: log, type: Self.logType(for: record.level), record.message)
+    }
+
+    private static func logType(for level: LogLevel) -> OSLogType {
+        switch level {
+        case .debug: return .debug
+        case .info: return .info
+        case .notice, .warning: return .default
+        case .error: return .error
+        }
+    }
+}
+#endif
@@ -0,0 +1,241 @@
+//
+//  ReachabilityLog.swift
+//  RealReachability2
+//
+//  Created by RealReachability2 on 2026.
+//
+
+import Foundation
+
+/// Severity of a log record
+public enum LogLevel: Int, Comparable, Sendable, CustomStringConvertible {
+    case debug = 0
+    case info
+    case notice
+    case warning
+    case error
+
+    public static func < (lhs: LogLevel, rhs: LogLevel) -> Bool {
+        lhs.rawValue < rhs.rawValue
+    }
+
+    public var description: String {
+        switch self {
+        case .debug: return "debug"
+        case .info: return "info"
+        case .notice: return "notice"
+        case .warning: return "warning"
+        case .error: return "error"
+        }
+    }
+}
+
+/// Component a record comes from; rate limits apply per subsystem
+public struct LogSubsystem: Hashable, Sendable, CustomStringConvertible {
+    public let name: String
+
+    public init(_ name: String) {
+        self.name = name
+    }
+
+    public var description: String { name }
+
+    public static let engine = LogSubsystem("engine")
+    public static let http = LogSubsystem("http")
+    public static let dns = LogSubsystem("dns")
+    public static let stun = LogSubsystem("stun")
+    public static let bandwidth = LogSubsystem("bandwidth")
+    public static let responsiveness = LogSubsystem("responsiveness")
+}
+
+/// One formatted log record
+public struct LogRecord: Sendable {
+    public let date: Date
+    public let level: LogLevel
+    public let subsystem: LogSubsystem
+    public let message: String
+
+    public init(date: Date = Date(), level: LogLevel, subsystem: LogSubsystem, message: String) {
+        self.date = date
+        self.level = level
+        self.subsystem = subsystem
+        self.message = message
+    }
+
+    /// Single-line rendering used by the text sinks
+    public var formatted: String {
+        "\(Self.timestampFormatter.string(from: date)) [\(level)] [\(subsystem)] \(message)"
+    }
+
+    private static let timestampFormatter: ISO8601DateFormatter = {
+        let formatter = ISO8601DateFormatter()
+        formatter.formatOptions = [.withInternetDateTime, .withFractionalSeconds]
+        return formatter
+    }()
+}
+
+/// Destination for log records. Called on the logging thread, so sinks should not block.
+public protocol LogSink: AnyObject {
+    func write(_ record: LogRecord)
+}
+
+/// Leveled logging facade for the library.
+///
+/// Messages are autoclosures, so a disabled call site costs one comparison and never formats.
+/// `.debug` call sites are compiled out of release builds unless the library is built with
+/// `-D RR2_LOG_VERBOSE`; building with `-D RR2_LOG_QUIET` also compiles out `.info` and `.notice`.
+public enum ReachabilityLog {
+    /// Runtime threshold; `nil` disables logging.
+    /// Defaults to `.debug` in debug builds and `.notice` otherwise.
+    public static var minimumLevel: LogLevel? {
+        get {
+            let value = threshold.pointee
+            return value == disabled ? nil : LogLevel(rawValue: value)
+        }
+        set {
+            threshold.pointee = newValue?.rawValue ?? disabled
+        }
+    }
+
+    /// Most records each subsystem may emit per second; 0 means unlimited (default: 50).
+    /// Dropped records are summarized in one notice when the next second starts.
+    public static var maximumRecordsPerSecond: Int {
+        get { state.withLock { state.maximumRecordsPerSecond } }
+        set { state.withLock { state.maximumRecordsPerSecond = max(0, newValue) } }
+    }
+
+    /// Adds a sink; records go to every sink in order
+    public static func addSink(_ sink: LogSink) {
+        state.withLock { state.sinks.append(sink) }
+    }
+
+    /// Removes a sink added earlier, or one of the defaults
+    public static func removeSink(_ sink: LogSink) {
+        state.withLock { state.sinks.removeAll { $0 === sink } }
+    }
+
+    /// Removes every sink, including the default one
+    public static func removeAllSinks() {
+        state.withLock { state.sinks.removeAll() }
+    }
+
+    // MARK: - Call Sites
+
+    static func debug(_ subsystem: LogSubsystem, _ message: @autoclosure () -> String) {
+#if DEBUG || RR2_LOG_VERBOSE
+        emit(.debug, subsystem, message)
+#endif
+    }
+
+    static func info(_ subsystem: LogSubsystem, _ message: @autoclosure () -> String) {
+#if !RR2_LOG_QUIET
+        emit(.info, subsystem, message)
+#endif
+    }
+
+    static func notice(_ subsystem: LogSubsystem, _ message: @autoclosure () -> String) {
+#if !RR2_LOG_QUIET
+        emit(.notice, subsystem, message)
+#endif
+    }
+
+    static func warning(_ subsystem: LogSubsystem, _ message: @autoclosure () -> String) {
+        emit(.warning, subsystem, message)
+    }
+
+    static func error(_ subsystem: LogSubsystem, _ message: @autoclosure () -> String) {
+        emit(.error, subsystem, message)
+    }
+
+    // MARK: - Dispatch
+
+    private static let disabled = Int.max
+
+    /// Word-sized threshold read without a lock on every call site. Writes are rare; a racing
+    /// reader sees either the old or the new level, which only shifts when a change takes effect.
+    private static let threshold: UnsafeMutablePointer<Int> = {
+        let pointer = UnsafeMutablePointer<Int>.allocate(capacity: 1)
+#if DEBUG
+        pointer.initialize(to: LogLevel.debug.rawValue)
+#else
+        pointer.initialize(to: LogLevel.notice.rawValue)
+#endif
+        return pointer
+    }()
+
+    private static let state = LogState()
+
+    private static func emit(_ level: LogLevel, _ subsystem: LogSubsystem, _ message: () -> String) {
+        guard level.rawValue >= threshold.pointee else {
+            return
+        }
+        guard let (sinks, suppressed) = state.admit(subsystem, at: Date()) else {
+            return
+        }
+
+        let record = LogRecord(level: level, subsystem: subsystem, message: message())
+        for sink in sinks {
+            if suppressed > 0 {
+                sink.write(LogRecord(date: record.date, level: .notice, subsystem: subsystem,
+                                     message: "\(suppressed) records suppressed by rate limit"))
+            }
+            sink.write(record)
+        }
+    }
+}
+
+/// Sinks and per-subsystem rate windows
+private final class LogState: @unchecked Sendable {
+    private struct Window {
+        var start: Date
+        var count: Int
+        var dropped: Int
+    }
+
+    private let lock = NSLock()
+    var sinks: [LogSink] = [LogState.defaultSink()]
+    var maximumRecordsPerSecond = 50
+    private var windows: [LogSubsystem: Window] = [:]
+
+    func withLock<T>(_ body: () -> T) -> T {
+        lock.lock()
+        defer { lock.unlock() }
+        return body()
+    }
+
+    /// The sinks to write to, and how many records were dropped since the last admitted one;
+    /// `nil` if the subsystem is over its rate.
+    func admit(_ subsystem: LogSubsystem, at now: Date) -> ([LogSink], Int)? {
+        withLock {
+            guard !sinks.isEmpty else {
+                return nil
+            }
+            guard maximumRecordsPerSecond > 0 else {
+                return (sinks, 0)
+            }
+
+            var window = windows[subsystem] ?? Window(start: now, count: 0, dropped: 0)
+            var suppressed = 0
+            if now.timeIntervalSince(window.start) >= 1 {
+                suppressed = window.dropped
+                window = Window(start: now, count: 0, dropped: 0)
+            }
+            guard window.count < maximumRecordsPerSecond else {
+                window.dropped += 1
+                windows[subsystem] = window
+                return nil
+            }
+            window.count += 1
+            windows[subsystem] = window
+            return (sinks, suppressed)
+        }
+    }
+
+    private static func defaultSink() -> LogSink {
+#if canImport(os)
+        return OSLogSink()
+#else
+        return StandardErrorLogSink()
+#endif
+    }
+}
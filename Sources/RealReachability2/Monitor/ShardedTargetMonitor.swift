@@ -0,0 +1,602 @@
+//
+//  ShardedTargetMonitor.swift
+//  RealReachability2
+//
+//  Created by RealReachability2 on 2026.
+//
+
+import Foundation
+
+/// An endpoint watched by `ShardedTargetMonitor`
+@available(iOS 13.0, *)
+public struct MonitoredTarget: Hashable, Sendable {
+    /// How the target is probed
+    public enum Kind: Hashable, Sendable {
+        /// ICMP echo
+        case icmp
+
+        /// TCP handshake with the given port
+        case tcp(port: UInt16)
+    }
+
+    /// Host name or address literal
+    public let host: String
+
+    /// How the target is probed
+    public let kind: Kind
+
+    public init(host: String, kind: Kind) {
+        self.host = host
+        self.kind = kind
+    }
+
+    /// Key the consistent-hash ring places the target by
+    var shardingKey: String {
+        switch kind {
+        case .icmp:
+            return "icmp|\(host)"
+        case .tcp(let port):
+            return "tcp|\(host)|\(port)"
+        }
+    }
+}
+
+/// Latest probe outcome of one target
+@available(iOS 13.0, *)
+public struct TargetHealth: Equatable, Sendable {
+    /// Whether the last probe succeeded
+    public let reachable: Bool
+
+    /// Round-trip (ICMP) or handshake (TCP) time of the last probe in milliseconds
+    public let latencyMs: Double?
+
+    /// Why the last probe failed (`nil` when reachable)
+    public let failureReason: ProbeFailureReason?
+
+    /// When the last probe finished
+    public let date: Date
+
+    public init(reachable: Bool, latencyMs: Double? = nil, failureReason: ProbeFailureReason? = nil, date: Date = Date()) {
+        self.reachable = reachable
+        self.latencyMs = latencyMs
+        self.failureReason = reachable ? nil : (failureReason ?? .unknown)
+        self.date = date
+    }
+
+    init(_ result: ProbeResult) {
+        self.init(reachable: result.success, latencyMs: result.latencyMs, failureReason: result.failureReason)
+    }
+}
+
+/// Load and work-stealing counters of a `ShardedTargetMonitor`
+@available(iOS 13.0, *)
+public struct ShardedMonitorStatistics: Equatable, Sendable {
+    /// Targets owned by each shard
+    public let targetsPerShard: [Int]
+
+    /// Probes finished across all shards
+    public let completedProbes: Int
+
+    /// Targets moved from a backlogged shard to an idle one
+    public let stolenTargets: Int
+}
+
+/// Health monitor for large target sets (thousands of hosts), for server-side use.
+///
+/// Targets are spread over shards by a consistent-hash ring, so adding or removing a target never
+/// moves the others. Each shard has its own serial queue, timer wheel, probe sockets and result
+/// table, and shards share no lock: the only cross-shard interaction is work stealing, where a
+/// shard with free probe slots and nothing due takes a batch of due targets from the most
+/// backlogged shard and keeps them. `snapshot()` merges the per-shard tables; a reader takes each
+/// shard's lock in turn and never blocks the other shards.
+///
+/// Unrelated to `RealReachability`: the monitor reports per-target health, not device
+/// connectivity.
+@available(iOS 13.0, *)
+public final class ShardedTargetMonitor: @unchecked Sendable {
+    /// Monitor settings
+    public struct Configuration: Equatable, Sendable {
+        /// Number of shards (default: active processor count)
+        public var shardCount: Int
+
+        /// Seconds between probes of one target (default: 10)
+        public var probeInterval: TimeInterval
+
+        /// Per-probe timeout in seconds (default: 2)
+        public var timeout: TimeInterval
+
+        /// Timer wheel granularity in seconds (default: 0.1)
+        public var tickInterval: TimeInterval
+
+        /// Probes one shard keeps in flight (default: 64)
+        public var maxProbesInFlightPerShard: Int
+
+        /// Most targets an idle shard steals at once (default: 32)
+        public var stealBatchSize: Int
+
+        public init(shardCount: Int = ProcessInfo.processInfo.activeProcessorCount,
+                    probeInterval: TimeInterval = 10,
+                    timeout: TimeInterval = 2,
+                    tickInterval: TimeInterval = 0.1,
+                    maxProbesInFlightPerShard: Int = 64,
+                    stealBatchSize: Int = 32) {
+            self.shardCount = shardCount
+            self.probeInterval = probeInterval
+            self.timeout = timeout
+            self.tickInterval = tickInterval
+            self.maxProbesInFlightPerShard = maxProbesInFlightPerShard
+            self.stealBatchSize = stealBatchSize
+        }
+    }
+
+    /// Probes one target; runs on the owning shard
+    typealias ProbeHandler = @Sendable (MonitoredTarget, TargetShard) async -> TargetHealth
+
+    public let configuration: Configuration
+
+    private let shards: [TargetShard]
+    private let ring: ConsistentHashRing
+    private let probeHandler: ProbeHandler
+    private let lock = NSLock()
+    private var stolenTargets = 0
+    private var isRunning = false
+
+    /// Creates a monitor probing with ICMP echoes and TCP handshakes
+    public convenience init(configuration: Configuration = Configuration()) {
+        self.init(configuration: configuration) { target, shard in
+            await shard.probe(target)
+        }
+    }
+
+    /// Creates a monitor with a custom probe, for tests and benchmarks
+    init(configuration: Configuration, probe: @escaping ProbeHandler) {
+        var configuration = configuration
+        configuration.shardCount = max(1, configuration.shardCount)
+        configuration.tickInterval = max(0.001, configuration.tickInterval)
+        configuration.maxProbesInFlightPerShard = max(1, configuration.maxProbesInFlightPerShard)
+        configuration.stealBatchSize = max(1, configuration.stealBatchSize)
+        self.configuration = configuration
+        self.probeHandler = probe
+        self.ring = ConsistentHashRing(shardCount: configuration.shardCount)
+
+        let intervalTicks = max(1, Int((configuration.probeInterval / configuration.tickInterval).rounded(.up)))
+        self.shards = (0..<configuration.shardCount).map { index in
+            TargetShard(index: index,
+                        intervalTicks: intervalTicks,
+                        timeout: configuration.timeout,
+                        maxInFlight: configuration.maxProbesInFlightPerShard)
+        }
+        for shard in shards {
+            shard.monitor = self
+        }
+    }
+
+    deinit {
+        shards.forEach { $0.stop() }
+    }
+
+    private func withLockedState<T>(_ body: () -> T) -> T {
+        lock.lock()
+        defer { lock.unlock() }
+        return body()
+    }
+
+    // MARK: - Targets
+
+    /// Starts watching `targets`; each is first probed within one probe interval
+    public func add(_ targets: [MonitoredTarget]) {
+        var assignments: [Int: [MonitoredTarget]] = [:]
+        for target in targets {
+            assignments[ring.shard(for: target.shardingKey), default: []].append(target)
+        }
+        for (index, batch) in assignments {
+            shards[index].adopt(batch, results: [:], dueNow: false)
+        }
+    }
+
+    /// Stops watching `targets` and drops their results
+    public func remove(_ targets: [MonitoredTarget]) {
+        // A stolen target may live on any shard.
+        let removed = Set(targets)
+        shards.forEach { $0.drop(removed) }
+    }
+
+    // MARK: - Running
+
+    /// Starts every shard's timer
+    public func start() {
+        let shouldStart = withLockedState { () -> Bool in
+            guard !isRunning else {
+                return false
+            }
+            isRunning = true
+            return true
+        }
+        guard shouldStart else {
+            return
+        }
+        shards.forEach { $0.start(tickInterval: configuration.tickInterval) }
+        ReachabilityLog.info(.engine, "Sharded monitor started with \(shards.count) shards")
+    }
+
+    /// Stops every shard's timer; probes in flight still record their results
+    public func stop() {
+        withLockedState { isRunning = false }
+        shards.forEach { $0.stop() }
+    }
+
+    // MARK: - Results
+
+    /// Latest health of `target`, or `nil` before its first probe
+    public func health(of target: MonitoredTarget) -> TargetHealth? {
+        var latest: TargetHealth?
+        for shard in shards {
+            if let health = shard.health(of: target), latest.map({ health.date > $0.date }) ?? true {
+                latest = health
+            }
+        }
+        return latest
+    }
+
+    /// Latest health of every probed target, merged from all shards
+    public func snapshot() -> [MonitoredTarget: TargetHealth] {
+        var merged: [MonitoredTarget: TargetHealth] = [:]
+        for shard in shards {
+            merged.merge(shard.results()) { existing, candidate in
+                candidate.date > existing.date ? candidate : existing
+            }
+        }
+        return merged
+    }
+
+    /// Per-shard load and stealing counters
+    public var statistics: ShardedMonitorStatistics {
+        ShardedMonitorStatistics(targetsPerShard: shards.map { $0.ownedCount },
+                                 completedProbes: shards.reduce(0) { $0 + $1.completedProbes },
+                                 stolenTargets: withLockedState { stolenTargets })
+    }
+
+    // MARK: - Shard Callbacks
+
+    func probe(_ target: MonitoredTarget, on shard: TargetShard) async -> TargetHealth {
+        await probeHandler(target, shard)
+    }
+
+    /// Moves due targets from the most backlogged shard to `thief`; called on the thief's queue
+    func stealWork(for thief: TargetShard) {
+        var victim: TargetShard?
+        var victimBacklog = 0
+        for shard in shards where shard !== thief {
+            let backlog = shard.backlog
+            if backlog > victimBacklog {
+                victim = shard
+                victimBacklog = backlog
+            }
+        }
+        guard let victim = victim else {
+            return
+        }
+
+        // Take half the backlog so the victim keeps working on the rest.
+        let count = min(configuration.stealBatchSize, (victimBacklog + 1) / 2)
+        let (stolen, results) = victim.surrender(upTo: count)
+        guard !stolen.isEmpty else {
+            return
+        }
+        withLockedState { stolenTargets += stolen.count }
+        thief.adopt(stolen, results: results, dueNow: true)
+        ReachabilityLog.debug(.engine, "Shard \(thief.index) stole \(stolen.count) targets from shard \(victim.index)")
+    }
+}
+
+// MARK: - Shard
+
+/// One worker of `ShardedTargetMonitor`. Ticks, completions and TCP connection events run on the
+/// shard's serial queue; `lock` guards the state other shards and readers touch.
+@available(iOS 13.0, *)
+final class TargetShard: @unchecked Sendable {
+    let index: Int
+    let queue: DispatchQueue
+    weak var monitor: ShardedTargetMonitor?
+
+    private let intervalTicks: Int
+    private let timeout: TimeInterval
+    private let maxInFlight: Int
+    private let lock = NSLock()
+    private var wheel: TimerWheel<ScheduledTarget>
+    /// Owned targets with the generation of their current ownership
+    private var owned: [MonitoredTarget: Int] = [:]
+    private var nextGeneration = 0
+    private var ready: [ScheduledTarget] = []
+    private var inFlight = 0
+    private var resultTable: [MonitoredTarget: TargetHealth] = [:]
+    private var completed = 0
+    private var pingers: [String: ICMPPinger] = [:]
+    private var timer: DispatchSourceTimer?
+
+    init(index: Int, intervalTicks: Int, timeout: TimeInterval, maxInFlight: Int) {
+        self.index = index
+        self.queue = DispatchQueue(label: "com.realreachability2.shard.\(index)")
+        self.intervalTicks = intervalTicks
+        self.timeout = timeout
+        self.maxInFlight = maxInFlight
+        self.wheel = TimerWheel(slotCount: min(intervalTicks + 1, 4096))
+    }
+
+    private func withLockedState<T>(_ body: () -> T) -> T {
+        lock.lock()
+        defer { lock.unlock() }
+        return body()
+    }
+
+    var ownedCount: Int {
+        withLockedState { owned.count }
+    }
+
+    var completedProbes: Int {
+        withLockedState { completed }
+    }
+
+    /// Due targets waiting for a probe slot
+    var backlog: Int {
+        withLockedState { ready.count }
+    }
+
+    func health(of target: MonitoredTarget) -> TargetHealth? {
+        withLockedState { resultTable[target] }
+    }
+
+    func results() -> [MonitoredTarget: TargetHealth] {
+        withLockedState { resultTable }
+    }
+
+    /// A wheel entry, ready entry or probe in flight for one ownership of a target. A target
+    /// removed and re-added gets a new generation, so entries left from before are ignored
+    /// instead of probing it twice per interval.
+    private struct ScheduledTarget: Hashable {
+        let target: MonitoredTarget
+        let generation: Int
+    }
+
+    /// Whether `entry` belongs to the target's current ownership; caller holds `lock`
+    private func isCurrent(_ entry: ScheduledTarget) -> Bool {
+        owned[entry.target] == entry.generation
+    }
+
+    // MARK: Ownership
+
+    /// Takes ownership of `targets`; new targets are spread over one interval, stolen ones are due now
+    func adopt(_ targets: [MonitoredTarget], results: [MonitoredTarget: TargetHealth], dueNow: Bool) {
+        withLockedState {
+            for target in targets where owned[target] == nil {
+                let entry = ScheduledTarget(target: target, generation: nextGeneration)
+                owned[target] = nextGeneration
+                nextGeneration += 1
+                if dueNow {
+                    ready.append(entry)
+                } else {
+                    wheel.schedule(entry, afterTicks: Int.random(in: 1...intervalTicks))
+                }
+            }
+            resultTable.merge(results) { _, stolen in stolen }
+        }
+        if dueNow {
+            queue.async { [self] in
+                launchReadyProbes()
+            }
+        }
+    }
+
+    /// Gives up to `count` due targets, newest first, with their results
+    func surrender(upTo count: Int) -> ([MonitoredTarget], [MonitoredTarget: TargetHealth]) {
+        withLockedState {
+            let stolen = ready.suffix(count).map(\.target)
+            ready.removeLast(stolen.count)
+            var results: [MonitoredTarget: TargetHealth] = [:]
+            for target in stolen {
+                owned[target] = nil
+                results[target] = resultTable.removeValue(forKey: target)
+            }
+            return (stolen, results)
+        }
+    }
+
+    func drop(_ targets: Set<MonitoredTarget>) {
+        withLockedState {
+            ready.removeAll { targets.contains($0.target) }
+            for target in targets {
+                owned[target] = nil
+                resultTable[target] = nil
+                if target.kind == .icmp {
+                    pingers[target.host] = nil
+                }
+            }
+            // Wheel entries and probes in flight of dropped targets are discarded when they come
+            // due or finish, even if the target was re-added meanwhile: its generation changed.
+        }
+    }
+
+    // MARK: Ticking
+
+    func start(tickInterval: TimeInterval) {
+        let timer = DispatchSource.makeTimerSource(queue: queue)
+        timer.schedule(deadline: .now() + tickInterval, repeating: tickInterval, leeway: .milliseconds(1))
+        timer.setEventHandler { [weak self] in
+            self?.tick()
+        }
+        withLockedState {
+            self.timer?.cancel()
+            self.timer = timer
+        }
+        timer.resume()
+    }
+
+    func stop() {
+        withLockedState {
+            timer?.cancel()
+            timer = nil
+        }
+    }
+
+    private func tick() {
+        withLockedState {
+            for entry in wheel.advance() where isCurrent(entry) {
+                ready.append(entry)
+            }
+        }
+        launchReadyProbes()
+    }
+
+    /// Fills free probe slots from the ready list, then steals when slots remain free
+    private func launchReadyProbes() {
+        let (launches, hasFreeSlots) = withLockedState { () -> ([ScheduledTarget], Bool) in
+            let count = min(maxInFlight - inFlight, ready.count)
+            guard count > 0 else {
+                return ([], inFlight < maxInFlight)
+            }
+            let launches = Array(ready.prefix(count))
+            ready.removeFirst(count)
+            inFlight += count
+            return (launches, inFlight < maxInFlight)
+        }
+
+        for entry in launches {
+            Task { [self] in
+                let health = await monitor?.probe(entry.target, on: self)
+                    ?? TargetHealth(reachable: false, failureReason: .cancelled)
+                queue.async {
+                    self.complete(entry, health: health)
+                }
+            }
+        }
+
+        if hasFreeSlots {
+            monitor?.stealWork(for: self)
+        }
+    }
+
+    private func complete(_ entry: ScheduledTarget, health: TargetHealth) {
+        let hasReadyWork = withLockedState { () -> Bool in
+            inFlight -= 1
+            completed += 1
+            // A target removed, re-added or handed off meanwhile has been scheduled again by its new owner.
+            if isCurrent(entry) {
+                resultTable[entry.target] = health
+                wheel.schedule(entry, afterTicks: intervalTicks)
+            }
+            return !ready.isEmpty
+        }
+        if hasReadyWork {
+            launchReadyProbes()
+        }
+    }
+
+    // MARK: Probing
+
+    /// Probes `target` with this shard's own sockets: one pinger per host, TCP connections on the shard queue
+    func probe(_ target: MonitoredTarget) async -> TargetHealth {
+        switch target.kind {
+        case .icmp:
+            let pinger = withLockedState { () -> ICMPPinger in
+                if let pinger = pingers[target.host] {
+                    return pinger
+                }
+                let pinger = ICMPPinger(host: target.host, timeout: timeout)
+                pingers[target.host] = pinger
+                return pinger
+            }
+            return TargetHealth(await pinger.probeWithDetails())
+        case .tcp(let port):
+            let prober = TCPProber(host: target.host, port: port, timeout: timeout, queue: queue)
+            return TargetHealth(await prober.probeWithDetails())
+        }
+    }
+}
+
+// MARK: - Timer Wheel
+
+/// Hashed timer wheel: scheduling and advancing are O(1) per entry regardless of how many are pending.
+/// Delays longer than one turn wait out extra rounds in their slot.
+struct TimerWheel<Element: Hashable> {
+    private var slots: [[(element: Element, rounds: Int)]]
+    private var cursor = 0
+
+    init(slotCount: Int) {
+        slots = Array(repeating: [], count: max(1, slotCount))
+    }
+
+    /// Entries scheduled and not yet due
+    var count: Int {
+        slots.reduce(0) { $0 + $1.count }
+    }
+
+    /// Makes `element` due on the `ticks`-th call to `advance()` from now (at least the next)
+    mutating func schedule(_ element: Element, afterTicks ticks: Int) {
+        let ticks = max(1, ticks)
+        let slot = (cursor + ticks) % slots.count
+        slots[slot].append((element, (ticks - 1) / slots.count))
+    }
+
+    /// Moves one tick forward and returns the entries now due
+    mutating func advance() -> [Element] {
+        cursor = (cursor + 1) % slots.count
+        var due: [Element] = []
+        var waiting: [(element: Element, rounds: Int)] = []
+        for entry in slots[cursor] {
+            if entry.rounds == 0 {
+                due.append(entry.element)
+            } else {
+                waiting.append((entry.element, entry.rounds - 1))
+            }
+        }
+        slots[cursor] = waiting
+        return due
+    }
+}
+
+// MARK: - Consistent Hashing
+
+/// Ring of virtual nodes; a key belongs to the first node clockwise from its hash
+struct ConsistentHashRing {
+    private let nodes: [(hash: UInt64, shard: Int)]
+
+    init(shardCount: Int, virtualNodesPerShard: Int = 64) {
+        var nodes: [(hash: UInt64, shard: Int)] = []
+        for shard in 0..<max(1, shardCount) {
+            for replica in 0..<virtualNodesPerShard {
+                nodes.append((Self.hash("shard-\(shard)#\(replica)"), shard))
+            }
+        }
+        self.nodes = nodes.sorted { $0.hash < $1.hash }
+    }
+
+    func shard(for key: String) -> Int {
+        let hash = Self.hash(key)
+        var low = 0
+        var high = nodes.count
+        while low < high {
+            let mid = (low + high) / 2
+            if nodes[mid].hash < hash {
+                low = mid + 1
+            } else {
+                high = mid
+            }
+        }
+        return nodes[low == nodes.count ? 0 : low].shard
+    }
+
+    /// FNV-1a with a final avalanche so similar keys (host names, addresses) land far apart
+    static func hash(_ key: String) -> UInt64 {
+        var hash: UInt64 = 0xcbf2_9ce4_8422_2325
+        for byte in key.utf8 {
+            hash ^= UInt64(byte)
+            hash = hash &* 0x0000_0100_0000_01b3
+        }
+        hash ^= hash >> 33
+        hash = hash &* 0xff51_afd7_ed55_8ccd
+        hash ^= hash >> 33
+        hash = hash &* 0xc4ce_b9fe_1a85_ec53
+        hash ^= hash >> 33
+        return hash
+    }
+}
@@ -0,0 +1,165 @@
+//
+//  StatusCoalescer.swift
+//  RealReachability2
+//
+//  Created by RealReachability2 on 2026.
+//
+
+import Foundation
+
+/// Status changes handed to subscribers versus merged away by `statusDeliveryWindow`
+public struct StatusDeliveryCounts: Equatable, Sendable {
+    /// Changes delivered to subscribers
+    public var delivered: Int
+
+    /// Changes absorbed into a later one, or dropped because the burst ended where it started
+    public var merged: Int
+
+    public init(delivered: Int = 0, merged: Int = 0) {
+        self.delivered = delivered
+        self.merged = merged
+    }
+}
+
+/// Merges bursts of changes into their net transition.
+///
+/// The first change after a quiet period is delivered at once and opens a window. Changes inside
+/// the window replace each other; when it closes, the latest is delivered if it differs from the
+/// last one delivered, and that delivery opens the next window. A single change is never delayed,
+/// and a sustained flap delivers at most one change per window.
+final class StatusCoalescer<Value: Equatable>: @unchecked Sendable {
+    /// Called with each delivered value, outside the lock
+    var handler: ((Value) -> Void)? {
+        get { withLockedState { deliverHandler } }
+        set { withLockedState { deliverHandler = newValue } }
+    }
+
+    /// Window length in seconds; 0 delivers every change immediately
+    var window: TimeInterval {
+        get { withLockedState { windowLength } }
+        set {
+            withLockedState { windowLength = max(0, newValue) }
+            if newValue <= 0 {
+                flush()
+            }
+        }
+    }
+
+    var counts: StatusDeliveryCounts {
+        withLockedState { deliveryCounts }
+    }
+
+    private let lock = NSLock()
+    private var deliverHandler: ((Value) -> Void)?
+    private var windowLength: TimeInterval
+    private var lastDelivered: Value?
+    private var pending: Value?
+    private var windowTask: Task<Void, Never>?
+    private var windowGeneration: UInt64 = 0
+    private var deliveryCounts = StatusDeliveryCounts()
+
+    init(window: TimeInterval) {
+        self.windowLength = max(0, window)
+    }
+
+    private func withLockedState<T>(_ body: () -> T) -> T {
+        lock.lock()
+        defer { lock.unlock() }
+        return body()
+    }
+
+    /// Delivers `value` now, or holds it until the open window closes
+    func submit(_ value: Value) {
+        lock.lock()
+        if windowTask != nil {
+            if pending != nil {
+                deliveryCounts.merged += 1
+            }
+            pending = value
+            lock.unlock()
+            return
+        }
+
+        let handler = deliverHandler
+        recordDelivery(value)
+        lock.unlock()
+
+        handler?(value)
+    }
+
+    /// Closes the open window now, delivering the held change if it is a net transition.
+    /// For transitions that must not wait, such as losing the path.
+    func flush() {
+        lock.lock()
+        windowTask?.cancel()
+        windowTask = nil
+        windowGeneration &+= 1
+        let delivery = takePending()
+        let handler = deliverHandler
+        lock.unlock()
+
+        if let delivery {
+            handler?(delivery)
+        }
+    }
+
+    /// Drops the held change and closes the window without delivering
+    func reset() {
+        lock.lock()
+        windowTask?.cancel()
+        windowTask = nil
+        windowGeneration &+= 1
+        pending = nil
+        lastDelivered = nil
+        lock.unlock()
+    }
+
+    // MARK: - Window
+
+    /// Counts a delivery and opens a window behind it. Called with the lock held.
+    private func recordDelivery(_ value: Value) {
+        lastDelivered = value
+        deliveryCounts.delivered += 1
+
+        guard windowLength > 0 else {
+            return
+        }
+        windowGeneration &+= 1
+        let generation = windowGeneration
+        let nanoseconds = UInt64(windowLength * 1_000_000_000)
+        windowTask = Task { [weak self] in
+            try? await Task.sleep(nanoseconds: nanoseconds)
+            self?.closeWindow(generation: generation)
+        }
+    }
+
+    private func closeWindow(generation: UInt64) {
+        lock.lock()
+        guard generation == windowGeneration else {
+            lock.unlock()
+            return
+        }
+        windowTask = nil
+        let delivery = takePending()
+        let handler = deliverHandler
+        lock.unlock()
+
+        if let delivery {
+            handler?(delivery)
+        }
+    }
+
+    /// The held change if it is a net transition, recorded as delivered. Called with the lock held.
+    private func takePending() -> Value? {
+        guard let value = pending else {
+            return nil
+        }
+        pending = nil
+        guard value != lastDelivered else {
+            deliveryCounts.merged += 1
+            return nil
+        }
+        recordDelivery(value)
+        return value
+    }
+}
@@ -0,0 +1,334 @@
+//
+//  BandwidthProber.swift
+//  RealReachability2
+//
+//  Created by RealReachability2 on 2026.
+//
+
+import Foundation
+
+/// Settings for the opt-in throughput probe
+@available(iOS 13.0, *)
+public struct BandwidthProbeConfiguration: Equatable, Sendable {
+    /// Endpoint for the ranged GET; should serve at least `downloadBytes`
+    public var downloadURL: URL
+
+    /// Bytes requested by the ranged GET
+    public var downloadBytes: Int
+
+    /// Endpoint accepting a POST body for the upload leg (`nil` skips the upload leg)
+    public var uploadURL: URL?
+
+    /// Bytes sent by the upload leg
+    public var uploadBytes: Int
+
+    /// Hard cap on bytes transferred by one estimate, across both legs
+    public var byteBudget: Int
+
+    /// Timeout for each leg
+    public var timeout: TimeInterval
+
+    /// Runs an estimate automatically once per network when a probe succeeds on a path that is
+    /// neither expensive nor constrained. Otherwise estimates only run on demand.
+    public var runsOnUnmeteredPaths: Bool
+
+    public init(
+        downloadURL: URL = BandwidthProber.defaultDownloadURL,
+        downloadBytes: Int = 256 * 1024,
+        uploadURL: URL? = nil,
+        uploadBytes: Int = 32 * 1024,
+        byteBudget: Int = 1024 * 1024,
+        timeout: TimeInterval = 10.0,
+        runsOnUnmeteredPaths: Bool = false
+    ) {
+        self.downloadURL = downloadURL
+        self.downloadBytes = downloadBytes
+        self.uploadURL = uploadURL
+        self.uploadBytes = uploadBytes
+        self.byteBudget = byteBudget
+        self.timeout = timeout
+        self.runsOnUnmeteredPaths = runsOnUnmeteredPaths
+    }
+}
+
+/// Result of a throughput probe
+@available(iOS 13.0, *)
+public struct BandwidthEstimate: Sendable {
+    /// Whether the download leg completed (the upload leg is best effort)
+    public let success: Bool
+
+    /// Download goodput in bits per second, if enough of the body arrived to measure it
+    public let downloadBitsPerSecond: Double?
+
+    /// Upload goodput in bits per second, if an upload leg ran and could be measured
+    public let uploadBitsPerSecond: Double?
+
+    /// Body bytes received by the download leg
+    public let bytesDownloaded: Int
+
+    /// Body bytes sent by the upload leg
+    public let bytesUploaded: Int
+
+    /// Why the download leg failed (`nil` when successful)
+    public let failureReason: ProbeFailureReason?
+
+    /// When the estimate finished
+    public let date: Date
+}
+
+/// One point of a transfer: cumulative body bytes at a time
+struct TransferSample: Equatable {
+    let time: CFAbsoluteTime
+    let bytes: Int
+}
+
+/// Throughput prober: a ranged GET streamed without buffering, plus an optional small upload.
+/// Goodput is measured over the packet train after the first chunk, so connection setup and
+/// time to first byte do not dilute the rate.
+@available(iOS 13.0, *)
+public final class BandwidthProber: @unchecked Sendable {
+    /// Default download endpoint (serves an arbitrary number of bytes)
+    public static let defaultDownloadURL = URL(string: "https://speed.cloudflare.com/__down?bytes=1048576")!
+
+    /// Probe settings
+    public let configuration: BandwidthProbeConfiguration
+
+    /// Creates a new bandwidth prober
+    /// - Parameter configuration: Endpoints, sizes and byte budget
+    public init(configuration: BandwidthProbeConfiguration = BandwidthProbeConfiguration()) {
+        self.configuration = configuration
+    }
+
+    /// Runs the download leg, then the upload leg if configured and the budget allows it
+    /// - Parameter allowsMeteredNetworks: When `false`, the transfer refuses expensive and
+    ///   constrained paths instead of spending the user's data
+    /// - Returns: The estimate
+    public func estimate(allowsMeteredNetworks: Bool = true) async -> BandwidthEstimate {
+        let downloadLimit = min(configuration.downloadBytes, configuration.byteBudget)
+        guard downloadLimit > 0 else {
+            return BandwidthEstimate(success: false, downloadBitsPerSecond: nil, uploadBitsPerSecond: nil,
+                                     bytesDownloaded: 0, bytesUploaded: 0,
+                                     failureReason: .invalidConfiguration, date: Date())
+        }
+
+        let download = await transfer(.download(limit: downloadLimit), allowsMeteredNetworks: allowsMeteredNetworks)
+
+        var upload: TransferOutcome?
+        let uploadLimit = min(configuration.uploadBytes, configuration.byteBudget - download.bytes)
+        if download.failureReason == nil, configuration.uploadURL != nil, uploadLimit > 0 {
+            upload = await transfer(.upload(size: uploadLimit), allowsMeteredNetworks: allowsMeteredNetworks)
+        }
+
+        let estimate = BandwidthEstimate(
+            success: download.failureReason == nil,
+            downloadBitsPerSecond: Self.goodput(download.samples),
+            uploadBitsPerSecond: upload.flatMap { $0.failureReason == nil ? Self.goodput($0.samples) : nil },
+            bytesDownloaded: download.bytes,
+            bytesUploaded: upload?.bytes ?? 0,
+            failureReason: download.failureReason,
+            date: Date()
+        )
+        ReachabilityLog.info(.bandwidth, String(format: "down=%.0fbps (%ld bytes) up=%.0fbps (%ld bytes)",
+                                                estimate.downloadBitsPerSecond ?? 0, estimate.bytesDownloaded,
+                                                estimate.uploadBitsPerSecond ?? 0, estimate.bytesUploaded))
+        return estimate
+    }
+
+    /// Goodput in bits per second over the packet train after the first sample.
+    /// The first sample absorbs handshake and time to first byte, so it only marks the start.
+    /// - Returns: `nil` with fewer than two samples or no measurable time span
+    static func goodput(_ samples: [TransferSample]) -> Double? {
+        guard let first = samples.first, let last = samples.last, samples.count >= 2 else {
+            return nil
+        }
+        let duration = last.time - first.time
+        let bytes = last.bytes - first.bytes
+        guard duration > 0, bytes > 0 else {
+            return nil
+        }
+        return Double(bytes) * 8 / duration
+    }
+
+    // MARK: - Transfers
+
+    private func transfer(_ leg: TransferLeg, allowsMeteredNetworks: Bool) async -> TransferOutcome {
+        guard !Task.isCancelled else {
+            return TransferOutcome(samples: [], bytes: 0, failureReason: .cancelled)
+        }
+
+        let sessionConfiguration = URLSessionConfiguration.ephemeral
+        sessionConfiguration.timeoutIntervalForRequest = configuration.timeout
+        sessionConfiguration.timeoutIntervalForResource = configuration.timeout
+        sessionConfiguration.waitsForConnectivity = false
+        sessionConfiguration.requestCachePolicy = .reloadIgnoringLocalAndRemoteCacheData
+        sessionConfiguration.urlCache = nil
+
+        let recorder = TransferRecorder(leg: leg)
+        let session = URLSession(configuration: sessionConfiguration, delegate: recorder, delegateQueue: nil)
+        defer { session.invalidateAndCancel() }
+
+        var request: URLRequest
+        switch leg {
+        case .download(let limit):
+            request = URLRequest(url: configuration.downloadURL)
+            request.httpMethod = "GET"
+            request.setValue("bytes=0-\(limit - 1)", forHTTPHeaderField: "Range")
+            request.setValue("identity", forHTTPHeaderField: "Accept-Encoding")
+        case .upload:
+            guard let uploadURL = configuration.uploadURL else {
+                return TransferOutcome(samples: [], bytes: 0, failureReason: .invalidConfiguration)
+            }
+            request = URLRequest(url: uploadURL)
+            request.httpMethod = "POST"
+            request.setValue("application/octet-stream", forHTTPHeaderField: "Content-Type")
+        }
+        request.cachePolicy = .reloadIgnoringLocalAndRemoteCacheData
+        request.timeoutInterval = configuration.timeout
+        request.allowsExpensiveNetworkAccess = allowsMeteredNetworks
+        request.allowsConstrainedNetworkAccess = allowsMeteredNetworks
+
+        return await withTaskCancellationHandler {
+            await withCheckedContinuation { continuation in
+                recorder.start(session: session, request: request) { outcome in
+                    continuation.resume(returning: outcome)
+                }
+            }
+        } onCancel: {
+            recorder.cancel()
+        }
+    }
+}
+
+/// Which leg a transfer measures
+private enum TransferLeg {
+    /// Ranged GET, cancelled once `limit` body bytes arrived
+    case download(limit: Int)
+    /// POST of `size` bytes
+    case upload(size: Int)
+}
+
+private struct TransferOutcome {
+    let samples: [TransferSample]
+    let bytes: Int
+    let failureReason: ProbeFailureReason?
+}
+
+/// Session delegate that timestamps each chunk and discards the body
+@available(iOS 13.0, *)
+private final class TransferRecorder: NSObject, URLSessionDataDelegate {
+    private let leg: TransferLeg
+    private let lock = NSLock()
+    private var samples: [TransferSample] = []
+    private var bytes = 0
+    private var task: URLSessionTask?
+    private var completion: ((TransferOutcome) -> Void)?
+    private var reachedLimit = false
+    private var hasCompleted = false
+
+    init(leg: TransferLeg) {
+        self.leg = leg
+    }
+
+    func start(session: URLSession, request: URLRequest, completion: @escaping (TransferOutcome) -> Void) {
+        let task: URLSessionTask
+        switch leg {
+        case .download:
+            task = session.dataTask(with: request)
+        case .upload(let size):
+            task = session.uploadTask(with: request, from: Data(count: size))
+        }
+
+        lock.lock()
+        let alreadyCompleted = hasCompleted
+        if !alreadyCompleted {
+            self.task = task
+            self.completion = completion
+        }
+        lock.unlock()
+
+        if alreadyCompleted {
+            completion(TransferOutcome(samples: [], bytes: 0, failureReason: .cancelled))
+            return
+        }
+        task.resume()
+    }
+
+    func cancel() {
+        finish(failureReason: .cancelled)
+    }
+
+    func urlSession(_ session: URLSession,
+                    dataTask: URLSessionDataTask,
+                    didReceive response: URLResponse,
+                    completionHandler: @escaping (URLSession.ResponseDisposition) -> Void) {
+        guard let httpResponse = response as? HTTPURLResponse, (200...299).contains(httpResponse.statusCode) else {
+            completionHandler(.cancel)
+            finish(failureReason: .httpMismatch)
+            return
+        }
+        completionHandler(.allow)
+    }
+
+    func urlSession(_ session: URLSession, dataTask: URLSessionDataTask, didReceive data: Data) {
+        guard case .download(let limit) = leg else {
+            return
+        }
+
+        lock.lock()
+        bytes += data.count
+        samples.append(TransferSample(time: CFAbsoluteTimeGetCurrent(), bytes: bytes))
+        // Servers that ignore the Range header would otherwise stream past the budget.
+        let limitReached = bytes >= limit
+        if limitReached {
+            reachedLimit = true
+        }
+        lock.unlock()
+
+        if limitReached {
+            dataTask.cancel()
+            finish(failureReason: nil)
+        }
+    }
+
+    func urlSession(_ session: URLSession,
+                    task: URLSessionTask,
+                    didSendBodyData bytesSent: Int64,
+                    totalBytesSent: Int64,
+                    totalBytesExpectedToSend: Int64) {
+        lock.lock()
+        bytes = Int(totalBytesSent)
+        samples.append(TransferSample(time: CFAbsoluteTimeGetCurrent(), bytes: bytes))
+        lock.unlock()
+    }
+
+    func urlSession(_ session: URLSession, task: URLSessionTask, didCompleteWithError error: Error?) {
+        lock.lock()
+        let cancelledAtLimit = reachedLimit
+        lock.unlock()
+
+        if let error, !cancelledAtLimit {
+            finish(failureReason: HTTPProber.failureReason(for: error))
+        } else {
+            finish(failureReason: nil)
+        }
+    }
+
+    private func finish(failureReason: ProbeFailureReason?) {
+        lock.lock()
+        guard !hasCompleted else {
+            lock.unlock()
+            return
+        }
+        hasCompleted = true
+        let callback = completion
+        completion = nil
+        let outcome = TransferOutcome(samples: samples, bytes: bytes, failureReason: failureReason)
+        let task = self.task
+        lock.unlock()
+
+        if failureReason != nil {
+            task?.cancel()
+        }
+        callback?(outcome)
+    }
+}
@@ -0,0 +1,359 @@
+//
+//  DoHProber.swift
+//  RealReachability2
+//
+//  Created by RealReachability2 on 2026.
+//
+
+import Foundation
+
+/// Address record type queried by the DNS health probe
+@available(iOS 13.0, *)
+public enum DNSRecordType: UInt16, Sendable {
+    /// IPv4 address
+    case a = 1
+    /// IPv6 address
+    case aaaa = 28
+}
+
+/// Outcome of comparing DNS-over-HTTPS with the system resolver
+@available(iOS 13.0, *)
+public enum DNSHealth: Equatable, Sendable {
+    /// Both resolved, with at least one address in common
+    case healthy
+    /// Both resolved, but to disjoint addresses (load-balanced names can do this; hijacking does)
+    case answersDiffer
+    /// DoH resolved but the system resolver did not: plain DNS is blocked or broken
+    case systemResolverFailed
+    /// The system resolver worked but DoH did not (DoH blocked, or no connectivity to the DoH server)
+    case dohFailed
+    /// Neither resolved
+    case unresolvable
+}
+
+/// Result of a DNS health probe
+@available(iOS 13.0, *)
+public struct DNSHealthResult: Sendable {
+    /// Overall verdict
+    public let health: DNSHealth
+
+    /// Addresses from the DoH answer
+    public let dohAddresses: [String]
+
+    /// DoH round trip in milliseconds (one HTTPS request)
+    public let dohLatencyMs: Double?
+
+    /// Why DoH failed (`nil` when it resolved)
+    public let dohFailureReason: ProbeFailureReason?
+
+    /// Addresses from the system resolver
+    public let systemAddresses: [String]
+
+    /// System resolver lookup time in milliseconds
+    public let systemLatencyMs: Double?
+
+    /// Why the system resolver failed (`nil` when it resolved)
+    public let systemFailureReason: ProbeFailureReason?
+}
+
+/// What the DNS health probe resolves, and where
+@available(iOS 13.0, *)
+public struct DNSHealthProbeConfiguration: Equatable, Sendable {
+    /// Default DoH endpoint
+    public static let defaultResolverURL = URL(string: "https://dns.google/dns-query")!
+
+    /// Default name to resolve
+    public static let defaultQueryName = "www.gstatic.com"
+
+    /// DoH endpoint accepting `application/dns-message` POSTs
+    public var resolverURL: URL
+
+    /// The name to resolve, typically one of the app's own domains
+    public var queryName: String
+
+    /// Record type queried (default: A)
+    public var recordType: DNSRecordType
+
+    /// Timeout for each lookup in seconds (default: 5)
+    public var timeout: TimeInterval
+
+    public init(resolverURL: URL = DNSHealthProbeConfiguration.defaultResolverURL,
+                queryName: String = DNSHealthProbeConfiguration.defaultQueryName,
+                recordType: DNSRecordType = .a,
+                timeout: TimeInterval = 5.0) {
+        self.resolverURL = resolverURL
+        self.queryName = queryName
+        self.recordType = recordType
+        self.timeout = timeout
+    }
+}
+
+/// Resolves a name over DNS-over-HTTPS (RFC 8484 wire format) and with the system resolver,
+/// so DNS health is reported separately from HTTP reachability. Plain DNS hijacked or blocked
+/// by the network shows up as a failed or diverging system answer next to a good DoH answer.
+/// The DoH session is kept alive between probes, so each probe costs one request.
+@available(iOS 13.0, *)
+public final class DoHProber: @unchecked Sendable {
+    /// Resolves a host name to address literals of one record type (empty on failure)
+    public typealias SystemResolver = @Sendable (String, DNSRecordType) -> [String]
+
+    /// Name, endpoint and timeout this prober was created with
+    let configuration: DNSHealthProbeConfiguration
+
+    private let systemResolver: SystemResolver
+
+    /// Persistent session: the TLS connection to the DoH server is reused across probes
+    private let session: URLSession
+
+    /// Creates a new DoH prober
+    /// - Parameters:
+    ///   - configuration: Name to resolve, DoH endpoint and timeout
+    ///   - systemResolver: Lookup used for comparison (default: `getaddrinfo`)
+    public init(configuration: DNSHealthProbeConfiguration = DNSHealthProbeConfiguration(),
+                systemResolver: @escaping SystemResolver = DoHProber.systemResolve) {
+        self.configuration = configuration
+        self.systemResolver = systemResolver
+
+        let config = URLSessionConfiguration.ephemeral
+        config.timeoutIntervalForRequest = configuration.timeout
+        config.timeoutIntervalForResource = configuration.timeout
+        config.waitsForConnectivity = false
+        config.requestCachePolicy = .reloadIgnoringLocalAndRemoteCacheData
+        config.urlCache = nil
+        config.httpMaximumConnectionsPerHost = 1
+        self.session = URLSession(configuration: config)
+    }
+
+    deinit {
+        session.finishTasksAndInvalidate()
+    }
+
+    /// Resolves the name over DoH and with the system resolver, concurrently
+    /// - Returns: Both answers with timing and the overall verdict
+    public func probe() async -> DNSHealthResult {
+        async let doh = resolveOverHTTPS()
+        async let system = resolveWithSystem()
+        let (dohAnswer, systemAnswer) = await (doh, system)
+
+        let health: DNSHealth
+        switch (dohAnswer.failureReason == nil, systemAnswer.failureReason == nil) {
+        case (true, true):
+            let common = Set(dohAnswer.addresses).intersection(systemAnswer.addresses)
+            health = common.isEmpty ? .answersDiffer : .healthy
+        case (true, false):
+            health = .systemResolverFailed
+        case (false, true):
+            health = .dohFailed
+        case (false, false):
+            health = .unresolvable
+        }
+
+        ReachabilityLog.info(.dns, "\(configuration.queryName) health=\(health) doh=\(dohAnswer.addresses) system=\(systemAnswer.addresses)")
+        return DNSHealthResult(health: health,
+                               dohAddresses: dohAnswer.addresses,
+                               dohLatencyMs: dohAnswer.latencyMs,
+                               dohFailureReason: dohAnswer.failureReason,
+                               systemAddresses: systemAnswer.addresses,
+                               systemLatencyMs: systemAnswer.latencyMs,
+                               systemFailureReason: systemAnswer.failureReason)
+    }
+
+    // MARK: - Lookups
+
+    private struct Answer {
+        let addresses: [String]
+        let latencyMs: Double?
+        let failureReason: ProbeFailureReason?
+    }
+
+    private func resolveOverHTTPS() async -> Answer {
+        let id = UInt16.random(in: .min ... .max)
+        let recordType = configuration.recordType
+        guard let query = DNSWireFormat.query(name: configuration.queryName, type: recordType, id: id) else {
+            return Answer(addresses: [], latencyMs: nil, failureReason: .invalidConfiguration)
+        }
+
+        var request = URLRequest(url: configuration.resolverURL)
+        request.httpMethod = "POST"
+        request.httpBody = query
+        request.timeoutInterval = configuration.timeout
+        request.cachePolicy = .reloadIgnoringLocalAndRemoteCacheData
+        request.setValue("application/dns-message", forHTTPHeaderField: "Content-Type")
+        request.setValue("application/dns-message", forHTTPHeaderField: "Accept")
+
+        let startTime = CFAbsoluteTimeGetCurrent()
+        do {
+            let (data, response) = try await session.data(for: request)
+            let latency = (CFAbsoluteTimeGetCurrent() - startTime) * 1000
+            guard let httpResponse = response as? HTTPURLResponse, httpResponse.statusCode == 200 else {
+                return Answer(addresses: [], latencyMs: latency, failureReason: .httpMismatch)
+            }
+            guard let addresses = DNSWireFormat.addresses(inResponse: data, id: id, type: recordType) else {
+                return Answer(addresses: [], latencyMs: latency, failureReason: .httpMismatch)
+            }
+            return Answer(addresses: addresses, latencyMs: latency, failureReason: addresses.isEmpty ? .dnsFailure : nil)
+        } catch {
+            return Answer(addresses: [], latencyMs: nil, failureReason: HTTPProber.failureReason(for: error))
+        }
+    }
+
+    private func resolveWithSystem() async -> Answer {
+        let resolve = systemResolver
+        let name = configuration.queryName
+        let type = configuration.recordType
+        let timeout = configuration.timeout
+        let startTime = CFAbsoluteTimeGetCurrent()
+
+        // getaddrinfo cannot be cancelled, so a hung lookup is abandoned at the timeout.
+        let addresses: [String]? = await ProbeWatchdog.run(deadline: timeout) {
+            await Task.detached(priority: .utility) { resolve(name, type) }.value
+        } onDeadline: {
+            nil
+        }
+
+        guard let addresses else {
+            return Answer(addresses: [], latencyMs: nil, failureReason: .timeout)
+        }
+        let latency = (CFAbsoluteTimeGetCurrent() - startTime) * 1000
+        return Answer(addresses: addresses, latencyMs: latency, failureReason: addresses.isEmpty ? .dnsFailure : nil)
+    }
+
+    /// Default lookup using the system resolver
+    public static let systemResolve: SystemResolver = { hostName, type in
+        var hints = addrinfo()
+        hints.ai_family = type == .a ? AF_INET : AF_INET6
+        hints.ai_socktype = SOCK_DGRAM
+
+        var result: UnsafeMutablePointer<addrinfo>?
+        guard getaddrinfo(hostName, nil, &hints, &result) == 0, let first = result else {
+            return []
+        }
+        defer { freeaddrinfo(first) }
+
+        var addresses: [String] = []
+        var cursor: UnsafeMutablePointer<addrinfo>? = first
+        while let info = cursor {
+            if let address = info.pointee.ai_addr {
+                var host = [CChar](repeating: 0, count: Int(NI_MAXHOST))
+                if getnameinfo(address, info.pointee.ai_addrlen, &host, socklen_t(host.count), nil, 0, NI_NUMERICHOST) == 0 {
+                    addresses.append(String(cString: host))
+                }
+            }
+            cursor = info.pointee.ai_next
+        }
+        return addresses
+    }
+}
+
+// MARK: - DNS Wire Format
+
+/// Builds DNS queries and extracts addresses from responses (RFC 1035 §4)
+@available(iOS 13.0, *)
+enum DNSWireFormat {
+    /// Builds a recursive query for one name and record type
+    /// - Returns: The message, or `nil` if the name has an empty or over-long label
+    static func query(name: String, type: DNSRecordType, id: UInt16) -> Data? {
+        var bytes: [UInt8] = []
+        bytes += bigEndianBytes(id)
+        bytes += [0x01, 0x00]           // RD
+        bytes += [0x00, 0x01]           // QDCOUNT
+        bytes += [0x00, 0x00, 0x00, 0x00, 0x00, 0x00]
+
+        // A trailing dot (fully-qualified form) is allowed; any other empty label is not.
+        let trimmed = name.hasSuffix(".") ? String(name.dropLast()) : name
+        for label in trimmed.split(separator: ".", omittingEmptySubsequences: false) {
+            let utf8 = Array(label.utf8)
+            guard !utf8.isEmpty, utf8.count <= 63 else {
+                return nil
+            }
+            bytes.append(UInt8(utf8.count))
+            bytes += utf8
+        }
+        bytes.append(0)
+        bytes += bigEndianBytes(type.rawValue)
+        bytes += [0x00, 0x01]           // IN
+        return Data(bytes)
+    }
+
+    /// Addresses of the answer records of `type` in a response to query `id`
+    /// - Returns: The addresses (empty for NXDOMAIN or no data), or `nil` if the message is
+    ///   malformed or answers a different query
+    static func addresses(inResponse data: Data, id: UInt16, type: DNSRecordType) -> [String]? {
+        let bytes = [UInt8](data)
+        guard bytes.count >= 12,
+              readUInt16(bytes, at: 0) == id,
+              bytes[2] & 0x80 != 0 else {
+            return nil
+        }
+
+        let rcode = bytes[3] & 0x0F
+        let questionCount = Int(readUInt16(bytes, at: 4))
+        let answerCount = Int(readUInt16(bytes, at: 6))
+        guard rcode == 0 else {
+            return []
+        }
+
+        var offset = 12
+        for _ in 0..<questionCount {
+            guard let end = skipName(bytes, at: offset), end + 4 <= bytes.count else {
+                return nil
+            }
+            offset = end + 4
+        }
+
+        var addresses: [String] = []
+        for _ in 0..<answerCount {
+            guard let end = skipName(bytes, at: offset), end + 10 <= bytes.count else {
+                return nil
+            }
+            let recordType = readUInt16(bytes, at: end)
+            let length = Int(readUInt16(bytes, at: end + 8))
+            let dataStart = end + 10
+            guard dataStart + length <= bytes.count else {
+                return nil
+            }
+
+            // CNAME and other records on the way to the address are skipped.
+            if recordType == type.rawValue, let address = addressString(Array(bytes[dataStart..<(dataStart + length)]), type: type) {
+                addresses.append(address)
+            }
+            offset = dataStart + length
+        }
+        return addresses
+    }
+
+    /// Offset just past a (possibly compressed) name
+    private static func skipName(_ bytes: [UInt8], at start: Int) -> Int? {
+        var offset = start
+        while offset < bytes.count {
+            let length = bytes[offset]
+            if length == 0 {
+                return offset + 1
+            }
+            if length & 0xC0 == 0xC0 {
+                // A compression pointer ends the name.
+                return offset + 2 <= bytes.count ? offset + 2 : nil
+            }
+            offset += 1 + Int(length)
+        }
+        return nil
+    }
+
+    private static func addressString(_ rdata: [UInt8], type: DNSRecordType) -> String? {
+        switch type {
+        case .a:
+            guard rdata.count == 4 else { return nil }
+            return rdata.map(String.init).joined(separator: ".")
+        case .aaaa:
+            return NAT64Prefix.ipv6String(from: rdata)
+        }
+    }
+
+    static func bigEndianBytes(_ value: UInt16) -> [UInt8] {
+        [UInt8(value >> 8), UInt8(value & 0xFF)]
+    }
+
+    private static func readUInt16(_ bytes: [UInt8], at offset: Int) -> UInt16 {
+        (UInt16(bytes[offset]) << 8) | UInt16(bytes[offset + 1])
+    }
+}
@@ -6,6 +6,8 @@
 //
 
 import Foundation
+import Network
+import Security
 
 /// HTTP HEAD prober for verifying internet connectivity
 /// Uses Apple's captive portal detection URL for reliable connectivity checks
@@ -23,13 +25,41 @@ public final class HTTPProber: Prober, @unchecked Sendable {
     /// URLSession for making requests
     private let session: URLSession
     
+    /// Pre-resolved address of the probe host (`nil` when address pinning is off)
+    private let addressCache: PinnedAddressCache?
+    
+    /// Decides whether a server certificate presented on a pinned connection is trusted
+    typealias ServerTrustEvaluator = @Sendable (SecTrust) -> Bool
+    
+    private let serverTrustEvaluator: ServerTrustEvaluator
+    
+    private let lock = NSLock()
+    private var handshakeCounts = TLSHandshakeCounts()
+    
     /// Creates a new HTTP prober
     /// - Parameters:
     ///   - url: The URL to probe (default: Apple's captive portal URL)
     ///   - timeout: Timeout interval in seconds (default: 5)
-    public init(url: URL = HTTPProber.defaultURL, timeout: TimeInterval = 5.0) {
+    ///   - pinsAddress: Whether to connect to a pre-resolved address of the host instead of resolving
+    ///     it on every probe (default: false). Ignored for URLs whose host is already an address.
+    public convenience init(url: URL = HTTPProber.defaultURL, timeout: TimeInterval = 5.0, pinsAddress: Bool = false) {
+        var addressCache: PinnedAddressCache?
+        if pinsAddress, let host = url.host, !host.isEmpty, !host.contains(":"),
+           NAT64Prefix.ipv4Bytes(fromLiteral: host) == nil {
+            addressCache = PinnedAddressCache(hostName: host)
+        }
+        self.init(url: url, timeout: timeout, addressCache: addressCache)
+    }
+    
+    /// Creates a prober connecting through the given address cache
+    init(url: URL,
+         timeout: TimeInterval,
+         addressCache: PinnedAddressCache?,
+         serverTrustEvaluator: @escaping ServerTrustEvaluator = { SecTrustEvaluateWithError($0, nil) }) {
         self.url = url
         self.timeout = timeout
+        self.addressCache = addressCache
+        self.serverTrustEvaluator = serverTrustEvaluator
         
         let config = URLSessionConfiguration.ephemeral
         config.timeoutIntervalForRequest = timeout
@@ -49,73 +79,148 @@ public final class HTTPProber: Prober, @unchecked Sendable {
     /// - Parameter allowsCellularAccess: Whether cellular can be used for this probe.
     /// - Returns: `true` if the probe was successful.
     public func probe(allowsCellularAccess: Bool) async -> Bool {
-        let request = makeRequest(allowsCellularAccess: allowsCellularAccess)
-        
-        do {
-            let (_, response) = try await session.data(for: request)
-            
-            guard let httpResponse = response as? HTTPURLResponse else {
-#if DEBUG
-                logProbe("failed allowsCellular=\(allowsCellularAccess) reason=non-http-response response=\(response)")
-#endif
-                return false
-            }
-            
-            let success = isSuccessfulResponse(httpResponse)
-#if DEBUG
-            if success {
-                logProbe("success allowsCellular=\(allowsCellularAccess) status=\(httpResponse.statusCode) responseURL=\(httpResponse.url?.absoluteString ?? "nil") expectedURL=\(url.absoluteString)")
-            } else {
-                logProbe("failed allowsCellular=\(allowsCellularAccess) status=\(httpResponse.statusCode) responseURL=\(httpResponse.url?.absoluteString ?? "nil") expectedURL=\(url.absoluteString)")
-            }
-#endif
-            return success
-        } catch {
-            if isExpectedCancellation(error) {
-                return false
-            }
-#if DEBUG
-            logProbe("failed allowsCellular=\(allowsCellularAccess) error=\(error)")
-#endif
-            return false
-        }
+        await probeWithDetails(allowsCellularAccess: allowsCellularAccess).success
     }
     
     /// Probes with detailed result including latency
     /// - Returns: ProbeResult with success status and latency
     public func probeWithDetails() async -> ProbeResult {
+        await probeWithDetails(allowsCellularAccess: true)
+    }
+
+    /// Probes with detailed result and explicit cellular access policy.
+    /// - Parameter allowsCellularAccess: Whether cellular can be used for this probe.
+    /// - Returns: ProbeResult with success status, latency and failure reason.
+    public func probeWithDetails(allowsCellularAccess: Bool) async -> ProbeResult {
+        if let addressCache {
+            return await probePinnedAddress(addressCache, allowsCellularAccess: allowsCellularAccess)
+        }
+        
         let startTime = CFAbsoluteTimeGetCurrent()
-        let request = makeRequest(allowsCellularAccess: true)
+        let request = makeRequest(allowsCellularAccess: allowsCellularAccess)
         
         do {
             let (_, response) = try await session.data(for: request)
             let latency = (CFAbsoluteTimeGetCurrent() - startTime) * 1000
             
             guard let httpResponse = response as? HTTPURLResponse else {
-#if DEBUG
-                logProbe("details failed reason=non-http-response response=\(response)")
-#endif
-                return ProbeResult(success: false, latencyMs: latency, error: nil)
+                ReachabilityLog.debug(.http, "failed allowsCellular=\(allowsCellularAccess) reason=non-http-response response=\(response)")
+                return ProbeResult(success: false, latencyMs: latency, error: nil, failureReason: .httpMismatch)
             }
             
             let success = isSuccessfulResponse(httpResponse)
-#if DEBUG
-            if success {
-                logProbe("details success status=\(httpResponse.statusCode) responseURL=\(httpResponse.url?.absoluteString ?? "nil") expectedURL=\(url.absoluteString)")
-            } else {
-                logProbe("details failed status=\(httpResponse.statusCode) responseURL=\(httpResponse.url?.absoluteString ?? "nil") expectedURL=\(url.absoluteString)")
-            }
-#endif
-            return ProbeResult(success: success, latencyMs: latency, error: nil)
+            ReachabilityLog.debug(.http, "\(success ? "success" : "failed") allowsCellular=\(allowsCellularAccess) status=\(httpResponse.statusCode) responseURL=\(httpResponse.url?.absoluteString ?? "nil") expectedURL=\(url.absoluteString)")
+            return ProbeResult(success: success, latencyMs: latency, error: nil, failureReason: .httpMismatch)
         } catch {
             let latency = (CFAbsoluteTimeGetCurrent() - startTime) * 1000
             if isExpectedCancellation(error) {
-                return ProbeResult(success: false, latencyMs: latency, error: nil)
+                return ProbeResult(success: false, latencyMs: latency, error: nil, failureReason: .cancelled)
             }
-#if DEBUG
-            logProbe("details failed error=\(error)")
-#endif
-            return ProbeResult(success: false, latencyMs: latency, error: error)
+            ReachabilityLog.debug(.http, "failed allowsCellular=\(allowsCellularAccess) error=\(error)")
+            return ProbeResult(success: false, latencyMs: latency, error: error, failureReason: Self.failureReason(for: error))
+        }
+    }
+
+    /// Resumed and full TLS handshakes of pinned HTTPS probes so far
+    public var tlsHandshakeCounts: TLSHandshakeCounts {
+        lock.lock()
+        defer { lock.unlock() }
+        return handshakeCounts
+    }
+    
+    /// Resolves the pinned address in the background, for example after a network change.
+    /// Does nothing when address pinning is off.
+    public func prefetchPinnedAddress() {
+        addressCache?.prefetch()
+    }
+    
+    /// Drops the pinned address, so the next probe resolves the host again.
+    public func invalidatePinnedAddress() {
+        addressCache?.invalidate()
+    }
+
+    /// Cancels probes in flight and closes the session and its kept-alive connections.
+    /// The prober cannot probe afterwards.
+    func closeConnections() {
+        session.invalidateAndCancel()
+    }
+
+    /// Connects straight to the pinned address, with the URL's host as TLS server name and Host header.
+    /// Latency covers connection setup and the HEAD exchange, not DNS. HTTPS connections resume
+    /// cached TLS sessions and carry the HEAD as early data where the server allows it.
+    private func probePinnedAddress(_ addressCache: PinnedAddressCache, allowsCellularAccess: Bool) async -> ProbeResult {
+        guard let address = await addressCache.address() else {
+            ReachabilityLog.debug(.http, "failed allowsCellular=\(allowsCellularAccess) reason=pinned-address-unresolved host=\(addressCache.hostName)")
+            return ProbeResult(success: false, latencyMs: nil, error: nil, failureReason: .dnsFailure)
+        }
+        
+        let startTime = CFAbsoluteTimeGetCurrent()
+        let exchange = PinnedHTTPExchange(address: address,
+                                          url: urlByAppendingNonce(url),
+                                          timeout: timeout,
+                                          allowsCellularAccess: allowsCellularAccess,
+                                          serverTrustEvaluator: serverTrustEvaluator)
+        let (statusCode, failureReason, handshake) = await exchange.run()
+        let latency = (CFAbsoluteTimeGetCurrent() - startTime) * 1000
+        
+        if let handshake {
+            lock.lock()
+            switch handshake {
+            case .resumed:
+                handshakeCounts.resumed += 1
+            case .full:
+                handshakeCounts.full += 1
+            }
+            lock.unlock()
+        }
+        
+        guard let statusCode else {
+            // The address may have moved; resolve again rather than keep failing against it.
+            if failureReason != .cancelled {
+                addressCache.invalidate()
+            }
+            ReachabilityLog.debug(.http, "failed allowsCellular=\(allowsCellularAccess) pinned=\(address) reason=\(failureReason ?? .unknown)")
+            return ProbeResult(success: false, latencyMs: latency, error: nil, failureReason: failureReason ?? .unknown,
+                               tlsHandshake: handshake)
+        }
+        
+        let success = isSuccessfulStatus(statusCode)
+        ReachabilityLog.debug(.http, "\(success ? "success" : "failed") allowsCellular=\(allowsCellularAccess) pinned=\(address) status=\(statusCode) handshake=\(handshake.map { "\($0)" } ?? "none")")
+        return ProbeResult(success: success, latencyMs: latency, error: nil, failureReason: .httpMismatch, tlsHandshake: handshake)
+    }
+
+    /// Maps a URL loading error to a probe failure reason
+    static func failureReason(for error: Error) -> ProbeFailureReason {
+        let nsError = error as NSError
+        guard nsError.domain == NSURLErrorDomain else {
+            return .unknown
+        }
+
+        switch nsError.code {
+        case NSURLErrorCannotFindHost, NSURLErrorDNSLookupFailed:
+            return .dnsFailure
+        case NSURLErrorCannotConnectToHost:
+            return .connectionRefused
+        case NSURLErrorNetworkConnectionLost:
+            return .connectionReset
+        case NSURLErrorSecureConnectionFailed,
+             NSURLErrorServerCertificateHasBadDate,
+             NSURLErrorServerCertificateUntrusted,
+             NSURLErrorServerCertificateHasUnknownRoot,
+             NSURLErrorServerCertificateNotYetValid,
+             NSURLErrorClientCertificateRejected,
+             NSURLErrorClientCertificateRequired:
+            return .tlsFailure
+        case NSURLErrorTimedOut:
+            return .timeout
+        case NSURLErrorNotConnectedToInternet,
+             NSURLErrorInternationalRoamingOff,
+             NSURLErrorDataNotAllowed:
+            return .noRoute
+        case NSURLErrorCancelled:
+            return .cancelled
+        default:
+            return .unknown
         }
     }
 
@@ -157,10 +262,14 @@ public final class HTTPProber: Prober, @unchecked Sendable {
             return false
         }
         
-        if expectedPath == "/generate_204" {
-            return response.statusCode == 204
+        return isSuccessfulStatus(response.statusCode)
+    }
+
+    private func isSuccessfulStatus(_ statusCode: Int) -> Bool {
+        if url.path == "/generate_204" {
+            return statusCode == 204
         }
-        return (200...299).contains(response.statusCode)
+        return (200...299).contains(statusCode)
     }
 
     private func isExpectedCancellation(_ error: Error) -> Bool {
@@ -172,9 +281,194 @@ public final class HTTPProber: Prober, @unchecked Sendable {
         return nsError.domain == NSURLErrorDomain && nsError.code == NSURLErrorCancelled
     }
 
-#if DEBUG
-    private func logProbe(_ message: String) {
-        NSLog("[HTTPProber] %@", message)
+}
+
+/// Resumed versus full TLS handshakes on pinned HTTPS probe connections
+@available(iOS 13.0, *)
+public struct TLSHandshakeCounts: Equatable, Sendable {
+    /// Handshakes resumed from a cached session ticket
+    public var resumed = 0
+
+    /// Full handshakes with certificate verification
+    public var full = 0
+
+    public init(resumed: Int = 0, full: Int = 0) {
+        self.resumed = resumed
+        self.full = full
+    }
+}
+
+/// One HEAD request over a fresh connection to a fixed address. Redirects are not followed,
+/// so a captive portal shows up as a non-2xx status.
+@available(iOS 13.0, *)
+private final class PinnedHTTPExchange: @unchecked Sendable {
+    private let address: String
+    private let url: URL
+    private let timeout: TimeInterval
+    private let allowsCellularAccess: Bool
+    private let serverTrustEvaluator: HTTPProber.ServerTrustEvaluator
+    private let queue = DispatchQueue(label: "com.realreachability2.pinnedhttp")
+    private let lock = NSLock()
+    private var connection: NWConnection?
+    private var completion: ((Int?, ProbeFailureReason?) -> Void)?
+    private var hasCompleted = false
+    private var handshake: TLSHandshake?
+    private var verifiedCertificate = false
+
+    init(address: String,
+         url: URL,
+         timeout: TimeInterval,
+         allowsCellularAccess: Bool,
+         serverTrustEvaluator: @escaping HTTPProber.ServerTrustEvaluator) {
+        self.address = address
+        self.url = url
+        self.timeout = timeout
+        self.allowsCellularAccess = allowsCellularAccess
+        self.serverTrustEvaluator = serverTrustEvaluator
+    }
+
+    /// - Returns: The response status code, or `nil` and why the exchange failed; plus the TLS
+    ///   handshake kind once an HTTPS connection got that far
+    func run() async -> (Int?, ProbeFailureReason?, TLSHandshake?) {
+        let (statusCode, failureReason): (Int?, ProbeFailureReason?) = await withTaskCancellationHandler {
+            await withCheckedContinuation { continuation in
+                start { statusCode, failureReason in
+                    continuation.resume(returning: (statusCode, failureReason))
+                }
+            }
+        } onCancel: {
+            finish(statusCode: nil, failureReason: .cancelled)
+        }
+        lock.lock()
+        defer { lock.unlock() }
+        return (statusCode, failureReason, handshake)
+    }
+
+    private func start(completion: @escaping (Int?, ProbeFailureReason?) -> Void) {
+        let isTLS = url.scheme?.lowercased() == "https"
+        guard let host = url.host,
+              let port = NWEndpoint.Port(rawValue: UInt16(url.port ?? (isTLS ? 443 : 80))) else {
+            completion(nil, .invalidConfiguration)
+            return
+        }
+
+        let parameters: NWParameters
+        if isTLS {
+            let tls = NWProtocolTLS.Options()
+            let options = tls.securityProtocolOptions
+            sec_protocol_options_set_tls_server_name(options, host)
+            // Sessions are cached per server name across connections in the process.
+            sec_protocol_options_set_tls_resumption_enabled(options, true)
+            sec_protocol_options_set_tls_tickets_enabled(options, true)
+
+            // The certificate is verified against the server name, not the address we connect to.
+            // A resumed session presents no certificate, so this only runs on full handshakes.
+            let evaluate = serverTrustEvaluator
+            sec_protocol_options_set_verify_block(options, { [self] _, trust, complete in
+                let secTrust = sec_trust_copy_ref(trust).takeRetainedValue()
+                SecTrustSetPolicies(secTrust, SecPolicyCreateSSL(true, host as CFString))
+                let trusted = evaluate(secTrust)
+                lock.lock()
+                verifiedCertificate = true
+                lock.unlock()
+                complete(trusted)
+            }, queue)
+
+            parameters = NWParameters(tls: tls)
+            // The HEAD is idempotent, so it may ride in TLS 1.3 early data on a resumed session.
+            parameters.allowFastOpen = true
+        } else {
+            parameters = .tcp
+        }
+        if !allowsCellularAccess {
+            parameters.prohibitedInterfaceTypes = [.cellular]
+        }
+
+        let connection = NWConnection(host: NWEndpoint.Host(address), port: port, using: parameters)
+        lock.lock()
+        let alreadyCompleted = hasCompleted
+        if !alreadyCompleted {
+            self.completion = completion
+            self.connection = connection
+        }
+        lock.unlock()
+
+        if alreadyCompleted {
+            completion(nil, .cancelled)
+            return
+        }
+
+        var path = url.path.isEmpty ? "/" : url.path
+        if let query = url.query {
+            path += "?" + query
+        }
+        let hostHeader = url.port.map { "\(host):\($0)" } ?? host
+        let request = "HEAD \(path) HTTP/1.1\r\nHost: \(hostHeader)\r\nCache-Control: no-cache\r\nPragma: no-cache\r\nConnection: close\r\n\r\n"
+
+        connection.stateUpdateHandler = { [self] state in
+            switch state {
+            case .ready:
+                if isTLS {
+                    lock.lock()
+                    handshake = verifiedCertificate ? .full : .resumed
+                    lock.unlock()
+                }
+                readStatusLine(on: connection, buffered: Data())
+            case .waiting(let error), .failed(let error):
+                finish(statusCode: nil, failureReason: ProbeFailureReason(error))
+            default:
+                break
+            }
+        }
+        // Queued before start, so it can go out with the first flight when fast open is allowed.
+        connection.send(content: Data(request.utf8), completion: .idempotent)
+        connection.start(queue: queue)
+
+        queue.asyncAfter(deadline: .now() + timeout) { [self] in
+            finish(statusCode: nil, failureReason: .timeout)
+        }
+    }
+
+    private func readStatusLine(on connection: NWConnection, buffered: Data) {
+        connection.receive(minimumIncompleteLength: 1, maximumLength: 4096) { [self] data, _, isComplete, error in
+            var buffered = buffered
+            if let data {
+                buffered.append(data)
+            }
+
+            if let lineEnd = buffered.range(of: Data("\r\n".utf8)) {
+                // "HTTP/1.1 204 No Content"
+                let statusLine = String(decoding: buffered[..<lineEnd.lowerBound], as: UTF8.self)
+                let fields = statusLine.split(separator: " ")
+                if fields.count >= 2, fields[0].hasPrefix("HTTP/"), let statusCode = Int(fields[1]) {
+                    finish(statusCode: statusCode, failureReason: nil)
+                } else {
+                    finish(statusCode: nil, failureReason: .httpMismatch)
+                }
+            } else if let error {
+                finish(statusCode: nil, failureReason: ProbeFailureReason(error))
+            } else if isComplete {
+                finish(statusCode: nil, failureReason: .connectionReset)
+            } else {
+                readStatusLine(on: connection, buffered: buffered)
+            }
+        }
+    }
+
+    private func finish(statusCode: Int?, failureReason: ProbeFailureReason?) {
+        lock.lock()
+        guard !hasCompleted else {
+            lock.unlock()
+            return
+        }
+        hasCompleted = true
+        let callback = completion
+        completion = nil
+        let connection = self.connection
+        self.connection = nil
+        lock.unlock()
+
+        connection?.cancel()
+        callback?(statusCode, failureReason)
     }
-#endif
 }
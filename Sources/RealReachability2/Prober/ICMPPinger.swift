@@ -25,42 +25,72 @@ public final class ICMPPinger: Prober, @unchecked Sendable {
     
     /// Timeout interval
     private let timeout: TimeInterval
+
+    /// Capture receiving every packet of this pinger's probes, if any
+    public let packetCapture: PacketCapture?
     
     /// Creates a new ICMP pinger
     /// - Parameters:
     ///   - host: The host to ping (default: 8.8.8.8)
     ///   - port: Kept for API compatibility (not used for real ICMP ping)
     ///   - timeout: Timeout interval in seconds (default: 5)
+    ///   - packetCapture: Records probe packets when set (default: nil)
     public init(host: String = ICMPPinger.defaultHost,
                 port: UInt16 = ICMPPinger.defaultPort,
-                timeout: TimeInterval = 5.0) {
+                timeout: TimeInterval = 5.0,
+                packetCapture: PacketCapture? = nil) {
         self.host = host
         self.port = port
         self.timeout = timeout
+        self.packetCapture = packetCapture
     }
     
     /// Probes the network using real ICMP ping
     /// - Returns: `true` if the probe was successful
     public func probe() async -> Bool {
-        let pingOperation = PingOperation(host: host, timeout: timeout)
-        return await withTaskCancellationHandler {
+        await probeWithDetails().success
+    }
+    
+    /// Probes with detailed result including latency
+    /// - Returns: ProbeResult with success status, latency and failure reason
+    public func probeWithDetails() async -> ProbeResult {
+        let startTime = CFAbsoluteTimeGetCurrent()
+        let pingOperation = PingOperation(host: host, timeout: timeout, packetCapture: packetCapture)
+        let failureReason: ProbeFailureReason? = await withTaskCancellationHandler {
             await withCheckedContinuation { continuation in
-                pingOperation.ping { success in
-                    continuation.resume(returning: success)
+                pingOperation.ping { failureReason in
+                    continuation.resume(returning: failureReason)
                 }
             }
         } onCancel: {
             pingOperation.cancel()
         }
-    }
-    
-    /// Probes with detailed result including latency
-    /// - Returns: ProbeResult with success status and latency
-    public func probeWithDetails() async -> ProbeResult {
-        let startTime = CFAbsoluteTimeGetCurrent()
-        let success = await probe()
         let latency = (CFAbsoluteTimeGetCurrent() - startTime) * 1000
-        return ProbeResult(success: success, latencyMs: latency, error: nil)
+        return ProbeResult(success: failureReason == nil, latencyMs: latency, error: nil, failureReason: failureReason)
+    }
+
+    /// Maps a ping start or send error to a probe failure reason
+    static func failureReason(for error: Error) -> ProbeFailureReason {
+        let nsError = error as NSError
+        if nsError.domain == kCFErrorDomainCFNetwork as String {
+            return .dnsFailure
+        }
+
+        if nsError.domain == NSPOSIXErrorDomain {
+            switch Int32(nsError.code) {
+            case ENETUNREACH, EHOSTUNREACH, EADDRNOTAVAIL, ENETDOWN, EHOSTDOWN:
+                return .noRoute
+            case ECONNREFUSED:
+                return .connectionRefused
+            case ECONNRESET:
+                return .connectionReset
+            case ETIMEDOUT:
+                return .timeout
+            default:
+                return .unknown
+            }
+        }
+        return .unknown
     }
 }
 
@@ -69,21 +99,26 @@ public final class ICMPPinger: Prober, @unchecked Sendable {
 /// Internal class to manage a single ping operation with RunLoop
 @available(iOS 13.0, *)
 private final class PingOperation: NSObject, PingFoundationDelegate {
+    /// Called with `nil` on success, or the reason the ping failed
+    typealias Completion = (ProbeFailureReason?) -> Void
+
     private let host: String
     private let timeout: TimeInterval
+    private let packetCapture: PacketCapture?
     private var pingFoundation: PingFoundation?
-    private var completion: ((Bool) -> Void)?
+    private var completion: Completion?
     private var hasCompleted = false
     private var timeoutTimer: Timer?
     private let lock = NSLock()
     
-    init(host: String, timeout: TimeInterval) {
+    init(host: String, timeout: TimeInterval, packetCapture: PacketCapture?) {
         self.host = host
         self.timeout = timeout
+        self.packetCapture = packetCapture
         super.init()
     }
     
-    func ping(completion: @escaping (Bool) -> Void) {
+    func ping(completion: @escaping Completion) {
         lock.lock()
         let alreadyCompleted = hasCompleted
         if !alreadyCompleted {
@@ -92,7 +127,7 @@ private final class PingOperation: NSObject, PingFoundationDelegate {
         lock.unlock()
         
         if alreadyCompleted {
-            completion(false)
+            completion(.cancelled)
             return
         }
 
@@ -108,7 +143,7 @@ private final class PingOperation: NSObject, PingFoundationDelegate {
     }
 
     func cancel() {
-        finishWithResult(false)
+        finish(failureReason: .cancelled)
     }
     
     private func startPing() {
@@ -121,15 +156,16 @@ private final class PingOperation: NSObject, PingFoundationDelegate {
         
         pingFoundation = PingFoundation(hostName: host)
         pingFoundation?.delegate = self
+        pingFoundation?.packetCapture = packetCapture
         pingFoundation?.start()
         
         // Setup timeout
         timeoutTimer = Timer.scheduledTimer(withTimeInterval: timeout, repeats: false) { [self] _ in
-            finishWithResult(false)
+            finish(failureReason: .timeout)
         }
     }
     
-    private func finishWithResult(_ success: Bool) {
+    private func finish(failureReason: ProbeFailureReason?) {
         lock.lock()
         guard !hasCompleted else {
             lock.unlock()
@@ -143,7 +179,7 @@ private final class PingOperation: NSObject, PingFoundationDelegate {
         // Resume the continuation immediately on the current thread so that
         // callers (especially Swift concurrency tasks) are never blocked
         // waiting for the main RunLoop to pump.
-        callback?(success)
+        callback?(failureReason)
 
         // Timer invalidation and PingFoundation cleanup require the main
         // thread / RunLoop, but they don't affect the caller any more.
@@ -169,14 +205,14 @@ private final class PingOperation: NSObject, PingFoundationDelegate {
     }
     
     func pingFoundation(_ pinger: PingFoundation, didFailWithError error: Error) {
-        finishWithResult(false)
+        finish(failureReason: ICMPPinger.failureReason(for: error))
     }
     
     func pingFoundation(_ pinger: PingFoundation, didFailToSendPacket packet: Data, sequenceNumber: UInt16, error: Error) {
-        finishWithResult(false)
+        finish(failureReason: ICMPPinger.failureReason(for: error))
     }
     
     func pingFoundation(_ pinger: PingFoundation, didReceivePingResponsePacket packet: Data, sequenceNumber: UInt16) {
-        finishWithResult(true)
+        finish(failureReason: nil)
     }
 }
@@ -0,0 +1,211 @@
+//
+//  NAT64PrefixResolver.swift
+//  RealReachability2
+//
+//  Created by RealReachability2 on 2026.
+//
+
+import Foundation
+
+/// A NAT64 prefix (RFC 6052) discovered through DNS64 (RFC 7050)
+@available(iOS 13.0, *)
+public struct NAT64Prefix: Equatable, Sendable {
+    /// Well-known name whose only records are 192.0.0.170 and 192.0.0.171
+    public static let discoveryHostName = "ipv4only.arpa"
+
+    /// Well-known IPv4 addresses of `ipv4only.arpa`
+    static let wellKnownIPv4Addresses: [[UInt8]] = [[192, 0, 0, 170], [192, 0, 0, 171]]
+
+    /// Byte offsets of the embedded IPv4 address for each legal prefix length.
+    /// Byte 8 (bits 64..71) is reserved and always skipped.
+    private static let embeddingOffsets: [Int: [Int]] = [
+        96: [12, 13, 14, 15],
+        64: [9, 10, 11, 12],
+        56: [7, 9, 10, 11],
+        48: [6, 7, 9, 10],
+        40: [5, 6, 7, 9],
+        32: [4, 5, 6, 7]
+    ]
+
+    /// Prefix bytes (16 bytes, everything past the prefix is zero)
+    public let bytes: [UInt8]
+
+    /// Prefix length in bits (32, 40, 48, 56, 64 or 96)
+    public let length: Int
+
+    /// Creates a prefix from raw bytes
+    /// - Returns: `nil` if the length is not one allowed by RFC 6052
+    public init?(bytes: [UInt8], length: Int) {
+        guard bytes.count == 16, Self.embeddingOffsets[length] != nil else {
+            return nil
+        }
+        var masked = [UInt8](repeating: 0, count: 16)
+        for index in 0..<(length / 8) {
+            masked[index] = bytes[index]
+        }
+        self.bytes = masked
+        self.length = length
+    }
+
+    /// Extracts the prefix from a synthesized AAAA record of `ipv4only.arpa`
+    /// - Parameter address: 16-byte IPv6 address
+    /// - Returns: The prefix, or `nil` if no well-known IPv4 address is embedded
+    public static func discover(fromSynthesizedAddress address: [UInt8]) -> NAT64Prefix? {
+        guard address.count == 16 else {
+            return nil
+        }
+
+        // Longest prefix first, so that /96 wins over shorter lengths that
+        // would also happen to match a zero-padded suffix.
+        for length in [96, 64, 56, 48, 40, 32] {
+            guard let offsets = embeddingOffsets[length] else { continue }
+            let embedded = offsets.map { address[$0] }
+            if wellKnownIPv4Addresses.contains(embedded) {
+                return NAT64Prefix(bytes: address, length: length)
+            }
+        }
+        return nil
+    }
+
+    /// Synthesizes an IPv6 address embedding the given IPv4 address
+    /// - Parameter ipv4: 4-byte IPv4 address
+    /// - Returns: 16-byte IPv6 address
+    public func synthesize(ipv4: [UInt8]) -> [UInt8] {
+        var result = bytes
+        guard ipv4.count == 4, let offsets = Self.embeddingOffsets[length] else {
+            return result
+        }
+        for (index, offset) in offsets.enumerated() {
+            result[offset] = ipv4[index]
+        }
+        return result
+    }
+
+    /// Synthesizes an IPv6 literal for an IPv4 literal host
+    /// - Parameter host: IPv4 literal such as `8.8.8.8`
+    /// - Returns: IPv6 literal, or `nil` if `host` is not an IPv4 literal
+    public func synthesizedHost(forIPv4Literal host: String) -> String? {
+        guard let ipv4 = Self.ipv4Bytes(fromLiteral: host) else {
+            return nil
+        }
+        return Self.ipv6String(from: synthesize(ipv4: ipv4))
+    }
+
+    /// Parses an IPv4 literal into network-order bytes
+    static func ipv4Bytes(fromLiteral host: String) -> [UInt8]? {
+        var address = in_addr()
+        guard inet_pton(AF_INET, host, &address) == 1 else {
+            return nil
+        }
+        return withUnsafeBytes(of: address) { Array($0) }
+    }
+
+    /// Formats 16 bytes as an IPv6 literal
+    static func ipv6String(from bytes: [UInt8]) -> String? {
+        guard bytes.count == 16 else {
+            return nil
+        }
+        var address = in6_addr()
+        withUnsafeMutableBytes(of: &address) { $0.copyBytes(from: bytes) }
+        var buffer = [CChar](repeating: 0, count: Int(INET6_ADDRSTRLEN))
+        guard inet_ntop(AF_INET6, &address, &buffer, socklen_t(buffer.count)) != nil else {
+            return nil
+        }
+        return String(cString: buffer)
+    }
+}
+
+/// Discovers and caches the NAT64 prefix once per network
+@available(iOS 13.0, *)
+public final class NAT64PrefixResolver: @unchecked Sendable {
+    /// Resolves a host name to its IPv6 (AAAA) addresses, 16 bytes each
+    public typealias AddressResolver = @Sendable (String) -> [[UInt8]]
+
+    /// The resolver used for `ipv4only.arpa` lookups
+    private let resolveIPv6Addresses: AddressResolver
+
+    /// Lock for thread-safe access
+    private let lock = NSLock()
+
+    /// Discovery results per network key; `nil` values mean "no NAT64 on this network"
+    private var cache: [String: NAT64Prefix?] = [:]
+
+    /// In-flight discoveries, so concurrent probes share one lookup
+    private var pending: [String: Task<NAT64Prefix?, Never>] = [:]
+
+    /// Creates a resolver
+    /// - Parameter resolver: AAAA lookup function (default: system resolver via `getaddrinfo`)
+    public init(resolver: @escaping AddressResolver = NAT64PrefixResolver.systemResolveIPv6) {
+        self.resolveIPv6Addresses = resolver
+    }
+
+    /// Returns the NAT64 prefix for a network, discovering it on first use
+    /// - Parameter networkKey: Identifies the current network; results are cached per key
+    /// - Returns: The prefix, or `nil` if the network has no DNS64/NAT64
+    public func prefix(forNetwork networkKey: String) async -> NAT64Prefix? {
+        let task: Task<NAT64Prefix?, Never> = withLockedState {
+            if let existing = pending[networkKey] {
+                return existing
+            }
+            if let cached = cache[networkKey] {
+                return Task { cached }
+            }
+
+            let resolve = resolveIPv6Addresses
+            let task = Task.detached(priority: .utility) { () -> NAT64Prefix? in
+                let addresses = resolve(NAT64Prefix.discoveryHostName)
+                return addresses.lazy.compactMap(NAT64Prefix.discover(fromSynthesizedAddress:)).first
+            }
+            pending[networkKey] = task
+            return task
+        }
+
+        let prefix = await task.value
+
+        withLockedState {
+            if pending[networkKey] == task {
+                pending[networkKey] = nil
+                cache[networkKey] = .some(prefix)
+            }
+        }
+        return prefix
+    }
+
+    /// Drops all cached results, for example when the network goes away
+    public func invalidate() {
+        withLockedState {
+            cache.removeAll()
+            pending.removeAll()
+        }
+    }
+
+    private func withLockedState<T>(_ body: () -> T) -> T {
+        lock.lock()
+        defer { lock.unlock() }
+        return body()
+    }
+
+    /// Default AAAA lookup using the system resolver
+    public static let systemResolveIPv6: AddressResolver = { hostName in
+        var hints = addrinfo()
+        hints.ai_family = AF_INET6
+        hints.ai_socktype = SOCK_DGRAM
+
+        var result: UnsafeMutablePointer<addrinfo>?
+        guard getaddrinfo(hostName, nil, &hints, &result) == 0, let first = result else {
+            return []
+        }
+        defer { freeaddrinfo(first) }
+
+        var addresses: [[UInt8]] = []
+        var cursor: UnsafeMutablePointer<addrinfo>? = first
+        while let info = cursor {
+            if info.pointee.ai_family == AF_INET6, let address = info.pointee.ai_addr {
+                let sin6 = address.withMemoryRebound(to: sockaddr_in6.self, capacity: 1) { $0.pointee }
+                addresses.append(withUnsafeBytes(of: sin6.sin6_addr) { Array($0) })
+            }
+            cursor = info.pointee.ai_next
+        }
+        return addresses
+    }
+}
@@ -0,0 +1,270 @@
+//
+//  PacketCapture.swift
+//  RealReachability2
+//
+//  Created by RealReachability2 on 2026.
+//
+
+import Foundation
+
+/// Bounded in-memory capture of ICMP probe packets, exportable as pcapng for Wireshark.
+///
+/// Attach one to a `PingFoundation`, an `ICMPPinger` or the engine to record every echo request
+/// sent and every packet read from the probe socket, including the ones rejected as unexpected.
+/// The ring holds at most `capacity` packets of at most `snapLength` bytes each; the oldest
+/// packet is overwritten when it is full. Without a capture attached, the probe path only
+/// checks for `nil`.
+public final class PacketCapture: @unchecked Sendable {
+    /// Which way a captured packet travelled
+    public enum Direction: Sendable {
+        case inbound
+        case outbound
+    }
+
+    /// Packets kept before the oldest is overwritten
+    public let capacity: Int
+
+    /// Bytes kept per packet, counting the IP header (at least 48); longer packets are truncated
+    public let snapLength: Int
+
+    private struct Entry {
+        let timestampMicroseconds: UInt64
+        let direction: Direction
+        let isIPv6: Bool
+        let bytes: Data
+        let originalLength: Int
+    }
+
+    private let lock = NSLock()
+    private var slots: [Entry?]
+    private var nextIndex = 0
+    private var written = 0
+
+    /// Creates an empty capture with a fixed number of slots
+    /// - Parameters:
+    ///   - capacity: Packets kept (default: 256)
+    ///   - snapLength: Bytes kept per packet (default: 256)
+    public init(capacity: Int = 256, snapLength: Int = 256) {
+        self.capacity = max(1, capacity)
+        self.snapLength = max(PacketCapture.ipv6HeaderLength + 8, snapLength)
+        self.slots = Array(repeating: nil, count: self.capacity)
+    }
+
+    /// Packets currently held
+    public var packetCount: Int {
+        lock.lock()
+        defer { lock.unlock() }
+        return min(written, capacity)
+    }
+
+    /// Packets recorded since creation or the last `clear()`, including overwritten ones
+    public var totalPacketCount: Int {
+        lock.lock()
+        defer { lock.unlock() }
+        return written
+    }
+
+    /// Drops every held packet
+    public func clear() {
+        lock.lock()
+        slots = Array(repeating: nil, count: capacity)
+        nextIndex = 0
+        written = 0
+        lock.unlock()
+    }
+
+    /// The held packets as a pcapng file, oldest first.
+    ///
+    /// Interface 0 carries IPv4 packets and interface 1 IPv6 packets, both as raw IP. Outbound
+    /// packets and IPv6 replies are read from the socket without an IP header, so one is
+    /// synthesized from the socket address; the local address in it is unspecified.
+    public func pcapngData() -> Data {
+        lock.lock()
+        let entries: [Entry]
+        if written >= capacity {
+            entries = (slots[nextIndex...] + slots[..<nextIndex]).compactMap { $0 }
+        } else {
+            entries = slots[..<nextIndex].compactMap { $0 }
+        }
+        lock.unlock()
+
+        var data = Data()
+        PcapNG.appendSectionHeader(to: &data)
+        PcapNG.appendInterface(linkType: PcapNG.linkTypeIPv4, snapLength: snapLength, to: &data)
+        PcapNG.appendInterface(linkType: PcapNG.linkTypeIPv6, snapLength: snapLength, to: &data)
+        for entry in entries {
+            PcapNG.appendPacket(interface: entry.isIPv6 ? 1 : 0,
+                                timestampMicroseconds: entry.timestampMicroseconds,
+                                bytes: entry.bytes,
+                                originalLength: entry.originalLength,
+                                inbound: entry.direction == .inbound,
+                                to: &data)
+        }
+        return data
+    }
+
+    // MARK: - Recording
+
+    /// Records an ICMP packet exchanged with `peer`
+    /// - Parameters:
+    ///   - packet: ICMP message as sent, or as read from the socket (IPv4 reads include the IP header)
+    ///   - direction: Whether the packet was sent or received
+    ///   - peer: `sockaddr_in` or `sockaddr_in6` of the remote host
+    func record(_ packet: Data, direction: Direction, peer: Data) {
+        let timestamp = UInt64(max(0, Date().timeIntervalSince1970 * 1_000_000))
+        guard let datagram = ipDatagram(for: packet, direction: direction, peer: peer) else {
+            return
+        }
+
+        let entry = Entry(timestampMicroseconds: timestamp,
+                          direction: direction,
+                          isIPv6: datagram.isIPv6,
+                          bytes: datagram.bytes.prefix(snapLength),
+                          originalLength: datagram.originalLength)
+        lock.lock()
+        slots[nextIndex] = entry
+        nextIndex = (nextIndex + 1) % capacity
+        written += 1
+        lock.unlock()
+    }
+
+    private static let ipv4HeaderLength = 20
+    private static let ipv6HeaderLength = 40
+
+    /// Wraps the ICMP message in an IP header unless it already has one. Only the first
+    /// `snapLength` bytes of the payload are copied.
+    private func ipDatagram(for packet: Data, direction: Direction, peer: Data)
+        -> (isIPv6: Bool, bytes: Data, originalLength: Int)? {
+        guard peer.count >= MemoryLayout<sockaddr>.size else {
+            return nil
+        }
+        let family = peer.withUnsafeBytes { Int32($0.load(as: sockaddr.self).sa_family) }
+
+        switch family {
+        case AF_INET:
+            if direction == .inbound, packet.count >= Self.ipv4HeaderLength, packet.first.map({ $0 >> 4 }) == 4 {
+                return (false, Data(packet.prefix(snapLength)), packet.count)
+            }
+            guard peer.count >= MemoryLayout<sockaddr_in>.size else {
+                return nil
+            }
+            let address = peer.withUnsafeBytes { $0.load(as: sockaddr_in.self).sin_addr }
+            let remote = withUnsafeBytes(of: address) { Data($0) }
+            let unspecified = Data(count: 4)
+            let (source, destination) = direction == .inbound ? (remote, unspecified) : (unspecified, remote)
+
+            let totalLength = Self.ipv4HeaderLength + packet.count
+            var header = Data([0x45, 0x00, UInt8(truncatingIfNeeded: totalLength >> 8), UInt8(truncatingIfNeeded: totalLength),
+                               0x00, 0x00, 0x00, 0x00, 64, UInt8(IPPROTO_ICMP), 0x00, 0x00])
+            header.append(source)
+            header.append(destination)
+            let checksum = Self.internetChecksum(header)
+            header[10] = UInt8(checksum >> 8)
+            header[11] = UInt8(checksum & 0xFF)
+            header.append(packet.prefix(snapLength - Self.ipv4HeaderLength))
+            return (false, header, totalLength)
+
+        case AF_INET6:
+            guard peer.count >= MemoryLayout<sockaddr_in6>.size else {
+                return nil
+            }
+            let address = peer.withUnsafeBytes { $0.load(as: sockaddr_in6.self).sin6_addr }
+            let remote = withUnsafeBytes(of: address) { Data($0) }
+            let unspecified = Data(count: 16)
+            let (source, destination) = direction == .inbound ? (remote, unspecified) : (unspecified, remote)
+
+            let payloadLength = packet.count
+            var header = Data([0x60, 0x00, 0x00, 0x00,
+                               UInt8(truncatingIfNeeded: payloadLength >> 8), UInt8(truncatingIfNeeded: payloadLength),
+                               UInt8(IPPROTO_ICMPV6), 64])
+            header.append(source)
+            header.append(destination)
+            header.append(packet.prefix(snapLength - Self.ipv6HeaderLength))
+            return (true, header, Self.ipv6HeaderLength + payloadLength)
+
+        default:
+            return nil
+        }
+    }
+
+    private static func internetChecksum(_ data: Data) -> UInt16 {
+        var sum: UInt32 = 0
+        var index = data.startIndex
+        while index + 1 < data.endIndex {
+            sum += UInt32(data[index]) << 8 | UInt32(data[index + 1])
+            index += 2
+        }
+        if index < data.endIndex {
+            sum += UInt32(data[index]) << 8
+        }
+        while sum >> 16 != 0 {
+            sum = (sum & 0xFFFF) + (sum >> 16)
+        }
+        return ~UInt16(sum)
+    }
+}
+
+// MARK: - pcapng Encoding
+
+/// Little-endian pcapng blocks (draft-ietf-opsawg-pcapng)
+enum PcapNG {
+    static let sectionHeaderBlockType: UInt32 = 0x0A0D_0D0A
+    static let interfaceDescriptionBlockType: UInt32 = 0x0000_0001
+    static let enhancedPacketBlockType: UInt32 = 0x0000_0006
+    static let byteOrderMagic: UInt32 = 0x1A2B_3C4D
+
+    static let linkTypeIPv4: UInt16 = 228
+    static let linkTypeIPv6: UInt16 = 229
+
+    /// `epb_flags` option carrying the packet direction
+    static let flagsOptionCode: UInt16 = 2
+    static let inboundFlag: UInt32 = 1
+    static let outboundFlag: UInt32 = 2
+
+    static func appendSectionHeader(to data: inout Data) {
+        append(sectionHeaderBlockType, to: &data)
+        append(UInt32(28), to: &data)
+        append(byteOrderMagic, to: &data)
+        append(UInt16(1), to: &data)
+        append(UInt16(0), to: &data)
+        append(UInt64.max, to: &data)
+        append(UInt32(28), to: &data)
+    }
+
+    static func appendInterface(linkType: UInt16, snapLength: Int, to data: inout Data) {
+        append(interfaceDescriptionBlockType, to: &data)
+        append(UInt32(20), to: &data)
+        append(linkType, to: &data)
+        append(UInt16(0), to: &data)
+        append(UInt32(snapLength), to: &data)
+        append(UInt32(20), to: &data)
+    }
+
+    static func appendPacket(interface: UInt32,
+                             timestampMicroseconds: UInt64,
+                             bytes: Data,
+                             originalLength: Int,
+                             inbound: Bool,
+                             to data: inout Data) {
+        let padding = (4 - bytes.count % 4) % 4
+        let length = UInt32(28 + bytes.count + padding + 8 + 4 + 4)
+        append(enhancedPacketBlockType, to: &data)
+        append(length, to: &data)
+        append(interface, to: &data)
+        append(UInt32(truncatingIfNeeded: timestampMicroseconds >> 32), to: &data)
+        append(UInt32(truncatingIfNeeded: timestampMicroseconds), to: &data)
+        append(UInt32(bytes.count), to: &data)
+        append(UInt32(originalLength), to: &data)
+        data.append(bytes)
+        data.append(Data(count: padding))
+        append(flagsOptionCode, to: &data)
+        append(UInt16(4), to: &data)
+        append(inbound ? inboundFlag : outboundFlag, to: &data)
+        append(UInt32(0), to: &data)
+        append(length, to: &data)
+    }
+
+    private static func append<T: FixedWidthInteger>(_ value: T, to data: inout Data) {
+        withUnsafeBytes(of: value.littleEndian) { data.append(contentsOf: $0) }
+    }
+}
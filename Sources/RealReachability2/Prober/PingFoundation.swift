@@ -95,6 +95,9 @@ public final class PingFoundation: NSObject {
     
     /// Controls the IP address version used by the object
     public var addressStyle: PingAddressStyle = .any
+
+    /// Records sent and received packets when set (default: nil, no capture)
+    public var packetCapture: PacketCapture?
     
     /// The address being pinged (nil until started)
     public private(set) var hostAddress: Data?
@@ -205,6 +208,7 @@ public final class PingFoundation: NSObject {
         }
         
         if bytesSent > 0 && bytesSent == packet.count {
+            packetCapture?.record(packet, direction: .outbound, peer: hostAddress!)
             delegate?.pingFoundation(self, didSendPacket: packet, sequenceNumber: nextSequenceNumber)
         } else {
             if err == 0 { err = ENOBUFS }
@@ -398,6 +402,11 @@ public final class PingFoundation: NSObject {
         if bytesRead > 0 {
             var packet = Data(bytes: buffer, count: bytesRead)
             var sequenceNumber: UInt16 = 0
+
+            if let packetCapture = packetCapture {
+                let peer = withUnsafeBytes(of: &addr) { Data($0.prefix(Int(addrLen))) }
+                packetCapture.record(packet, direction: .inbound, peer: peer)
+            }
             
             if validatePingResponsePacket(&packet, sequenceNumber: &sequenceNumber) {
                 delegate?.pingFoundation(self, didReceivePingResponsePacket: packet, sequenceNumber: sequenceNumber)
@@ -0,0 +1,221 @@
+//
+//  PinnedAddressCache.swift
+//  RealReachability2
+//
+//  Created by RealReachability2 on 2026.
+//
+
+import Foundation
+import dnssd
+
+/// An address literal with the time-to-live of the DNS record it came from
+@available(iOS 13.0, *)
+public struct ResolvedAddress: Equatable, Sendable {
+    /// IPv4 or IPv6 literal
+    public let address: String
+
+    /// Seconds the answer may be cached
+    public let ttl: TimeInterval
+
+    public init(address: String, ttl: TimeInterval) {
+        self.address = address
+        self.ttl = ttl
+    }
+}
+
+/// Keeps a probe host's address resolved ahead of time, so HTTP probes connect straight to it.
+/// The cached address is used until its TTL runs out; after that the stale address is still used
+/// once while a refresh runs in the background. A failed connection drops it immediately.
+@available(iOS 13.0, *)
+public final class PinnedAddressCache: @unchecked Sendable {
+    /// Resolves a host name to addresses with TTLs (empty on failure)
+    public typealias Lookup = @Sendable (String) async -> [ResolvedAddress]
+
+    /// The host name being pinned
+    public let hostName: String
+
+    private let lookup: Lookup
+    private let minimumTTL: TimeInterval
+    private let lock = NSLock()
+    private var pinned: (address: String, expiry: Date)?
+    private var refreshTask: Task<String?, Never>?
+    /// Bumped by `invalidate()`; a lookup started before that does not pin its answer
+    private var generation = 0
+
+    /// Creates a cache for one host
+    /// - Parameters:
+    ///   - hostName: The host to resolve
+    ///   - minimumTTL: Floor for record TTLs, so zero-TTL answers do not put DNS back on every probe (default: 5)
+    ///   - lookup: Resolver used for (re)resolution (default: system resolver, with TTLs)
+    public init(hostName: String,
+                minimumTTL: TimeInterval = 5.0,
+                lookup: @escaping Lookup = PinnedAddressCache.systemLookup) {
+        self.hostName = hostName
+        self.minimumTTL = minimumTTL
+        self.lookup = lookup
+    }
+
+    /// The address to connect to. Only waits for DNS when nothing was resolved yet.
+    /// - Returns: The pinned address, or `nil` if the host does not resolve
+    public func address() async -> String? {
+        let (current, isFresh) = withLockedState { () -> (String?, Bool) in
+            guard let pinned else { return (nil, false) }
+            return (pinned.address, pinned.expiry > Date())
+        }
+
+        if let current {
+            if !isFresh {
+                _ = startRefresh()
+            }
+            return current
+        }
+        return await startRefresh().value
+    }
+
+    /// Resolves in the background, for example right after a network change
+    public func prefetch() {
+        _ = startRefresh()
+    }
+
+    /// Drops the pinned address after a failed connection or a network change; the next probe
+    /// resolves again. A lookup still running may answer for the previous network, so the next
+    /// refresh starts a new one instead of joining it.
+    public func invalidate() {
+        withLockedState {
+            pinned = nil
+            refreshTask = nil
+            generation += 1
+        }
+    }
+
+    /// Starts a lookup unless one is already running; concurrent callers share it.
+    private func startRefresh() -> Task<String?, Never> {
+        withLockedState {
+            if let refreshTask {
+                return refreshTask
+            }
+            let startGeneration = generation
+            let task = Task { [self] () -> String? in
+                let addresses = await lookup(hostName)
+                return withLockedState {
+                    // Invalidated meanwhile: callers already waiting get the answer, but it is
+                    // not pinned, and the refresh that replaced this one stays in place.
+                    guard generation == startGeneration else {
+                        return addresses.first?.address
+                    }
+                    refreshTask = nil
+                    // An expired pin stays usable if the refresh fails; a failed connection
+                    // already cleared it.
+                    guard let first = addresses.first else {
+                        return pinned?.address
+                    }
+                    pinned = (first.address, Date().addingTimeInterval(max(first.ttl, minimumTTL)))
+                    ReachabilityLog.debug(.dns, "Pinned \(self.hostName) -> \(first.address) ttl=\(Int(first.ttl))s")
+                    return first.address
+                }
+            }
+            refreshTask = task
+            return task
+        }
+    }
+
+    private func withLockedState<T>(_ body: () -> T) -> T {
+        lock.lock()
+        defer { lock.unlock() }
+        return body()
+    }
+
+    // MARK: - System Lookup
+
+    /// Default lookup: `DNSServiceGetAddrInfo`, which behaves like `getaddrinfo`
+    /// (NAT64 synthesis, system DNS settings) but also reports record TTLs.
+    public static let systemLookup: Lookup = { hostName in
+        await withCheckedContinuation { continuation in
+            AddressInfoQuery(hostName: hostName, timeout: 5.0).start { addresses in
+                continuation.resume(returning: addresses)
+            }
+        }
+    }
+}
+
+/// One `DNSServiceGetAddrInfo` query; everything runs on its serial queue.
+@available(iOS 13.0, *)
+private final class AddressInfoQuery {
+    private let hostName: String
+    private let timeout: TimeInterval
+    private let queue = DispatchQueue(label: "com.realreachability2.addrinfo")
+    private var serviceRef: DNSServiceRef?
+    private var addresses: [ResolvedAddress] = []
+    private var completion: (([ResolvedAddress]) -> Void)?
+    private var retainedSelf: AddressInfoQuery?
+
+    init(hostName: String, timeout: TimeInterval) {
+        self.hostName = hostName
+        self.timeout = timeout
+    }
+
+    func start(completion: @escaping ([ResolvedAddress]) -> Void) {
+        queue.async { [self] in
+            self.completion = completion
+            // The C callback only holds an unretained pointer, so the query keeps itself alive.
+            retainedSelf = self
+
+            let context = Unmanaged.passUnretained(self).toOpaque()
+            let protocols = DNSServiceProtocol(kDNSServiceProtocol_IPv4 | kDNSServiceProtocol_IPv6)
+            var ref: DNSServiceRef?
+            let error = DNSServiceGetAddrInfo(&ref, DNSServiceFlags(kDNSServiceFlagsTimeout), 0, protocols, hostName, { _, flags, _, error, _, address, ttl, context in
+                guard let context else { return }
+                let query = Unmanaged<AddressInfoQuery>.fromOpaque(context).takeUnretainedValue()
+                query.handleReply(flags: flags, error: error, address: address, ttl: ttl)
+            }, context)
+
+            guard error == DNSServiceErrorType(kDNSServiceErr_NoError), let ref else {
+                finish()
+                return
+            }
+            serviceRef = ref
+            DNSServiceSetDispatchQueue(ref, queue)
+
+            queue.asyncAfter(deadline: .now() + timeout) { [self] in
+                finish()
+            }
+        }
+    }
+
+    private func handleReply(flags: DNSServiceFlags, error: DNSServiceErrorType, address: UnsafePointer<sockaddr>?, ttl: UInt32) {
+        if error == DNSServiceErrorType(kDNSServiceErr_NoError),
+           flags & DNSServiceFlags(kDNSServiceFlagsAdd) != 0,
+           let address,
+           let literal = Self.numericHost(address) {
+            addresses.append(ResolvedAddress(address: literal, ttl: TimeInterval(ttl)))
+        }
+
+        // A family with no records reports NoSuchRecord; wait for the other one unless the batch is done.
+        let moreComing = flags & DNSServiceFlags(kDNSServiceFlagsMoreComing) != 0
+        let hardError = error != DNSServiceErrorType(kDNSServiceErr_NoError) && error != DNSServiceErrorType(kDNSServiceErr_NoSuchRecord)
+        if hardError || (!moreComing && !addresses.isEmpty) {
+            finish()
+        }
+    }
+
+    private func finish() {
+        guard let completion else {
+            return
+        }
+        self.completion = nil
+        if let serviceRef {
+            DNSServiceRefDeallocate(serviceRef)
+            self.serviceRef = nil
+        }
+        completion(addresses)
+        retainedSelf = nil
+    }
+
+    private static func numericHost(_ address: UnsafePointer<sockaddr>) -> String? {
+        var host = [CChar](repeating: 0, count: Int(NI_MAXHOST))
+        guard getnameinfo(address, socklen_t(address.pointee.sa_len), &host, socklen_t(host.count), nil, 0, NI_NUMERICHOST) == 0 else {
+            return nil
+        }
+        return String(cString: host)
+    }
+}
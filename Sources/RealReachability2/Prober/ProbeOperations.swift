@@ -0,0 +1,123 @@
+//
+//  ProbeOperations.swift
+//  RealReachability2
+//
+//  Created by RealReachability2 on 2026.
+//
+
+import Foundation
+
+/// Addresses a name resolved to, with timing
+@available(iOS 13.0, *)
+public struct DNSResolution: Sendable {
+    /// Address literals of the requested record type (empty on failure)
+    public let addresses: [String]
+
+    /// Lookup time in milliseconds (`nil` when the lookup did not answer)
+    public let latencyMs: Double?
+
+    /// Why the lookup failed (`nil` when it returned addresses)
+    public let failureReason: ProbeFailureReason?
+
+    public init(addresses: [String], latencyMs: Double?, failureReason: ProbeFailureReason?) {
+        self.addresses = addresses
+        self.latencyMs = latencyMs
+        self.failureReason = failureReason
+    }
+}
+
+/// One-shot awaitable probes for code that runs its own probe loop.
+///
+/// Every operation takes an absolute `deadline` on the uptime clock and returns by it: the prober
+/// gets the remaining time as its timeout, and a watchdog force-completes it with `.timeout` if
+/// it overruns. An operation whose deadline has already passed reports `.timeout` without
+/// touching the network. Cancelling the calling task stops the operation and reports
+/// `.cancelled`. The caller resumes on its own executor (for example the main actor), as with any
+/// `await`.
+@available(iOS 13.0, *)
+public enum ProbeOperations {
+    /// Sends one ICMP echo to `host`
+    public static func ping(_ host: String, deadline: DispatchTime) async -> ProbeResult {
+        await run(deadline: deadline) { timeout in
+            await ICMPPinger(host: host, timeout: timeout).probeWithDetails()
+        }
+    }
+
+    /// Completes a TCP handshake with `host` on `port`, sending no data
+    public static func connect(to host: String, port: UInt16, deadline: DispatchTime) async -> ProbeResult {
+        await run(deadline: deadline) { timeout in
+            await TCPProber(host: host, port: port, timeout: timeout).probeWithDetails()
+        }
+    }
+
+    /// Sends an HTTP HEAD request to `url`; succeeds on the responses `HTTPProber` accepts
+    public static func head(_ url: URL,
+                            allowsCellularAccess: Bool = true,
+                            deadline: DispatchTime) async -> ProbeResult {
+        await run(deadline: deadline) { timeout in
+            await HTTPProber(url: url, timeout: timeout).probeWithDetails(allowsCellularAccess: allowsCellularAccess)
+        }
+    }
+
+    /// Resolves `name` with the system resolver
+    public static func resolve(_ name: String,
+                               type: DNSRecordType = .a,
+                               deadline: DispatchTime) async -> DNSResolution {
+        let result = await run(deadline: deadline) { _ -> ResolvedProbe in
+            let startTime = CFAbsoluteTimeGetCurrent()
+            // getaddrinfo cannot be cancelled; the watchdog abandons it at the deadline.
+            let addresses = await Task.detached(priority: .utility) { DoHProber.systemResolve(name, type) }.value
+            let latency = (CFAbsoluteTimeGetCurrent() - startTime) * 1000
+            return ResolvedProbe(addresses: addresses,
+                                 result: ProbeResult(success: !addresses.isEmpty, latencyMs: latency,
+                                                     failureReason: .dnsFailure))
+        }
+        return DNSResolution(addresses: result.addresses,
+                             latencyMs: result.result.success ? result.result.latencyMs : nil,
+                             failureReason: result.result.failureReason)
+    }
+
+    // MARK: - Deadlines
+
+    fileprivate struct ResolvedProbe: DeadlineBound {
+        let addresses: [String]
+        let result: ProbeResult
+
+        static func failed(_ reason: ProbeFailureReason) -> ResolvedProbe {
+            ResolvedProbe(addresses: [], result: ProbeResult(success: false, failureReason: reason))
+        }
+    }
+
+    /// Runs `operation` with the time left until `deadline` as its timeout
+    fileprivate static func run<T: DeadlineBound>(deadline: DispatchTime,
+                                                  operation: @escaping @Sendable (TimeInterval) async -> T) async -> T {
+        let now = DispatchTime.now()
+        guard deadline > now else {
+            return .failed(.timeout)
+        }
+        guard !Task.isCancelled else {
+            return .failed(.cancelled)
+        }
+
+        let remaining = TimeInterval(deadline.uptimeNanoseconds - now.uptimeNanoseconds) / 1_000_000_000
+        let outcome = await ProbeWatchdog.run(deadline: remaining) {
+            await operation(remaining)
+        } onDeadline: {
+            .failed(.timeout)
+        }
+        return Task.isCancelled ? .failed(.cancelled) : outcome
+    }
+}
+
+/// A probe outcome that `ProbeOperations` can replace with a timeout or cancellation
+@available(iOS 13.0, *)
+fileprivate protocol DeadlineBound: Sendable {
+    static func failed(_ reason: ProbeFailureReason) -> Self
+}
+
+@available(iOS 13.0, *)
+extension ProbeResult: DeadlineBound {
+    fileprivate static func failed(_ reason: ProbeFailureReason) -> ProbeResult {
+        ProbeResult(success: false, failureReason: reason)
+    }
+}
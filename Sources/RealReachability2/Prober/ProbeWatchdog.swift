@@ -0,0 +1,120 @@
+//
+//  ProbeWatchdog.swift
+//  RealReachability2
+//
+//  Created by RealReachability2 on 2026.
+//
+
+import Foundation
+
+/// Enforces a hard completion deadline on a probe, independent of the prober's own timers.
+/// If the probe has not returned by the deadline, its task is cancelled and the caller
+/// resumes with the fallback value, so a prober that never resumes cannot wedge the engine.
+@available(iOS 13.0, *)
+enum ProbeWatchdog {
+    /// Runs `operation`, returning `onDeadline()` instead if it does not finish in time
+    /// - Parameters:
+    ///   - deadline: Hard deadline in seconds
+    ///   - operation: The probe to run
+    ///   - onDeadline: Produces the result reported when the deadline fires
+    /// - Returns: The operation's result, or the deadline result
+    static func run<T: Sendable>(deadline: TimeInterval,
+                                 operation: @escaping @Sendable () async -> T,
+                                 onDeadline: @escaping @Sendable () -> T) async -> T {
+        let gate = CompletionGate<T>()
+
+        return await withTaskCancellationHandler {
+            await withCheckedContinuation { continuation in
+                gate.arm(continuation)
+
+                gate.track(work: Task {
+                    gate.complete(await operation())
+                })
+
+                gate.track(timer: Task {
+                    let nanoseconds = UInt64(max(deadline, 0) * 1_000_000_000)
+                    do {
+                        try await Task.sleep(nanoseconds: nanoseconds)
+                    } catch {
+                        return
+                    }
+                    gate.complete(onDeadline())
+                })
+            }
+        } onCancel: {
+            // Only the probe is cancelled; the timer keeps running so that a probe
+            // ignoring cancellation still cannot hold the caller past the deadline.
+            gate.cancelWork()
+        }
+    }
+}
+
+/// Resumes a continuation exactly once and cancels the racing tasks afterwards
+@available(iOS 13.0, *)
+private final class CompletionGate<T>: @unchecked Sendable {
+    private let lock = NSLock()
+    private var continuation: CheckedContinuation<T, Never>?
+    private var work: Task<Void, Never>?
+    private var timer: Task<Void, Never>?
+    private var isCompleted = false
+    private var isWorkCancelled = false
+
+    func arm(_ continuation: CheckedContinuation<T, Never>) {
+        lock.lock()
+        self.continuation = continuation
+        lock.unlock()
+    }
+
+    func track(work task: Task<Void, Never>) {
+        lock.lock()
+        let completed = isCompleted
+        if !completed {
+            work = task
+        }
+        // The caller may have been cancelled before the work was tracked.
+        let cancelled = completed || isWorkCancelled
+        lock.unlock()
+
+        if cancelled {
+            task.cancel()
+        }
+    }
+
+    func track(timer task: Task<Void, Never>) {
+        lock.lock()
+        let completed = isCompleted
+        if !completed {
+            timer = task
+        }
+        lock.unlock()
+
+        if completed {
+            task.cancel()
+        }
+    }
+
+    func complete(_ value: T) {
+        lock.lock()
+        guard !isCompleted, let continuation else {
+            lock.unlock()
+            return
+        }
+        isCompleted = true
+        self.continuation = nil
+        let pending = [work, timer]
+        work = nil
+        timer = nil
+        lock.unlock()
+
+        pending.forEach { $0?.cancel() }
+        continuation.resume(returning: value)
+    }
+
+    func cancelWork() {
+        lock.lock()
+        isWorkCancelled = true
+        let task = work
+        lock.unlock()
+        task?.cancel()
+    }
+}
@@ -6,6 +6,7 @@
 //
 
 import Foundation
+import Network
 
 /// Protocol for network probers that verify internet connectivity
 @available(iOS 13.0, *)
@@ -15,6 +16,79 @@ public protocol Prober: Sendable {
     func probe() async -> Bool
 }
 
+/// Why a probe failed
+@available(iOS 13.0, *)
+public enum ProbeFailureReason: Equatable, Sendable {
+    /// Name resolution failed (for example NXDOMAIN or no DNS server)
+    case dnsFailure
+
+    /// The target actively refused the connection
+    case connectionRefused
+
+    /// An established connection was reset or lost mid-probe
+    case connectionReset
+
+    /// TLS handshake or certificate validation failed
+    case tlsFailure
+
+    /// No answer arrived before the probe timeout
+    case timeout
+
+    /// A response arrived but was not the expected one (for example a captive portal redirect)
+    case httpMismatch
+
+    /// The local stack has no route for the probe (not connected, network unreachable)
+    case noRoute
+
+    /// The probe was cancelled before it finished
+    case cancelled
+
+    /// The probe could not run with the current configuration
+    case invalidConfiguration
+
+    /// The probe did not complete by the engine's hard deadline and was force-completed
+    case watchdog
+
+    /// Any other failure
+    case unknown
+
+    /// Failures worth retrying immediately because a fresh attempt is likely to succeed
+    public var isTransient: Bool {
+        self == .connectionReset
+    }
+
+    /// Failures that will keep failing until the environment changes, so probing should back off
+    public var warrantsBackoff: Bool {
+        self == .dnsFailure || self == .invalidConfiguration
+    }
+}
+
+@available(iOS 13.0, *)
+extension ProbeFailureReason {
+    /// Maps a Network framework error from a UDP prober
+    init(_ error: NWError) {
+        switch error {
+        case .posix(let code):
+            self = ICMPPinger.failureReason(for: NSError(domain: NSPOSIXErrorDomain, code: Int(code.rawValue)))
+        case .dns:
+            self = .dnsFailure
+        case .tls:
+            self = .tlsFailure
+        @unknown default:
+            self = .unknown
+        }
+    }
+}
+
+/// How the TLS handshake of a fresh probe connection went
+@available(iOS 13.0, *)
+public enum TLSHandshake: Equatable, Sendable {
+    /// Resumed from a cached session ticket; the server presented no certificate
+    case resumed
+    /// Full handshake with certificate exchange and verification
+    case full
+}
+
 /// Result of a probe operation
 @available(iOS 13.0, *)
 public struct ProbeResult: Sendable {
@@ -26,10 +100,22 @@ public struct ProbeResult: Sendable {
     
     /// Any error that occurred during the probe
     public let error: Error?
+
+    /// Why the probe failed (`nil` when successful)
+    public let failureReason: ProbeFailureReason?
+
+    /// TLS handshake kind, for HTTPS probes that opened their own connection (`nil` otherwise)
+    public let tlsHandshake: TLSHandshake?
     
-    public init(success: Bool, latencyMs: Double? = nil, error: Error? = nil) {
+    public init(success: Bool,
+                latencyMs: Double? = nil,
+                error: Error? = nil,
+                failureReason: ProbeFailureReason? = nil,
+                tlsHandshake: TLSHandshake? = nil) {
         self.success = success
         self.latencyMs = latencyMs
         self.error = error
+        self.failureReason = success ? nil : (failureReason ?? .unknown)
+        self.tlsHandshake = tlsHandshake
     }
 }
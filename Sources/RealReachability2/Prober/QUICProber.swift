@@ -0,0 +1,263 @@
+//
+//  QUICProber.swift
+//  RealReachability2
+//
+//  Created by RealReachability2 on 2026.
+//
+
+import Foundation
+import Network
+
+/// QUIC prober for verifying that UDP traffic (and with it HTTP/3) gets through.
+/// Sends a single QUIC Initial packet with a reserved version to the target's UDP port
+/// and treats a Version Negotiation reply as success: one packet each way, no handshake.
+@available(iOS 13.0, *)
+public final class QUICProber: Prober, @unchecked Sendable {
+    /// Default host (serves HTTP/3)
+    public static let defaultHost = "www.gstatic.com"
+
+    /// Default port (HTTPS over QUIC)
+    public static let defaultPort: UInt16 = 443
+
+    /// The host to probe
+    private let host: String
+
+    /// The UDP port to probe
+    private let port: UInt16
+
+    /// Timeout interval
+    private let timeout: TimeInterval
+
+    /// Creates a new QUIC prober
+    /// - Parameters:
+    ///   - host: The host to probe (default: www.gstatic.com)
+    ///   - port: The UDP port to probe (default: 443)
+    ///   - timeout: Timeout interval in seconds (default: 5)
+    public init(host: String = QUICProber.defaultHost,
+                port: UInt16 = QUICProber.defaultPort,
+                timeout: TimeInterval = 5.0) {
+        self.host = host
+        self.port = port
+        self.timeout = timeout
+    }
+
+    /// Probes the network with a QUIC version negotiation exchange
+    /// - Returns: `true` if the probe was successful
+    public func probe() async -> Bool {
+        await probeWithDetails().success
+    }
+
+    /// Probes with detailed result including latency
+    /// - Returns: ProbeResult with success status, latency and failure reason
+    public func probeWithDetails() async -> ProbeResult {
+        let startTime = CFAbsoluteTimeGetCurrent()
+        let operation = QUICProbeOperation(host: host, port: port, timeout: timeout)
+        let failureReason: ProbeFailureReason? = await withTaskCancellationHandler {
+            await withCheckedContinuation { continuation in
+                operation.start { failureReason in
+                    continuation.resume(returning: failureReason)
+                }
+            }
+        } onCancel: {
+            operation.cancel()
+        }
+        let latency = (CFAbsoluteTimeGetCurrent() - startTime) * 1000
+        return ProbeResult(success: failureReason == nil, latencyMs: latency, error: nil, failureReason: failureReason)
+    }
+}
+
+// MARK: - Version Negotiation Packets
+
+/// Builds QUIC probe packets and validates Version Negotiation replies (RFC 9000 §17.2.1, RFC 8999)
+@available(iOS 13.0, *)
+enum QUICVersionNegotiation {
+    /// Servers ignore Initial packets in smaller datagrams, so probes are padded to this size
+    static let minimumInitialDatagramSize = 1200
+
+    /// Length of the connection IDs the probe chooses
+    static let connectionIDLength = 8
+
+    /// A random version from the reserved 0x?a?a?a?a space, which no server implements
+    static func reservedVersion() -> UInt32 {
+        (UInt32.random(in: .min ... .max) & 0xF0F0_F0F0) | 0x0A0A_0A0A
+    }
+
+    /// A random connection ID
+    static func randomConnectionID() -> [UInt8] {
+        (0..<connectionIDLength).map { _ in UInt8.random(in: .min ... .max) }
+    }
+
+    /// Builds a long-header Initial packet padded to the minimum datagram size
+    static func probePacket(version: UInt32,
+                            destinationConnectionID: [UInt8],
+                            sourceConnectionID: [UInt8]) -> Data {
+        var bytes: [UInt8] = [0xC0]
+        bytes += withUnsafeBytes(of: version.bigEndian) { Array($0) }
+        bytes.append(UInt8(destinationConnectionID.count))
+        bytes += destinationConnectionID
+        bytes.append(UInt8(sourceConnectionID.count))
+        bytes += sourceConnectionID
+        if bytes.count < minimumInitialDatagramSize {
+            bytes += [UInt8](repeating: 0, count: minimumInitialDatagramSize - bytes.count)
+        }
+        return Data(bytes)
+    }
+
+    /// Whether `packet` is a Version Negotiation reply to the probe: version 0, connection IDs
+    /// echoed back swapped, and a non-empty version list that does not offer the probed version.
+    static func isVersionNegotiation(_ packet: Data,
+                                     probedVersion: UInt32,
+                                     destinationConnectionID: [UInt8],
+                                     sourceConnectionID: [UInt8]) -> Bool {
+        let bytes = [UInt8](packet)
+        var offset = 0
+
+        func read(_ count: Int) -> ArraySlice<UInt8>? {
+            guard count >= 0, offset + count <= bytes.count else {
+                return nil
+            }
+            defer { offset += count }
+            return bytes[offset..<(offset + count)]
+        }
+
+        guard let first = read(1)?.first, first & 0x80 != 0,
+              let version = read(4), version.allSatisfy({ $0 == 0 }),
+              let dcidLength = read(1)?.first, let dcid = read(Int(dcidLength)),
+              let scidLength = read(1)?.first, let scid = read(Int(scidLength)) else {
+            return false
+        }
+
+        // The reply is addressed to our source connection ID and comes from our destination one.
+        guard Array(dcid) == sourceConnectionID, Array(scid) == destinationConnectionID else {
+            return false
+        }
+
+        let versionBytes = bytes[offset...]
+        guard !versionBytes.isEmpty, versionBytes.count % 4 == 0 else {
+            return false
+        }
+
+        var versions: [UInt32] = []
+        var index = versionBytes.startIndex
+        while index < versionBytes.endIndex {
+            versions.append(versionBytes[index..<(index + 4)].reduce(0) { ($0 << 8) | UInt32($1) })
+            index += 4
+        }
+        return !versions.contains(probedVersion)
+    }
+}
+
+// MARK: - QUIC Probe Operation
+
+/// Internal class to manage a single probe exchange over an NWConnection
+@available(iOS 13.0, *)
+private final class QUICProbeOperation {
+    /// Called with `nil` on success, or the reason the probe failed
+    typealias Completion = (ProbeFailureReason?) -> Void
+
+    private let host: String
+    private let port: UInt16
+    private let timeout: TimeInterval
+    private let queue = DispatchQueue(label: "com.realreachability2.quicprobe")
+    private let version = QUICVersionNegotiation.reservedVersion()
+    private let destinationConnectionID = QUICVersionNegotiation.randomConnectionID()
+    private let sourceConnectionID = QUICVersionNegotiation.randomConnectionID()
+    private var connection: NWConnection?
+    private var completion: Completion?
+    private var hasCompleted = false
+    private let lock = NSLock()
+
+    init(host: String, port: UInt16, timeout: TimeInterval) {
+        self.host = host
+        self.port = port
+        self.timeout = timeout
+    }
+
+    func start(completion: @escaping Completion) {
+        guard let nwPort = NWEndpoint.Port(rawValue: port), !host.isEmpty else {
+            completion(.invalidConfiguration)
+            return
+        }
+
+        lock.lock()
+        let alreadyCompleted = hasCompleted
+        if !alreadyCompleted {
+            self.completion = completion
+        }
+        lock.unlock()
+
+        if alreadyCompleted {
+            completion(.cancelled)
+            return
+        }
+
+        let connection = NWConnection(host: NWEndpoint.Host(host), port: nwPort, using: .udp)
+        lock.lock()
+        self.connection = connection
+        lock.unlock()
+
+        connection.stateUpdateHandler = { [self] state in
+            switch state {
+            case .ready:
+                sendProbe(on: connection)
+            case .waiting(let error), .failed(let error):
+                finish(failureReason: ProbeFailureReason(error))
+            default:
+                break
+            }
+        }
+        connection.start(queue: queue)
+
+        queue.asyncAfter(deadline: .now() + timeout) { [self] in
+            finish(failureReason: .timeout)
+        }
+    }
+
+    func cancel() {
+        finish(failureReason: .cancelled)
+    }
+
+    private func sendProbe(on connection: NWConnection) {
+        let packet = QUICVersionNegotiation.probePacket(version: version,
+                                                        destinationConnectionID: destinationConnectionID,
+                                                        sourceConnectionID: sourceConnectionID)
+        connection.send(content: packet, completion: .contentProcessed { [self] error in
+            if let error {
+                finish(failureReason: ProbeFailureReason(error))
+            }
+        })
+
+        connection.receiveMessage { [self] data, _, _, error in
+            if let error {
+                // An ICMP port unreachable surfaces here as ECONNREFUSED.
+                finish(failureReason: ProbeFailureReason(error))
+                return
+            }
+
+            let isVersionNegotiation = data.map {
+                QUICVersionNegotiation.isVersionNegotiation($0,
+                                                            probedVersion: version,
+                                                            destinationConnectionID: destinationConnectionID,
+                                                            sourceConnectionID: sourceConnectionID)
+            } ?? false
+            finish(failureReason: isVersionNegotiation ? nil : .httpMismatch)
+        }
+    }
+
+    private func finish(failureReason: ProbeFailureReason?) {
+        lock.lock()
+        guard !hasCompleted else {
+            lock.unlock()
+            return
+        }
+        hasCompleted = true
+        let callback = completion
+        completion = nil
+        let connection = self.connection
+        self.connection = nil
+        lock.unlock()
+
+        callback?(failureReason)
+        connection?.cancel()
+    }
+}
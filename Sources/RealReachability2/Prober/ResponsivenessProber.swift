@@ -0,0 +1,355 @@
+//
+//  ResponsivenessProber.swift
+//  RealReachability2
+//
+//  Created by RealReachability2 on 2026.
+//
+
+import Foundation
+
+/// A latency probe sampled while measuring responsiveness
+@available(iOS 13.0, *)
+public enum ResponsivenessLatencyTarget: Equatable, Sendable {
+    /// HTTP HEAD round trip (a 2xx response, or 204 for generate_204 URLs)
+    case http(URL)
+    /// ICMP echo round trip
+    case icmp(host: String)
+    /// TCP handshake time on a fresh connection
+    case tcp(host: String, port: UInt16)
+}
+
+/// Settings for a responsiveness-under-load measurement
+@available(iOS 13.0, *)
+public struct ResponsivenessConfiguration: Equatable, Sendable {
+    /// Large download used to saturate the link; streams restart until the load phase ends
+    public var loadURL: URL
+
+    /// Parallel load streams
+    public var parallelStreams: Int
+
+    /// Length of the loaded phase in seconds
+    public var loadDuration: TimeInterval
+
+    /// Hard cap on bytes the load streams may transfer
+    public var byteBudget: Int
+
+    /// Probes sampled idle, then under load, round robin
+    public var latencyTargets: [ResponsivenessLatencyTarget]
+
+    /// Rounds of idle samples taken before the load starts
+    public var idleRounds: Int
+
+    /// Pause between loaded sampling rounds
+    public var sampleInterval: TimeInterval
+
+    /// Timeout for each latency sample
+    public var timeout: TimeInterval
+
+    public init(
+        loadURL: URL = URL(string: "https://speed.cloudflare.com/__down?bytes=104857600")!,
+        parallelStreams: Int = 4,
+        loadDuration: TimeInterval = 8.0,
+        byteBudget: Int = 32 * 1024 * 1024,
+        latencyTargets: [ResponsivenessLatencyTarget] = [
+            .http(HTTPProber.defaultURL),
+            .tcp(host: QUICProber.defaultHost, port: 443)
+        ],
+        idleRounds: Int = 3,
+        sampleInterval: TimeInterval = 0.2,
+        timeout: TimeInterval = 5.0
+    ) {
+        self.loadURL = loadURL
+        self.parallelStreams = parallelStreams
+        self.loadDuration = loadDuration
+        self.byteBudget = byteBudget
+        self.latencyTargets = latencyTargets
+        self.idleRounds = idleRounds
+        self.sampleInterval = sampleInterval
+        self.timeout = timeout
+    }
+}
+
+/// Result of a responsiveness measurement
+@available(iOS 13.0, *)
+public struct ResponsivenessResult: Sendable {
+    /// Whether both idle and loaded latency could be measured
+    public let success: Bool
+
+    /// Median idle round trip in milliseconds
+    public let idleLatencyMs: Double?
+
+    /// Median round trip under load in milliseconds
+    public let loadedLatencyMs: Double?
+
+    /// Round trips per minute at idle latency
+    public let idleRoundTripsPerMinute: Double?
+
+    /// Round trips per minute under load (RPM); low values mean "connected but unusable"
+    public let roundTripsPerMinute: Double?
+
+    /// Successful idle samples
+    public let idleSampleCount: Int
+
+    /// Successful samples taken while the load streams were running
+    public let loadedSampleCount: Int
+
+    /// Bytes moved by the load streams
+    public let bytesTransferred: Int
+
+    /// Length of the loaded phase in seconds
+    public let loadedDuration: TimeInterval
+
+    /// Why the measurement failed (`nil` when successful)
+    public let failureReason: ProbeFailureReason?
+
+    /// Extra latency the load added, in milliseconds
+    public var latencyIncreaseMs: Double? {
+        guard let idleLatencyMs, let loadedLatencyMs else {
+            return nil
+        }
+        return loadedLatencyMs - idleLatencyMs
+    }
+}
+
+/// Measures responsiveness under load: latency probes are sampled at idle, then again while
+/// parallel downloads saturate the link. Idle RTT says a network works; the loaded RTT says
+/// whether it is usable when something else is using it (bufferbloat).
+@available(iOS 13.0, *)
+public final class ResponsivenessProber: @unchecked Sendable {
+    /// Measurement settings
+    public let configuration: ResponsivenessConfiguration
+
+    /// Creates a new responsiveness prober
+    /// - Parameter configuration: Load endpoint, latency targets and bounds
+    public init(configuration: ResponsivenessConfiguration = ResponsivenessConfiguration()) {
+        self.configuration = configuration
+    }
+
+    /// Runs the idle phase, then the loaded phase
+    /// - Returns: Idle and loaded latency with their RPM scores
+    public func measure() async -> ResponsivenessResult {
+        guard !configuration.latencyTargets.isEmpty,
+              configuration.parallelStreams > 0,
+              configuration.loadDuration > 0,
+              configuration.byteBudget > 0 else {
+            return Self.failure(.invalidConfiguration)
+        }
+
+        var idleLatencies: [Double] = []
+        var lastFailure: ProbeFailureReason?
+        for _ in 0..<max(configuration.idleRounds, 1) {
+            for target in configuration.latencyTargets {
+                let result = await sample(target, deadline: configuration.timeout)
+                if let latency = result.latencyMs, result.success {
+                    idleLatencies.append(latency)
+                } else {
+                    lastFailure = result.failureReason
+                }
+            }
+        }
+
+        guard let idleLatency = Self.median(idleLatencies) else {
+            return Self.failure(lastFailure ?? .unknown)
+        }
+
+        let load = LoadGenerator(url: configuration.loadURL,
+                                 streams: configuration.parallelStreams,
+                                 byteBudget: configuration.byteBudget,
+                                 timeout: configuration.loadDuration + configuration.timeout)
+        let loadStart = CFAbsoluteTimeGetCurrent()
+        let loadDeadline = loadStart + configuration.loadDuration
+        load.start()
+
+        var loadedLatencies: [Double] = []
+        sampling: while !Task.isCancelled, load.isRunning {
+            for target in configuration.latencyTargets {
+                let remaining = loadDeadline - CFAbsoluteTimeGetCurrent()
+                guard remaining > 0, load.isRunning else {
+                    break sampling
+                }
+                let result = await sample(target, deadline: min(configuration.timeout, remaining))
+                // Samples that outlived the load did not measure the loaded path.
+                if let latency = result.latencyMs, result.success, load.isRunning {
+                    loadedLatencies.append(latency)
+                }
+            }
+            try? await Task.sleep(nanoseconds: UInt64(max(configuration.sampleInterval, 0) * 1_000_000_000))
+        }
+        let loadedDuration = CFAbsoluteTimeGetCurrent() - loadStart
+        let bytesTransferred = load.stop()
+
+        let loadedLatency = Self.median(loadedLatencies)
+        let failureReason: ProbeFailureReason? = Task.isCancelled ? .cancelled
+            : (loadedLatency == nil ? (load.failureReason ?? .timeout) : nil)
+
+        let result = ResponsivenessResult(
+            success: failureReason == nil,
+            idleLatencyMs: idleLatency,
+            loadedLatencyMs: loadedLatency,
+            idleRoundTripsPerMinute: Self.roundTripsPerMinute(latencyMs: idleLatency),
+            roundTripsPerMinute: loadedLatency.flatMap { Self.roundTripsPerMinute(latencyMs: $0) },
+            idleSampleCount: idleLatencies.count,
+            loadedSampleCount: loadedLatencies.count,
+            bytesTransferred: bytesTransferred,
+            loadedDuration: loadedDuration,
+            failureReason: failureReason
+        )
+        ReachabilityLog.info(.responsiveness, String(format: "idle=%.1fms loaded=%.1fms rpm=%.0f bytes=%ld",
+                                                     idleLatency, loadedLatency ?? 0, result.roundTripsPerMinute ?? 0, bytesTransferred))
+        return result
+    }
+
+    /// Median of the samples, robust to the odd handshake or retransmission outlier
+    static func median(_ samples: [Double]) -> Double? {
+        guard !samples.isEmpty else {
+            return nil
+        }
+        let sorted = samples.sorted()
+        let middle = sorted.count / 2
+        return sorted.count % 2 == 0 ? (sorted[middle - 1] + sorted[middle]) / 2 : sorted[middle]
+    }
+
+    /// Round trips that fit in a minute at the given latency
+    static func roundTripsPerMinute(latencyMs: Double) -> Double? {
+        latencyMs > 0 ? 60_000 / latencyMs : nil
+    }
+
+    private static func failure(_ reason: ProbeFailureReason) -> ResponsivenessResult {
+        ResponsivenessResult(success: false, idleLatencyMs: nil, loadedLatencyMs: nil,
+                             idleRoundTripsPerMinute: nil, roundTripsPerMinute: nil,
+                             idleSampleCount: 0, loadedSampleCount: 0, bytesTransferred: 0,
+                             loadedDuration: 0, failureReason: reason)
+    }
+
+    // MARK: - Sampling
+
+    private func sample(_ target: ResponsivenessLatencyTarget, deadline: TimeInterval) async -> ProbeResult {
+        let timeout = configuration.timeout
+        return await ProbeWatchdog.run(deadline: deadline) {
+            switch target {
+            case .http(let url):
+                // A fresh prober per sample, so every sample pays for its own connection under load.
+                return await HTTPProber(url: url, timeout: timeout).probeWithDetails()
+            case .icmp(let host):
+                return await ICMPPinger(host: host, timeout: timeout).probeWithDetails()
+            case .tcp(let host, let port):
+                return await TCPProber(host: host, port: port, timeout: timeout).probeWithDetails()
+            }
+        } onDeadline: {
+            ProbeResult(success: false, latencyMs: nil, error: nil, failureReason: .timeout)
+        }
+    }
+}
+
+// MARK: - Load Generator
+
+/// Parallel downloads that keep the link busy until stopped or out of budget.
+/// Bodies are counted and discarded; finished streams are restarted while budget remains.
+@available(iOS 13.0, *)
+private final class LoadGenerator: NSObject, URLSessionDataDelegate, @unchecked Sendable {
+    private let url: URL
+    private let streams: Int
+    private let byteBudget: Int
+    private let lock = NSLock()
+    private var session: URLSession?
+    private var bytes = 0
+    private var running = false
+    private var lastFailure: ProbeFailureReason?
+
+    init(url: URL, streams: Int, byteBudget: Int, timeout: TimeInterval) {
+        self.url = url
+        self.streams = streams
+        self.byteBudget = byteBudget
+        super.init()
+
+        let configuration = URLSessionConfiguration.ephemeral
+        configuration.timeoutIntervalForRequest = timeout
+        configuration.timeoutIntervalForResource = timeout
+        configuration.waitsForConnectivity = false
+        configuration.requestCachePolicy = .reloadIgnoringLocalAndRemoteCacheData
+        configuration.urlCache = nil
+        // One connection per stream, so the streams compete for the bottleneck like real traffic.
+        configuration.httpMaximumConnectionsPerHost = streams
+        self.session = URLSession(configuration: configuration, delegate: self, delegateQueue: nil)
+    }
+
+    /// Whether the load streams are still running (budget left, not stopped)
+    var isRunning: Bool {
+        lock.lock()
+        defer { lock.unlock() }
+        return running
+    }
+
+    /// Why the last stream failed, if any did
+    var failureReason: ProbeFailureReason? {
+        lock.lock()
+        defer { lock.unlock() }
+        return lastFailure
+    }
+
+    func start() {
+        lock.lock()
+        running = true
+        lock.unlock()
+
+        for _ in 0..<streams {
+            startStream()
+        }
+    }
+
+    /// Stops all streams
+    /// - Returns: Bytes transferred
+    @discardableResult
+    func stop() -> Int {
+        lock.lock()
+        running = false
+        let session = self.session
+        self.session = nil
+        let transferred = bytes
+        lock.unlock()
+
+        session?.invalidateAndCancel()
+        return transferred
+    }
+
+    private func startStream() {
+        lock.lock()
+        let session = running ? self.session : nil
+        lock.unlock()
+
+        var request = URLRequest(url: url)
+        request.cachePolicy = .reloadIgnoringLocalAndRemoteCacheData
+        request.setValue("identity", forHTTPHeaderField: "Accept-Encoding")
+        session?.dataTask(with: request).resume()
+    }
+
+    func urlSession(_ session: URLSession, dataTask: URLSessionDataTask, didReceive data: Data) {
+        lock.lock()
+        bytes += data.count
+        let exhausted = bytes >= byteBudget
+        if exhausted {
+            running = false
+        }
+        lock.unlock()
+
+        if exhausted {
+            stop()
+        }
+    }
+
+    func urlSession(_ session: URLSession, task: URLSessionTask, didCompleteWithError error: Error?) {
+        if let error {
+            let reason = HTTPProber.failureReason(for: error)
+            guard reason != .cancelled else {
+                return
+            }
+            lock.lock()
+            lastFailure = reason
+            running = false
+            lock.unlock()
+            stop()
+            return
+        }
+        startStream()
+    }
+}
@@ -0,0 +1,587 @@
+//
+//  STUNProber.swift
+//  RealReachability2
+//
+//  Created by RealReachability2 on 2026.
+//
+
+import Foundation
+import Network
+
+/// A STUN server endpoint
+@available(iOS 13.0, *)
+public struct STUNServer: Hashable, Sendable {
+    /// Server host name or address literal
+    public var host: String
+
+    /// Server UDP port
+    public var port: UInt16
+
+    public init(host: String, port: UInt16 = STUNServer.defaultPort) {
+        self.host = host
+        self.port = port
+    }
+
+    /// Default STUN port
+    public static let defaultPort: UInt16 = 3478
+}
+
+/// Public address and port a NAT mapped the probe's UDP flow to
+@available(iOS 13.0, *)
+public struct STUNMappedAddress: Hashable, Sendable, CustomStringConvertible {
+    /// IPv4 or IPv6 address literal
+    public let address: String
+
+    /// Mapped UDP port
+    public let port: UInt16
+
+    public init(address: String, port: UInt16) {
+        self.address = address
+        self.port = port
+    }
+
+    public var description: String {
+        address.contains(":") ? "[\(address)]:\(port)" : "\(address):\(port)"
+    }
+}
+
+/// Result of a STUN binding probe
+@available(iOS 13.0, *)
+public struct STUNBindingResult: Sendable {
+    /// Whether any server answered, i.e. UDP egress works
+    public let success: Bool
+
+    /// Round-trip time of the first answer in milliseconds, including retransmissions
+    public let latencyMs: Double?
+
+    /// Why the probe failed (`nil` when successful)
+    public let failureReason: ProbeFailureReason?
+
+    /// NAT-mapped address reported by the first server to answer
+    public let mappedAddress: STUNMappedAddress?
+
+    /// Server that answered first
+    public let server: STUNServer?
+
+    /// Whether the mapping differs from the previous probe to the same server,
+    /// meaning the NAT rebound the flow to a new public address or port
+    public let mappingChanged: Bool
+
+    /// The equivalent generic probe result
+    public var probeResult: ProbeResult {
+        ProbeResult(success: success, latencyMs: latencyMs, error: nil, failureReason: failureReason)
+    }
+}
+
+/// STUN (RFC 5389) binding prober for verifying UDP egress and discovering the NAT-mapped address.
+/// Queries all configured servers in parallel, one flow each, and retransmits on the RFC 5389 RTO
+/// schedule. A server's flow keeps its local port across probes, in the family the server answered
+/// on, so repeated probes to the same server detect NAT rebinding.
+@available(iOS 13.0, *)
+public final class STUNProber: Prober, @unchecked Sendable {
+    /// Default public STUN servers
+    public static let defaultServers = [
+        STUNServer(host: "stun.l.google.com", port: 19302),
+        STUNServer(host: "stun.cloudflare.com", port: 3478)
+    ]
+
+    /// Default initial retransmission timeout (RFC 5389 §7.2.1)
+    public static let defaultInitialRTO: TimeInterval = 0.5
+
+    /// Default number of transmissions per server (Rc)
+    public static let defaultMaxTransmissions = 7
+
+    /// The servers queried in parallel
+    private let servers: [STUNServer]
+
+    /// Overall timeout, capping the retransmission schedule
+    private let timeout: TimeInterval
+
+    /// First retransmission timeout; doubled after every transmission
+    private let initialRTO: TimeInterval
+
+    /// Transmissions per server before giving up
+    private let maxTransmissions: Int
+
+    private let lock = NSLock()
+
+    /// Last mapping seen per server
+    private var lastMappings: [STUNServer: STUNMappedAddress] = [:]
+
+    /// Local wildcard address and port per server, kept across probes so mapping changes reflect
+    /// the NAT and not a new socket
+    private var localEndpoints: [STUNServer: NWEndpoint] = [:]
+
+    private var rebindings = 0
+
+    /// Number of probes that observed a NAT rebinding
+    public var natRebindingCount: Int {
+        lock.lock()
+        defer { lock.unlock() }
+        return rebindings
+    }
+
+    /// Creates a new STUN prober
+    /// - Parameters:
+    ///   - servers: Servers queried in parallel (default: Google and Cloudflare)
+    ///   - timeout: Overall timeout in seconds (default: 5)
+    ///   - initialRTO: First retransmission timeout in seconds (default: 0.5)
+    ///   - maxTransmissions: Transmissions per server (default: 7)
+    public init(servers: [STUNServer] = STUNProber.defaultServers,
+                timeout: TimeInterval = 5.0,
+                initialRTO: TimeInterval = STUNProber.defaultInitialRTO,
+                maxTransmissions: Int = STUNProber.defaultMaxTransmissions) {
+        self.servers = servers
+        self.timeout = timeout
+        self.initialRTO = initialRTO
+        self.maxTransmissions = max(maxTransmissions, 1)
+    }
+
+    /// Probes UDP egress with a STUN binding request
+    /// - Returns: `true` if any server answered
+    public func probe() async -> Bool {
+        await bindingRequest().success
+    }
+
+    /// Probes with detailed result including latency
+    /// - Returns: ProbeResult with success status, latency and failure reason
+    public func probeWithDetails() async -> ProbeResult {
+        await bindingRequest().probeResult
+    }
+
+    /// Sends a binding request to all servers and returns the first answer
+    /// - Returns: The result, including the mapped address and whether the NAT rebound
+    public func bindingRequest() async -> STUNBindingResult {
+        guard !servers.isEmpty else {
+            return STUNBindingResult(success: false, latencyMs: nil, failureReason: .invalidConfiguration,
+                                     mappedAddress: nil, server: nil, mappingChanged: false)
+        }
+
+        let startTime = CFAbsoluteTimeGetCurrent()
+        let pinnedEndpoints = withLockedState { localEndpoints }
+        let operations = servers.map {
+            STUNBindingOperation(server: $0,
+                                 localEndpoint: pinnedEndpoints[$0],
+                                 timeout: timeout,
+                                 initialRTO: initialRTO,
+                                 maxTransmissions: maxTransmissions)
+        }
+
+        let outcome = await withTaskCancellationHandler {
+            await withCheckedContinuation { (continuation: CheckedContinuation<STUNBindingOperation.Outcome, Never>) in
+                let gate = FirstAnswerGate(count: operations.count) { outcome in
+                    continuation.resume(returning: outcome)
+                }
+                for operation in operations {
+                    operation.start { outcome in
+                        gate.offer(outcome)
+                    }
+                }
+            }
+        } onCancel: {
+            operations.forEach { $0.cancel() }
+        }
+        operations.forEach { $0.cancel() }
+
+        let latency = (CFAbsoluteTimeGetCurrent() - startTime) * 1000
+        guard case .mapped(let server, let address, let boundEndpoint) = outcome else {
+            let failureReason: ProbeFailureReason
+            if case .failed(let reason) = outcome {
+                failureReason = reason
+            } else {
+                failureReason = .unknown
+            }
+            return STUNBindingResult(success: false, latencyMs: latency, failureReason: failureReason,
+                                     mappedAddress: nil, server: nil, mappingChanged: false)
+        }
+
+        let mappingChanged: Bool = withLockedState {
+            let pinned = localEndpoints[server]
+            if pinned == nil {
+                localEndpoints[server] = boundEndpoint
+            }
+            let previous = lastMappings[server]
+            lastMappings[server] = address
+            // A mapping seen from another local port says nothing about the NAT.
+            let changed = pinned != nil && pinned == boundEndpoint && previous != nil && previous != address
+            if changed {
+                rebindings += 1
+            }
+            return changed
+        }
+
+        if mappingChanged {
+            ReachabilityLog.notice(.stun, "NAT rebinding detected via \(server.host): now \(address)")
+        }
+        return STUNBindingResult(success: true, latencyMs: latency, failureReason: nil,
+                                 mappedAddress: address, server: server, mappingChanged: mappingChanged)
+    }
+
+    /// Forgets remembered mappings and the pinned local ports, for example after a network change
+    public func resetMappings() {
+        withLockedState {
+            lastMappings.removeAll()
+            localEndpoints.removeAll()
+        }
+    }
+
+    private func withLockedState<T>(_ body: () -> T) -> T {
+        lock.lock()
+        defer { lock.unlock() }
+        return body()
+    }
+}
+
+// MARK: - STUN Messages
+
+/// Encodes binding requests and decodes binding responses (RFC 5389 §6, §15)
+@available(iOS 13.0, *)
+enum STUNMessage {
+    static let magicCookie: UInt32 = 0x2112_A442
+    static let bindingRequest: UInt16 = 0x0001
+    static let bindingSuccessResponse: UInt16 = 0x0101
+    static let bindingErrorResponse: UInt16 = 0x0111
+    static let mappedAddressAttribute: UInt16 = 0x0001
+    static let xorMappedAddressAttribute: UInt16 = 0x0020
+    static let headerLength = 20
+
+    /// Meaning of a datagram received in reply to a request
+    enum Response: Equatable {
+        /// A success response carrying the mapped address
+        case mapped(STUNMappedAddress)
+        /// An error response for this transaction
+        case error
+        /// Not a response to this transaction (stray or malformed), keep listening
+        case unrelated
+    }
+
+    /// A random 96-bit transaction ID
+    static func randomTransactionID() -> [UInt8] {
+        (0..<12).map { _ in UInt8.random(in: .min ... .max) }
+    }
+
+    /// Builds an attribute-less binding request
+    static func bindingRequest(transactionID: [UInt8]) -> Data {
+        var bytes: [UInt8] = []
+        bytes += bigEndianBytes(bindingRequest)
+        bytes += bigEndianBytes(UInt16(0))
+        bytes += bigEndianBytes(magicCookie)
+        bytes += transactionID
+        return Data(bytes)
+    }
+
+    /// Decodes a datagram received for the transaction
+    static func parseResponse(_ data: Data, transactionID: [UInt8]) -> Response {
+        let bytes = [UInt8](data)
+        guard bytes.count >= headerLength, bytes[0] & 0xC0 == 0 else {
+            return .unrelated
+        }
+
+        let type = readUInt16(bytes, at: 0)
+        let length = Int(readUInt16(bytes, at: 2))
+        guard readUInt32(bytes, at: 4) == magicCookie,
+              Array(bytes[8..<20]) == transactionID,
+              headerLength + length <= bytes.count else {
+            return .unrelated
+        }
+
+        if type == bindingErrorResponse {
+            return .error
+        }
+        guard type == bindingSuccessResponse else {
+            return .unrelated
+        }
+
+        // Prefer XOR-MAPPED-ADDRESS; fall back to MAPPED-ADDRESS from RFC 3489 servers.
+        var mapped: STUNMappedAddress?
+        var offset = headerLength
+        let end = headerLength + length
+        while offset + 4 <= end {
+            let attributeType = readUInt16(bytes, at: offset)
+            let attributeLength = Int(readUInt16(bytes, at: offset + 2))
+            let valueStart = offset + 4
+            guard valueStart + attributeLength <= end else {
+                break
+            }
+            let value = Array(bytes[valueStart..<(valueStart + attributeLength)])
+
+            if attributeType == xorMappedAddressAttribute,
+               let address = decodeAddress(value, xorWith: bigEndianBytes(magicCookie) + transactionID) {
+                return .mapped(address)
+            }
+            if attributeType == mappedAddressAttribute, mapped == nil {
+                mapped = decodeAddress(value, xorWith: nil)
+            }
+
+            // Attribute values are padded to a multiple of 4 bytes.
+            offset = valueStart + (attributeLength + 3) / 4 * 4
+        }
+
+        return mapped.map { Response.mapped($0) } ?? .unrelated
+    }
+
+    /// Encodes an (XOR-)MAPPED-ADDRESS value: reserved, family, port, address
+    static func encodeAddress(_ address: STUNMappedAddress, xorWith mask: [UInt8]?) -> [UInt8]? {
+        var addressBytes: [UInt8]
+        let family: UInt8
+        if let ipv4 = IPv4Address(address.address) {
+            addressBytes = [UInt8](ipv4.rawValue)
+            family = 0x01
+        } else if let ipv6 = IPv6Address(address.address) {
+            addressBytes = [UInt8](ipv6.rawValue)
+            family = 0x02
+        } else {
+            return nil
+        }
+
+        var portBytes = bigEndianBytes(address.port)
+        if let mask {
+            portBytes = zip(portBytes, mask).map { $0 ^ $1 }
+            addressBytes = zip(addressBytes, mask).map { $0 ^ $1 }
+        }
+        return [0, family] + portBytes + addressBytes
+    }
+
+    private static func decodeAddress(_ value: [UInt8], xorWith mask: [UInt8]?) -> STUNMappedAddress? {
+        guard value.count >= 8 else {
+            return nil
+        }
+
+        let addressLength: Int
+        switch value[1] {
+        case 0x01:
+            addressLength = 4
+        case 0x02:
+            addressLength = 16
+        default:
+            return nil
+        }
+        guard value.count >= 4 + addressLength else {
+            return nil
+        }
+
+        var portBytes = Array(value[2..<4])
+        var addressBytes = Array(value[4..<(4 + addressLength)])
+        if let mask {
+            portBytes = zip(portBytes, mask).map { $0 ^ $1 }
+            addressBytes = zip(addressBytes, mask).map { $0 ^ $1 }
+        }
+
+        let port = UInt16(portBytes[0]) << 8 | UInt16(portBytes[1])
+        let literal: String?
+        if addressLength == 4 {
+            literal = IPv4Address(Data(addressBytes)).map { "\($0)" }
+        } else {
+            literal = IPv6Address(Data(addressBytes)).map { "\($0)" }
+        }
+        return literal.map { STUNMappedAddress(address: $0, port: port) }
+    }
+
+    static func bigEndianBytes<T: FixedWidthInteger>(_ value: T) -> [UInt8] {
+        withUnsafeBytes(of: value.bigEndian) { Array($0) }
+    }
+
+    private static func readUInt16(_ bytes: [UInt8], at offset: Int) -> UInt16 {
+        UInt16(bytes[offset]) << 8 | UInt16(bytes[offset + 1])
+    }
+
+    private static func readUInt32(_ bytes: [UInt8], at offset: Int) -> UInt32 {
+        bytes[offset..<(offset + 4)].reduce(0) { ($0 << 8) | UInt32($1) }
+    }
+}
+
+// MARK: - Binding Operation
+
+/// Resolves once with the first success, or with a failure after every server has failed
+@available(iOS 13.0, *)
+private final class FirstAnswerGate {
+    private let lock = NSLock()
+    private var remaining: Int
+    private var firstFailure: ProbeFailureReason?
+    private var completion: ((STUNBindingOperation.Outcome) -> Void)?
+
+    init(count: Int, completion: @escaping (STUNBindingOperation.Outcome) -> Void) {
+        self.remaining = count
+        self.completion = completion
+    }
+
+    func offer(_ outcome: STUNBindingOperation.Outcome) {
+        lock.lock()
+        remaining -= 1
+        var resolved: STUNBindingOperation.Outcome?
+        switch outcome {
+        case .mapped:
+            resolved = outcome
+        case .failed(let reason):
+            // Report the most specific failure: a timeout only if nothing else went wrong.
+            if firstFailure == nil || firstFailure == .timeout || firstFailure == .cancelled {
+                firstFailure = reason
+            }
+            if remaining == 0 {
+                resolved = .failed(firstFailure ?? reason)
+            }
+        }
+        let callback = resolved == nil ? nil : completion
+        if callback != nil {
+            completion = nil
+        }
+        lock.unlock()
+
+        if let callback, let resolved {
+            callback(resolved)
+        }
+    }
+}
+
+/// One binding transaction with one server over an NWConnection
+@available(iOS 13.0, *)
+private final class STUNBindingOperation {
+    enum Outcome {
+        /// The server answered; carries the wildcard local endpoint to pin later probes to
+        case mapped(STUNServer, STUNMappedAddress, NWEndpoint?)
+        case failed(ProbeFailureReason)
+    }
+
+    private let server: STUNServer
+    private let localEndpoint: NWEndpoint?
+    private let timeout: TimeInterval
+    private let initialRTO: TimeInterval
+    private let maxTransmissions: Int
+    private let queue = DispatchQueue(label: "com.realreachability2.stunprobe")
+    private let transactionID = STUNMessage.randomTransactionID()
+    private var connection: NWConnection?
+    private var completion: ((Outcome) -> Void)?
+    private var hasCompleted = false
+    private var transmissions = 0
+    private let lock = NSLock()
+
+    init(server: STUNServer, localEndpoint: NWEndpoint?, timeout: TimeInterval, initialRTO: TimeInterval, maxTransmissions: Int) {
+        self.server = server
+        self.localEndpoint = localEndpoint
+        self.timeout = timeout
+        self.initialRTO = initialRTO
+        self.maxTransmissions = maxTransmissions
+    }
+
+    func start(completion: @escaping (Outcome) -> Void) {
+        guard let port = NWEndpoint.Port(rawValue: server.port), !server.host.isEmpty else {
+            completion(.failed(.invalidConfiguration))
+            return
+        }
+
+        lock.lock()
+        let alreadyCompleted = hasCompleted
+        if !alreadyCompleted {
+            self.completion = completion
+        }
+        lock.unlock()
+
+        if alreadyCompleted {
+            completion(.failed(.cancelled))
+            return
+        }
+
+        let parameters = NWParameters.udp
+        if let localEndpoint {
+            parameters.allowLocalEndpointReuse = true
+            parameters.requiredLocalEndpoint = localEndpoint
+        }
+
+        let connection = NWConnection(host: NWEndpoint.Host(server.host), port: port, using: parameters)
+        lock.lock()
+        self.connection = connection
+        lock.unlock()
+
+        connection.stateUpdateHandler = { [self] state in
+            switch state {
+            case .ready:
+                receive(on: connection)
+                transmit(on: connection, rto: initialRTO)
+            case .waiting(let error), .failed(let error):
+                finish(.failed(ProbeFailureReason(error)))
+            default:
+                break
+            }
+        }
+        connection.start(queue: queue)
+
+        queue.asyncAfter(deadline: .now() + timeout) { [self] in
+            finish(.failed(.timeout))
+        }
+    }
+
+    func cancel() {
+        finish(.failed(.cancelled))
+    }
+
+    /// Sends the request, then retransmits after `rto`, doubling it each time (RFC 5389 §7.2.1).
+    /// After the last transmission the overall timeout decides.
+    private func transmit(on connection: NWConnection, rto: TimeInterval) {
+        lock.lock()
+        guard !hasCompleted, transmissions < maxTransmissions else {
+            lock.unlock()
+            return
+        }
+        transmissions += 1
+        lock.unlock()
+
+        connection.send(content: STUNMessage.bindingRequest(transactionID: transactionID),
+                        completion: .contentProcessed { [self] error in
+            if let error {
+                finish(.failed(ProbeFailureReason(error)))
+            }
+        })
+
+        queue.asyncAfter(deadline: .now() + rto) { [self] in
+            transmit(on: connection, rto: rto * 2)
+        }
+    }
+
+    private func receive(on connection: NWConnection) {
+        connection.receiveMessage { [self] data, _, _, error in
+            if let error {
+                // An ICMP port unreachable surfaces here as ECONNREFUSED.
+                finish(.failed(ProbeFailureReason(error)))
+                return
+            }
+
+            switch data.map({ STUNMessage.parseResponse($0, transactionID: transactionID) }) ?? .unrelated {
+            case .mapped(let address):
+                finish(.mapped(server, address, pinnableLocalEndpoint(of: connection)))
+            case .error:
+                finish(.failed(.httpMismatch))
+            case .unrelated:
+                receive(on: connection)
+            }
+        }
+    }
+
+    /// The flow's local port on the wildcard address of its family, so the pin survives
+    /// interface address changes on the same network
+    private func pinnableLocalEndpoint(of connection: NWConnection) -> NWEndpoint? {
+        guard case .hostPort(let host, let port)? = connection.currentPath?.localEndpoint else {
+            return nil
+        }
+        if case .ipv4 = host {
+            return .hostPort(host: .ipv4(.any), port: port)
+        }
+        return .hostPort(host: .ipv6(.any), port: port)
+    }
+
+    private func finish(_ outcome: Outcome) {
+        lock.lock()
+        guard !hasCompleted else {
+            lock.unlock()
+            return
+        }
+        hasCompleted = true
+        let callback = completion
+        completion = nil
+        let connection = self.connection
+        self.connection = nil
+        lock.unlock()
+
+        callback?(outcome)
+        connection?.cancel()
+    }
+}
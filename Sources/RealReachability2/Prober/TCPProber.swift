@@ -0,0 +1,152 @@
+//
+//  TCPProber.swift
+//  RealReachability2
+//
+//  Created by RealReachability2 on 2026.
+//
+
+import Foundation
+import Network
+
+/// TCP connect prober: succeeds once the three-way handshake with the target port completes,
+/// then closes the connection without sending data.
+@available(iOS 13.0, *)
+public final class TCPProber: Prober, @unchecked Sendable {
+    /// The host to probe
+    private let host: String
+
+    /// The TCP port to probe
+    private let port: UInt16
+
+    /// Timeout interval
+    private let timeout: TimeInterval
+
+    /// Queue the connection's events are delivered on
+    private let queue: DispatchQueue
+
+    /// Creates a new TCP prober
+    /// - Parameters:
+    ///   - host: The host to probe
+    ///   - port: The TCP port to probe
+    ///   - timeout: Timeout interval in seconds (default: 5)
+    ///   - queue: Queue for connection events (default: a private serial queue)
+    public init(host: String,
+                port: UInt16,
+                timeout: TimeInterval = 5.0,
+                queue: DispatchQueue = DispatchQueue(label: "com.realreachability2.tcpprobe")) {
+        self.host = host
+        self.port = port
+        self.timeout = timeout
+        self.queue = queue
+    }
+
+    /// Probes the target with a TCP handshake
+    /// - Returns: `true` if the handshake completed
+    public func probe() async -> Bool {
+        await probeWithDetails().success
+    }
+
+    /// Probes with detailed result including latency
+    /// - Returns: ProbeResult with success status, handshake latency and failure reason
+    public func probeWithDetails() async -> ProbeResult {
+        let startTime = CFAbsoluteTimeGetCurrent()
+        let operation = TCPProbeOperation(host: host, port: port, timeout: timeout, queue: queue)
+        let failureReason: ProbeFailureReason? = await withTaskCancellationHandler {
+            await withCheckedContinuation { continuation in
+                operation.start { failureReason in
+                    continuation.resume(returning: failureReason)
+                }
+            }
+        } onCancel: {
+            operation.cancel()
+        }
+        let latency = (CFAbsoluteTimeGetCurrent() - startTime) * 1000
+        return ProbeResult(success: failureReason == nil, latencyMs: latency, error: nil, failureReason: failureReason)
+    }
+}
+
+// MARK: - TCP Probe Operation
+
+/// Internal class to manage a single connect attempt over an NWConnection
+@available(iOS 13.0, *)
+private final class TCPProbeOperation {
+    /// Called with `nil` on success, or the reason the probe failed
+    typealias Completion = (ProbeFailureReason?) -> Void
+
+    private let host: String
+    private let port: UInt16
+    private let timeout: TimeInterval
+    private let queue: DispatchQueue
+    private var connection: NWConnection?
+    private var completion: Completion?
+    private var hasCompleted = false
+    private let lock = NSLock()
+
+    init(host: String, port: UInt16, timeout: TimeInterval, queue: DispatchQueue) {
+        self.host = host
+        self.port = port
+        self.timeout = timeout
+        self.queue = queue
+    }
+
+    func start(completion: @escaping Completion) {
+        guard let nwPort = NWEndpoint.Port(rawValue: port), port != 0, !host.isEmpty else {
+            completion(.invalidConfiguration)
+            return
+        }
+
+        lock.lock()
+        let alreadyCompleted = hasCompleted
+        if !alreadyCompleted {
+            self.completion = completion
+        }
+        lock.unlock()
+
+        if alreadyCompleted {
+            completion(.cancelled)
+            return
+        }
+
+        let connection = NWConnection(host: NWEndpoint.Host(host), port: nwPort, using: .tcp)
+        lock.lock()
+        self.connection = connection
+        lock.unlock()
+
+        connection.stateUpdateHandler = { [self] state in
+            switch state {
+            case .ready:
+                finish(failureReason: nil)
+            case .waiting(let error), .failed(let error):
+                finish(failureReason: ProbeFailureReason(error))
+            default:
+                break
+            }
+        }
+        connection.start(queue: queue)
+
+        queue.asyncAfter(deadline: .now() + timeout) { [self] in
+            finish(failureReason: .timeout)
+        }
+    }
+
+    func cancel() {
+        finish(failureReason: .cancelled)
+    }
+
+    private func finish(failureReason: ProbeFailureReason?) {
+        lock.lock()
+        guard !hasCompleted else {
+            lock.unlock()
+            return
+        }
+        hasCompleted = true
+        let callback = completion
+        completion = nil
+        let connection = self.connection
+        self.connection = nil
+        lock.unlock()
+
+        callback?(failureReason)
+        connection?.cancel()
+    }
+}
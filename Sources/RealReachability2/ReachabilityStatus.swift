@@ -30,7 +30,7 @@ public enum ReachabilityStatus: Equatable, Sendable {
 
 /// The type of network connection
 @available(iOS 13.0, *)
-public enum ConnectionType: Equatable, Sendable {
+public enum ConnectionType: Hashable, Sendable {
     /// WiFi connection
     case wifi
     
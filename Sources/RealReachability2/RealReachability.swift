@@ -19,6 +19,62 @@ public enum ProbeMode: Sendable {
 
     /// Use only ICMP ping probe
     case icmpOnly
+
+    /// Use only a QUIC version negotiation probe over UDP (detects networks that block HTTP/3)
+    case quicOnly
+}
+
+/// Probe strategy for one connection type
+@available(iOS 13.0, *)
+public struct ProbeProfile: Hashable, Sendable {
+    /// Probe mode to use on this link
+    public var probeMode: ProbeMode
+
+    /// Timeout for probe requests
+    public var timeout: TimeInterval
+
+    /// Interval between periodic probes while the notifier is running
+    public var periodicProbeInterval: TimeInterval
+
+    /// HTTP probe URL
+    public var httpProbeURL: URL
+
+    /// ICMP ping host
+    public var icmpHost: String
+
+    /// ICMP ping port
+    public var icmpPort: UInt16
+
+    /// QUIC probe host
+    public var quicHost: String
+
+    /// QUIC probe UDP port
+    public var quicPort: UInt16
+
+    /// Adds the QUIC probe as a third branch of `.parallel` mode
+    public var includesQUICInParallel: Bool
+
+    public init(
+        probeMode: ProbeMode = .parallel,
+        timeout: TimeInterval = 5.0,
+        periodicProbeInterval: TimeInterval = 5.0,
+        httpProbeURL: URL = HTTPProber.defaultURL,
+        icmpHost: String = ICMPPinger.defaultHost,
+        icmpPort: UInt16 = ICMPPinger.defaultPort,
+        quicHost: String = QUICProber.defaultHost,
+        quicPort: UInt16 = QUICProber.defaultPort,
+        includesQUICInParallel: Bool = false
+    ) {
+        self.probeMode = probeMode
+        self.timeout = timeout
+        self.periodicProbeInterval = periodicProbeInterval
+        self.httpProbeURL = httpProbeURL
+        self.icmpHost = icmpHost
+        self.icmpPort = icmpPort
+        self.quicHost = quicHost
+        self.quicPort = quicPort
+        self.includesQUICInParallel = includesQUICInParallel
+    }
 }
 
 /// Configuration for RealReachability
@@ -39,13 +95,52 @@ public struct ReachabilityConfiguration: Sendable {
     /// ICMP ping port
     public var icmpPort: UInt16
 
+    /// QUIC probe host
+    public var quicHost: String
+
+    /// QUIC probe UDP port
+    public var quicPort: UInt16
+
+    /// Adds the QUIC probe as a third branch of `.parallel` mode
+    public var includesQUICInParallel: Bool
+
     /// Enables periodic probing while notifier is running.
     public var periodicProbeEnabled: Bool
 
     /// Enables cellular fallback when primary Wi-Fi probe fails.
-    /// Requires HTTP participation (.parallel or .httpOnly). Invalid with .icmpOnly.
+    /// Requires HTTP participation (.parallel or .httpOnly). Invalid with .icmpOnly or .quicOnly.
     public var allowCellularFallback: Bool
 
+    /// Per-connection-type overrides (for example ICMP-only on wired, sparse probing on cellular).
+    /// Connection types without an entry use the top-level settings above.
+    public var profiles: [ConnectionType: ProbeProfile]
+
+    /// Scales the periodic interval with the learned connectivity pattern of the current network:
+    /// faster just before a likely outage, slower during reliably stable periods.
+    public var predictiveSchedulingEnabled: Bool
+
+    /// Opt-in throughput estimation (`nil` disables it). Estimates run on demand through
+    /// `estimateBandwidth()`, and automatically on unmetered paths if the configuration asks for it.
+    public var bandwidthProbe: BandwidthProbeConfiguration?
+
+    /// Connects HTTP probes to a pre-resolved address of the probe host (with the host as TLS server
+    /// name), so probe latency measures the path to the server rather than the resolver. The address
+    /// is refreshed when its DNS TTL runs out, after a failed probe, and on link changes.
+    public var pinsHTTPProbeAddress: Bool
+
+    /// Responsiveness-under-load measurement used by `measureResponsiveness()` (`nil` disables it).
+    /// It saturates the link for its load duration, so it never runs automatically.
+    public var responsivenessProbe: ResponsivenessConfiguration?
+
+    /// DNS-over-HTTPS lookup compared with the system resolver by `checkDNSHealth()`
+    /// (`nil` disables it). Reported separately, so it never changes reachability status.
+    public var dnsHealthProbe: DNSHealthProbeConfiguration?
+
+    /// Seconds over which `statusStream` merges bursts of changes (0 disables merging).
+    /// The first change is delivered at once; later ones inside the window are merged and only
+    /// the net transition is delivered when it closes. See `flushStatusDelivery()`.
+    public var statusDeliveryWindow: TimeInterval
+
     /// Default configuration
     public static let `default` = ReachabilityConfiguration(
         probeMode: .parallel,
@@ -53,8 +148,18 @@ public struct ReachabilityConfiguration: Sendable {
         httpProbeURL: HTTPProber.defaultURL,
         icmpHost: ICMPPinger.defaultHost,
         icmpPort: ICMPPinger.defaultPort,
+        quicHost: QUICProber.defaultHost,
+        quicPort: QUICProber.defaultPort,
+        includesQUICInParallel: false,
         periodicProbeEnabled: true,
-        allowCellularFallback: false
+        allowCellularFallback: false,
+        profiles: [:],
+        predictiveSchedulingEnabled: false,
+        bandwidthProbe: nil,
+        pinsHTTPProbeAddress: false,
+        responsivenessProbe: nil,
+        dnsHealthProbe: nil,
+        statusDeliveryWindow: 0
     )
 
     public init(
@@ -63,16 +168,72 @@ public struct ReachabilityConfiguration: Sendable {
         httpProbeURL: URL = HTTPProber.defaultURL,
         icmpHost: String = ICMPPinger.defaultHost,
         icmpPort: UInt16 = ICMPPinger.defaultPort,
+        quicHost: String = QUICProber.defaultHost,
+        quicPort: UInt16 = QUICProber.defaultPort,
+        includesQUICInParallel: Bool = false,
         periodicProbeEnabled: Bool = true,
-        allowCellularFallback: Bool = false
+        allowCellularFallback: Bool = false,
+        profiles: [ConnectionType: ProbeProfile] = [:],
+        predictiveSchedulingEnabled: Bool = false,
+        bandwidthProbe: BandwidthProbeConfiguration? = nil,
+        pinsHTTPProbeAddress: Bool = false,
+        responsivenessProbe: ResponsivenessConfiguration? = nil,
+        dnsHealthProbe: DNSHealthProbeConfiguration? = nil,
+        statusDeliveryWindow: TimeInterval = 0
     ) {
         self.probeMode = probeMode
         self.timeout = timeout
         self.httpProbeURL = httpProbeURL
         self.icmpHost = icmpHost
         self.icmpPort = icmpPort
+        self.quicHost = quicHost
+        self.quicPort = quicPort
+        self.includesQUICInParallel = includesQUICInParallel
         self.periodicProbeEnabled = periodicProbeEnabled
         self.allowCellularFallback = allowCellularFallback
+        self.profiles = profiles
+        self.predictiveSchedulingEnabled = predictiveSchedulingEnabled
+        self.bandwidthProbe = bandwidthProbe
+        self.pinsHTTPProbeAddress = pinsHTTPProbeAddress
+        self.responsivenessProbe = responsivenessProbe
+        self.dnsHealthProbe = dnsHealthProbe
+        self.statusDeliveryWindow = statusDeliveryWindow
+    }
+
+    /// The profile used on a connection type: its override, or the top-level settings.
+    public func profile(for connectionType: ConnectionType) -> ProbeProfile {
+        if let profile = profiles[connectionType] {
+            return profile
+        }
+        return ProbeProfile(
+            probeMode: probeMode,
+            timeout: timeout,
+            periodicProbeInterval: Self.defaultPeriodicProbeInterval,
+            httpProbeURL: httpProbeURL,
+            icmpHost: icmpHost,
+            icmpPort: icmpPort,
+            quicHost: quicHost,
+            quicPort: quicPort,
+            includesQUICInParallel: includesQUICInParallel
+        )
+    }
+
+    /// Periodic interval used when no profile overrides it
+    static let defaultPeriodicProbeInterval: TimeInterval = 5.0
+}
+
+/// Outcome of `RealReachability.resume()`
+@available(iOS 13.0, *)
+public struct ResumeReport: Equatable, Sendable {
+    /// Seconds between the last confirmed status and resuming (`nil` if there was none)
+    public let staleness: TimeInterval?
+
+    /// Status after the catch-up probe
+    public let status: ReachabilityStatus
+
+    public init(staleness: TimeInterval?, status: ReachabilityStatus) {
+        self.staleness = staleness
+        self.status = status
     }
 }
 
@@ -82,9 +243,53 @@ public final class RealReachability: @unchecked Sendable {
     private struct ProbeOutcome {
         let reachable: Bool
         let secondaryReachable: Bool
+        let failureReason: ProbeFailureReason?
+
+        init(reachable: Bool, secondaryReachable: Bool, failureReason: ProbeFailureReason?) {
+            self.reachable = reachable
+            self.secondaryReachable = secondaryReachable
+            self.failureReason = reachable ? nil : failureReason
+        }
+
+        init(_ result: ProbeResult, secondaryReachable: Bool = false) {
+            self.init(reachable: result.success, secondaryReachable: secondaryReachable, failureReason: result.failureReason)
+        }
     }
 
-    private static let periodicProbeInterval: UInt64 = 5_000_000_000
+    /// Cache keys for probers, so profiles sharing a target also share its warm session
+    private struct HTTPProberKey: Hashable {
+        let url: URL
+        let timeout: TimeInterval
+        let pinsAddress: Bool
+    }
+
+    private struct ICMPPingerKey: Hashable {
+        let host: String
+        let port: UInt16
+        let timeout: TimeInterval
+        let capture: ObjectIdentifier?
+    }
+
+    private struct QUICProberKey: Hashable {
+        let host: String
+        let port: UInt16
+        let timeout: TimeInterval
+    }
+
+    /// Probe work the scheduler deduplicates: one reachability probe per link type, one throughput estimate
+    private enum ProbeWork: Hashable {
+        case reachability(ConnectionType)
+        case bandwidth
+    }
+
+    /// Probe work allowed to run at once; a reachability probe and a throughput estimate fit side by side
+    private static let maxConcurrentProbeWork = 2
+
+    /// Upper bound for the periodic interval multiplier applied after persistent failures
+    private static let maxPeriodicBackoffFactor: UInt64 = 8
+
+    /// Slack added to the watchdog deadline on top of the probers' own timeouts
+    private static let watchdogGracePeriod: TimeInterval = 2.0
 
     /// Shared singleton instance
     public static let shared = RealReachability()
@@ -100,11 +305,29 @@ public final class RealReachability: @unchecked Sendable {
     /// Path monitor wrapper
     private let pathMonitor: PathMonitorWrapper
 
-    /// HTTP prober
-    private var httpProber: HTTPProber
+    /// HTTP probers by target, shared across profiles
+    private var httpProbers: [HTTPProberKey: HTTPProber] = [:]
+
+    /// ICMP pingers by target, shared across profiles
+    private var icmpPingers: [ICMPPingerKey: ICMPPinger] = [:]
+
+    /// QUIC probers by target, shared across profiles
+    private var quicProbers: [QUICProberKey: QUICProber] = [:]
 
-    /// ICMP pinger
-    private var icmpPinger: ICMPPinger
+    /// Connection type of the most recently applied probe, selecting the active profile
+    private var activeConnectionType: ConnectionType?
+
+    /// Connection type of the last path update, to detect link switches
+    private var lastPathConnectionType: ConnectionType?
+
+    /// Network of the most recently applied probe, so path loss can be attributed to it
+    private var lastProbedNetworkKey: String?
+
+    /// NAT64 prefix discovery, cached per network
+    private let nat64Resolver: NAT64PrefixResolver
+
+    /// Daily connectivity pattern learned from probe results, used for predictive scheduling
+    public let connectivityPredictor: ConnectivityPredictor
 
     /// Lock for thread-safe access
     private let lock = NSLock()
@@ -118,9 +341,32 @@ public final class RealReachability: @unchecked Sendable {
     /// Continuation for the status stream
     private var statusContinuation: AsyncStream<ReachabilityStatus>.Continuation?
 
+    /// A change as seen by stream subscribers
+    private struct StatusChange: Equatable {
+        let status: ReachabilityStatus
+        let secondaryReachable: Bool
+    }
+
+    /// Merges status changes per `statusDeliveryWindow` before they reach the stream
+    private let statusCoalescer: StatusCoalescer<StatusChange>
+
     /// Whether the notifier is running
     private var isNotifierRunning = false
 
+    /// Whether the running notifier is suspended: no timers, path monitor or open connections
+    private var isSuspended = false
+
+    /// Bumped by `suspend()` and `stopNotifier()`, so a catch-up probe started before either is dropped
+    private var lifecycleGeneration: UInt64 = 0
+
+    /// When a probe or path loss last confirmed the status
+    private var lastStatusDate: Date?
+
+    /// Whether probes and timers should run; read under `lock`
+    private var isMonitoring: Bool {
+        isNotifierRunning && !isSuspended
+    }
+
     /// Task consuming path monitor updates
     private var pathMonitorTask: Task<Void, Never>?
 
@@ -133,9 +379,48 @@ public final class RealReachability: @unchecked Sendable {
     /// Last pending path update while probe is in flight
     private var pendingProbePath: NWPath?
 
+    /// Highest priority among the triggers folded into `pendingProbePath`
+    private var pendingProbePriority: ProbePriority = .periodic
+
+    /// Admits probes by priority, so checks join or preempt background work instead of queueing behind it
+    private let probeScheduler = ProbeScheduler<ProbeWork>(maxConcurrentOperations: RealReachability.maxConcurrentProbeWork)
+
+    /// Aligns periodic wakeups and shares identical probes with the other engines in the process
+    private let probeCoordinator: ProbeCoordinator
+
+    /// This engine's probes, and how many of them ran as their own network operation
+    private var sharingCounts = ProbeSharingCounts()
+
     /// Monotonic sequence for invalidating stale probe results
     private var probeSequence: UInt64 = 0
 
+    /// Why the most recent probe failed (`nil` after a successful probe)
+    private var currentFailureReason: ProbeFailureReason?
+
+    /// Periodic interval multiplier, grown on failures that warrant backoff (for example DNS)
+    private var periodicBackoffFactor: UInt64 = 1
+
+    /// Number of probes force-completed by the watchdog
+    private var watchdogFires = 0
+
+    /// Most recent throughput estimate
+    private var currentBandwidthEstimate: BandwidthEstimate?
+
+    /// Networks that already had their automatic throughput estimate
+    private var bandwidthEstimatedNetworkKeys: Set<String> = []
+
+    /// Automatic throughput estimate in flight
+    private var bandwidthTask: Task<Void, Never>?
+
+    /// DoH prober kept across checks so its HTTPS connection stays warm
+    private var dohProber: DoHProber?
+
+    /// Most recent DNS health check
+    private var currentDNSHealth: DNSHealthResult?
+
+    /// Capture handed to ICMP pingers
+    private var currentPacketCapture: PacketCapture?
+
     /// Whether current status is reachable through secondary fallback link.
     public var isSecondaryReachable: Bool {
         lock.lock()
@@ -143,13 +428,125 @@ public final class RealReachability: @unchecked Sendable {
         return currentSecondaryReachable
     }
 
+    /// Profile in effect for the current link (the `.other` profile before the first probe).
+    public var activeProfile: ProbeProfile {
+        lock.lock()
+        defer { lock.unlock() }
+        guard let activeConnectionType else {
+            return configuration.profile(for: .other)
+        }
+        return configuration.profile(for: activeConnectionType)
+    }
+
+    /// Number of probes the watchdog had to force-complete because a prober never returned.
+    public var watchdogFireCount: Int {
+        lock.lock()
+        defer { lock.unlock() }
+        return watchdogFires
+    }
+
+    /// Resumed versus full TLS handshakes of pinned HTTPS probes (see `pinsHTTPProbeAddress`),
+    /// summed over the probers of the current configuration.
+    public var tlsHandshakeCounts: TLSHandshakeCounts {
+        let probers = withLockedState { Array(httpProbers.values) }
+        return probers.reduce(into: TLSHandshakeCounts()) { total, prober in
+            let counts = prober.tlsHandshakeCounts
+            total.resumed += counts.resumed
+            total.full += counts.full
+        }
+    }
+
+    /// Records the packets of ICMP probes when set; `nil` (the default) disables capture.
+    /// Takes effect from the next probe.
+    public var packetCapture: PacketCapture? {
+        get {
+            lock.lock()
+            defer { lock.unlock() }
+            return currentPacketCapture
+        }
+        set {
+            lock.lock()
+            currentPacketCapture = newValue
+            lock.unlock()
+            updateProbers()
+        }
+    }
+
+    /// How probe requests were started, joined to work in flight, or preempted by higher-priority work.
+    public var probeSchedulerCounts: ProbeSchedulerCounts {
+        probeScheduler.counts
+    }
+
+    /// Probes this engine requested versus the ones it ran itself; the rest reused the outcome
+    /// of an identical probe another engine had in flight.
+    public var probeSharingCounts: ProbeSharingCounts {
+        withLockedState { sharingCounts }
+    }
+
+    /// Probes requested versus network operations performed, over every engine in the process.
+    public static var globalProbeSharingCounts: ProbeSharingCounts {
+        ProbeCoordinator.shared.counts
+    }
+
+    /// Status changes delivered to `statusStream` versus merged by `statusDeliveryWindow`.
+    public var statusDeliveryCounts: StatusDeliveryCounts {
+        statusCoalescer.counts
+    }
+
+    /// Why the most recent probe failed, or `nil` if it succeeded.
+    public var lastFailureReason: ProbeFailureReason? {
+        lock.lock()
+        defer { lock.unlock() }
+        return currentFailureReason
+    }
+
+    /// The most recent throughput estimate, on demand or automatic.
+    public var lastBandwidthEstimate: BandwidthEstimate? {
+        lock.lock()
+        defer { lock.unlock() }
+        return currentBandwidthEstimate
+    }
+
+    /// Seconds since a probe (or a lost path) last confirmed `statusStream`'s status, or `nil` before
+    /// the first one. Grows while the notifier is suspended.
+    public var statusAge: TimeInterval? {
+        withLockedState { lastStatusDate.map { Date().timeIntervalSince($0) } }
+    }
+
+    /// Whether `suspend()` paused the running notifier.
+    public var isNotifierSuspended: Bool {
+        withLockedState { isSuspended }
+    }
+
+    /// The most recent DNS health check, or `nil` if none ran yet.
+    public var lastDNSHealth: DNSHealthResult? {
+        lock.lock()
+        defer { lock.unlock() }
+        return currentDNSHealth
+    }
+
     /// Creates a new RealReachability instance
     /// - Parameter configuration: Configuration for reachability checks
-    public init(configuration: ReachabilityConfiguration = .default) {
+    public convenience init(configuration: ReachabilityConfiguration = .default) {
+        self.init(configuration: configuration,
+                  nat64Resolver: NAT64PrefixResolver(),
+                  connectivityPredictor: ConnectivityPredictor(),
+                  probeCoordinator: .shared)
+    }
+
+    init(configuration: ReachabilityConfiguration,
+         nat64Resolver: NAT64PrefixResolver,
+         connectivityPredictor: ConnectivityPredictor,
+         probeCoordinator: ProbeCoordinator = .shared) {
         self.configuration = configuration
         self.pathMonitor = PathMonitorWrapper()
-        self.httpProber = HTTPProber(url: configuration.httpProbeURL, timeout: configuration.timeout)
-        self.icmpPinger = ICMPPinger(host: configuration.icmpHost, port: configuration.icmpPort, timeout: configuration.timeout)
+        self.nat64Resolver = nat64Resolver
+        self.connectivityPredictor = connectivityPredictor
+        self.probeCoordinator = probeCoordinator
+        self.statusCoalescer = StatusCoalescer(window: configuration.statusDeliveryWindow)
+        statusCoalescer.handler = { [weak self] change in
+            self?.yieldStatus(change.status)
+        }
     }
 
     private func withLockedState<T>(_ body: () -> T) -> T {
@@ -158,22 +555,58 @@ public final class RealReachability: @unchecked Sendable {
         return body()
     }
 
-    /// Updates probers based on current configuration
+    /// Drops cached probers no profile of the current configuration uses any more;
+    /// probers still in use keep their warm sessions.
     private func updateProbers() {
         lock.lock()
-        httpProber = HTTPProber(url: configuration.httpProbeURL, timeout: configuration.timeout)
-        icmpPinger = ICMPPinger(host: configuration.icmpHost, port: configuration.icmpPort, timeout: configuration.timeout)
+        let activeProfiles = [ConnectionType.wifi, .cellular, .wired, .other].map { configuration.profile(for: $0) }
+        let pinsAddress = configuration.pinsHTTPProbeAddress
+        let httpKeys = Set(activeProfiles.map { HTTPProberKey(url: $0.httpProbeURL, timeout: $0.timeout, pinsAddress: pinsAddress) })
+        let capture = currentPacketCapture.map { ObjectIdentifier($0) }
+        let icmpKeys = Set(activeProfiles.map { ICMPPingerKey(host: $0.icmpHost, port: $0.icmpPort, timeout: $0.timeout, capture: capture) })
+        let quicKeys = Set(activeProfiles.map { QUICProberKey(host: $0.quicHost, port: $0.quicPort, timeout: $0.timeout) })
+        httpProbers = httpProbers.filter { httpKeys.contains($0.key) }
+        icmpPingers = icmpPingers.filter { icmpKeys.contains($0.key) }
+        quicProbers = quicProbers.filter { quicKeys.contains($0.key) }
         lock.unlock()
     }
 
+    /// Resolves the profile and its probers for a connection type in one locked snapshot,
+    /// so a concurrent configuration change cannot mix settings from two profiles.
+    private func probeContext(for connectionType: ConnectionType)
+        -> (configuration: ReachabilityConfiguration, profile: ProbeProfile, http: HTTPProber, icmp: ICMPPinger, quic: QUICProber) {
+        withLockedState {
+            let profile = configuration.profile(for: connectionType)
+
+            let pinsAddress = configuration.pinsHTTPProbeAddress
+            let httpKey = HTTPProberKey(url: profile.httpProbeURL, timeout: profile.timeout, pinsAddress: pinsAddress)
+            let http = httpProbers[httpKey] ?? HTTPProber(url: profile.httpProbeURL, timeout: profile.timeout, pinsAddress: pinsAddress)
+            httpProbers[httpKey] = http
+
+            let capture = currentPacketCapture
+            let icmpKey = ICMPPingerKey(host: profile.icmpHost, port: profile.icmpPort, timeout: profile.timeout,
+                                        capture: capture.map { ObjectIdentifier($0) })
+            let icmp = icmpPingers[icmpKey] ?? ICMPPinger(host: profile.icmpHost, port: profile.icmpPort, timeout: profile.timeout,
+                                                          packetCapture: capture)
+            icmpPingers[icmpKey] = icmp
+
+            let quicKey = QUICProberKey(host: profile.quicHost, port: profile.quicPort, timeout: profile.timeout)
+            let quic = quicProbers[quicKey] ?? QUICProber(host: profile.quicHost, port: profile.quicPort, timeout: profile.timeout)
+            quicProbers[quicKey] = quic
+
+            return (configuration, profile, http, icmp, quic)
+        }
+    }
+
     private func applyRuntimeConfigurationChange() {
         lock.lock()
-        let notifierRunning = isNotifierRunning
+        let notifierRunning = isMonitoring
         let periodicEnabled = configuration.periodicProbeEnabled
         let config = configuration
         lock.unlock()
 
         _ = validateCellularFallbackConfiguration(config)
+        statusCoalescer.window = config.statusDeliveryWindow
 
         guard notifierRunning else {
             return
@@ -191,7 +624,9 @@ public final class RealReachability: @unchecked Sendable {
 
     // MARK: - One-time Check
 
-    /// Performs a one-time network reachability check
+    /// Performs a one-time network reachability check.
+    /// Runs at `.userInitiated` priority: it joins a probe of the same link already in flight and
+    /// may preempt periodic or background work when every probe slot is busy.
     /// - Returns: The current reachability status
     public func check() async -> ReachabilityStatus {
         let path: NWPath?
@@ -202,13 +637,14 @@ public final class RealReachability: @unchecked Sendable {
         }
 
         guard path?.status == .satisfied else {
-            setSecondaryReachableForCheck(false)
+            setCheckOutcome(ProbeOutcome(reachable: false, secondaryReachable: false, failureReason: .noRoute))
             return .notReachable
         }
 
         let connectionType = getConnectionType(from: path)
-        let outcome = await performProbe(for: connectionType)
-        setSecondaryReachableForCheck(outcome.secondaryReachable)
+        let outcome = await performProbeRetryingTransientFailure(for: connectionType, path: path,
+                                                                 priority: .userInitiated) { true }
+        setCheckOutcome(outcome)
 
         if outcome.reachable {
             return .reachable(connectionType)
@@ -216,9 +652,10 @@ public final class RealReachability: @unchecked Sendable {
         return .notReachable
     }
 
-    private func setSecondaryReachableForCheck(_ reachable: Bool) {
+    private func setCheckOutcome(_ outcome: ProbeOutcome) {
         lock.lock()
-        currentSecondaryReachable = reachable
+        currentSecondaryReachable = outcome.secondaryReachable
+        currentFailureReason = outcome.failureReason
         lock.unlock()
     }
 
@@ -236,58 +673,142 @@ public final class RealReachability: @unchecked Sendable {
         }
     }
 
+    /// Performs a probe and, if it failed transiently (for example a connection reset) or was
+    /// cancelled by `suspend()`, immediately retries once instead of waiting for the next scheduled probe.
+    /// - Parameter shouldRetry: Evaluated before retrying, so stale probes are not repeated.
+    private func performProbeRetryingTransientFailure(for connectionType: ConnectionType,
+                                                      path: NWPath?,
+                                                      priority: ProbePriority,
+                                                      shouldRetry: () -> Bool) async -> ProbeOutcome {
+        let outcome = await performScheduledProbe(for: connectionType, path: path, priority: priority)
+        // A run cancelled by `suspend()` says nothing about the network; callers still waiting ask again.
+        let warrantsRetry = outcome.failureReason?.isTransient == true
+            || (outcome.failureReason == .cancelled && !Task.isCancelled)
+        guard !outcome.reachable, warrantsRetry, shouldRetry() else {
+            return outcome
+        }
+        return await performScheduledProbe(for: connectionType, path: path, priority: priority)
+    }
+
+    /// Performs the probe through the scheduler; concurrent requests for the same link share one run,
+    /// and an identical probe in flight on another engine is shared through the coordinator.
+    private func performScheduledProbe(for connectionType: ConnectionType,
+                                       path: NWPath?,
+                                       priority: ProbePriority) async -> ProbeOutcome {
+        await probeScheduler.run(.reachability(connectionType), priority: priority) { [self] in
+            let key: ProbeCoordinator.ProbeKey = withLockedState {
+                sharingCounts.requested += 1
+                return ProbeCoordinator.ProbeKey(profile: configuration.profile(for: connectionType),
+                                                 network: path.map { networkKey(for: $0) } ?? "\(connectionType)",
+                                                 allowsCellularFallback: configuration.allowCellularFallback,
+                                                 pinsHTTPProbeAddress: configuration.pinsHTTPProbeAddress)
+            }
+            return await probeCoordinator.perform(key, priority: priority) { [self] in
+                withLockedState { sharingCounts.performed += 1 }
+                return await performProbeWithWatchdog(for: connectionType, path: path)
+            }
+        }
+    }
+
+    /// Performs the probe under a hard deadline, so a prober that never completes
+    /// cannot leave `probeInFlight` set and freeze monitoring.
+    /// The deadline covers the worst legitimate case: a primary and a fallback HTTP probe
+    /// back to back, plus a grace period for NAT64 discovery and scheduling.
+    private func performProbeWithWatchdog(for connectionType: ConnectionType, path: NWPath?) async -> ProbeOutcome {
+        let timeout = withLockedState { configuration.profile(for: connectionType).timeout }
+        let deadline = timeout * 2 + Self.watchdogGracePeriod
+
+        return await ProbeWatchdog.run(deadline: deadline) { [self] in
+            await performProbe(for: connectionType, path: path)
+        } onDeadline: { [self] in
+            withLockedState { watchdogFires += 1 }
+            ReachabilityLog.warning(.engine, "Watchdog force-completed a probe after \(String(format: "%.1f", deadline))s")
+            return ProbeOutcome(reachable: false, secondaryReachable: false, failureReason: .watchdog)
+        }
+    }
+
     /// Performs the probe based on configuration and current connection type.
-    private func performProbe(for connectionType: ConnectionType) async -> ProbeOutcome {
-        let (config, http, icmp) = withLockedState { (configuration, httpProber, icmpPinger) }
+    private func performProbe(for connectionType: ConnectionType, path: NWPath?) async -> ProbeOutcome {
+        let (config, profile, http, configuredICMP, quic) = probeContext(for: connectionType)
+        var icmp = configuredICMP
+        if profile.probeMode == .parallel || profile.probeMode == .icmpOnly {
+            icmp = await icmpPingerAdjustedForNAT64(configuredICMP, profile: profile, path: path)
+        }
+        let parallelQUIC = profile.includesQUICInParallel ? quic : nil
 
         if shouldAttemptCellularFallback(for: connectionType, configuration: config) {
-            guard validateCellularFallbackConfiguration(config) else {
-                return ProbeOutcome(reachable: false, secondaryReachable: false)
+            guard validateCellularFallback(config.allowCellularFallback, probeMode: profile.probeMode) else {
+                return ProbeOutcome(reachable: false, secondaryReachable: false, failureReason: .invalidConfiguration)
             }
 
-            let primaryReachable: Bool
-            switch config.probeMode {
+            let primary: ProbeResult
+            switch profile.probeMode {
             case .parallel:
-                primaryReachable = await probeParallel(http: http, icmp: icmp, httpAllowsCellular: false)
+                primary = await probeParallel(http: http, icmp: icmp, quic: parallelQUIC, httpAllowsCellular: false)
             case .httpOnly:
-                primaryReachable = await http.probe(allowsCellularAccess: false)
-            case .icmpOnly:
-                primaryReachable = false
+                primary = await http.probeWithDetails(allowsCellularAccess: false)
+            case .icmpOnly, .quicOnly:
+                primary = ProbeResult(success: false, failureReason: .invalidConfiguration)
             }
 
-            if primaryReachable {
-                return ProbeOutcome(reachable: true, secondaryReachable: false)
+            if primary.success {
+                return ProbeOutcome(primary)
             }
 
-            let fallbackReachable = await http.probe(allowsCellularAccess: true)
-            return ProbeOutcome(reachable: fallbackReachable, secondaryReachable: fallbackReachable)
+            let fallback = await http.probeWithDetails(allowsCellularAccess: true)
+            return ProbeOutcome(fallback, secondaryReachable: fallback.success)
         }
 
         // Wi-Fi primary probing should not silently route through cellular when fallback is disabled.
-        if connectionType == .wifi && probeModeSupportsHTTP(config.probeMode) && !config.allowCellularFallback {
-            switch config.probeMode {
+        if connectionType == .wifi && probeModeSupportsHTTP(profile.probeMode) && !config.allowCellularFallback {
+            switch profile.probeMode {
             case .parallel:
-                let reachable = await probeParallel(http: http, icmp: icmp, httpAllowsCellular: false)
-                return ProbeOutcome(reachable: reachable, secondaryReachable: false)
+                return ProbeOutcome(await probeParallel(http: http, icmp: icmp, quic: parallelQUIC, httpAllowsCellular: false))
             case .httpOnly:
-                let reachable = await http.probe(allowsCellularAccess: false)
-                return ProbeOutcome(reachable: reachable, secondaryReachable: false)
-            case .icmpOnly:
+                return ProbeOutcome(await http.probeWithDetails(allowsCellularAccess: false))
+            case .icmpOnly, .quicOnly:
                 break
             }
         }
 
-        switch config.probeMode {
+        switch profile.probeMode {
         case .parallel:
-            let reachable = await probeParallel(http: http, icmp: icmp, httpAllowsCellular: true)
-            return ProbeOutcome(reachable: reachable, secondaryReachable: false)
+            return ProbeOutcome(await probeParallel(http: http, icmp: icmp, quic: parallelQUIC, httpAllowsCellular: true))
         case .httpOnly:
-            let reachable = await http.probe(allowsCellularAccess: true)
-            return ProbeOutcome(reachable: reachable, secondaryReachable: false)
+            return ProbeOutcome(await http.probeWithDetails(allowsCellularAccess: true))
         case .icmpOnly:
-            let reachable = await icmp.probe()
-            return ProbeOutcome(reachable: reachable, secondaryReachable: false)
+            return ProbeOutcome(await icmp.probeWithDetails())
+        case .quicOnly:
+            return ProbeOutcome(await quic.probeWithDetails())
+        }
+    }
+
+    /// On IPv6-only paths an IPv4 literal target is unroutable, so it is rewritten
+    /// into the network's NAT64 address space when a DNS64 prefix is available.
+    private func icmpPingerAdjustedForNAT64(_ pinger: ICMPPinger,
+                                            profile: ProbeProfile,
+                                            path: NWPath?) async -> ICMPPinger {
+        guard let path,
+              path.supportsIPv6,
+              !path.supportsIPv4,
+              NAT64Prefix.ipv4Bytes(fromLiteral: profile.icmpHost) != nil else {
+            return pinger
         }
+
+        guard let prefix = await nat64Resolver.prefix(forNetwork: networkKey(for: path)),
+              let synthesizedHost = prefix.synthesizedHost(forIPv4Literal: profile.icmpHost) else {
+            return pinger
+        }
+
+        return ICMPPinger(host: synthesizedHost, port: profile.icmpPort, timeout: profile.timeout,
+                          packetCapture: pinger.packetCapture)
+    }
+
+    /// Identifies the attached network for per-network caches.
+    private func networkKey(for path: NWPath) -> String {
+        let interfaces = path.availableInterfaces.map { $0.name }.joined(separator: ",")
+        let gateways = path.gateways.map { "\($0)" }.joined(separator: ",")
+        return "\(getConnectionType(from: path))|\(interfaces)|\(gateways)"
     }
 
     private func shouldAttemptCellularFallback(for connectionType: ConnectionType,
@@ -301,46 +822,167 @@ public final class RealReachability: @unchecked Sendable {
 
     @discardableResult
     private func validateCellularFallbackConfiguration(_ config: ReachabilityConfiguration) -> Bool {
-        guard config.allowCellularFallback else {
+        validateCellularFallback(config.allowCellularFallback, probeMode: config.profile(for: .wifi).probeMode)
+    }
+
+    /// Cellular fallback only applies on Wi-Fi, so it is checked against the Wi-Fi probe mode.
+    @discardableResult
+    private func validateCellularFallback(_ allowCellularFallback: Bool, probeMode: ProbeMode) -> Bool {
+        guard allowCellularFallback else {
             return true
         }
 
-        if probeModeSupportsHTTP(config.probeMode) {
+        if probeModeSupportsHTTP(probeMode) {
             return true
         }
 
-        let message = "[RealReachability] Configuration error: allowCellularFallback requires HTTP participation (.parallel or .httpOnly)."
-#if DEBUG
-        NSLog("%@", message)
-#endif
+        let message = "Configuration error: allowCellularFallback requires HTTP participation (.parallel or .httpOnly)."
+        ReachabilityLog.error(.engine, message)
         assertionFailure(message)
         return false
     }
 
-    /// Performs parallel HTTP and ICMP probes.
+    /// Performs parallel HTTP and ICMP probes, plus QUIC when the profile includes it.
     /// - Parameter httpAllowsCellular: Whether cellular is allowed for the HTTP branch.
-    /// - Returns: `true` if either probe succeeds.
-    private func probeParallel(http: HTTPProber, icmp: ICMPPinger, httpAllowsCellular: Bool) async -> Bool {
-        await withTaskGroup(of: Bool.self) { group in
+    /// - Returns: The first successful result, or a failure carrying the HTTP branch's
+    ///   reason (the more specific one) when all fail.
+    private func probeParallel(http: HTTPProber,
+                               icmp: ICMPPinger,
+                               quic: QUICProber?,
+                               httpAllowsCellular: Bool) async -> ProbeResult {
+        await withTaskGroup(of: (mode: ProbeMode, result: ProbeResult).self) { group in
             group.addTask {
-                await http.probe(allowsCellularAccess: httpAllowsCellular)
+                (.httpOnly, await http.probeWithDetails(allowsCellularAccess: httpAllowsCellular))
             }
 
             group.addTask {
-                await icmp.probe()
+                (.icmpOnly, await icmp.probeWithDetails())
             }
 
-            for await result in group {
-                if result {
+            if let quic {
+                group.addTask {
+                    (.quicOnly, await quic.probeWithDetails())
+                }
+            }
+
+            var failures: [ProbeMode: ProbeResult] = [:]
+            for await branch in group {
+                if branch.result.success {
                     group.cancelAll()
-                    return true
+                    return branch.result
                 }
+                failures[branch.mode] = branch.result
             }
 
-            return false
+            return failures[.httpOnly] ?? failures[.icmpOnly] ?? failures[.quicOnly]
+                ?? ProbeResult(success: false, failureReason: .unknown)
         }
     }
 
+    // MARK: - Bandwidth Estimation
+
+    /// Estimates throughput with `configuration.bandwidthProbe`, on whatever path is current.
+    /// - Returns: The estimate, failing with `.invalidConfiguration` if no bandwidth probe is configured
+    public func estimateBandwidth() async -> BandwidthEstimate {
+        guard let bandwidthConfiguration = withLockedState({ configuration.bandwidthProbe }) else {
+            return BandwidthEstimate(success: false, downloadBitsPerSecond: nil, uploadBitsPerSecond: nil,
+                                     bytesDownloaded: 0, bytesUploaded: 0,
+                                     failureReason: .invalidConfiguration, date: Date())
+        }
+
+        let estimate = await probeScheduler.run(.bandwidth, priority: .userInitiated) {
+            await BandwidthProber(configuration: bandwidthConfiguration).estimate()
+        }
+        withLockedState { currentBandwidthEstimate = estimate }
+        return estimate
+    }
+
+    /// Starts the automatic estimate after a successful probe: once per network, and only on
+    /// paths that are neither expensive nor constrained, so it never spends metered data.
+    private func scheduleAutomaticBandwidthEstimateIfNeeded(path: NWPath, networkKey key: String) {
+        guard !path.isExpensive, !path.isConstrained else {
+            return
+        }
+
+        withLockedState {
+            guard let bandwidthConfiguration = configuration.bandwidthProbe,
+                  bandwidthConfiguration.runsOnUnmeteredPaths,
+                  isMonitoring,
+                  bandwidthTask == nil,
+                  !bandwidthEstimatedNetworkKeys.contains(key) else {
+                return
+            }
+            bandwidthEstimatedNetworkKeys.insert(key)
+
+            let scheduler = probeScheduler
+            bandwidthTask = Task { [weak self] in
+                let estimate = await scheduler.run(.bandwidth, priority: .backgroundDiagnostic) {
+                    await BandwidthProber(configuration: bandwidthConfiguration)
+                        .estimate(allowsMeteredNetworks: false)
+                }
+                self?.finishAutomaticBandwidthEstimate(estimate, networkKey: key)
+            }
+        }
+    }
+
+    private func finishAutomaticBandwidthEstimate(_ estimate: BandwidthEstimate, networkKey key: String) {
+        withLockedState {
+            // A failed estimate may be retried on the next successful probe of the network.
+            if !estimate.success {
+                bandwidthEstimatedNetworkKeys.remove(key)
+            }
+            // Cancellation comes from stopNotifier, which already released the task slot.
+            guard estimate.failureReason != .cancelled else {
+                return
+            }
+            bandwidthTask = nil
+            currentBandwidthEstimate = estimate
+        }
+    }
+
+    // MARK: - Responsiveness
+
+    /// Measures latency at idle and while parallel downloads saturate the link, using
+    /// `configuration.responsivenessProbe`. Bounded by its load duration and byte budget.
+    /// - Returns: Idle and loaded latency, failing with `.invalidConfiguration` if no
+    ///   responsiveness probe is configured
+    public func measureResponsiveness() async -> ResponsivenessResult {
+        guard let responsivenessConfiguration = withLockedState({ configuration.responsivenessProbe }) else {
+            return ResponsivenessResult(success: false, idleLatencyMs: nil, loadedLatencyMs: nil,
+                                        idleRoundTripsPerMinute: nil, roundTripsPerMinute: nil,
+                                        idleSampleCount: 0, loadedSampleCount: 0, bytesTransferred: 0,
+                                        loadedDuration: 0, failureReason: .invalidConfiguration)
+        }
+        return await ResponsivenessProber(configuration: responsivenessConfiguration).measure()
+    }
+
+    // MARK: - DNS Health
+
+    /// Resolves `configuration.dnsHealthProbe` over DNS-over-HTTPS and with the system resolver.
+    /// Tells DNS trouble (blocked or hijacked plain DNS) apart from general reachability.
+    /// - Returns: Both answers, or `nil` if no DNS health probe is configured
+    public func checkDNSHealth() async -> DNSHealthResult? {
+        let prober: DoHProber? = withLockedState {
+            guard let dnsConfiguration = configuration.dnsHealthProbe else {
+                dohProber = nil
+                return nil
+            }
+            if let existing = dohProber, existing.configuration == dnsConfiguration {
+                return existing
+            }
+            let created = DoHProber(configuration: dnsConfiguration)
+            dohProber = created
+            return created
+        }
+        guard let prober else {
+            return nil
+        }
+
+        let result = await prober.probe()
+        withLockedState { currentDNSHealth = result }
+        return result
+    }
+
     // MARK: - Continuous Monitoring
 
     /// Async stream of reachability status changes.
@@ -374,6 +1016,7 @@ public final class RealReachability: @unchecked Sendable {
         isNotifierRunning = true
         lock.unlock()
 
+        probeCoordinator.register(self)
         pathMonitor.start()
         startPathMonitorTaskIfNeeded()
         startPeriodicProbeIfNeeded()
@@ -387,23 +1030,140 @@ public final class RealReachability: @unchecked Sendable {
             return
         }
         isNotifierRunning = false
+        isSuspended = false
+        lifecycleGeneration &+= 1
         probeSequence &+= 1
         probeInFlight = false
         pendingProbePath = nil
+        lastPathConnectionType = nil
         statusContinuation?.finish()
         statusContinuation = nil
+        statusCoalescer.reset()
+        let bandwidthTask = self.bandwidthTask
+        self.bandwidthTask = nil
         lock.unlock()
 
+        bandwidthTask?.cancel()
         stopPeriodicProbeIfNeeded()
+        probeCoordinator.unregister(self)
 
         pathMonitor.stop()
         pathMonitorTask?.cancel()
         pathMonitorTask = nil
     }
 
+    // MARK: - Suspend and Resume
+
+    /// Pauses the running notifier while the host is idle. Stops the periodic timer and the path
+    /// monitor, abandons probes in flight and closes every prober's sockets and kept-alive
+    /// connections. `statusStream` stays open and keeps the last status, which ages meanwhile
+    /// (see `statusAge`). Does nothing unless the notifier is running and not suspended.
+    public func suspend() {
+        let released: (probers: [HTTPProber], bandwidthTask: Task<Void, Never>?)? = withLockedState {
+            guard isMonitoring else {
+                return nil
+            }
+            isSuspended = true
+            lifecycleGeneration &+= 1
+            probeSequence &+= 1
+            probeInFlight = false
+            pendingProbePath = nil
+            lastPathConnectionType = nil
+            let bandwidthTask = self.bandwidthTask
+            self.bandwidthTask = nil
+
+            // Recreated on the first probe after resuming; dropping the DoH prober closes its connection.
+            let probers = Array(httpProbers.values)
+            httpProbers = [:]
+            icmpPingers = [:]
+            quicProbers = [:]
+            dohProber = nil
+            return (probers, bandwidthTask)
+        }
+        guard let released else {
+            return
+        }
+
+        released.bandwidthTask?.cancel()
+        stopPeriodicProbeIfNeeded()
+        // Cancelling the engine's runs withdraws them from the coordinator too; a run no other
+        // engine waits on is cancelled there, and the catch-up probe cannot join a stale run.
+        probeScheduler.cancelAll()
+        probeCoordinator.unregister(self)
+        pathMonitor.stop()
+        let pathTask = withLockedState { () -> Task<Void, Never>? in
+            defer { pathMonitorTask = nil }
+            return pathMonitorTask
+        }
+        pathTask?.cancel()
+        released.probers.forEach { $0.closeConnections() }
+
+        // A change held by the delivery window goes out now rather than after the idle period.
+        statusCoalescer.flush()
+        ReachabilityLog.info(.engine, "Notifier suspended")
+    }
+
+    /// Resumes a suspended notifier: restarts the path monitor and periodic timer, and runs a
+    /// catch-up probe right away at `.userInitiated` priority instead of waiting for the next tick.
+    /// - Returns: How old the status was when resuming, and the status after the catch-up probe.
+    ///   Without a suspended notifier nothing is probed and the current status is returned.
+    @discardableResult
+    public func resume() async -> ResumeReport {
+        let resumed: (staleness: TimeInterval?, generation: UInt64)? = withLockedState {
+            guard isNotifierRunning, isSuspended else {
+                return nil
+            }
+            isSuspended = false
+            return (lastStatusDate.map { Date().timeIntervalSince($0) }, lifecycleGeneration)
+        }
+        guard let resumed else {
+            return withLockedState {
+                ResumeReport(staleness: lastStatusDate.map { Date().timeIntervalSince($0) }, status: currentStatus)
+            }
+        }
+
+        ReachabilityLog.info(.engine, "Notifier resumed; status was \(resumed.staleness.map { String(format: "%.0f", $0) } ?? "never")s old")
+        probeCoordinator.register(self)
+        pathMonitor.start()
+        startPathMonitorTaskIfNeeded()
+        startPeriodicProbeIfNeeded()
+
+        let status = await runCatchUpProbe(generation: resumed.generation)
+        return ResumeReport(staleness: resumed.staleness, status: status)
+    }
+
+    /// Probes the current path and applies the outcome unless the notifier was suspended or
+    /// stopped meanwhile. The probe joins the path monitor's first probe of the same link, if any.
+    private func runCatchUpProbe(generation: UInt64) async -> ReachabilityStatus {
+        // The wrapper still holds the path from before the suspension; ask for a fresh one.
+        let path = await getCurrentPath()
+        let isCurrent = { [self] in
+            withLockedState { isMonitoring && lifecycleGeneration == generation }
+        }
+
+        guard let path, path.status == .satisfied else {
+            if isCurrent() {
+                await handleUnsatisfiedPath()
+            }
+            return withLockedState { currentStatus }
+        }
+
+        let connectionType = getConnectionType(from: path)
+        let outcome = await performProbeRetryingTransientFailure(for: connectionType, path: path,
+                                                                 priority: .userInitiated, shouldRetry: isCurrent)
+        if isCurrent() {
+            withLockedState { activeConnectionType = connectionType }
+            let status: ReachabilityStatus = outcome.reachable ? .reachable(connectionType) : .notReachable
+            updateStatus(status, secondaryReachable: outcome.secondaryReachable, failureReason: outcome.failureReason)
+            // Resuming is exactly when a stale status must not wait out the delivery window.
+            statusCoalescer.flush()
+        }
+        return withLockedState { currentStatus }
+    }
+
     private func startPathMonitorTaskIfNeeded() {
         lock.lock()
-        let shouldStart = isNotifierRunning && pathMonitorTask == nil
+        let shouldStart = isMonitoring && pathMonitorTask == nil
         lock.unlock()
 
         guard shouldStart else {
@@ -421,7 +1181,7 @@ public final class RealReachability: @unchecked Sendable {
         }
 
         lock.lock()
-        if isNotifierRunning && pathMonitorTask == nil {
+        if isMonitoring && pathMonitorTask == nil {
             pathMonitorTask = task
             lock.unlock()
         } else {
@@ -432,7 +1192,7 @@ public final class RealReachability: @unchecked Sendable {
 
     private func startPeriodicProbeIfNeeded() {
         lock.lock()
-        let shouldStart = isNotifierRunning && configuration.periodicProbeEnabled && periodicProbeTask == nil
+        let shouldStart = isMonitoring && configuration.periodicProbeEnabled && periodicProbeTask == nil
         lock.unlock()
 
         guard shouldStart else {
@@ -443,8 +1203,9 @@ public final class RealReachability: @unchecked Sendable {
             guard let self else { return }
 
             while !Task.isCancelled {
+                let interval = self.alignedPeriodicProbeDelayNanoseconds()
                 do {
-                    try await Task.sleep(nanoseconds: Self.periodicProbeInterval)
+                    try await Task.sleep(nanoseconds: interval)
                 } catch {
                     break
                 }
@@ -458,7 +1219,7 @@ public final class RealReachability: @unchecked Sendable {
         }
 
         lock.lock()
-        if isNotifierRunning && configuration.periodicProbeEnabled && periodicProbeTask == nil {
+        if isMonitoring && configuration.periodicProbeEnabled && periodicProbeTask == nil {
             periodicProbeTask = task
             lock.unlock()
         } else {
@@ -467,6 +1228,39 @@ public final class RealReachability: @unchecked Sendable {
         }
     }
 
+    /// Sleep until the next periodic probe of the current link, on the coordinator's shared clock,
+    /// so engines in the same process wake, and probe, together.
+    private func alignedPeriodicProbeDelayNanoseconds() -> UInt64 {
+        let path = pathMonitor.path
+        let connectionType = getConnectionType(from: path)
+        let (seconds, backoff, predictive) = withLockedState {
+            (configuration.profile(for: connectionType).periodicProbeInterval,
+             periodicBackoffFactor,
+             configuration.predictiveSchedulingEnabled)
+        }
+
+        var network: String?
+        if predictive, let path, path.status == .satisfied {
+            network = networkKey(for: path)
+        }
+        let delay = Self.periodicProbeDelay(interval: seconds, backoff: backoff, network: network,
+                                            predictor: connectivityPredictor, coordinator: probeCoordinator, now: Date())
+        return UInt64(delay * 1_000_000_000)
+    }
+
+    /// Seconds from `now` until the next periodic probe: `interval` stretched by the failure backoff
+    /// and, for a `network` under predictive scheduling, scaled by its predicted outage risk,
+    /// then aligned on the coordinator's shared clock.
+    static func periodicProbeDelay(interval: TimeInterval,
+                                   backoff: UInt64,
+                                   network: String?,
+                                   predictor: ConnectivityPredictor,
+                                   coordinator: ProbeCoordinator,
+                                   now: Date) -> TimeInterval {
+        let multiplier = network.map { predictor.intervalMultiplier(network: $0, at: now) } ?? 1
+        return coordinator.delayUntilNextTick(interval: max(interval, 0) * multiplier * Double(backoff), now: now)
+    }
+
     private func stopPeriodicProbeIfNeeded() {
         lock.lock()
         let task = periodicProbeTask
@@ -477,7 +1271,7 @@ public final class RealReachability: @unchecked Sendable {
 
     private func handlePeriodicProbeTick() async {
         let shouldRun = withLockedState {
-            isNotifierRunning && configuration.periodicProbeEnabled
+            isMonitoring && configuration.periodicProbeEnabled
         }
 
         guard shouldRun else {
@@ -489,37 +1283,65 @@ public final class RealReachability: @unchecked Sendable {
             return
         }
 
-        await triggerProbe(for: path)
+        await triggerProbe(for: path, priority: .periodic)
     }
 
     /// Handles path changes from the monitor.
     private func handlePathChange(_ path: NWPath) async {
+        // A different link may use a different profile; restart the periodic loop so
+        // its interval applies now rather than after the previous profile's sleep.
+        let connectionType = getConnectionType(from: path)
+        let linkChanged: Bool = withLockedState {
+            defer { lastPathConnectionType = connectionType }
+            return lastPathConnectionType != nil && lastPathConnectionType != connectionType
+        }
+        if linkChanged {
+            stopPeriodicProbeIfNeeded()
+            startPeriodicProbeIfNeeded()
+
+            // CDNs answer per network, so pinned addresses are re-resolved for the new link.
+            for prober in withLockedState({ Array(httpProbers.values) }) {
+                prober.invalidatePinnedAddress()
+                prober.prefetchPinnedAddress()
+            }
+        }
+
         if path.status == .satisfied {
-            await triggerProbe(for: path)
+            await triggerProbe(for: path, priority: .pathChange)
         } else {
             await handleUnsatisfiedPath()
         }
     }
 
     private func handleUnsatisfiedPath() async {
-        withLockedState {
+        nat64Resolver.invalidate()
+        for prober in withLockedState({ Array(httpProbers.values) }) {
+            prober.invalidatePinnedAddress()
+        }
+
+        let lostNetworkKey: String? = withLockedState {
             probeSequence &+= 1
             probeInFlight = false
             pendingProbePath = nil
+            return lastProbedNetworkKey
         }
 
-        updateStatus(.notReachable, secondaryReachable: false)
-    }
+        // Losing the path (for example in a tunnel) is an outage of the network we were on.
+        if let lostNetworkKey {
+            connectivityPredictor.record(reachable: false, network: lostNetworkKey, at: Date())
+        }
 
-    private func triggerProbe(for path: NWPath) async {
-        let type = getConnectionType(from: path)
+        updateStatus(.notReachable, secondaryReachable: false, failureReason: .noRoute)
+    }
 
+    private func triggerProbe(for path: NWPath, priority: ProbePriority) async {
         let token: UInt64? = withLockedState {
-            guard isNotifierRunning else {
+            guard isMonitoring else {
                 return nil
             }
 
             if probeInFlight {
+                pendingProbePriority = pendingProbePath == nil ? priority : max(pendingProbePriority, priority)
                 pendingProbePath = path
                 return nil
             }
@@ -533,25 +1355,37 @@ public final class RealReachability: @unchecked Sendable {
             return
         }
 
-        await runProbe(connectionType: type, token: token)
+        await runProbe(path: path, token: token, priority: priority)
     }
 
-    private func runProbe(connectionType: ConnectionType, token: UInt64) async {
-        let outcome = await performProbe(for: connectionType)
+    private func runProbe(path: NWPath, token: UInt64, priority: ProbePriority) async {
+        let connectionType = getConnectionType(from: path)
+        let outcome = await performProbeRetryingTransientFailure(for: connectionType, path: path, priority: priority) {
+            withLockedState { isMonitoring && token == probeSequence }
+        }
 
         var shouldApplyResult = false
-        var shouldRunPendingProbe = false
-        var nextType: ConnectionType = .other
+        var nextPath: NWPath?
         var nextToken: UInt64 = 0
+        var nextPriority: ProbePriority = .periodic
 
         withLockedState {
-            shouldApplyResult = isNotifierRunning && (token == probeSequence)
+            shouldApplyResult = isMonitoring && (token == probeSequence)
+
+            if shouldApplyResult {
+                activeConnectionType = connectionType
+                if outcome.failureReason?.warrantsBackoff == true {
+                    periodicBackoffFactor = min(periodicBackoffFactor * 2, Self.maxPeriodicBackoffFactor)
+                } else {
+                    periodicBackoffFactor = 1
+                }
+            }
 
             if let pendingPath = pendingProbePath,
-               isNotifierRunning,
+               isMonitoring,
                pendingPath.status == .satisfied {
-                shouldRunPendingProbe = true
-                nextType = getConnectionType(from: pendingPath)
+                nextPath = pendingPath
+                nextPriority = pendingProbePriority
                 pendingProbePath = nil
                 probeSequence &+= 1
                 nextToken = probeSequence
@@ -563,30 +1397,52 @@ public final class RealReachability: @unchecked Sendable {
         }
 
         if shouldApplyResult {
+            let key = networkKey(for: path)
+            withLockedState { lastProbedNetworkKey = key }
+            connectivityPredictor.record(reachable: outcome.reachable, network: key, at: Date())
+
             let status: ReachabilityStatus = outcome.reachable ? .reachable(connectionType) : .notReachable
-            updateStatus(status, secondaryReachable: outcome.secondaryReachable)
+            updateStatus(status, secondaryReachable: outcome.secondaryReachable, failureReason: outcome.failureReason)
+
+            if outcome.reachable {
+                scheduleAutomaticBandwidthEstimateIfNeeded(path: path, networkKey: key)
+            }
         }
 
-        if shouldRunPendingProbe {
-            await runProbe(connectionType: nextType, token: nextToken)
+        if let nextPath {
+            await runProbe(path: nextPath, token: nextToken, priority: nextPriority)
         }
     }
 
-    private func updateStatus(_ status: ReachabilityStatus, secondaryReachable: Bool) {
+    private func updateStatus(_ status: ReachabilityStatus,
+                              secondaryReachable: Bool,
+                              failureReason: ProbeFailureReason?) {
         lock.lock()
         let statusChanged = currentStatus != status
         let secondaryChanged = currentSecondaryReachable != secondaryReachable
         let shouldNotify = statusChanged || secondaryChanged
         currentStatus = status
         currentSecondaryReachable = secondaryReachable
-        let continuation = statusContinuation
+        currentFailureReason = failureReason
+        lastStatusDate = Date()
         lock.unlock()
 
         if shouldNotify {
-            continuation?.yield(status)
+            statusCoalescer.submit(StatusChange(status: status, secondaryReachable: secondaryReachable))
         }
     }
 
+    private func yieldStatus(_ status: ReachabilityStatus) {
+        let continuation = withLockedState { statusContinuation }
+        continuation?.yield(status)
+    }
+
+    /// Delivers a status change held by `statusDeliveryWindow` now instead of when the window
+    /// closes, for transitions that must not wait.
+    public func flushStatusDelivery() {
+        statusCoalescer.flush()
+    }
+
     /// Gets the connection type from a path
     private func getConnectionType(from path: NWPath?) -> ConnectionType {
         guard let path else { return .other }
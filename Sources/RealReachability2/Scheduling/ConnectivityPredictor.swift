@@ -0,0 +1,238 @@
+//
+//  ConnectivityPredictor.swift
+//  RealReachability2
+//
+//  Created by RealReachability2 on 2026.
+//
+
+import Foundation
+
+/// Learns daily connectivity patterns (commute tunnels, office Wi-Fi) from the engine's own
+/// probe history and predicts outages, so periodic probing can speed up just before a
+/// likely outage and relax during reliably stable periods.
+///
+/// The model is a Markov chain per network over time-of-day buckets: each bucket is
+/// summarized as "stable" or "had an outage", and the chain counts transitions between
+/// consecutive buckets. Memory is fixed: at most `maxNetworks` networks, each holding
+/// `bucketsPerDay` 2x2 transition tables with decaying counts.
+@available(iOS 13.0, *)
+public final class ConnectivityPredictor: @unchecked Sendable {
+    /// Outage prediction for a network at a point in time
+    public struct Prediction: Equatable, Sendable {
+        /// Highest outage probability among the well-sampled candidate buckets
+        /// (the current bucket, unless an outage was already seen in it, and the next one)
+        public let outageProbability: Double
+
+        /// Fewest observed transitions behind any candidate bucket
+        public let sampleCount: Int
+    }
+
+    /// Probability at or above which probing is sped up
+    static let outageThreshold = 0.3
+
+    /// Probability at or below which a period counts as reliably stable
+    static let stableThreshold = 0.05
+
+    /// Transitions needed before a bucket's prediction is trusted
+    static let minimumSamples = 5
+
+    /// Row total at which counts are halved, so old habits fade
+    static let maximumRowCount = 32.0
+
+    /// Interval multiplier just before a likely outage
+    public static let outageIntervalMultiplier = 0.5
+
+    /// Interval multiplier during reliably stable periods
+    public static let stableIntervalMultiplier = 2.0
+
+    private struct NetworkModel {
+        /// transitions[bucket][from][to]; index 0 = stable, 1 = outage
+        var transitions: [[[Double]]]
+
+        /// Absolute bucket (days * bucketsPerDay + bucket) currently being observed
+        var currentBucket: Int?
+
+        /// Whether an outage has been seen in the current bucket so far
+        var currentHadOutage = false
+
+        /// Absolute index and state of the last completed bucket
+        var lastCompleted: (bucket: Int, hadOutage: Bool)?
+
+        /// Logical clock for least-recently-used eviction
+        var lastUsed: UInt64 = 0
+
+        init(bucketsPerDay: Int) {
+            transitions = Array(repeating: [[0, 0], [0, 0]], count: bucketsPerDay)
+        }
+    }
+
+    /// Number of time-of-day buckets (48 = half-hour buckets)
+    public let bucketsPerDay: Int
+
+    /// Maximum number of networks kept; the least recently used is evicted
+    public let maxNetworks: Int
+
+    private let calendar: Calendar
+    private let lock = NSLock()
+    private var models: [String: NetworkModel] = [:]
+    private var useClock: UInt64 = 0
+
+    /// Creates a predictor
+    /// - Parameters:
+    ///   - bucketsPerDay: Time-of-day resolution (default: 48 half-hour buckets)
+    ///   - maxNetworks: Networks remembered at once (default: 8)
+    ///   - calendar: Calendar defining local time of day (default: current)
+    public init(bucketsPerDay: Int = 48, maxNetworks: Int = 8, calendar: Calendar = .current) {
+        self.bucketsPerDay = max(bucketsPerDay, 1)
+        self.maxNetworks = max(maxNetworks, 1)
+        self.calendar = calendar
+    }
+
+    /// Records one probe result
+    /// - Parameters:
+    ///   - reachable: Whether the probe succeeded
+    ///   - network: Identifies the network the probe ran on
+    ///   - date: When the probe completed
+    public func record(reachable: Bool, network: String, at date: Date) {
+        let bucket = absoluteBucket(for: date)
+
+        withLockedState {
+            var model = models[network] ?? NetworkModel(bucketsPerDay: bucketsPerDay)
+
+            if let current = model.currentBucket, current != bucket {
+                complete(bucket: current, hadOutage: model.currentHadOutage, in: &model)
+                model.currentHadOutage = false
+            }
+            model.currentBucket = bucket
+            if !reachable {
+                model.currentHadOutage = true
+            }
+
+            useClock &+= 1
+            model.lastUsed = useClock
+            models[network] = model
+            evictIfNeeded()
+        }
+    }
+
+    /// Predicts whether an outage is imminent on a network
+    /// - Returns: The prediction, or `nil` if the network has never been observed
+    public func prediction(network: String, at date: Date) -> Prediction? {
+        let bucket = absoluteBucket(for: date)
+
+        return withLockedState {
+            guard let model = models[network] else {
+                return nil
+            }
+
+            let currentIndex = bucketIndex(bucket)
+            let nextIndex = bucketIndex(bucket + 1)
+
+            // State of the bucket before the current one, as the chain's "from" state.
+            let previousHadOutage: Bool
+            if model.currentBucket == bucket, let last = model.lastCompleted, last.bucket == bucket - 1 {
+                previousHadOutage = last.hadOutage
+            } else if model.currentBucket == bucket - 1 {
+                previousHadOutage = model.currentHadOutage
+            } else {
+                previousHadOutage = false
+            }
+
+            // Current bucket: only relevant if no outage has been seen in it yet.
+            let current = outageProbability(model.transitions[currentIndex], from: previousHadOutage)
+            let currentOutageSeen = model.currentBucket == bucket && model.currentHadOutage
+
+            // Next bucket, conditioned on how the current bucket is going so far.
+            let next = outageProbability(model.transitions[nextIndex], from: currentOutageSeen)
+
+            var candidates = [next]
+            if !currentOutageSeen {
+                candidates.append(current)
+            }
+
+            // A bucket transition never seen before (for example "stable" before a bucket that
+            // always has an outage) must not hide a well-sampled warning from the other bucket.
+            let probability = candidates
+                .filter { $0.samples >= Self.minimumSamples }
+                .map { $0.probability }
+                .max() ?? 0
+            let samples = candidates.map { $0.samples }.min() ?? 0
+            return Prediction(outageProbability: probability, sampleCount: samples)
+        }
+    }
+
+    /// Multiplier to apply to the periodic probe interval
+    /// - Returns: `outageIntervalMultiplier` before a likely outage, `stableIntervalMultiplier`
+    ///   during a reliably stable period, and 1 when the model is unsure
+    public func intervalMultiplier(network: String, at date: Date) -> Double {
+        guard let prediction = prediction(network: network, at: date) else {
+            return 1
+        }
+
+        if prediction.outageProbability >= Self.outageThreshold {
+            return Self.outageIntervalMultiplier
+        }
+        if prediction.sampleCount >= Self.minimumSamples && prediction.outageProbability <= Self.stableThreshold {
+            return Self.stableIntervalMultiplier
+        }
+        return 1
+    }
+
+    /// Forgets everything learned
+    public func reset() {
+        withLockedState {
+            models.removeAll()
+        }
+    }
+
+    // MARK: - Private
+
+    private func complete(bucket: Int, hadOutage: Bool, in model: inout NetworkModel) {
+        if let last = model.lastCompleted, last.bucket == bucket - 1 {
+            let index = bucketIndex(bucket)
+            let from = last.hadOutage ? 1 : 0
+            let to = hadOutage ? 1 : 0
+            model.transitions[index][from][to] += 1
+
+            let row = model.transitions[index][from]
+            if row[0] + row[1] > Self.maximumRowCount {
+                model.transitions[index][from] = row.map { $0 / 2 }
+            }
+        }
+        model.lastCompleted = (bucket, hadOutage)
+    }
+
+    private func outageProbability(_ table: [[Double]], from hadOutage: Bool) -> (probability: Double, samples: Int) {
+        let row = table[hadOutage ? 1 : 0]
+        let total = row[0] + row[1]
+        guard total > 0 else {
+            return (0, 0)
+        }
+        return (row[1] / total, Int(total.rounded()))
+    }
+
+    private func evictIfNeeded() {
+        while models.count > maxNetworks,
+              let oldest = models.min(by: { $0.value.lastUsed < $1.value.lastUsed })?.key {
+            models[oldest] = nil
+        }
+    }
+
+    private func absoluteBucket(for date: Date) -> Int {
+        let startOfDay = calendar.startOfDay(for: date)
+        let day = calendar.ordinality(of: .day, in: .era, for: date) ?? 0
+        let secondsIntoDay = date.timeIntervalSince(startOfDay)
+        let bucket = min(Int(secondsIntoDay / 86_400 * Double(bucketsPerDay)), bucketsPerDay - 1)
+        return day * bucketsPerDay + bucket
+    }
+
+    private func bucketIndex(_ absoluteBucket: Int) -> Int {
+        ((absoluteBucket % bucketsPerDay) + bucketsPerDay) % bucketsPerDay
+    }
+
+    private func withLockedState<T>(_ body: () -> T) -> T {
+        lock.lock()
+        defer { lock.unlock() }
+        return body()
+    }
+}
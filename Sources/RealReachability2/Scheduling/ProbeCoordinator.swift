@@ -0,0 +1,104 @@
+//
+//  ProbeCoordinator.swift
+//  RealReachability2
+//
+//  Created by RealReachability2 on 2026.
+//
+
+import Foundation
+
+/// Probes requested versus network operations performed, for one engine or the whole process
+public struct ProbeSharingCounts: Equatable, Sendable {
+    /// Probes requested
+    public var requested: Int
+
+    /// Probes that ran as their own network operation
+    public var performed: Int
+
+    /// Probes answered by an identical probe already in flight
+    public var shared: Int {
+        requested - performed
+    }
+
+    public init(requested: Int = 0, performed: Int = 0) {
+        self.requested = requested
+        self.performed = performed
+    }
+}
+
+/// Process-wide meeting point of every engine, so several SDKs embedding the library do not each
+/// probe the same targets on their own timers.
+///
+/// Periodic wakeups are aligned on one clock: an engine sleeps until the next multiple of its
+/// interval since the coordinator started, so engines with the same (or a multiple of the same)
+/// interval wake together. Identical probes (same profile, link type, interfaces and gateways)
+/// run as one network operation on the engine that asked first, and every engine waiting on it
+/// gets the result.
+@available(iOS 13.0, *)
+final class ProbeCoordinator: @unchecked Sendable {
+    /// The coordinator shared by all engines in the process
+    static let shared = ProbeCoordinator()
+
+    /// Identifies a probe whose outcome any engine can reuse
+    struct ProbeKey: Hashable, Sendable {
+        let profile: ProbeProfile
+        let network: String
+        let allowsCellularFallback: Bool
+        let pinsHTTPProbeAddress: Bool
+    }
+
+    var counts: ProbeSharingCounts {
+        withLockedState { sharingCounts }
+    }
+
+    /// Engines with a running notifier
+    var registeredEngineCount: Int {
+        withLockedState { registeredEngines.count }
+    }
+
+    /// Deduplication only; each engine bounds its own concurrency
+    private let probes = ProbeScheduler<ProbeKey>(maxConcurrentOperations: .max)
+    private let epoch: Date
+    private let lock = NSLock()
+    private var registeredEngines: Set<ObjectIdentifier> = []
+    private var sharingCounts = ProbeSharingCounts()
+
+    init(epoch: Date = Date()) {
+        self.epoch = epoch
+    }
+
+    private func withLockedState<T>(_ body: () -> T) -> T {
+        lock.lock()
+        defer { lock.unlock() }
+        return body()
+    }
+
+    func register(_ engine: AnyObject) {
+        withLockedState { _ = registeredEngines.insert(ObjectIdentifier(engine)) }
+    }
+
+    func unregister(_ engine: AnyObject) {
+        withLockedState { _ = registeredEngines.remove(ObjectIdentifier(engine)) }
+    }
+
+    /// Seconds until the next wakeup on the shared grid for `interval`
+    func delayUntilNextTick(interval: TimeInterval, now: Date = Date()) -> TimeInterval {
+        guard interval > 0 else {
+            return 0
+        }
+        let elapsed = max(0, now.timeIntervalSince(epoch))
+        let next = ((elapsed / interval).rounded(.down) + 1) * interval
+        return next - elapsed
+    }
+
+    /// Runs `operation` for `key`, or shares the outcome of the identical probe in flight
+    func perform<R>(_ key: ProbeKey,
+                    priority: ProbePriority,
+                    operation: @escaping @Sendable () async -> R) async -> R {
+        withLockedState { sharingCounts.requested += 1 }
+        return await probes.run(key, priority: priority) { [self] in
+            withLockedState { sharingCounts.performed += 1 }
+            return await operation()
+        }
+    }
+}
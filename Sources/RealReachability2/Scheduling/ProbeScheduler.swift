@@ -0,0 +1,268 @@
+//
+//  ProbeScheduler.swift
+//  RealReachability2
+//
+//  Created by RealReachability2 on 2026.
+//
+
+import Foundation
+
+/// Admission class of probe work; higher classes are started first and may preempt lower ones
+public enum ProbePriority: Int, Comparable, Sendable, CaseIterable {
+    /// Diagnostics nobody is waiting on, such as the automatic throughput estimate
+    case backgroundDiagnostic
+
+    /// Periodic re-probes of the current link
+    case periodic
+
+    /// Probes triggered by a path update
+    case pathChange
+
+    /// Checks an app is waiting on, such as `check()`
+    case userInitiated
+
+    public static func < (lhs: ProbePriority, rhs: ProbePriority) -> Bool {
+        lhs.rawValue < rhs.rawValue
+    }
+}
+
+/// How probe requests were admitted by the engine's scheduler
+public struct ProbeSchedulerCounts: Equatable, Sendable {
+    /// Operations started, counting restarts after preemption
+    public var started: Int
+
+    /// Requests answered by an operation already running or queued for the same work
+    public var piggybacked: Int
+
+    /// Running operations cancelled and requeued to make room for higher-priority work
+    public var preempted: Int
+
+    public init(started: Int = 0, piggybacked: Int = 0, preempted: Int = 0) {
+        self.started = started
+        self.piggybacked = piggybacked
+        self.preempted = preempted
+    }
+}
+
+/// Runs keyed probe work with bounded concurrency and priority admission.
+///
+/// A request for work that is already running or queued shares its result and raises its priority
+/// instead of starting a duplicate. When every slot is busy, a request of a higher class cancels
+/// the lowest running `.periodic` or `.backgroundDiagnostic` operation and takes its slot; the
+/// preempted operation is requeued and restarted from scratch, and its cancelled run is ignored.
+/// Queued work starts in priority order, first come first served within a class.
+///
+/// Every operation for a given key must return the same type.
+final class ProbeScheduler<Key: Hashable>: @unchecked Sendable {
+    /// Highest class that can be preempted
+    static var preemptiblePriority: ProbePriority { .periodic }
+
+    /// Operations allowed to run at once
+    let maxConcurrentOperations: Int
+
+    var counts: ProbeSchedulerCounts {
+        withLockedState { schedulerCounts }
+    }
+
+    private final class Entry {
+        let key: Key
+        let sequence: UInt64
+        var priority: ProbePriority
+        let operation: @Sendable () async -> Any
+        var waiters: [UInt64: CheckedContinuation<Any, Never>] = [:]
+        var withdrawnWaiters: Set<UInt64> = []
+        var task: Task<Void, Never>?
+        var generation: UInt64 = 0
+        var isAbandoned = false
+
+        init(key: Key, sequence: UInt64, priority: ProbePriority, operation: @escaping @Sendable () async -> Any) {
+            self.key = key
+            self.sequence = sequence
+            self.priority = priority
+            self.operation = operation
+        }
+    }
+
+    private let lock = NSLock()
+    private var running: [Entry] = []
+    private var queued: [Entry] = []
+    private var nextSequence: UInt64 = 0
+    private var nextWaiterID: UInt64 = 0
+    private var schedulerCounts = ProbeSchedulerCounts()
+
+    init(maxConcurrentOperations: Int) {
+        self.maxConcurrentOperations = max(1, maxConcurrentOperations)
+    }
+
+    private func withLockedState<T>(_ body: () -> T) -> T {
+        lock.lock()
+        defer { lock.unlock() }
+        return body()
+    }
+
+    /// Runs `operation` for `key`, or joins the run already admitted for it.
+    /// The operation is cancelled once every caller waiting on it is cancelled.
+    func run<R>(_ key: Key,
+                priority: ProbePriority,
+                operation: @escaping @Sendable () async -> R) async -> R {
+        let waiterID: UInt64 = withLockedState {
+            nextWaiterID &+= 1
+            return nextWaiterID
+        }
+
+        let value = await withTaskCancellationHandler {
+            await withCheckedContinuation { continuation in
+                admit(key, priority: priority, waiterID: waiterID, continuation: continuation) {
+                    await operation()
+                }
+                if Task.isCancelled {
+                    withdraw(key, waiterID: waiterID)
+                }
+            }
+        } onCancel: {
+            withdraw(key, waiterID: waiterID)
+        }
+        return value as! R
+    }
+
+    // MARK: - Admission
+
+    private func admit(_ key: Key,
+                       priority: ProbePriority,
+                       waiterID: UInt64,
+                       continuation: CheckedContinuation<Any, Never>,
+                       operation: @escaping @Sendable () async -> Any) {
+        lock.lock()
+        if let entry = activeEntry(for: key) {
+            entry.waiters[waiterID] = continuation
+            entry.priority = max(entry.priority, priority)
+            schedulerCounts.piggybacked += 1
+        } else {
+            nextSequence &+= 1
+            let entry = Entry(key: key, sequence: nextSequence, priority: priority, operation: operation)
+            entry.waiters[waiterID] = continuation
+            queued.append(entry)
+        }
+        let preempted = startQueuedWork()
+        lock.unlock()
+
+        preempted.forEach { $0.cancel() }
+    }
+
+    /// Marks a caller as cancelled; work whose callers are all cancelled is cancelled too.
+    /// Cancelled callers still receive the operation's result.
+    private func withdraw(_ key: Key, waiterID: UInt64) {
+        lock.lock()
+        guard let entry = (running + queued).first(where: { $0.key == key && $0.waiters[waiterID] != nil }),
+              !entry.isAbandoned else {
+            lock.unlock()
+            return
+        }
+        entry.withdrawnWaiters.insert(waiterID)
+        guard entry.withdrawnWaiters.count == entry.waiters.count else {
+            lock.unlock()
+            return
+        }
+
+        entry.isAbandoned = true
+        if let index = queued.firstIndex(where: { $0 === entry }) {
+            // The caller still needs a value, so the work runs, already cancelled, outside the slots.
+            queued.remove(at: index)
+            let task = launch(entry)
+            lock.unlock()
+            task.cancel()
+            return
+        }
+        let task = entry.task
+        lock.unlock()
+        task?.cancel()
+    }
+
+    /// Cancels all running and queued work; new requests start fresh runs instead of joining it.
+    /// Callers already waiting still receive the cancelled operations' results.
+    func cancelAll() {
+        lock.lock()
+        var tasks: [Task<Void, Never>] = []
+        for entry in running where !entry.isAbandoned {
+            entry.isAbandoned = true
+            if let task = entry.task {
+                tasks.append(task)
+            }
+        }
+        // Queued work runs, already cancelled, outside the slots, as in `withdraw`.
+        let abandoned = queued
+        queued = []
+        for entry in abandoned {
+            entry.isAbandoned = true
+            tasks.append(launch(entry))
+        }
+        lock.unlock()
+        tasks.forEach { $0.cancel() }
+    }
+
+    /// Running or queued work new callers can join. Called with the lock held.
+    private func activeEntry(for key: Key) -> Entry? {
+        running.first { $0.key == key && !$0.isAbandoned } ?? queued.first { $0.key == key }
+    }
+
+    /// Starts queued work while slots are free, then preempts lower classes for the rest.
+    /// Called with the lock held; returns the preempted tasks, to be cancelled after unlocking.
+    private func startQueuedWork() -> [Task<Void, Never>] {
+        var preempted: [Task<Void, Never>] = []
+        queued.sort { ($0.priority, $1.sequence) > ($1.priority, $0.sequence) }
+
+        while let next = queued.first {
+            if running.count >= maxConcurrentOperations {
+                guard let victim = running
+                    .filter({ $0.priority <= Self.preemptiblePriority && $0.priority < next.priority && !$0.isAbandoned })
+                    .min(by: { ($0.priority, $1.sequence) < ($1.priority, $0.sequence) }) else {
+                    break
+                }
+                running.removeAll { $0 === victim }
+                if let task = victim.task {
+                    preempted.append(task)
+                }
+                victim.task = nil
+                victim.generation &+= 1
+                schedulerCounts.preempted += 1
+                queued.append(victim)
+                queued.sort { ($0.priority, $1.sequence) > ($1.priority, $0.sequence) }
+                continue
+            }
+
+            queued.removeFirst()
+            running.append(next)
+            schedulerCounts.started += 1
+            next.task = launch(next)
+        }
+        return preempted
+    }
+
+    /// Starts the entry's operation. Called with the lock held.
+    private func launch(_ entry: Entry) -> Task<Void, Never> {
+        entry.generation &+= 1
+        let generation = entry.generation
+        let operation = entry.operation
+        return Task { [weak self] in
+            let value = await operation()
+            self?.finish(entry, generation: generation, value: value)
+        }
+    }
+
+    private func finish(_ entry: Entry, generation: UInt64, value: Any) {
+        lock.lock()
+        guard entry.generation == generation else {
+            lock.unlock()
+            return
+        }
+        running.removeAll { $0 === entry }
+        let waiters = Array(entry.waiters.values)
+        entry.waiters.removeAll()
+        entry.task = nil
+        let preempted = startQueuedWork()
+        lock.unlock()
+
+        preempted.forEach { $0.cancel() }
+        waiters.forEach { $0.resume(returning: value) }
+    }
+}
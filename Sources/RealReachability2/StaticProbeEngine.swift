@@ -0,0 +1,313 @@
+//
+//  StaticProbeEngine.swift
+//  RealReachability2
+//
+//  Created by RealReachability2 on 2026.
+//
+
+import Foundation
+
+// MARK: - Backends
+
+/// A prober reporting a detailed result; the I/O backend of a `ProbePolicy`
+@available(iOS 13.0, *)
+public protocol DetailedProber: Prober {
+    func probeWithDetails() async -> ProbeResult
+}
+
+/// A prober whose route can be kept off cellular; needed for cellular fallback
+@available(iOS 13.0, *)
+public protocol CellularSelectableProber: DetailedProber {
+    func probeWithDetails(allowsCellularAccess: Bool) async -> ProbeResult
+}
+
+@available(iOS 13.0, *)
+extension ICMPPinger: DetailedProber {}
+
+@available(iOS 13.0, *)
+extension QUICProber: DetailedProber {}
+
+@available(iOS 13.0, *)
+extension TCPProber: DetailedProber {}
+
+@available(iOS 13.0, *)
+extension HTTPProber: CellularSelectableProber {}
+
+// MARK: - Policies
+
+/// Probe strategy fixed at compile time. Unlike `ProbeMode`, which `RealReachability` switches on
+/// for every probe, a policy type is resolved when `StaticProbeEngine` is specialized.
+@available(iOS 13.0, *)
+public protocol ProbePolicy: Sendable {
+    /// The dynamic mode this policy implements
+    static var probeMode: ProbeMode { get }
+
+    func probe() async -> ProbeResult
+}
+
+/// A policy with an HTTP branch. Cellular fallback retries over HTTP with cellular allowed, so
+/// only these policies offer it: ICMP- or QUIC-only fallback does not compile, where the dynamic
+/// engine rejects it at runtime.
+@available(iOS 13.0, *)
+public protocol CellularFallbackCapablePolicy: ProbePolicy {
+    /// Probes with the HTTP branch allowed or kept off cellular
+    func probe(allowsCellularAccess: Bool) async -> ProbeResult
+
+    /// Probes over cellular after a failed primary probe
+    func cellularFallbackProbe() async -> ProbeResult
+}
+
+/// `.httpOnly` as a type
+@available(iOS 13.0, *)
+public struct HTTPOnlyPolicy<HTTP: CellularSelectableProber>: CellularFallbackCapablePolicy {
+    public static var probeMode: ProbeMode { .httpOnly }
+
+    public let http: HTTP
+
+    public init(http: HTTP) {
+        self.http = http
+    }
+
+    @inlinable
+    public func probe() async -> ProbeResult {
+        await http.probeWithDetails(allowsCellularAccess: true)
+    }
+
+    @inlinable
+    public func probe(allowsCellularAccess: Bool) async -> ProbeResult {
+        await http.probeWithDetails(allowsCellularAccess: allowsCellularAccess)
+    }
+
+    @inlinable
+    public func cellularFallbackProbe() async -> ProbeResult {
+        await http.probeWithDetails(allowsCellularAccess: true)
+    }
+}
+
+/// `.icmpOnly` as a type
+@available(iOS 13.0, *)
+public struct ICMPOnlyPolicy<ICMP: DetailedProber>: ProbePolicy {
+    public static var probeMode: ProbeMode { .icmpOnly }
+
+    public let icmp: ICMP
+
+    public init(icmp: ICMP) {
+        self.icmp = icmp
+    }
+
+    @inlinable
+    public func probe() async -> ProbeResult {
+        await icmp.probeWithDetails()
+    }
+}
+
+/// `.quicOnly` as a type
+@available(iOS 13.0, *)
+public struct QUICOnlyPolicy<QUIC: DetailedProber>: ProbePolicy {
+    public static var probeMode: ProbeMode { .quicOnly }
+
+    public let quic: QUIC
+
+    public init(quic: QUIC) {
+        self.quic = quic
+    }
+
+    @inlinable
+    public func probe() async -> ProbeResult {
+        await quic.probeWithDetails()
+    }
+}
+
+/// `.parallel` as a type: HTTP and ICMP race, the first success wins, and the HTTP failure
+/// (the more specific one) is reported when both fail
+@available(iOS 13.0, *)
+public struct ParallelPolicy<HTTP: CellularSelectableProber, ICMP: DetailedProber>: CellularFallbackCapablePolicy {
+    public static var probeMode: ProbeMode { .parallel }
+
+    public let http: HTTP
+    public let icmp: ICMP
+
+    public init(http: HTTP, icmp: ICMP) {
+        self.http = http
+        self.icmp = icmp
+    }
+
+    @inlinable
+    public func probe() async -> ProbeResult {
+        await probe(allowsCellularAccess: true)
+    }
+
+    @inlinable
+    public func probe(allowsCellularAccess: Bool) async -> ProbeResult {
+        await withTaskGroup(of: (isHTTP: Bool, result: ProbeResult).self) { group in
+            group.addTask {
+                (true, await http.probeWithDetails(allowsCellularAccess: allowsCellularAccess))
+            }
+            group.addTask {
+                (false, await icmp.probeWithDetails())
+            }
+
+            var httpFailure: ProbeResult?
+            var icmpFailure: ProbeResult?
+            for await branch in group {
+                if branch.result.success {
+                    group.cancelAll()
+                    return branch.result
+                }
+                if branch.isHTTP {
+                    httpFailure = branch.result
+                } else {
+                    icmpFailure = branch.result
+                }
+            }
+            return httpFailure ?? icmpFailure ?? ProbeResult(success: false, failureReason: .unknown)
+        }
+    }
+
+    @inlinable
+    public func cellularFallbackProbe() async -> ProbeResult {
+        await http.probeWithDetails(allowsCellularAccess: true)
+    }
+}
+
+// MARK: - Clocks and Stats
+
+/// Time source of a `StaticProbeEngine`
+@available(iOS 13.0, *)
+public protocol ProbeClock: Sendable {
+    /// Monotonic time in nanoseconds
+    var nanoseconds: UInt64 { get }
+}
+
+/// Monotonic uptime clock
+@available(iOS 13.0, *)
+public struct UptimeProbeClock: ProbeClock {
+    public init() {}
+
+    @inlinable
+    public var nanoseconds: UInt64 {
+        DispatchTime.now().uptimeNanoseconds
+    }
+}
+
+/// Receives every result of a `StaticProbeEngine`
+@available(iOS 13.0, *)
+public protocol ProbeStatsSink: Sendable {
+    func record(_ result: ProbeResult, elapsedNanoseconds: UInt64)
+}
+
+/// Discards results; specialized away entirely
+@available(iOS 13.0, *)
+public struct NoProbeStats: ProbeStatsSink {
+    public init() {}
+
+    @inlinable
+    public func record(_ result: ProbeResult, elapsedNanoseconds: UInt64) {}
+}
+
+/// Counts successes and failures and sums probe time
+@available(iOS 13.0, *)
+public final class CountingProbeStats: ProbeStatsSink, @unchecked Sendable {
+    private let lock = NSLock()
+    private var successCount = 0
+    private var failureCount = 0
+    private var totalNanoseconds: UInt64 = 0
+
+    public init() {}
+
+    private func withLockedState<T>(_ body: () -> T) -> T {
+        lock.lock()
+        defer { lock.unlock() }
+        return body()
+    }
+
+    /// Successful probes recorded
+    public var successes: Int {
+        withLockedState { successCount }
+    }
+
+    /// Failed probes recorded
+    public var failures: Int {
+        withLockedState { failureCount }
+    }
+
+    /// Mean probe time in milliseconds, or `nil` before the first probe
+    public var meanProbeMilliseconds: Double? {
+        withLockedState {
+            let count = successCount + failureCount
+            return count == 0 ? nil : Double(totalNanoseconds) / Double(count) / 1_000_000
+        }
+    }
+
+    public func record(_ result: ProbeResult, elapsedNanoseconds: UInt64) {
+        withLockedState {
+            if result.success {
+                successCount += 1
+            } else {
+                failureCount += 1
+            }
+            totalNanoseconds &+= elapsedNanoseconds
+        }
+    }
+}
+
+// MARK: - Engine
+
+/// Probe engine whose mode, clock, I/O backend and stats sink are generic parameters, for
+/// embedded and server code with one fixed configuration. Every call is resolved statically and,
+/// with the inlinable policies above, specialized into the caller; no mode is switched on per probe.
+///
+/// ```swift
+/// let engine = StaticProbeEngine(policy: ParallelPolicy(http: HTTPProber(), icmp: ICMPPinger()))
+/// let outcome = await engine.probeWithCellularFallback()
+/// ```
+///
+/// Path monitoring, periodic probing and notifications remain the job of `RealReachability`.
+@available(iOS 13.0, *)
+public struct StaticProbeEngine<Policy: ProbePolicy, Clock: ProbeClock, Stats: ProbeStatsSink>: Sendable {
+    public let policy: Policy
+    public let clock: Clock
+    public let stats: Stats
+
+    public init(policy: Policy, clock: Clock, stats: Stats) {
+        self.policy = policy
+        self.clock = clock
+        self.stats = stats
+    }
+
+    /// Runs one probe with the policy
+    @inlinable
+    public func probe() async -> ProbeResult {
+        let start = clock.nanoseconds
+        let result = await policy.probe()
+        stats.record(result, elapsedNanoseconds: clock.nanoseconds &- start)
+        return result
+    }
+}
+
+@available(iOS 13.0, *)
+extension StaticProbeEngine where Clock == UptimeProbeClock, Stats == NoProbeStats {
+    /// Creates an engine on the uptime clock without stats
+    public init(policy: Policy) {
+        self.init(policy: policy, clock: UptimeProbeClock(), stats: NoProbeStats())
+    }
+}
+
+@available(iOS 13.0, *)
+extension StaticProbeEngine where Policy: CellularFallbackCapablePolicy {
+    /// Probes with the HTTP branch kept off cellular, then retries over cellular when that fails.
+    /// Only available for policies with an HTTP branch.
+    /// - Returns: The result that decided reachability, and whether it came from the cellular retry
+    @inlinable
+    public func probeWithCellularFallback() async -> (result: ProbeResult, secondaryReachable: Bool) {
+        let start = clock.nanoseconds
+        let primary = await policy.probe(allowsCellularAccess: false)
+        if primary.success {
+            stats.record(primary, elapsedNanoseconds: clock.nanoseconds &- start)
+            return (primary, false)
+        }
+        let fallback = await policy.cellularFallbackProbe()
+        stats.record(fallback, elapsedNanoseconds: clock.nanoseconds &- start)
+        return (fallback, fallback.success)
+    }
+}
@@ -0,0 +1,396 @@
+//
+//  RRLog.m
+//  RealReachability2ObjC
+//
+//  Created by RealReachability2 on 2026.
+//
+
+#import "RRLog.h"
+#import "RRLogMacros.h"
+#import <os/log.h>
+
+#if DEBUG
+_Atomic(NSInteger) RRLogThreshold = RRLogLevelDebug;
+#else
+_Atomic(NSInteger) RRLogThreshold = RRLogLevelNotice;
+#endif
+
+NSString *RRLogLevelName(RRLogLevel level) {
+    switch (level) {
+        case RRLogLevelDebug: return @"debug";
+        case RRLogLevelInfo: return @"info";
+        case RRLogLevelNotice: return @"notice";
+        case RRLogLevelWarning: return @"warning";
+        case RRLogLevelError: return @"error";
+        case RRLogLevelOff: return @"off";
+    }
+    return @"unknown";
+}
+
+#pragma mark - RRLogRecord
+
+@implementation RRLogRecord
+
+- (instancetype)initWithDate:(NSDate *)date level:(RRLogLevel)level subsystem:(NSString *)subsystem message:(NSString *)message {
+    self = [super init];
+    if (self) {
+        _date = date;
+        _level = level;
+        _subsystem = [subsystem copy];
+        _message = [message copy];
+    }
+    return self;
+}
+
+- (NSString *)formattedMessage {
+    static NSISO8601DateFormatter *formatter = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        formatter = [[NSISO8601DateFormatter alloc] init];
+        formatter.formatOptions = NSISO8601DateFormatWithInternetDateTime | NSISO8601DateFormatWithFractionalSeconds;
+    });
+    return [NSString stringWithFormat:@"%@ [%@] [%@] %@",
+            [formatter stringFromDate:self.date], RRLogLevelName(self.level), self.subsystem, self.message];
+}
+
+@end
+
+#pragma mark - RRLogger
+
+/// Per-subsystem rate window
+@interface RRLogRateWindow : NSObject
+@property (nonatomic, assign) NSTimeInterval start;
+@property (nonatomic, assign) NSUInteger count;
+@property (nonatomic, assign) NSUInteger dropped;
+@end
+
+@implementation RRLogRateWindow
+@end
+
+static NSMutableArray<id<RRLogSink>> *RRLogSinks(void) {
+    static NSMutableArray<id<RRLogSink>> *sinks = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        sinks = [NSMutableArray arrayWithObject:[[RROSLogSink alloc] init]];
+    });
+    return sinks;
+}
+
+static NSMutableDictionary<NSString *, RRLogRateWindow *> *RRLogRateWindows(void) {
+    static NSMutableDictionary<NSString *, RRLogRateWindow *> *windows = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        windows = [NSMutableDictionary dictionary];
+    });
+    return windows;
+}
+
+static NSUInteger RRLogMaximumRecordsPerSecond = 50;
+
+@implementation RRLogger
+
++ (RRLogLevel)minimumLevel {
+    return (RRLogLevel)atomic_load_explicit(&RRLogThreshold, memory_order_relaxed);
+}
+
++ (void)setMinimumLevel:(RRLogLevel)minimumLevel {
+    atomic_store_explicit(&RRLogThreshold, minimumLevel, memory_order_relaxed);
+}
+
++ (NSUInteger)maximumRecordsPerSecond {
+    @synchronized(self) {
+        return RRLogMaximumRecordsPerSecond;
+    }
+}
+
++ (void)setMaximumRecordsPerSecond:(NSUInteger)maximumRecordsPerSecond {
+    @synchronized(self) {
+        RRLogMaximumRecordsPerSecond = maximumRecordsPerSecond;
+    }
+}
+
++ (void)addSink:(id<RRLogSink>)sink {
+    @synchronized(self) {
+        [RRLogSinks() addObject:sink];
+    }
+}
+
++ (void)removeSink:(id<RRLogSink>)sink {
+    @synchronized(self) {
+        [RRLogSinks() removeObjectIdenticalTo:sink];
+    }
+}
+
++ (void)removeAllSinks {
+    @synchronized(self) {
+        [RRLogSinks() removeAllObjects];
+    }
+}
+
++ (BOOL)isLevelEnabled:(RRLogLevel)level {
+    return level != RRLogLevelOff && RRLogLevelIsEnabled(level);
+}
+
++ (void)logWithLevel:(RRLogLevel)level subsystem:(NSString *)subsystem format:(NSString *)format, ... {
+    if (![self isLevelEnabled:level]) {
+        return;
+    }
+
+    // Admission is decided before formatting, so rate-limited records cost no formatting either.
+    NSArray<id<RRLogSink>> *sinks = nil;
+    NSUInteger suppressed = 0;
+    NSTimeInterval now = [NSDate timeIntervalSinceReferenceDate];
+    @synchronized(self) {
+        if (RRLogSinks().count == 0) {
+            return;
+        }
+        if (RRLogMaximumRecordsPerSecond > 0) {
+            RRLogRateWindow *window = RRLogRateWindows()[subsystem];
+            if (!window) {
+                window = [[RRLogRateWindow alloc] init];
+                window.start = now;
+                RRLogRateWindows()[subsystem] = window;
+            }
+            if (now - window.start >= 1.0) {
+                suppressed = window.dropped;
+                window.start = now;
+                window.count = 0;
+                window.dropped = 0;
+            }
+            if (window.count >= RRLogMaximumRecordsPerSecond) {
+                window.dropped += 1;
+                return;
+            }
+            window.count += 1;
+        }
+        sinks = [RRLogSinks() copy];
+    }
+
+    va_list arguments;
+    va_start(arguments, format);
+    NSString *message = [[NSString alloc] initWithFormat:format arguments:arguments];
+    va_end(arguments);
+
+    NSDate *date = [NSDate dateWithTimeIntervalSinceReferenceDate:now];
+    RRLogRecord *record = [[RRLogRecord alloc] initWithDate:date level:level subsystem:subsystem message:message];
+    RRLogRecord *summary = nil;
+    if (suppressed > 0) {
+        NSString *summaryMessage = [NSString stringWithFormat:@"%lu records suppressed by rate limit", (unsigned long)suppressed];
+        summary = [[RRLogRecord alloc] initWithDate:date level:RRLogLevelNotice subsystem:subsystem message:summaryMessage];
+    }
+
+    for (id<RRLogSink> sink in sinks) {
+        if (summary) {
+            [sink writeRecord:summary];
+        }
+        [sink writeRecord:record];
+    }
+}
+
+@end
+
+#pragma mark - RRRingBufferLogSink
+
+enum {
+    kRRRingSubsystemLength = 32,
+    kRRRingMessageLength = 256
+};
+
+/// One slot. `sequence` is 2n+1 while record n is being written and 2n+2 once it is complete.
+typedef struct {
+    _Atomic(uint64_t) sequence;
+    NSTimeInterval timestamp;
+    RRLogLevel level;
+    char subsystem[kRRRingSubsystemLength];
+    char message[kRRRingMessageLength];
+} RRRingSlot;
+
+@implementation RRRingBufferLogSink {
+    RRRingSlot *_slots;
+    _Atomic(uint64_t) _head;
+}
+
+- (instancetype)init {
+    return [self initWithCapacity:256];
+}
+
+- (instancetype)initWithCapacity:(NSUInteger)capacity {
+    self = [super init];
+    if (self) {
+        _capacity = MAX(capacity, (NSUInteger)1);
+        _slots = calloc(_capacity, sizeof(RRRingSlot));
+        atomic_init(&_head, 0);
+    }
+    return self;
+}
+
+- (void)dealloc {
+    free(_slots);
+}
+
+/// Copies a string into a fixed buffer without splitting a UTF-8 sequence
+static void RRRingCopyString(NSString *string, char *buffer, NSUInteger length) {
+    NSUInteger used = 0;
+    [string getBytes:buffer
+           maxLength:length - 1
+          usedLength:&used
+            encoding:NSUTF8StringEncoding
+             options:0
+               range:NSMakeRange(0, string.length)
+      remainingRange:NULL];
+    buffer[used] = '\0';
+}
+
+- (void)writeRecord:(RRLogRecord *)record {
+    uint64_t index = atomic_fetch_add_explicit(&_head, 1, memory_order_relaxed);
+    RRRingSlot *slot = &_slots[index % _capacity];
+
+    atomic_store_explicit(&slot->sequence, 2 * index + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    slot->timestamp = record.date.timeIntervalSinceReferenceDate;
+    slot->level = record.level;
+    RRRingCopyString(record.subsystem, slot->subsystem, kRRRingSubsystemLength);
+    RRRingCopyString(record.message, slot->message, kRRRingMessageLength);
+    atomic_store_explicit(&slot->sequence, 2 * index + 2, memory_order_release);
+}
+
+- (NSArray<RRLogRecord *> *)records {
+    uint64_t head = atomic_load_explicit(&_head, memory_order_acquire);
+    uint64_t first = head > _capacity ? head - _capacity : 0;
+    NSMutableArray<RRLogRecord *> *records = [NSMutableArray arrayWithCapacity:(NSUInteger)(head - first)];
+
+    for (uint64_t index = first; index < head; index++) {
+        RRRingSlot *slot = &_slots[index % _capacity];
+        uint64_t before = atomic_load_explicit(&slot->sequence, memory_order_acquire);
+        if (before != 2 * index + 2) {
+            continue;
+        }
+
+        NSTimeInterval timestamp = slot->timestamp;
+        RRLogLevel level = slot->level;
+        char subsystem[kRRRingSubsystemLength];
+        char message[kRRRingMessageLength];
+        memcpy(subsystem, slot->subsystem, sizeof(subsystem));
+        memcpy(message, slot->message, sizeof(message));
+
+        // Overwritten while copying: the copy may be torn, so drop it.
+        atomic_thread_fence(memory_order_acquire);
+        if (atomic_load_explicit(&slot->sequence, memory_order_relaxed) != before) {
+            continue;
+        }
+        subsystem[kRRRingSubsystemLength - 1] = '\0';
+        message[kRRRingMessageLength - 1] = '\0';
+
+        [records addObject:[[RRLogRecord alloc] initWithDate:[NSDate dateWithTimeIntervalSinceReferenceDate:timestamp]
+                                                       level:level
+                                                   subsystem:@(subsystem)
+                                                     message:@(message)]];
+    }
+    return records;
+}
+
+@end
+
+#pragma mark - RRStandardErrorLogSink
+
+@implementation RRStandardErrorLogSink
+
+- (void)writeRecord:(RRLogRecord *)record {
+    NSData *line = [[record.formattedMessage stringByAppendingString:@"\n"] dataUsingEncoding:NSUTF8StringEncoding];
+    @synchronized(self) {
+        fwrite(line.bytes, 1, line.length, stderr);
+    }
+}
+
+@end
+
+#pragma mark - RRFileLogSink
+
+@interface RRFileLogSink ()
+@property (nonatomic, strong) NSFileHandle *fileHandle;
+@property (nonatomic, strong) dispatch_queue_t queue;
+@end
+
+@implementation RRFileLogSink
+
+- (nullable instancetype)initWithFileURL:(NSURL *)fileURL {
+    self = [super init];
+    if (self) {
+        NSFileManager *fileManager = [NSFileManager defaultManager];
+        if (![fileManager fileExistsAtPath:fileURL.path] &&
+            ![fileManager createFileAtPath:fileURL.path contents:nil attributes:nil]) {
+            return nil;
+        }
+        NSFileHandle *fileHandle = [NSFileHandle fileHandleForWritingToURL:fileURL error:NULL];
+        if (!fileHandle) {
+            return nil;
+        }
+        [fileHandle seekToEndOfFile];
+
+        _fileURL = [fileURL copy];
+        _fileHandle = fileHandle;
+        _queue = dispatch_queue_create("com.realreachability2.filelog", DISPATCH_QUEUE_SERIAL);
+    }
+    return self;
+}
+
+- (void)dealloc {
+    [_fileHandle closeFile];
+}
+
+- (void)writeRecord:(RRLogRecord *)record {
+    NSData *line = [[record.formattedMessage stringByAppendingString:@"\n"] dataUsingEncoding:NSUTF8StringEncoding];
+    NSFileHandle *fileHandle = self.fileHandle;
+    dispatch_async(self.queue, ^{
+        [fileHandle writeData:line];
+    });
+}
+
+- (void)flush {
+    dispatch_sync(self.queue, ^{});
+}
+
+@end
+
+#pragma mark - RROSLogSink
+
+@interface RROSLogSink ()
+@property (nonatomic, strong) NSMutableDictionary<NSString *, os_log_t> *logs;
+@end
+
+@implementation RROSLogSink
+
+- (instancetype)init {
+    return [self initWithSubsystem:@"com.realreachability2"];
+}
+
+- (instancetype)initWithSubsystem:(NSString *)subsystem {
+    self = [super init];
+    if (self) {
+        _subsystem = [subsystem copy];
+        _logs = [NSMutableDictionary dictionary];
+    }
+    return self;
+}
+
+- (void)writeRecord:(RRLogRecord *)record {
+    os_log_t log = nil;
+    @synchronized(self) {
+        log = self.logs[record.subsystem];
+        if (!log) {
+            log = os_log_create(self.subsystem.UTF8String, record.subsystem.UTF8String);
+            self.logs[record.subsystem] = log;
+        }
+    }
+
+    os_log_type_t type = OS_LOG_TYPE_DEFAULT;
+    switch (record.level) {
+        case RRLogLevelDebug: type = OS_LOG_TYPE_DEBUG; break;
+        case RRLogLevelInfo: type = OS_LOG_TYPE_INFO; break;
+        case RRLogLevelError: type = OS_LOG_TYPE_ERROR; break;
+        default: break;
+    }
+    os_log_with_type(log, type, "%{public}@", record.message);
+}
+
+@end
@@ -0,0 +1,40 @@
+//
+//  RRLogMacros.h
+//  RealReachability2ObjC
+//
+//  Created by RealReachability2 on 2026.
+//
+
+#import "RRLog.h"
+#include <stdatomic.h>
+
+/// Levels below this are compiled out of the library
+#ifndef RR_LOG_COMPILED_MINIMUM_LEVEL
+#if DEBUG || defined(RR_LOG_VERBOSE)
+#define RR_LOG_COMPILED_MINIMUM_LEVEL RRLogLevelDebug
+#elif defined(RR_LOG_QUIET)
+#define RR_LOG_COMPILED_MINIMUM_LEVEL RRLogLevelWarning
+#else
+#define RR_LOG_COMPILED_MINIMUM_LEVEL RRLogLevelInfo
+#endif
+#endif
+
+/// Runtime threshold backing +[RRLogger minimumLevel]
+FOUNDATION_EXTERN _Atomic(NSInteger) RRLogThreshold;
+
+static inline BOOL RRLogLevelIsEnabled(RRLogLevel level) {
+    return level >= atomic_load_explicit(&RRLogThreshold, memory_order_relaxed);
+}
+
+/// Arguments are only evaluated when the level is compiled in and passes the threshold.
+#define RRLog(lvl, subsys, fmt, ...) do { \
+    if ((lvl) >= RR_LOG_COMPILED_MINIMUM_LEVEL && RRLogLevelIsEnabled(lvl)) { \
+        [RRLogger logWithLevel:(lvl) subsystem:(subsys) format:(fmt), ##__VA_ARGS__]; \
+    } \
+} while (0)
+
+#define RRLogDebug(subsys, fmt, ...) RRLog(RRLogLevelDebug, subsys, fmt, ##__VA_ARGS__)
+#define RRLogInfo(subsys, fmt, ...) RRLog(RRLogLevelInfo, subsys, fmt, ##__VA_ARGS__)
+#define RRLogNotice(subsys, fmt, ...) RRLog(RRLogLevelNotice, subsys, fmt, ##__VA_ARGS__)
+#define RRLogWarning(subsys, fmt, ...) RRLog(RRLogLevelWarning, subsys, fmt, ##__VA_ARGS__)
+#define RRLogError(subsys, fmt, ...) RRLog(RRLogLevelError, subsys, fmt, ##__VA_ARGS__)
@@ -0,0 +1,315 @@
+//
+//  RRMTUProber.m
+//  RealReachability2ObjC
+//
+//  Created by RealReachability2 on 2026.
+//
+
+#import "RRMTUProber.h"
+#import "RRPingFoundation.h"
+#import "RRLogMacros.h"
+
+#include <netinet/in.h>
+
+/// IP header bytes in front of the ICMP header, per address family
+static const NSUInteger kRRMTUIPv4HeaderLength = 20;
+static const NSUInteger kRRMTUIPv6HeaderLength = 40;
+
+#pragma mark - RRMTUProbeOperation
+
+/// One don't-fragment echo of a given size, on its own socket
+@interface RRMTUProbeOperation : NSObject <RRPingFoundationDelegate>
+
+@property (nonatomic, assign) NSUInteger mtu;
+@property (nonatomic, assign) NSTimeInterval timeout;
+@property (nonatomic, strong, nullable) RRPacketCapture *packetCapture;
+@property (nonatomic, strong, nullable) RRPingFoundation *pingFoundation;
+@property (nonatomic, strong, nullable) NSTimer *resendTimer;
+@property (nonatomic, strong, nullable) NSTimer *timeoutTimer;
+@property (nonatomic, copy, nullable) NSData *payload;
+@property (nonatomic, copy, nullable) RRMTUProbeCompletionBlock completion;
+
+- (void)startWithHost:(NSString *)host;
+- (void)finishWithFits:(BOOL)fits failureReason:(RRProbeFailureReason)failureReason;
+
+@end
+
+@implementation RRMTUProbeOperation
+
+- (void)startWithHost:(NSString *)host {
+    self.pingFoundation = [[RRPingFoundation alloc] initWithHostName:host];
+    self.pingFoundation.dontFragment = YES;
+    self.pingFoundation.delegate = self;
+    self.pingFoundation.packetCapture = self.packetCapture;
+    [self.pingFoundation start];
+
+    __weak typeof(self) weakSelf = self;
+    self.timeoutTimer = [NSTimer scheduledTimerWithTimeInterval:self.timeout repeats:NO block:^(NSTimer * _Nonnull timer) {
+        [weakSelf finishWithFits:NO failureReason:RRProbeFailureReasonTimeout];
+    }];
+}
+
+- (void)finishWithFits:(BOOL)fits failureReason:(RRProbeFailureReason)failureReason {
+    RRMTUProbeCompletionBlock completion = self.completion;
+    self.completion = nil;
+
+    [self.resendTimer invalidate];
+    self.resendTimer = nil;
+    [self.timeoutTimer invalidate];
+    self.timeoutTimer = nil;
+    self.pingFoundation.delegate = nil;
+    [self.pingFoundation stop];
+    self.pingFoundation = nil;
+
+    if (completion) {
+        completion(fits, fits ? RRProbeFailureReasonNone : failureReason);
+    }
+}
+
+#pragma mark - RRPingFoundationDelegate
+
+- (void)pingFoundation:(RRPingFoundation *)pinger didStartWithAddress:(NSData *)address {
+    NSUInteger headerLength = (pinger.hostAddressFamily == AF_INET6) ? kRRMTUIPv6HeaderLength : kRRMTUIPv4HeaderLength;
+    NSUInteger overhead = headerLength + sizeof(RRICMPHeader);
+    if (self.mtu <= overhead) {
+        [self finishWithFits:NO failureReason:RRProbeFailureReasonInvalidConfiguration];
+        return;
+    }
+
+    self.payload = [NSMutableData dataWithLength:self.mtu - overhead];
+    [pinger sendPingWithData:self.payload];
+
+    // One resend halfway through, so a single lost echo is not mistaken for a size limit.
+    __weak typeof(self) weakSelf = self;
+    self.resendTimer = [NSTimer scheduledTimerWithTimeInterval:self.timeout / 2 repeats:NO block:^(NSTimer * _Nonnull timer) {
+        __strong typeof(weakSelf) strongSelf = weakSelf;
+        if (strongSelf.pingFoundation && strongSelf.payload) {
+            [strongSelf.pingFoundation sendPingWithData:strongSelf.payload];
+        }
+    }];
+}
+
+- (void)pingFoundation:(RRPingFoundation *)pinger didFailWithError:(NSError *)error {
+    [self finishWithFits:NO failureReason:RRProbeFailureReasonFromError(error)];
+}
+
+- (void)pingFoundation:(RRPingFoundation *)pinger didFailToSendPacket:(NSData *)packet sequenceNumber:(uint16_t)sequenceNumber error:(NSError *)error {
+    // EMSGSIZE means larger than the local interface MTU: refused before it left the host.
+    [self finishWithFits:NO failureReason:RRProbeFailureReasonFromError(error)];
+}
+
+- (void)pingFoundation:(RRPingFoundation *)pinger didReceivePingResponsePacket:(NSData *)packet sequenceNumber:(uint16_t)sequenceNumber {
+    // Some middleboxes truncate echo replies; only a full-size reply proves the size got through.
+    BOOL isFullSize = packet.length >= sizeof(RRICMPHeader) + self.payload.length;
+    if (isFullSize) {
+        [self finishWithFits:YES failureReason:RRProbeFailureReasonNone];
+    }
+}
+
+@end
+
+#pragma mark - RRMTUProber
+
+@interface RRMTUProber ()
+
+@property (nonatomic, strong) NSMutableDictionary<NSString *, NSNumber *> *cache;
+@property (nonatomic, strong) NSMutableSet<RRMTUProbeOperation *> *operations;
+@property (nonatomic, copy, nullable) RRMTUDiscoveryCompletionBlock discoveryCompletion;
+@property (nonatomic, copy, nullable) NSString *discoveryNetworkKey;
+
+@end
+
+@implementation RRMTUProber
+
+#pragma mark - Lifecycle
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        _host = @"8.8.8.8";
+        _timeout = 1.0;
+        _minimumMTU = 1280;
+        _maximumMTU = 1500;
+        _parallelProbes = 4;
+        _cache = [NSMutableDictionary dictionary];
+        _operations = [NSMutableSet set];
+    }
+    return self;
+}
+
+- (void)dealloc {
+    for (RRMTUProbeOperation *operation in self.operations) {
+        operation.completion = nil;
+        [operation finishWithFits:NO failureReason:RRProbeFailureReasonCancelled];
+    }
+}
+
+#pragma mark - Public Methods
+
+- (void)discoverPathMTUForNetworkKey:(NSString *)networkKey completion:(RRMTUDiscoveryCompletionBlock)completion {
+    dispatch_async(dispatch_get_main_queue(), ^{
+        NSUInteger cached = networkKey ? [self cachedPathMTUForNetworkKey:networkKey] : 0;
+        if (cached > 0) {
+            completion(cached, RRProbeFailureReasonNone);
+            return;
+        }
+
+        if (self.host.length == 0 || self.minimumMTU == 0 || self.minimumMTU > self.maximumMTU || self.parallelProbes == 0) {
+            completion(0, RRProbeFailureReasonInvalidConfiguration);
+            return;
+        }
+
+        // A discovery already in flight answers for both callers.
+        RRMTUDiscoveryCompletionBlock pending = self.discoveryCompletion;
+        if (pending) {
+            self.discoveryCompletion = ^(NSUInteger pathMTU, RRProbeFailureReason failureReason) {
+                pending(pathMTU, failureReason);
+                completion(pathMTU, failureReason);
+            };
+            return;
+        }
+
+        self.discoveryCompletion = completion;
+        self.discoveryNetworkKey = networkKey;
+        [self searchWithConfirmedMTU:0 low:self.minimumMTU high:self.maximumMTU];
+    });
+}
+
+- (NSUInteger)cachedPathMTUForNetworkKey:(NSString *)networkKey {
+    @synchronized(self) {
+        return self.cache[networkKey].unsignedIntegerValue;
+    }
+}
+
+- (void)invalidate {
+    @synchronized(self) {
+        [self.cache removeAllObjects];
+    }
+}
+
+- (void)cancel {
+    dispatch_async(dispatch_get_main_queue(), ^{
+        NSArray<RRMTUProbeOperation *> *operations = self.operations.allObjects;
+        [self.operations removeAllObjects];
+        for (RRMTUProbeOperation *operation in operations) {
+            operation.completion = nil;
+            [operation finishWithFits:NO failureReason:RRProbeFailureReasonCancelled];
+        }
+        [self finishDiscoveryWithMTU:0 failureReason:RRProbeFailureReasonCancelled];
+    });
+}
+
+- (void)probeMTU:(NSUInteger)mtu completion:(RRMTUProbeCompletionBlock)completion {
+    RRMTUProbeOperation *operation = [[RRMTUProbeOperation alloc] init];
+    operation.mtu = mtu;
+    operation.timeout = self.timeout;
+    operation.packetCapture = self.packetCapture;
+
+    __weak typeof(self) weakSelf = self;
+    __weak RRMTUProbeOperation *weakOperation = operation;
+    operation.completion = ^(BOOL fits, RRProbeFailureReason failureReason) {
+        RRMTUProbeOperation *finishedOperation = weakOperation;
+        if (finishedOperation) {
+            [weakSelf.operations removeObject:finishedOperation];
+        }
+        completion(fits, failureReason);
+    };
+
+    [self.operations addObject:operation];
+    [operation startWithHost:self.host];
+}
+
++ (NSArray<NSNumber *> *)candidateMTUsFrom:(NSUInteger)low to:(NSUInteger)high count:(NSUInteger)count {
+    if (low > high || count == 0) {
+        return @[];
+    }
+
+    NSUInteger span = high - low;
+    if (span < count) {
+        NSMutableArray<NSNumber *> *all = [NSMutableArray arrayWithCapacity:span + 1];
+        for (NSUInteger mtu = low; mtu <= high; mtu++) {
+            [all addObject:@(mtu)];
+        }
+        return all;
+    }
+    if (count == 1) {
+        return @[@(high)];
+    }
+
+    NSMutableOrderedSet<NSNumber *> *candidates = [NSMutableOrderedSet orderedSetWithCapacity:count];
+    for (NSUInteger i = 0; i < count; i++) {
+        [candidates addObject:@(low + span * i / (count - 1))];
+    }
+    return candidates.array;
+}
+
+#pragma mark - Search
+
+/// One round: probes sizes spread over [low, high] in parallel. Everything up to `confirmed`
+/// is known to fit and everything above `high` is known not to.
+- (void)searchWithConfirmedMTU:(NSUInteger)confirmed low:(NSUInteger)low high:(NSUInteger)high {
+    if (!self.discoveryCompletion) {
+        return;
+    }
+    if (low > high) {
+        [self finishDiscoveryWithMTU:confirmed failureReason:RRProbeFailureReasonNone];
+        return;
+    }
+
+    NSArray<NSNumber *> *candidates = [[self class] candidateMTUsFrom:low to:high count:self.parallelProbes];
+    NSMutableDictionary<NSNumber *, NSNumber *> *fits = [NSMutableDictionary dictionary];
+    __block RRProbeFailureReason smallestFailure = RRProbeFailureReasonNone;
+    __block NSUInteger pending = candidates.count;
+
+    for (NSNumber *candidate in candidates) {
+        [self probeMTU:candidate.unsignedIntegerValue completion:^(BOOL candidateFits, RRProbeFailureReason failureReason) {
+            fits[candidate] = @(candidateFits);
+            if (!candidateFits && candidate.unsignedIntegerValue == low) {
+                smallestFailure = failureReason;
+            }
+            if (--pending > 0) {
+                return;
+            }
+
+            // The smallest size that did not fit caps the range; the largest that fit below it
+            // raises the floor. Sizes above a failure are ignored even if they got through.
+            NSUInteger newConfirmed = confirmed;
+            NSUInteger newHigh = high;
+            for (NSNumber *mtu in candidates) {
+                if (fits[mtu].boolValue) {
+                    newConfirmed = mtu.unsignedIntegerValue;
+                } else {
+                    newHigh = mtu.unsignedIntegerValue - 1;
+                    break;
+                }
+            }
+
+            if (newConfirmed == 0 && newHigh < low) {
+                // Not even the minimum got through: the host is unreachable, not the MTU small.
+                [self finishDiscoveryWithMTU:0 failureReason:smallestFailure];
+                return;
+            }
+            [self searchWithConfirmedMTU:newConfirmed low:MAX(newConfirmed + 1, low) high:newHigh];
+        }];
+    }
+}
+
+- (void)finishDiscoveryWithMTU:(NSUInteger)pathMTU failureReason:(RRProbeFailureReason)failureReason {
+    RRMTUDiscoveryCompletionBlock completion = self.discoveryCompletion;
+    NSString *networkKey = self.discoveryNetworkKey;
+    self.discoveryCompletion = nil;
+    self.discoveryNetworkKey = nil;
+    if (!completion) {
+        return;
+    }
+
+    if (pathMTU > 0 && networkKey) {
+        @synchronized(self) {
+            self.cache[networkKey] = @(pathMTU);
+        }
+    }
+    RRLogInfo(@"mtu", @"pathMTU=%lu failureReason=%ld", (unsigned long)pathMTU, (long)failureReason);
+    completion(pathMTU, pathMTU > 0 ? RRProbeFailureReasonNone : failureReason);
+}
+
+@end
@@ -0,0 +1,246 @@
+//
+//  RRNAT64Resolver.m
+//  RealReachability2ObjC
+//
+//  Created by RealReachability2 on 2026.
+//
+
+#import "RRNAT64Resolver.h"
+
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <netdb.h>
+
+static NSString * const kRRNAT64DiscoveryHostName = @"ipv4only.arpa";
+
+/// Byte offsets of the embedded IPv4 address for a prefix length, or NULL if the length is invalid.
+/// Byte 8 (bits 64..71) is reserved and always skipped.
+static const uint8_t *RRNAT64EmbeddingOffsets(NSUInteger prefixLength) {
+    static const uint8_t offsets96[4] = {12, 13, 14, 15};
+    static const uint8_t offsets64[4] = {9, 10, 11, 12};
+    static const uint8_t offsets56[4] = {7, 9, 10, 11};
+    static const uint8_t offsets48[4] = {6, 7, 9, 10};
+    static const uint8_t offsets40[4] = {5, 6, 7, 9};
+    static const uint8_t offsets32[4] = {4, 5, 6, 7};
+
+    switch (prefixLength) {
+        case 96: return offsets96;
+        case 64: return offsets64;
+        case 56: return offsets56;
+        case 48: return offsets48;
+        case 40: return offsets40;
+        case 32: return offsets32;
+        default: return NULL;
+    }
+}
+
+#pragma mark - RRNAT64Prefix
+
+@implementation RRNAT64Prefix
+
+- (instancetype)initWithPrefixData:(NSData *)prefixData prefixLength:(NSUInteger)prefixLength {
+    if (prefixData.length != 16 || RRNAT64EmbeddingOffsets(prefixLength) == NULL) {
+        return nil;
+    }
+
+    self = [super init];
+    if (self) {
+        uint8_t masked[16] = {0};
+        memcpy(masked, prefixData.bytes, prefixLength / 8);
+        _prefixData = [NSData dataWithBytes:masked length:sizeof(masked)];
+        _prefixLength = prefixLength;
+    }
+    return self;
+}
+
++ (instancetype)prefixFromSynthesizedAddress:(NSData *)address {
+    if (address.length != 16) {
+        return nil;
+    }
+
+    static const NSUInteger lengths[] = {96, 64, 56, 48, 40, 32};
+    const uint8_t *bytes = address.bytes;
+
+    // Longest prefix first, so that /96 wins over shorter lengths that
+    // would also happen to match a zero-padded suffix.
+    for (size_t i = 0; i < sizeof(lengths) / sizeof(lengths[0]); i++) {
+        const uint8_t *offsets = RRNAT64EmbeddingOffsets(lengths[i]);
+        BOOL isWellKnown = (bytes[offsets[0]] == 192 &&
+                            bytes[offsets[1]] == 0 &&
+                            bytes[offsets[2]] == 0 &&
+                            (bytes[offsets[3]] == 170 || bytes[offsets[3]] == 171));
+        if (isWellKnown) {
+            return [[RRNAT64Prefix alloc] initWithPrefixData:address prefixLength:lengths[i]];
+        }
+    }
+    return nil;
+}
+
+- (NSString *)synthesizedHostForIPv4Literal:(NSString *)host {
+    struct in_addr ipv4;
+    if (host.length == 0 || inet_pton(AF_INET, host.UTF8String, &ipv4) != 1) {
+        return nil;
+    }
+
+    const uint8_t *offsets = RRNAT64EmbeddingOffsets(self.prefixLength);
+    const uint8_t *ipv4Bytes = (const uint8_t *) &ipv4;
+    struct in6_addr ipv6;
+    memcpy(&ipv6, self.prefixData.bytes, sizeof(ipv6));
+    for (size_t i = 0; i < 4; i++) {
+        ((uint8_t *) &ipv6)[offsets[i]] = ipv4Bytes[i];
+    }
+
+    char buffer[INET6_ADDRSTRLEN];
+    if (inet_ntop(AF_INET6, &ipv6, buffer, sizeof(buffer)) == NULL) {
+        return nil;
+    }
+    return [NSString stringWithUTF8String:buffer];
+}
+
+- (BOOL)isEqual:(id)object {
+    if (![object isKindOfClass:[RRNAT64Prefix class]]) {
+        return NO;
+    }
+    RRNAT64Prefix *other = object;
+    return other.prefixLength == self.prefixLength && [other.prefixData isEqualToData:self.prefixData];
+}
+
+- (NSUInteger)hash {
+    return self.prefixData.hash ^ self.prefixLength;
+}
+
+@end
+
+#pragma mark - RRNAT64Discovery
+
+/// One lookup in flight; callers for the same network wait on it instead of repeating it
+@interface RRNAT64Discovery : NSObject
+
+@property (nonatomic, strong, readonly) dispatch_group_t group;
+@property (nonatomic, strong, nullable) RRNAT64Prefix *prefix;
+
+@end
+
+@implementation RRNAT64Discovery
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        _group = dispatch_group_create();
+    }
+    return self;
+}
+
+@end
+
+#pragma mark - RRNAT64Resolver
+
+@interface RRNAT64Resolver ()
+
+@property (nonatomic, copy) RRNAT64AddressResolver addressResolver;
+/// Discovery results per network key; NSNull means "no NAT64 on this network"
+@property (nonatomic, strong) NSMutableDictionary<NSString *, id> *cache;
+/// In-flight discoveries, so concurrent probes share one lookup
+@property (nonatomic, strong) NSMutableDictionary<NSString *, RRNAT64Discovery *> *pending;
+
+@end
+
+@implementation RRNAT64Resolver
+
+- (instancetype)init {
+    return [self initWithAddressResolver:^NSArray<NSData *> *(NSString *hostName) {
+        return [RRNAT64Resolver systemResolveIPv6:hostName];
+    }];
+}
+
+- (instancetype)initWithAddressResolver:(RRNAT64AddressResolver)addressResolver {
+    self = [super init];
+    if (self) {
+        _addressResolver = [addressResolver copy];
+        _cache = [NSMutableDictionary dictionary];
+        _pending = [NSMutableDictionary dictionary];
+    }
+    return self;
+}
+
+- (RRNAT64Prefix *)prefixForNetworkKey:(NSString *)networkKey {
+    RRNAT64Discovery *discovery = nil;
+    BOOL joined = NO;
+    @synchronized(self) {
+        id cached = self.cache[networkKey];
+        if (cached != nil) {
+            return (cached == [NSNull null]) ? nil : cached;
+        }
+
+        discovery = self.pending[networkKey];
+        joined = discovery != nil;
+        if (!joined) {
+            discovery = [[RRNAT64Discovery alloc] init];
+            dispatch_group_enter(discovery.group);
+            self.pending[networkKey] = discovery;
+        }
+    }
+
+    if (joined) {
+        dispatch_group_wait(discovery.group, DISPATCH_TIME_FOREVER);
+        return discovery.prefix;
+    }
+
+    // The lookup blocks on DNS, so it runs outside the lock; other networks and invalidate stay responsive.
+    RRNAT64Prefix *prefix = nil;
+    for (NSData *address in self.addressResolver(kRRNAT64DiscoveryHostName)) {
+        prefix = [RRNAT64Prefix prefixFromSynthesizedAddress:address];
+        if (prefix) {
+            break;
+        }
+    }
+
+    @synchronized(self) {
+        discovery.prefix = prefix;
+        // An invalidate meanwhile dropped the entry; the result is stale for the cache.
+        if (self.pending[networkKey] == discovery) {
+            [self.pending removeObjectForKey:networkKey];
+            self.cache[networkKey] = prefix ?: [NSNull null];
+        }
+    }
+    dispatch_group_leave(discovery.group);
+    return prefix;
+}
+
+- (void)invalidate {
+    @synchronized(self) {
+        [self.cache removeAllObjects];
+        [self.pending removeAllObjects];
+    }
+}
+
++ (BOOL)isIPv4Literal:(NSString *)host {
+    struct in_addr ipv4;
+    return host.length > 0 && inet_pton(AF_INET, host.UTF8String, &ipv4) == 1;
+}
+
++ (NSArray<NSData *> *)systemResolveIPv6:(NSString *)hostName {
+    struct addrinfo hints;
+    struct addrinfo *result = NULL;
+
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_INET6;
+    hints.ai_socktype = SOCK_DGRAM;
+
+    if (getaddrinfo(hostName.UTF8String, NULL, &hints, &result) != 0 || result == NULL) {
+        return @[];
+    }
+
+    NSMutableArray<NSData *> *addresses = [NSMutableArray array];
+    for (struct addrinfo *cursor = result; cursor != NULL; cursor = cursor->ai_next) {
+        if (cursor->ai_family == AF_INET6 && cursor->ai_addr != NULL) {
+            const struct sockaddr_in6 *sin6 = (const struct sockaddr_in6 *) cursor->ai_addr;
+            [addresses addObject:[NSData dataWithBytes:&sin6->sin6_addr length:sizeof(sin6->sin6_addr)]];
+        }
+    }
+    freeaddrinfo(result);
+    return addresses;
+}
+
+@end
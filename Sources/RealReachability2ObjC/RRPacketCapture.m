@@ -0,0 +1,237 @@
+//
+//  RRPacketCapture.m
+//  RealReachability2ObjC
+//
+//  Created by RealReachability2 on 2026.
+//
+
+#import "RRPacketCapture.h"
+
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+
+static const NSUInteger kRRCaptureIPv4HeaderLength = 20;
+static const NSUInteger kRRCaptureIPv6HeaderLength = 40;
+
+/// pcapng block types and link types (draft-ietf-opsawg-pcapng)
+static const uint32_t kRRPcapNGSectionHeaderBlock = 0x0A0D0D0A;
+static const uint32_t kRRPcapNGInterfaceDescriptionBlock = 0x00000001;
+static const uint32_t kRRPcapNGEnhancedPacketBlock = 0x00000006;
+static const uint32_t kRRPcapNGByteOrderMagic = 0x1A2B3C4D;
+static const uint16_t kRRPcapNGLinkTypeIPv4 = 228;
+static const uint16_t kRRPcapNGLinkTypeIPv6 = 229;
+
+/// `epb_flags` option carrying the packet direction
+static const uint16_t kRRPcapNGFlagsOption = 2;
+static const uint32_t kRRPcapNGInboundFlag = 1;
+static const uint32_t kRRPcapNGOutboundFlag = 2;
+
+/// Metadata of one ring slot; the bytes live in the shared storage block
+typedef struct {
+    uint64_t timestampMicroseconds;
+    uint32_t capturedLength;
+    uint32_t originalLength;
+    BOOL inbound;
+    BOOL ipv6;
+} RRCapturedPacket;
+
+static void RRAppendUInt16(NSMutableData *data, uint16_t value) {
+    uint8_t bytes[2] = { (uint8_t) value, (uint8_t) (value >> 8) };
+    [data appendBytes:bytes length:sizeof(bytes)];
+}
+
+static void RRAppendUInt32(NSMutableData *data, uint32_t value) {
+    uint8_t bytes[4] = { (uint8_t) value, (uint8_t) (value >> 8), (uint8_t) (value >> 16), (uint8_t) (value >> 24) };
+    [data appendBytes:bytes length:sizeof(bytes)];
+}
+
+static uint16_t RRInternetChecksum(const uint8_t *bytes, size_t length) {
+    uint32_t sum = 0;
+    size_t index = 0;
+    for (; index + 1 < length; index += 2) {
+        sum += ((uint32_t) bytes[index] << 8) | bytes[index + 1];
+    }
+    if (index < length) {
+        sum += (uint32_t) bytes[index] << 8;
+    }
+    while (sum >> 16) {
+        sum = (sum & 0xFFFF) + (sum >> 16);
+    }
+    return (uint16_t) ~sum;
+}
+
+@implementation RRPacketCapture {
+    uint8_t *_storage;
+    RRCapturedPacket *_packets;
+    NSUInteger _nextIndex;
+    NSUInteger _written;
+}
+
+- (instancetype)initWithCapacity:(NSUInteger)capacity snapLength:(NSUInteger)snapLength {
+    self = [super init];
+    if (self) {
+        _capacity = MAX(capacity, (NSUInteger) 1);
+        _snapLength = MAX(snapLength, kRRCaptureIPv6HeaderLength + 8);
+        _storage = calloc(_capacity, _snapLength);
+        _packets = calloc(_capacity, sizeof(RRCapturedPacket));
+    }
+    return self;
+}
+
+- (instancetype)init {
+    return [self initWithCapacity:256 snapLength:256];
+}
+
+- (void)dealloc {
+    free(_storage);
+    free(_packets);
+}
+
+- (NSUInteger)packetCount {
+    @synchronized(self) {
+        return MIN(_written, _capacity);
+    }
+}
+
+- (NSUInteger)totalPacketCount {
+    @synchronized(self) {
+        return _written;
+    }
+}
+
+- (void)clear {
+    @synchronized(self) {
+        _nextIndex = 0;
+        _written = 0;
+    }
+}
+
+#pragma mark - Recording
+
+- (void)recordPacket:(NSData *)packet direction:(RRPacketDirection)direction peerAddress:(NSData *)peerAddress {
+    if (peerAddress.length < sizeof(struct sockaddr)) {
+        return;
+    }
+
+    struct timeval now;
+    gettimeofday(&now, NULL);
+    uint64_t timestamp = (uint64_t) now.tv_sec * 1000000 + (uint64_t) now.tv_usec;
+    BOOL inbound = (direction == RRPacketDirectionInbound);
+    const uint8_t *payload = packet.bytes;
+    NSUInteger payloadLength = packet.length;
+    sa_family_t family = ((const struct sockaddr *) peerAddress.bytes)->sa_family;
+
+    uint8_t header[kRRCaptureIPv6HeaderLength];
+    NSUInteger headerLength = 0;
+    BOOL ipv6 = NO;
+
+    if (family == AF_INET) {
+        BOOL hasIPHeader = inbound && payloadLength >= kRRCaptureIPv4HeaderLength && (payload[0] >> 4) == 4;
+        if (!hasIPHeader) {
+            if (peerAddress.length < sizeof(struct sockaddr_in)) {
+                return;
+            }
+            const struct sockaddr_in *peer = peerAddress.bytes;
+            NSUInteger totalLength = kRRCaptureIPv4HeaderLength + payloadLength;
+            memset(header, 0, kRRCaptureIPv4HeaderLength);
+            header[0] = 0x45;
+            header[2] = (uint8_t) (totalLength >> 8);
+            header[3] = (uint8_t) totalLength;
+            header[8] = 64;
+            header[9] = IPPROTO_ICMP;
+            memcpy(&header[inbound ? 12 : 16], &peer->sin_addr, 4);
+            uint16_t checksum = RRInternetChecksum(header, kRRCaptureIPv4HeaderLength);
+            header[10] = (uint8_t) (checksum >> 8);
+            header[11] = (uint8_t) checksum;
+            headerLength = kRRCaptureIPv4HeaderLength;
+        }
+    } else if (family == AF_INET6) {
+        if (peerAddress.length < sizeof(struct sockaddr_in6)) {
+            return;
+        }
+        const struct sockaddr_in6 *peer = peerAddress.bytes;
+        memset(header, 0, kRRCaptureIPv6HeaderLength);
+        header[0] = 0x60;
+        header[4] = (uint8_t) (payloadLength >> 8);
+        header[5] = (uint8_t) payloadLength;
+        header[6] = IPPROTO_ICMPV6;
+        header[7] = 64;
+        memcpy(&header[inbound ? 8 : 24], &peer->sin6_addr, 16);
+        headerLength = kRRCaptureIPv6HeaderLength;
+        ipv6 = YES;
+    } else {
+        return;
+    }
+
+    NSUInteger copiedPayload = MIN(payloadLength, _snapLength - headerLength);
+    @synchronized(self) {
+        uint8_t *slot = _storage + _nextIndex * _snapLength;
+        memcpy(slot, header, headerLength);
+        memcpy(slot + headerLength, payload, copiedPayload);
+        _packets[_nextIndex] = (RRCapturedPacket) {
+            .timestampMicroseconds = timestamp,
+            .capturedLength = (uint32_t) (headerLength + copiedPayload),
+            .originalLength = (uint32_t) (headerLength + payloadLength),
+            .inbound = inbound,
+            .ipv6 = ipv6,
+        };
+        _nextIndex = (_nextIndex + 1) % _capacity;
+        _written += 1;
+    }
+}
+
+#pragma mark - pcapng Export
+
+- (NSData *)pcapngData {
+    NSMutableData *data = [NSMutableData data];
+
+    RRAppendUInt32(data, kRRPcapNGSectionHeaderBlock);
+    RRAppendUInt32(data, 28);
+    RRAppendUInt32(data, kRRPcapNGByteOrderMagic);
+    RRAppendUInt16(data, 1);
+    RRAppendUInt16(data, 0);
+    RRAppendUInt32(data, UINT32_MAX);
+    RRAppendUInt32(data, UINT32_MAX);
+    RRAppendUInt32(data, 28);
+
+    uint16_t linkTypes[2] = { kRRPcapNGLinkTypeIPv4, kRRPcapNGLinkTypeIPv6 };
+    for (NSUInteger i = 0; i < 2; i++) {
+        RRAppendUInt32(data, kRRPcapNGInterfaceDescriptionBlock);
+        RRAppendUInt32(data, 20);
+        RRAppendUInt16(data, linkTypes[i]);
+        RRAppendUInt16(data, 0);
+        RRAppendUInt32(data, (uint32_t) _snapLength);
+        RRAppendUInt32(data, 20);
+    }
+
+    static const uint8_t padding[4] = { 0 };
+    @synchronized(self) {
+        NSUInteger count = MIN(_written, _capacity);
+        NSUInteger first = (_written >= _capacity) ? _nextIndex : 0;
+        for (NSUInteger i = 0; i < count; i++) {
+            NSUInteger index = (first + i) % _capacity;
+            RRCapturedPacket packet = _packets[index];
+            uint32_t paddingLength = (4 - packet.capturedLength % 4) % 4;
+            uint32_t blockLength = 28 + packet.capturedLength + paddingLength + 8 + 4 + 4;
+
+            RRAppendUInt32(data, kRRPcapNGEnhancedPacketBlock);
+            RRAppendUInt32(data, blockLength);
+            RRAppendUInt32(data, packet.ipv6 ? 1 : 0);
+            RRAppendUInt32(data, (uint32_t) (packet.timestampMicroseconds >> 32));
+            RRAppendUInt32(data, (uint32_t) packet.timestampMicroseconds);
+            RRAppendUInt32(data, packet.capturedLength);
+            RRAppendUInt32(data, packet.originalLength);
+            [data appendBytes:_storage + index * _snapLength length:packet.capturedLength];
+            [data appendBytes:padding length:paddingLength];
+            RRAppendUInt16(data, kRRPcapNGFlagsOption);
+            RRAppendUInt16(data, 4);
+            RRAppendUInt32(data, packet.inbound ? kRRPcapNGInboundFlag : kRRPcapNGOutboundFlag);
+            RRAppendUInt32(data, 0);
+            RRAppendUInt32(data, blockLength);
+        }
+    }
+    return data;
+}
+
+@end
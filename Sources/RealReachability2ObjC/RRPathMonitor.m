@@ -15,6 +15,9 @@
 @property (nonatomic, assign) BOOL isMonitoring;
 @property (nonatomic, assign, readwrite) BOOL isSatisfied;
 @property (nonatomic, assign, readwrite) RRConnectionType connectionType;
+@property (nonatomic, assign, readwrite) BOOL supportsIPv4;
+@property (nonatomic, assign, readwrite) BOOL supportsIPv6;
+@property (nonatomic, copy, readwrite) NSString *networkFingerprint;
 
 @end
 
@@ -34,6 +37,9 @@
     if (self) {
         _isSatisfied = NO;
         _connectionType = RRConnectionTypeNone;
+        _supportsIPv4 = NO;
+        _supportsIPv6 = NO;
+        _networkFingerprint = @"";
         _isMonitoring = NO;
         _queue = dispatch_queue_create("com.realreachability2.pathmonitor", DISPATCH_QUEUE_SERIAL);
     }
@@ -58,10 +64,16 @@
         
         BOOL satisfied = (nw_path_get_status(path) == nw_path_status_satisfied);
         RRConnectionType type = [strongSelf connectionTypeFromPath:path];
+        BOOL hasIPv4 = nw_path_has_ipv4(path);
+        BOOL hasIPv6 = nw_path_has_ipv6(path);
+        NSString *fingerprint = [strongSelf fingerprintFromPath:path connectionType:type];
         
         dispatch_async(dispatch_get_main_queue(), ^{
             strongSelf.isSatisfied = satisfied;
             strongSelf.connectionType = type;
+            strongSelf.supportsIPv4 = hasIPv4;
+            strongSelf.supportsIPv6 = hasIPv6;
+            strongSelf.networkFingerprint = fingerprint;
             
             if (strongSelf.pathUpdateHandler) {
                 strongSelf.pathUpdateHandler(satisfied, type);
@@ -87,6 +99,31 @@
     self.isMonitoring = NO;
 }
 
+- (NSString *)fingerprintFromPath:(nw_path_t)path connectionType:(RRConnectionType)type {
+    NSMutableArray<NSString *> *interfaces = [NSMutableArray array];
+    nw_path_enumerate_interfaces(path, ^bool(nw_interface_t interface) {
+        [interfaces addObject:@(nw_interface_get_name(interface))];
+        return true;
+    });
+
+    NSMutableArray<NSString *> *gateways = [NSMutableArray array];
+    if (@available(iOS 13.0, macOS 10.15, *)) {
+        nw_path_enumerate_gateways(path, ^bool(nw_endpoint_t gateway) {
+            char *description = nw_endpoint_copy_address_string(gateway);
+            if (description) {
+                [gateways addObject:@(description)];
+                free(description);
+            }
+            return true;
+        });
+    }
+
+    return [NSString stringWithFormat:@"%ld|%@|%@",
+            (long)type,
+            [interfaces componentsJoinedByString:@","],
+            [gateways componentsJoinedByString:@","]];
+}
+
 - (RRConnectionType)connectionTypeFromPath:(nw_path_t)path {
     if (nw_path_uses_interface_type(path, nw_interface_type_wifi)) {
         return RRConnectionTypeWiFi;
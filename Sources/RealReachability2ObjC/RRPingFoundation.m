@@ -10,6 +10,7 @@
 //
 
 #import "RRPingFoundation.h"
+#import "RRPingFoundationPackets.h"
 
 #include <sys/socket.h>
 #include <netinet/in.h>
@@ -92,6 +93,8 @@ static uint16_t rr_in_cksum(const void *buffer, size_t bufferLen) {
 @property (nonatomic, strong, readwrite, nullable) CFHostRef host __attribute__ ((NSObject));
 @property (nonatomic, strong, readwrite, nullable) CFSocketRef socket __attribute__ ((NSObject));
 
++ (NSUInteger)icmpHeaderOffsetInIPv4Packet:(NSData *)packet;
+
 @end
 
 @implementation RRPingFoundation
@@ -227,6 +230,8 @@ static uint16_t rr_in_cksum(const void *buffer, size_t bufferLen) {
     // Handle the results of the send
     strongDelegate = self.delegate;
     if ((bytesSent > 0) && (((NSUInteger) bytesSent) == packet.length)) {
+        [self.packetCapture recordPacket:packet direction:RRPacketDirectionOutbound peerAddress:self.hostAddress];
+
         // Complete success. Tell the client.
         if ((strongDelegate != nil) && [strongDelegate respondsToSelector:@selector(pingFoundation:didSendPacket:sequenceNumber:)]) {
             [strongDelegate pingFoundation:self didSendPacket:packet sequenceNumber:self.nextSequenceNumber];
@@ -397,6 +402,13 @@ static uint16_t rr_in_cksum(const void *buffer, size_t bufferLen) {
         uint16_t sequenceNumber;
         
         packet = [NSMutableData dataWithBytes:buffer length:(NSUInteger) bytesRead];
+
+        RRPacketCapture *packetCapture = self.packetCapture;
+        if (packetCapture != nil) {
+            [packetCapture recordPacket:packet
+                              direction:RRPacketDirectionInbound
+                            peerAddress:[NSData dataWithBytes:&addr length:addrLen]];
+        }
         
         // Try to validate the packet
         if ([self validatePingResponsePacket:packet sequenceNumber:&sequenceNumber]) {
@@ -513,6 +525,14 @@ static void HostResolveCallback(CFHostRef theHost, CFHostInfoType typeInfo, cons
         } break;
     }
     
+    // Forbid fragmentation if asked to, for path MTU discovery
+    if ((err == 0) && self.dontFragment) {
+        err = [[self class] setDontFragmentOnSocket:fd family:addrPtr->sa_family];
+        if (err != 0) {
+            close(fd);
+        }
+    }
+    
     if (err != 0) {
         [self didFailWithError:[NSError errorWithDomain:NSPOSIXErrorDomain code:err userInfo:nil]];
     } else {
@@ -547,6 +567,40 @@ static void HostResolveCallback(CFHostRef theHost, CFHostInfoType typeInfo, cons
     }
 }
 
+/// Sets the don't-fragment option for the socket's address family.
+/// @returns 0 on success, otherwise an errno value.
++ (int)setDontFragmentOnSocket:(int)fd family:(sa_family_t)family {
+    int result;
+    int on = 1;
+    
+    switch (family) {
+        case AF_INET: {
+#if defined(IP_DONTFRAG)
+            result = setsockopt(fd, IPPROTO_IP, IP_DONTFRAG, &on, sizeof(on));
+#elif defined(IP_MTU_DISCOVER)
+            int discover = IP_PMTUDISC_DO;
+            result = setsockopt(fd, IPPROTO_IP, IP_MTU_DISCOVER, &discover, sizeof(discover));
+#else
+            errno = ENOPROTOOPT;
+            result = -1;
+#endif
+        } break;
+        case AF_INET6: {
+#if defined(IPV6_DONTFRAG)
+            result = setsockopt(fd, IPPROTO_IPV6, IPV6_DONTFRAG, &on, sizeof(on));
+#else
+            errno = ENOPROTOOPT;
+            result = -1;
+#endif
+        } break;
+        default: {
+            errno = EPROTONOSUPPORT;
+            result = -1;
+        } break;
+    }
+    return (result == 0) ? 0 : errno;
+}
+
 #pragma mark - Start/Stop
 
 - (void)start {
@@ -593,3 +647,83 @@ static void HostResolveCallback(CFHostRef theHost, CFHostInfoType typeInfo, cons
 }
 
 @end
+
+#pragma mark - Packets
+
+@implementation RRPingFoundation (Packets)
+
++ (nullable NSData *)echoRequestPacketWithFamily:(sa_family_t)family
+                                      identifier:(uint16_t)identifier
+                                  sequenceNumber:(uint16_t)sequenceNumber
+                                         payload:(NSData *)payload {
+    uint8_t type;
+    switch (family) {
+        case AF_INET: {
+            type = RRICMPv4TypeEchoRequest;
+        } break;
+        case AF_INET6: {
+            type = RRICMPv6TypeEchoRequest;
+        } break;
+        default: {
+            return nil;
+        }
+    }
+
+    NSMutableData *packet = [NSMutableData dataWithLength:sizeof(RRICMPHeader) + payload.length];
+    RRICMPHeader *icmpPtr = packet.mutableBytes;
+    icmpPtr->type = type;
+    icmpPtr->code = 0;
+    icmpPtr->checksum = 0;
+    icmpPtr->identifier     = OSSwapHostToBigInt16(identifier);
+    icmpPtr->sequenceNumber = OSSwapHostToBigInt16(sequenceNumber);
+    memcpy(&icmpPtr[1], payload.bytes, payload.length);
+
+    // The kernel computes ICMPv6 checksums
+    if (family == AF_INET) {
+        icmpPtr->checksum = rr_in_cksum(packet.bytes, packet.length);
+    }
+    return packet;
+}
+
++ (BOOL)parseEchoReplyPacket:(NSData *)packet
+                      family:(sa_family_t)family
+                  identifier:(uint16_t)identifier
+              sequenceNumber:(uint16_t *)sequenceNumberPtr {
+    const RRICMPHeader *icmpPtr;
+    switch (family) {
+        case AF_INET: {
+            NSUInteger icmpHeaderOffset = [self icmpHeaderOffsetInIPv4Packet:packet];
+            if (icmpHeaderOffset == NSNotFound) {
+                return NO;
+            }
+            icmpPtr = (const RRICMPHeader *) (((const uint8_t *) packet.bytes) + icmpHeaderOffset);
+            // Summing a message together with its checksum yields zero when it is intact
+            if (rr_in_cksum(icmpPtr, packet.length - icmpHeaderOffset) != 0) {
+                return NO;
+            }
+            if (icmpPtr->type != RRICMPv4TypeEchoReply) {
+                return NO;
+            }
+        } break;
+        case AF_INET6: {
+            if (packet.length < sizeof(RRICMPHeader)) {
+                return NO;
+            }
+            icmpPtr = packet.bytes;
+            if (icmpPtr->type != RRICMPv6TypeEchoReply) {
+                return NO;
+            }
+        } break;
+        default: {
+            return NO;
+        }
+    }
+
+    if ((icmpPtr->code != 0) || (OSSwapBigToHostInt16(icmpPtr->identifier) != identifier)) {
+        return NO;
+    }
+    *sequenceNumberPtr = OSSwapBigToHostInt16(icmpPtr->sequenceNumber);
+    return YES;
+}
+
+@end
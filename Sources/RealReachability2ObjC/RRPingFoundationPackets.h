@@ -0,0 +1,30 @@
+//
+//  RRPingFoundationPackets.h
+//  RealReachability2ObjC
+//
+//  Created by RealReachability2 on 2026.
+//
+
+#import "RRPingFoundation.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+/// ICMP echo packet building and parsing, for pingers that own their sockets
+@interface RRPingFoundation (Packets)
+
+/// Builds an echo request (checksummed for IPv4), or nil for an unsupported family
++ (nullable NSData *)echoRequestPacketWithFamily:(sa_family_t)family
+                                      identifier:(uint16_t)identifier
+                                  sequenceNumber:(uint16_t)sequenceNumber
+                                         payload:(NSData *)payload;
+
+/// Whether `packet`, as read from an ICMP datagram socket of `family`, is an intact echo reply
+/// carrying `identifier`; its sequence number is stored in `sequenceNumberPtr`
++ (BOOL)parseEchoReplyPacket:(NSData *)packet
+                      family:(sa_family_t)family
+                  identifier:(uint16_t)identifier
+              sequenceNumber:(uint16_t *)sequenceNumberPtr;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -13,7 +13,7 @@
 
 @interface RRPingHelper () <RRPingFoundationDelegate>
 
-@property (nonatomic, strong) NSMutableArray<RRPingCompletionBlock> *completionBlocks;
+@property (nonatomic, strong) NSMutableArray<RRPingDetailedCompletionBlock> *completionBlocks;
 @property (nonatomic, strong, nullable) RRPingFoundation *pingFoundation;
 @property (nonatomic, assign) BOOL isPinging;
 @property (nonatomic, assign) CFAbsoluteTime pingStartTime;
@@ -43,9 +43,22 @@
 #pragma mark - Public Methods
 
 - (void)pingWithBlock:(RRPingCompletionBlock)completion {
-    if (completion) {
+    if (!completion) {
+        [self pingWithDetailedBlock:nil];
+        return;
+    }
+    
+    [self pingWithDetailedBlock:^(BOOL isSuccess, NSTimeInterval latency, RRProbeFailureReason failureReason) {
+        completion(isSuccess, latency);
+    }];
+}
+
+- (id)pingWithDetailedBlock:(RRPingDetailedCompletionBlock)completion {
+    // The stored copy doubles as the caller's token for cancelPing:
+    RRPingDetailedCompletionBlock storedCompletion = [completion copy];
+    if (storedCompletion) {
         @synchronized(self) {
-            [self.completionBlocks addObject:[completion copy]];
+            [self.completionBlocks addObject:storedCompletion];
         }
     }
     
@@ -61,6 +74,29 @@
             [self startPing];
         }
     }
+    
+    return storedCompletion;
+}
+
+- (void)cancelPing:(id)token {
+    RRPingDetailedCompletionBlock completion = nil;
+    BOOL hasOtherCallers = NO;
+    @synchronized(self) {
+        NSUInteger index = [self.completionBlocks indexOfObjectIdenticalTo:token];
+        if (index == NSNotFound) {
+            return;
+        }
+        completion = self.completionBlocks[index];
+        [self.completionBlocks removeObjectAtIndex:index];
+        hasOtherCallers = self.completionBlocks.count > 0;
+    }
+    
+    if (!hasOtherCallers) {
+        [self clearPingFoundation];
+        [self invalidateTimer];
+        self.isPinging = NO;
+    }
+    completion(NO, 0, RRProbeFailureReasonCancelled);
 }
 
 - (void)cancel {
@@ -93,7 +129,7 @@
 - (void)startPing {
     if (!self.host || self.host.length == 0) {
         // No host set, fail immediately
-        [self endWithFlag:NO];
+        [self endWithFlag:NO failureReason:RRProbeFailureReasonInvalidConfiguration];
         return;
     }
     
@@ -104,6 +140,7 @@
     
     self.pingFoundation = [[RRPingFoundation alloc] initWithHostName:self.host];
     self.pingFoundation.delegate = self;
+    self.pingFoundation.packetCapture = self.packetCapture;
     [self.pingFoundation start];
     
     // Setup timeout
@@ -114,14 +151,17 @@
 }
 
 - (void)setHost:(NSString *)host {
+    if ([_host isEqualToString:host]) {
+        return;
+    }
     _host = [host copy];
     
-    // Clear any existing ping foundation when host changes
-    self.pingFoundation.delegate = nil;
-    self.pingFoundation = nil;
+    // A ping in flight targets the old host; its callers learn it was cancelled
+    [self endWithFlag:NO failureReason:RRProbeFailureReasonCancelled];
+    [self clearPingFoundation];
 }
 
-- (void)endWithFlag:(BOOL)isSuccess {
+- (void)endWithFlag:(BOOL)isSuccess failureReason:(RRProbeFailureReason)failureReason {
     [self invalidateTimer];
     
     if (!self.isPinging) {
@@ -136,8 +176,8 @@
     [self clearPingFoundation];
     
     @synchronized(self) {
-        for (RRPingCompletionBlock completion in self.completionBlocks) {
-            completion(isSuccess, latency);
+        for (RRPingDetailedCompletionBlock completion in self.completionBlocks) {
+            completion(isSuccess, latency, isSuccess ? RRProbeFailureReasonNone : failureReason);
         }
         [self.completionBlocks removeAllObjects];
     }
@@ -151,15 +191,15 @@
 }
 
 - (void)pingFoundation:(RRPingFoundation *)pinger didFailWithError:(NSError *)error {
-    [self endWithFlag:NO];
+    [self endWithFlag:NO failureReason:RRProbeFailureReasonFromError(error)];
 }
 
 - (void)pingFoundation:(RRPingFoundation *)pinger didFailToSendPacket:(NSData *)packet sequenceNumber:(uint16_t)sequenceNumber error:(NSError *)error {
-    [self endWithFlag:NO];
+    [self endWithFlag:NO failureReason:RRProbeFailureReasonFromError(error)];
 }
 
 - (void)pingFoundation:(RRPingFoundation *)pinger didReceivePingResponsePacket:(NSData *)packet sequenceNumber:(uint16_t)sequenceNumber {
-    [self endWithFlag:YES];
+    [self endWithFlag:YES failureReason:RRProbeFailureReasonNone];
 }
 
 #pragma mark - Timeout Handler
@@ -173,8 +213,8 @@
     [self clearPingFoundation];
     
     @synchronized(self) {
-        for (RRPingCompletionBlock completion in self.completionBlocks) {
-            completion(NO, self.timeout);
+        for (RRPingDetailedCompletionBlock completion in self.completionBlocks) {
+            completion(NO, self.timeout, RRProbeFailureReasonTimeout);
         }
         [self.completionBlocks removeAllObjects];
     }
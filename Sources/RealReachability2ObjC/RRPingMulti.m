@@ -0,0 +1,343 @@
+//
+//  RRPingMulti.m
+//  RealReachability2ObjC
+//
+//  Created by RealReachability2 on 2026.
+//
+
+#import "RRPingMulti.h"
+#import "RRPingFoundationPackets.h"
+
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netdb.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+
+/// Echo payload length, for a standard 64-byte ping
+static const NSUInteger kRRPingMultiPayloadLength = 56;
+
+/// Large enough for our replies with their IPv4 header; longer datagrams are someone else's
+static const size_t kRRPingMultiReadBufferSize = 2048;
+
+/// Monotonic seconds, immune to wall clock changes
+static NSTimeInterval RRPingMultiNow(void) {
+    return (NSTimeInterval) clock_gettime_nsec_np(CLOCK_UPTIME_RAW) / NSEC_PER_SEC;
+}
+
+#pragma mark - RRPingMultiEntry
+
+/// One ping in flight
+@interface RRPingMultiEntry : NSObject
+
+@property (nonatomic, assign) RRPingHandle handle;
+@property (nonatomic, assign) sa_family_t family;
+@property (nonatomic, assign) uint16_t sequenceNumber;
+@property (nonatomic, assign) NSTimeInterval startTime;
+@property (nonatomic, assign) NSTimeInterval deadline;
+@property (nonatomic, copy) RRPingDetailedCompletionBlock completion;
+
+@end
+
+@implementation RRPingMultiEntry
+@end
+
+#pragma mark - RRPingMulti
+
+@interface RRPingMulti ()
+
+@property (nonatomic, strong) NSMutableDictionary<NSNumber *, RRPingMultiEntry *> *entriesByHandle;
+@property (nonatomic, strong) NSMutableDictionary<NSNumber *, RRPingMultiEntry *> *entriesBySequence;
+@property (nonatomic, strong) NSData *payload;
+@property (nonatomic, assign) uint16_t identifier;
+@property (nonatomic, assign) uint16_t nextSequenceNumber;
+@property (nonatomic, assign) RRPingHandle lastHandle;
+@property (nonatomic, assign) int socket4;
+@property (nonatomic, assign) int socket6;
+
+@end
+
+@implementation RRPingMulti
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        _entriesByHandle = [NSMutableDictionary dictionary];
+        _entriesBySequence = [NSMutableDictionary dictionary];
+        _payload = [NSMutableData dataWithLength:kRRPingMultiPayloadLength];
+        _identifier = (uint16_t) arc4random();
+        _nextSequenceNumber = (uint16_t) arc4random();
+        _socket4 = -1;
+        _socket6 = -1;
+    }
+    return self;
+}
+
+- (void)dealloc {
+    if (_socket4 >= 0) {
+        close(_socket4);
+    }
+    if (_socket6 >= 0) {
+        close(_socket6);
+    }
+}
+
+- (NSUInteger)activePingCount {
+    @synchronized(self) {
+        return self.entriesByHandle.count;
+    }
+}
+
+- (NSIndexSet *)fileDescriptors {
+    NSMutableIndexSet *fileDescriptors = [NSMutableIndexSet indexSet];
+    @synchronized(self) {
+        if (self.socket4 >= 0) {
+            [fileDescriptors addIndex:(NSUInteger) self.socket4];
+        }
+        if (self.socket6 >= 0) {
+            [fileDescriptors addIndex:(NSUInteger) self.socket6];
+        }
+    }
+    return fileDescriptors;
+}
+
+- (NSTimeInterval)nextTimeoutInterval {
+    @synchronized(self) {
+        if (self.entriesByHandle.count == 0) {
+            return -1;
+        }
+        NSTimeInterval earliest = DBL_MAX;
+        for (RRPingMultiEntry *entry in self.entriesByHandle.objectEnumerator) {
+            earliest = MIN(earliest, entry.deadline);
+        }
+        return MAX(earliest - RRPingMultiNow(), 0);
+    }
+}
+
+#pragma mark - Pinging
+
+- (RRPingHandle)addPingToAddress:(NSString *)address
+                         timeout:(NSTimeInterval)timeout
+                      completion:(RRPingDetailedCompletionBlock)completion {
+    NSData *hostAddress = [[self class] numericAddressFromString:address];
+    if (!hostAddress) {
+        completion(NO, 0, RRProbeFailureReasonInvalidConfiguration);
+        return 0;
+    }
+    sa_family_t family = ((const struct sockaddr *) hostAddress.bytes)->sa_family;
+
+    RRPingMultiEntry *entry = nil;
+    NSData *packet = nil;
+    int fd = -1;
+    int err = 0;
+    @synchronized(self) {
+        fd = [self socketForFamily:family error:&err];
+        if (fd >= 0 && ![self claimSequenceNumberForFamily:family]) {
+            err = ENOBUFS;
+        }
+        if (err == 0) {
+            entry = [[RRPingMultiEntry alloc] init];
+            self.lastHandle += 1;
+            entry.handle = self.lastHandle;
+            entry.family = family;
+            entry.sequenceNumber = self.nextSequenceNumber;
+            entry.startTime = RRPingMultiNow();
+            entry.deadline = entry.startTime + MAX(timeout, 0);
+            entry.completion = completion;
+            self.nextSequenceNumber += 1;
+            packet = [RRPingFoundation echoRequestPacketWithFamily:family
+                                                        identifier:self.identifier
+                                                    sequenceNumber:entry.sequenceNumber
+                                                           payload:self.payload];
+            // Registered before sending, so a reply read on another thread finds it
+            self.entriesByHandle[@(entry.handle)] = entry;
+            self.entriesBySequence[[self sequenceKeyForFamily:family sequenceNumber:entry.sequenceNumber]] = entry;
+        }
+    }
+    if (!entry) {
+        completion(NO, 0, RRProbeFailureReasonFromError([NSError errorWithDomain:NSPOSIXErrorDomain code:err userInfo:nil]));
+        return 0;
+    }
+
+    ssize_t bytesSent = sendto(fd, packet.bytes, packet.length, 0, hostAddress.bytes, (socklen_t) hostAddress.length);
+    if (bytesSent < 0 || (NSUInteger) bytesSent != packet.length) {
+        err = (bytesSent < 0) ? errno : ENOBUFS;
+        if ([self removeEntryForHandle:entry.handle]) {
+            completion(NO, 0, RRProbeFailureReasonFromError([NSError errorWithDomain:NSPOSIXErrorDomain code:err userInfo:nil]));
+        }
+        return 0;
+    }
+    [self.packetCapture recordPacket:packet direction:RRPacketDirectionOutbound peerAddress:hostAddress];
+    return entry.handle;
+}
+
+- (void)cancelPing:(RRPingHandle)handle {
+    RRPingMultiEntry *entry = [self removeEntryForHandle:handle];
+    if (entry) {
+        entry.completion(NO, 0, RRProbeFailureReasonCancelled);
+    }
+}
+
+- (void)handleReadableFileDescriptor:(int)fileDescriptor {
+    sa_family_t family = AF_UNSPEC;
+    @synchronized(self) {
+        if (fileDescriptor >= 0 && fileDescriptor == self.socket4) {
+            family = AF_INET;
+        } else if (fileDescriptor >= 0 && fileDescriptor == self.socket6) {
+            family = AF_INET6;
+        }
+    }
+    if (family == AF_UNSPEC) {
+        return;
+    }
+
+    uint8_t buffer[kRRPingMultiReadBufferSize];
+    for (;;) {
+        struct sockaddr_storage addr;
+        socklen_t addrLen = sizeof(addr);
+        ssize_t bytesRead = recvfrom(fileDescriptor, buffer, sizeof(buffer), 0, (struct sockaddr *) &addr, &addrLen);
+        if (bytesRead < 0 && errno == EINTR) {
+            continue;
+        }
+        // EAGAIN: the socket is drained
+        if (bytesRead <= 0) {
+            break;
+        }
+
+        NSData *packet = [NSData dataWithBytes:buffer length:(NSUInteger) bytesRead];
+        RRPacketCapture *packetCapture = self.packetCapture;
+        if (packetCapture != nil) {
+            [packetCapture recordPacket:packet
+                              direction:RRPacketDirectionInbound
+                            peerAddress:[NSData dataWithBytes:&addr length:addrLen]];
+        }
+
+        uint16_t sequenceNumber = 0;
+        if (![RRPingFoundation parseEchoReplyPacket:packet family:family identifier:self.identifier sequenceNumber:&sequenceNumber]) {
+            continue;
+        }
+
+        RRPingMultiEntry *entry = nil;
+        @synchronized(self) {
+            entry = self.entriesBySequence[[self sequenceKeyForFamily:family sequenceNumber:sequenceNumber]];
+            if (entry) {
+                [self forgetEntry:entry];
+            }
+        }
+        if (entry) {
+            entry.completion(YES, RRPingMultiNow() - entry.startTime, RRProbeFailureReasonNone);
+        }
+    }
+}
+
+- (void)handleTimeout {
+    NSMutableArray<RRPingMultiEntry *> *expired = [NSMutableArray array];
+    NSTimeInterval now = RRPingMultiNow();
+    @synchronized(self) {
+        for (RRPingMultiEntry *entry in self.entriesByHandle.objectEnumerator) {
+            if (entry.deadline <= now) {
+                [expired addObject:entry];
+            }
+        }
+        for (RRPingMultiEntry *entry in expired) {
+            [self forgetEntry:entry];
+        }
+    }
+
+    for (RRPingMultiEntry *entry in expired) {
+        entry.completion(NO, 0, RRProbeFailureReasonTimeout);
+    }
+}
+
+#pragma mark - Bookkeeping
+
+- (nullable RRPingMultiEntry *)removeEntryForHandle:(RRPingHandle)handle {
+    @synchronized(self) {
+        RRPingMultiEntry *entry = self.entriesByHandle[@(handle)];
+        if (entry) {
+            [self forgetEntry:entry];
+        }
+        return entry;
+    }
+}
+
+/// Called inside @synchronized(self)
+- (void)forgetEntry:(RRPingMultiEntry *)entry {
+    [self.entriesByHandle removeObjectForKey:@(entry.handle)];
+    [self.entriesBySequence removeObjectForKey:[self sequenceKeyForFamily:entry.family sequenceNumber:entry.sequenceNumber]];
+}
+
+- (NSNumber *)sequenceKeyForFamily:(sa_family_t)family sequenceNumber:(uint16_t)sequenceNumber {
+    return @(((NSUInteger) family << 16) | sequenceNumber);
+}
+
+/// Moves `nextSequenceNumber` to one no active ping of `family` uses.
+/// Called inside @synchronized(self); returns NO when all 65536 are in flight.
+- (BOOL)claimSequenceNumberForFamily:(sa_family_t)family {
+    for (NSUInteger attempt = 0; attempt <= UINT16_MAX; attempt++) {
+        if (!self.entriesBySequence[[self sequenceKeyForFamily:family sequenceNumber:self.nextSequenceNumber]]) {
+            return YES;
+        }
+        self.nextSequenceNumber += 1;
+    }
+    return NO;
+}
+
+/// The shared non-blocking ICMP socket of `family`, opened on first use.
+/// Called inside @synchronized(self); returns -1 and sets `errPtr` on failure.
+- (int)socketForFamily:(sa_family_t)family error:(int *)errPtr {
+    int existing = (family == AF_INET) ? self.socket4 : self.socket6;
+    if (existing >= 0) {
+        return existing;
+    }
+
+    int fd = socket(family, SOCK_DGRAM, (family == AF_INET) ? IPPROTO_ICMP : IPPROTO_ICMPV6);
+    if (fd < 0) {
+        *errPtr = errno;
+        return -1;
+    }
+
+    int on = 1;
+    int flags = fcntl(fd, F_GETFL, 0);
+    if (flags < 0 || fcntl(fd, F_SETFL, flags | O_NONBLOCK) < 0 || fcntl(fd, F_SETFD, FD_CLOEXEC) < 0
+        || setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &on, sizeof(on)) < 0) {
+        *errPtr = errno;
+        close(fd);
+        return -1;
+    }
+
+    if (family == AF_INET) {
+        self.socket4 = fd;
+    } else {
+        self.socket6 = fd;
+    }
+    return fd;
+}
+
+/// Parses a numeric IPv4 or IPv6 address without touching DNS
++ (nullable NSData *)numericAddressFromString:(NSString *)string {
+    if (string.length == 0) {
+        return nil;
+    }
+
+    struct addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_flags = AI_NUMERICHOST;
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_DGRAM;
+
+    struct addrinfo *result = NULL;
+    if (getaddrinfo(string.UTF8String, NULL, &hints, &result) != 0 || result == NULL) {
+        return nil;
+    }
+    NSData *address = nil;
+    if (result->ai_family == AF_INET || result->ai_family == AF_INET6) {
+        address = [NSData dataWithBytes:result->ai_addr length:result->ai_addrlen];
+    }
+    freeaddrinfo(result);
+    return address;
+}
+
+@end
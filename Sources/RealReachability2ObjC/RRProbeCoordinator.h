@@ -0,0 +1,48 @@
+//
+//  RRProbeCoordinator.h
+//  RealReachability2ObjC
+//
+//  Created by RealReachability2 on 2026.
+//
+
+#import "RRProbeScheduler.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+/// Process-wide meeting point of every RRReachability, so several SDKs embedding the library do
+/// not each probe the same targets on their own timers.
+///
+/// Periodic timers are aligned on one clock: a timer first fires at the next multiple of its
+/// interval since the coordinator started, so engines with the same (or a multiple of the same)
+/// interval fire together. Identical probes (same key) run as one network operation on the engine
+/// that asked first, and every engine waiting on it gets the result.
+@interface RRProbeCoordinator : NSObject
+
+/// The coordinator shared by all engines in the process
++ (instancetype)sharedCoordinator;
+
+/// Probes requested by all engines
+@property (nonatomic, assign, readonly) NSUInteger requestedProbeCount;
+
+/// Probes that ran as their own network operation
+@property (nonatomic, assign, readonly) NSUInteger performedProbeCount;
+
+/// Engines with a running notifier
+@property (nonatomic, assign, readonly) NSUInteger registeredEngineCount;
+
+- (void)registerEngine:(id)engine;
+- (void)unregisterEngine:(id)engine;
+
+/// Seconds until the next tick on the shared clock for `interval`
+- (NSTimeInterval)delayUntilNextTickForInterval:(NSTimeInterval)interval;
+
+/// Runs `operation` for `key`, or shares the result of the identical probe in flight.
+/// The completion runs on the queue the operation completed on.
+- (void)performProbeForKey:(NSString *)key
+                  priority:(RRProbePriority)priority
+                 operation:(RRProbeOperationBlock)operation
+                completion:(void (^)(id _Nullable result))completion;
+
+@end
+
+NS_ASSUME_NONNULL_END
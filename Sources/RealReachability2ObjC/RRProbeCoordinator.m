@@ -0,0 +1,95 @@
+//
+//  RRProbeCoordinator.m
+//  RealReachability2ObjC
+//
+//  Created by RealReachability2 on 2026.
+//
+
+#import "RRProbeCoordinator.h"
+
+@interface RRProbeCoordinator ()
+
+@property (nonatomic, assign, readwrite) NSUInteger requestedProbeCount;
+@property (nonatomic, assign, readwrite) NSUInteger performedProbeCount;
+/// Deduplication only; each engine bounds its own concurrency
+@property (nonatomic, strong) RRProbeScheduler *probes;
+@property (nonatomic, strong) NSHashTable *engines;
+@property (nonatomic, assign) CFAbsoluteTime epoch;
+
+@end
+
+@implementation RRProbeCoordinator
+
++ (instancetype)sharedCoordinator {
+    static RRProbeCoordinator *coordinator = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        coordinator = [[RRProbeCoordinator alloc] init];
+    });
+    return coordinator;
+}
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        _probes = [[RRProbeScheduler alloc] initWithMaximumConcurrentOperations:NSUIntegerMax];
+        _engines = [NSHashTable weakObjectsHashTable];
+        _epoch = CFAbsoluteTimeGetCurrent();
+    }
+    return self;
+}
+
+- (NSUInteger)requestedProbeCount {
+    @synchronized(self) {
+        return _requestedProbeCount;
+    }
+}
+
+- (NSUInteger)performedProbeCount {
+    @synchronized(self) {
+        return _performedProbeCount;
+    }
+}
+
+- (NSUInteger)registeredEngineCount {
+    @synchronized(self) {
+        return self.engines.allObjects.count;
+    }
+}
+
+- (void)registerEngine:(id)engine {
+    @synchronized(self) {
+        [self.engines addObject:engine];
+    }
+}
+
+- (void)unregisterEngine:(id)engine {
+    @synchronized(self) {
+        [self.engines removeObject:engine];
+    }
+}
+
+- (NSTimeInterval)delayUntilNextTickForInterval:(NSTimeInterval)interval {
+    if (interval <= 0) {
+        return 0;
+    }
+    NSTimeInterval elapsed = MAX(CFAbsoluteTimeGetCurrent() - self.epoch, 0.0);
+    return (floor(elapsed / interval) + 1) * interval - elapsed;
+}
+
+- (void)performProbeForKey:(NSString *)key
+                  priority:(RRProbePriority)priority
+                 operation:(RRProbeOperationBlock)operation
+                completion:(void (^)(id _Nullable))completion {
+    @synchronized(self) {
+        _requestedProbeCount += 1;
+    }
+    [self.probes scheduleOperationForKey:key priority:priority operation:^RRProbeCancelBlock(RRProbeOperationCompletion done) {
+        @synchronized(self) {
+            self->_performedProbeCount += 1;
+        }
+        return operation(done);
+    } completion:completion];
+}
+
+@end
@@ -0,0 +1,81 @@
+//
+//  RRProbeFailureReason.m
+//  RealReachability2ObjC
+//
+//  Created by RealReachability2 on 2026.
+//
+
+#import "RRProbeFailureReason.h"
+#import <CFNetwork/CFNetwork.h>
+
+#include <errno.h>
+
+BOOL RRProbeFailureReasonIsTransient(RRProbeFailureReason reason) {
+    return reason == RRProbeFailureReasonConnectionReset;
+}
+
+BOOL RRProbeFailureReasonWarrantsBackoff(RRProbeFailureReason reason) {
+    return reason == RRProbeFailureReasonDNS || reason == RRProbeFailureReasonInvalidConfiguration;
+}
+
+RRProbeFailureReason RRProbeFailureReasonFromError(NSError *error) {
+    if (!error) {
+        return RRProbeFailureReasonUnknown;
+    }
+
+    if ([error.domain isEqualToString:NSURLErrorDomain]) {
+        switch (error.code) {
+            case NSURLErrorCannotFindHost:
+            case NSURLErrorDNSLookupFailed:
+                return RRProbeFailureReasonDNS;
+            case NSURLErrorCannotConnectToHost:
+                return RRProbeFailureReasonConnectionRefused;
+            case NSURLErrorNetworkConnectionLost:
+                return RRProbeFailureReasonConnectionReset;
+            case NSURLErrorSecureConnectionFailed:
+            case NSURLErrorServerCertificateHasBadDate:
+            case NSURLErrorServerCertificateUntrusted:
+            case NSURLErrorServerCertificateHasUnknownRoot:
+            case NSURLErrorServerCertificateNotYetValid:
+            case NSURLErrorClientCertificateRejected:
+            case NSURLErrorClientCertificateRequired:
+                return RRProbeFailureReasonTLS;
+            case NSURLErrorTimedOut:
+                return RRProbeFailureReasonTimeout;
+            case NSURLErrorNotConnectedToInternet:
+            case NSURLErrorInternationalRoamingOff:
+            case NSURLErrorDataNotAllowed:
+                return RRProbeFailureReasonNoRoute;
+            case NSURLErrorCancelled:
+                return RRProbeFailureReasonCancelled;
+            default:
+                return RRProbeFailureReasonUnknown;
+        }
+    }
+
+    if ([error.domain isEqualToString:(NSString *)kCFErrorDomainCFNetwork]) {
+        // CFHost resolution failures from the ICMP engine
+        return RRProbeFailureReasonDNS;
+    }
+
+    if ([error.domain isEqualToString:NSPOSIXErrorDomain]) {
+        switch (error.code) {
+            case ENETUNREACH:
+            case EHOSTUNREACH:
+            case EADDRNOTAVAIL:
+            case ENETDOWN:
+            case EHOSTDOWN:
+                return RRProbeFailureReasonNoRoute;
+            case ECONNREFUSED:
+                return RRProbeFailureReasonConnectionRefused;
+            case ECONNRESET:
+                return RRProbeFailureReasonConnectionReset;
+            case ETIMEDOUT:
+                return RRProbeFailureReasonTimeout;
+            default:
+                return RRProbeFailureReasonUnknown;
+        }
+    }
+
+    return RRProbeFailureReasonUnknown;
+}
@@ -0,0 +1,231 @@
+//
+//  RRProbeScheduler.m
+//  RealReachability2ObjC
+//
+//  Created by RealReachability2 on 2026.
+//
+
+#import "RRProbeScheduler.h"
+
+/// Highest class that can be preempted
+static const RRProbePriority kRRPreemptiblePriority = RRProbePriorityPeriodic;
+
+#pragma mark - RRProbeSchedulerEntry
+
+/// One admitted run and the callers waiting on it
+@interface RRProbeSchedulerEntry : NSObject
+
+@property (nonatomic, copy, readonly) id<NSCopying> key;
+@property (nonatomic, assign, readonly) NSUInteger sequence;
+@property (nonatomic, copy, readonly) RRProbeOperationBlock operation;
+@property (nonatomic, assign) RRProbePriority priority;
+@property (nonatomic, strong) NSMutableArray<void (^)(id _Nullable)> *completions;
+@property (nonatomic, copy, nullable) RRProbeCancelBlock cancelBlock;
+@property (nonatomic, assign) NSUInteger generation;
+
+@end
+
+@implementation RRProbeSchedulerEntry
+
+- (instancetype)initWithKey:(id<NSCopying>)key
+                   sequence:(NSUInteger)sequence
+                   priority:(RRProbePriority)priority
+                  operation:(RRProbeOperationBlock)operation {
+    self = [super init];
+    if (self) {
+        _key = [(id)key copy];
+        _sequence = sequence;
+        _priority = priority;
+        _operation = [operation copy];
+        _completions = [NSMutableArray array];
+    }
+    return self;
+}
+
+@end
+
+#pragma mark - RRProbeScheduler
+
+@interface RRProbeScheduler ()
+
+@property (nonatomic, assign, readwrite) NSUInteger startedOperationCount;
+@property (nonatomic, assign, readwrite) NSUInteger piggybackedRequestCount;
+@property (nonatomic, assign, readwrite) NSUInteger preemptedOperationCount;
+@property (nonatomic, strong) NSMutableArray<RRProbeSchedulerEntry *> *running;
+@property (nonatomic, strong) NSMutableArray<RRProbeSchedulerEntry *> *queued;
+@property (nonatomic, assign) NSUInteger nextSequence;
+
+@end
+
+@implementation RRProbeScheduler
+
+- (instancetype)initWithMaximumConcurrentOperations:(NSUInteger)maximumConcurrentOperations {
+    self = [super init];
+    if (self) {
+        _maximumConcurrentOperations = MAX(maximumConcurrentOperations, (NSUInteger) 1);
+        _running = [NSMutableArray array];
+        _queued = [NSMutableArray array];
+    }
+    return self;
+}
+
+- (instancetype)init {
+    return [self initWithMaximumConcurrentOperations:2];
+}
+
+- (NSUInteger)startedOperationCount {
+    @synchronized(self) {
+        return _startedOperationCount;
+    }
+}
+
+- (NSUInteger)piggybackedRequestCount {
+    @synchronized(self) {
+        return _piggybackedRequestCount;
+    }
+}
+
+- (NSUInteger)preemptedOperationCount {
+    @synchronized(self) {
+        return _preemptedOperationCount;
+    }
+}
+
+#pragma mark - Admission
+
+- (void)scheduleOperationForKey:(id<NSCopying>)key
+                       priority:(RRProbePriority)priority
+                      operation:(RRProbeOperationBlock)operation
+                     completion:(void (^)(id _Nullable))completion {
+    NSArray<dispatch_block_t> *actions = nil;
+    @synchronized(self) {
+        RRProbeSchedulerEntry *entry = [self entryForKey:key inEntries:self.running]
+            ?: [self entryForKey:key inEntries:self.queued];
+        if (entry) {
+            entry.priority = MAX(entry.priority, priority);
+            _piggybackedRequestCount += 1;
+        } else {
+            self.nextSequence += 1;
+            entry = [[RRProbeSchedulerEntry alloc] initWithKey:key
+                                                      sequence:self.nextSequence
+                                                      priority:priority
+                                                     operation:operation];
+            [self.queued addObject:entry];
+        }
+        [entry.completions addObject:[completion copy]];
+        actions = [self startQueuedWork];
+    }
+
+    for (dispatch_block_t action in actions) {
+        action();
+    }
+}
+
+- (nullable RRProbeSchedulerEntry *)entryForKey:(id<NSCopying>)key inEntries:(NSArray<RRProbeSchedulerEntry *> *)entries {
+    for (RRProbeSchedulerEntry *entry in entries) {
+        if ([(id)entry.key isEqual:key]) {
+            return entry;
+        }
+    }
+    return nil;
+}
+
+/// Starts queued work while slots are free, then preempts lower classes for the rest.
+/// Called inside @synchronized(self); returns the launches and cancellations to run outside it.
+- (NSArray<dispatch_block_t> *)startQueuedWork {
+    NSMutableArray<dispatch_block_t> *actions = [NSMutableArray array];
+    [self sortQueue];
+
+    while (self.queued.count > 0) {
+        RRProbeSchedulerEntry *next = self.queued.firstObject;
+
+        if (self.running.count >= self.maximumConcurrentOperations) {
+            RRProbeSchedulerEntry *victim = nil;
+            for (RRProbeSchedulerEntry *candidate in self.running) {
+                if (candidate.cancelBlock == nil || candidate.priority > kRRPreemptiblePriority || candidate.priority >= next.priority) {
+                    continue;
+                }
+                if (!victim || candidate.priority < victim.priority
+                    || (candidate.priority == victim.priority && candidate.sequence > victim.sequence)) {
+                    victim = candidate;
+                }
+            }
+            if (!victim) {
+                break;
+            }
+
+            [self.running removeObjectIdenticalTo:victim];
+            [actions addObject:victim.cancelBlock];
+            victim.cancelBlock = nil;
+            victim.generation += 1;
+            _preemptedOperationCount += 1;
+            [self.queued addObject:victim];
+            [self sortQueue];
+            continue;
+        }
+
+        [self.queued removeObjectAtIndex:0];
+        [self.running addObject:next];
+        _startedOperationCount += 1;
+        next.generation += 1;
+        NSUInteger generation = next.generation;
+        [actions addObject:^{
+            [self launchEntry:next generation:generation];
+        }];
+    }
+    return actions;
+}
+
+/// Highest class first, first come first served within a class
+- (void)sortQueue {
+    [self.queued sortUsingComparator:^NSComparisonResult(RRProbeSchedulerEntry *lhs, RRProbeSchedulerEntry *rhs) {
+        if (lhs.priority != rhs.priority) {
+            return lhs.priority > rhs.priority ? NSOrderedAscending : NSOrderedDescending;
+        }
+        if (lhs.sequence != rhs.sequence) {
+            return lhs.sequence < rhs.sequence ? NSOrderedAscending : NSOrderedDescending;
+        }
+        return NSOrderedSame;
+    }];
+}
+
+#pragma mark - Running
+
+- (void)launchEntry:(RRProbeSchedulerEntry *)entry generation:(NSUInteger)generation {
+    __weak typeof(self) weakSelf = self;
+    RRProbeCancelBlock cancelBlock = entry.operation(^(id result) {
+        [weakSelf finishEntry:entry generation:generation result:result];
+    });
+
+    // An operation that completed synchronously has already left the running set.
+    @synchronized(self) {
+        if (cancelBlock && entry.generation == generation && [self.running indexOfObjectIdenticalTo:entry] != NSNotFound) {
+            entry.cancelBlock = cancelBlock;
+        }
+    }
+}
+
+- (void)finishEntry:(RRProbeSchedulerEntry *)entry generation:(NSUInteger)generation result:(id)result {
+    NSArray<void (^)(id _Nullable)> *completions = nil;
+    NSArray<dispatch_block_t> *actions = nil;
+    @synchronized(self) {
+        // A preempted run reports too; its entry was requeued under a new generation.
+        if (entry.generation != generation || [self.running indexOfObjectIdenticalTo:entry] == NSNotFound) {
+            return;
+        }
+        [self.running removeObjectIdenticalTo:entry];
+        completions = [entry.completions copy];
+        [entry.completions removeAllObjects];
+        entry.cancelBlock = nil;
+        actions = [self startQueuedWork];
+    }
+
+    for (dispatch_block_t action in actions) {
+        action();
+    }
+    for (void (^completion)(id _Nullable) in completions) {
+        completion(result);
+    }
+}
+
+@end
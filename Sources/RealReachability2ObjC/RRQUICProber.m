@@ -0,0 +1,314 @@
+//
+//  RRQUICProber.m
+//  RealReachability2ObjC
+//
+//  Created by RealReachability2 on 2026.
+//
+
+#import "RRQUICProber.h"
+#import <Network/Network.h>
+
+/// Servers ignore Initial packets in smaller datagrams, so probes are padded to this size
+static const NSUInteger kRRQUICMinimumInitialDatagramSize = 1200;
+/// Length of the connection IDs the probe chooses
+static const NSUInteger kRRQUICConnectionIDLength = 8;
+
+static uint32_t RRQUICReservedVersion(void) {
+    return (arc4random() & 0xF0F0F0F0) | 0x0A0A0A0A;
+}
+
+static NSData *RRQUICRandomConnectionID(void) {
+    uint8_t bytes[kRRQUICConnectionIDLength];
+    arc4random_buf(bytes, sizeof(bytes));
+    return [NSData dataWithBytes:bytes length:sizeof(bytes)];
+}
+
+static RRProbeFailureReason RRProbeFailureReasonFromNWError(nw_error_t _Nullable error) {
+    if (!error) {
+        return RRProbeFailureReasonUnknown;
+    }
+
+    switch (nw_error_get_error_domain(error)) {
+        case nw_error_domain_posix:
+            // An ICMP port unreachable surfaces as ECONNREFUSED.
+            return RRProbeFailureReasonFromError([NSError errorWithDomain:NSPOSIXErrorDomain
+                                                                     code:nw_error_get_error_code(error)
+                                                                 userInfo:nil]);
+        case nw_error_domain_dns:
+            return RRProbeFailureReasonDNS;
+        case nw_error_domain_tls:
+            return RRProbeFailureReasonTLS;
+        default:
+            return RRProbeFailureReasonUnknown;
+    }
+}
+
+#pragma mark - RRQUICProbeOperation
+
+/// One probe exchange over its own UDP flow
+@interface RRQUICProbeOperation : NSObject
+
+@property (nonatomic, strong, nullable) nw_connection_t connection;
+@property (nonatomic, assign) uint32_t version;
+@property (nonatomic, copy) NSData *destinationConnectionID;
+@property (nonatomic, copy) NSData *sourceConnectionID;
+@property (nonatomic, assign) CFAbsoluteTime startTime;
+@property (nonatomic, copy, nullable) RRQUICProbeCompletionBlock completion;
+
+- (void)sendProbeOnQueue:(dispatch_queue_t)queue;
+- (void)finishWithSuccess:(BOOL)isSuccess failureReason:(RRProbeFailureReason)failureReason;
+
+@end
+
+@implementation RRQUICProbeOperation
+
+- (void)sendProbeOnQueue:(dispatch_queue_t)queue {
+    nw_connection_t connection;
+    @synchronized(self) {
+        connection = self.connection;
+    }
+    if (!connection) {
+        return;
+    }
+
+    NSData *packet = [RRQUICProber probePacketWithVersion:self.version
+                                  destinationConnectionID:self.destinationConnectionID
+                                       sourceConnectionID:self.sourceConnectionID];
+    dispatch_data_t content = dispatch_data_create(packet.bytes, packet.length, queue, DISPATCH_DATA_DESTRUCTOR_DEFAULT);
+
+    nw_connection_send(connection, content, NW_CONNECTION_DEFAULT_MESSAGE_CONTEXT, true, ^(nw_error_t _Nullable error) {
+        if (error) {
+            [self finishWithSuccess:NO failureReason:RRProbeFailureReasonFromNWError(error)];
+        }
+    });
+
+    nw_connection_receive_message(connection, ^(dispatch_data_t _Nullable reply, nw_content_context_t _Nullable context, bool isComplete, nw_error_t _Nullable error) {
+        if (error) {
+            [self finishWithSuccess:NO failureReason:RRProbeFailureReasonFromNWError(error)];
+            return;
+        }
+
+        BOOL isVersionNegotiation = reply && [RRQUICProber isVersionNegotiationPacket:(NSData *)reply
+                                                                        probedVersion:self.version
+                                                              destinationConnectionID:self.destinationConnectionID
+                                                                   sourceConnectionID:self.sourceConnectionID];
+        [self finishWithSuccess:isVersionNegotiation
+                  failureReason:isVersionNegotiation ? RRProbeFailureReasonNone : RRProbeFailureReasonHTTPMismatch];
+    });
+}
+
+- (void)finishWithSuccess:(BOOL)isSuccess failureReason:(RRProbeFailureReason)failureReason {
+    RRQUICProbeCompletionBlock completion;
+    nw_connection_t connection;
+    @synchronized(self) {
+        completion = self.completion;
+        connection = self.connection;
+        self.completion = nil;
+        self.connection = nil;
+    }
+    if (!completion) {
+        return;
+    }
+
+    if (connection) {
+        nw_connection_cancel(connection);
+    }
+
+    NSTimeInterval latency = isSuccess ? (CFAbsoluteTimeGetCurrent() - self.startTime) : 0;
+    completion(isSuccess, latency, isSuccess ? RRProbeFailureReasonNone : failureReason);
+}
+
+@end
+
+#pragma mark - RRQUICProber
+
+@interface RRQUICProber ()
+
+@property (nonatomic, strong) dispatch_queue_t queue;
+@property (nonatomic, strong) NSMutableSet<RRQUICProbeOperation *> *operations;
+
+@end
+
+@implementation RRQUICProber
+
+#pragma mark - Lifecycle
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        _host = @"www.gstatic.com";
+        _port = 443;
+        _timeout = 5.0;
+        _queue = dispatch_queue_create("com.realreachability2.quicprobe", DISPATCH_QUEUE_SERIAL);
+        _operations = [NSMutableSet set];
+    }
+    return self;
+}
+
+- (void)dealloc {
+    [self cancel];
+}
+
+#pragma mark - Public Methods
+
+- (id)probeWithCompletion:(RRQUICProbeCompletionBlock)completion {
+    if (self.host.length == 0 || self.port == 0) {
+        completion(NO, 0, RRProbeFailureReasonInvalidConfiguration);
+        return nil;
+    }
+
+    RRQUICProbeOperation *operation = [[RRQUICProbeOperation alloc] init];
+    operation.version = RRQUICReservedVersion();
+    operation.destinationConnectionID = RRQUICRandomConnectionID();
+    operation.sourceConnectionID = RRQUICRandomConnectionID();
+    operation.startTime = CFAbsoluteTimeGetCurrent();
+
+    __weak typeof(self) weakSelf = self;
+    __weak RRQUICProbeOperation *weakOperation = operation;
+    operation.completion = ^(BOOL isSuccess, NSTimeInterval latency, RRProbeFailureReason failureReason) {
+        __strong typeof(weakSelf) strongSelf = weakSelf;
+        RRQUICProbeOperation *finishedOperation = weakOperation;
+        if (strongSelf && finishedOperation) {
+            @synchronized(strongSelf) {
+                [strongSelf.operations removeObject:finishedOperation];
+            }
+        }
+        completion(isSuccess, latency, failureReason);
+    };
+
+    char port[6];
+    snprintf(port, sizeof(port), "%u", self.port);
+    nw_endpoint_t endpoint = nw_endpoint_create_host(self.host.UTF8String, port);
+    nw_parameters_t parameters = nw_parameters_create_secure_udp(NW_PARAMETERS_DISABLE_PROTOCOL, NW_PARAMETERS_DEFAULT_CONFIGURATION);
+    nw_connection_t connection = nw_connection_create(endpoint, parameters);
+    operation.connection = connection;
+
+    @synchronized(self) {
+        [self.operations addObject:operation];
+    }
+
+    dispatch_queue_t queue = self.queue;
+    nw_connection_set_queue(connection, queue);
+    nw_connection_set_state_changed_handler(connection, ^(nw_connection_state_t state, nw_error_t _Nullable error) {
+        switch (state) {
+            case nw_connection_state_ready:
+                [operation sendProbeOnQueue:queue];
+                break;
+            case nw_connection_state_waiting:
+            case nw_connection_state_failed:
+                [operation finishWithSuccess:NO failureReason:RRProbeFailureReasonFromNWError(error)];
+                break;
+            default:
+                break;
+        }
+    });
+    nw_connection_start(connection);
+
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(self.timeout * NSEC_PER_SEC)), queue, ^{
+        [operation finishWithSuccess:NO failureReason:RRProbeFailureReasonTimeout];
+    });
+
+    return operation;
+}
+
+- (void)cancelProbe:(id)probe {
+    RRQUICProbeOperation *operation;
+    @synchronized(self) {
+        operation = [self.operations member:probe];
+    }
+
+    // Finishing removes the operation from the set through its completion.
+    [operation finishWithSuccess:NO failureReason:RRProbeFailureReasonCancelled];
+}
+
+- (void)cancel {
+    NSArray<RRQUICProbeOperation *> *operations;
+    @synchronized(self) {
+        operations = self.operations.allObjects;
+        [self.operations removeAllObjects];
+    }
+
+    for (RRQUICProbeOperation *operation in operations) {
+        [operation finishWithSuccess:NO failureReason:RRProbeFailureReasonCancelled];
+    }
+}
+
+#pragma mark - Packets
+
++ (NSData *)probePacketWithVersion:(uint32_t)version
+           destinationConnectionID:(NSData *)destinationConnectionID
+                sourceConnectionID:(NSData *)sourceConnectionID {
+    NSMutableData *packet = [NSMutableData dataWithCapacity:kRRQUICMinimumInitialDatagramSize];
+
+    // Long header, fixed bit set, Initial packet type
+    uint8_t firstByte = 0xC0;
+    [packet appendBytes:&firstByte length:1];
+
+    uint32_t networkVersion = CFSwapInt32HostToBig(version);
+    [packet appendBytes:&networkVersion length:sizeof(networkVersion)];
+
+    uint8_t destinationLength = (uint8_t)destinationConnectionID.length;
+    [packet appendBytes:&destinationLength length:1];
+    [packet appendData:destinationConnectionID];
+
+    uint8_t sourceLength = (uint8_t)sourceConnectionID.length;
+    [packet appendBytes:&sourceLength length:1];
+    [packet appendData:sourceConnectionID];
+
+    if (packet.length < kRRQUICMinimumInitialDatagramSize) {
+        [packet increaseLengthBy:kRRQUICMinimumInitialDatagramSize - packet.length];
+    }
+    return [packet copy];
+}
+
++ (BOOL)isVersionNegotiationPacket:(NSData *)packet
+                     probedVersion:(uint32_t)version
+           destinationConnectionID:(NSData *)destinationConnectionID
+                sourceConnectionID:(NSData *)sourceConnectionID {
+    const uint8_t *bytes = packet.bytes;
+    NSUInteger length = packet.length;
+
+    // Long header bit, then a zero version
+    if (length < 6 || (bytes[0] & 0x80) == 0) {
+        return NO;
+    }
+    if (bytes[1] != 0 || bytes[2] != 0 || bytes[3] != 0 || bytes[4] != 0) {
+        return NO;
+    }
+
+    // The reply is addressed to our source connection ID and comes from our destination one.
+    NSUInteger offset = 5;
+    NSUInteger replyDestinationLength = bytes[offset++];
+    if (offset + replyDestinationLength >= length) {
+        return NO;
+    }
+    NSData *replyDestination = [packet subdataWithRange:NSMakeRange(offset, replyDestinationLength)];
+    offset += replyDestinationLength;
+
+    NSUInteger replySourceLength = bytes[offset++];
+    if (offset + replySourceLength > length) {
+        return NO;
+    }
+    NSData *replySource = [packet subdataWithRange:NSMakeRange(offset, replySourceLength)];
+    offset += replySourceLength;
+
+    if (![replyDestination isEqualToData:sourceConnectionID] || ![replySource isEqualToData:destinationConnectionID]) {
+        return NO;
+    }
+
+    NSUInteger versionsLength = length - offset;
+    if (versionsLength == 0 || versionsLength % 4 != 0) {
+        return NO;
+    }
+
+    for (; offset < length; offset += 4) {
+        uint32_t offered = ((uint32_t)bytes[offset] << 24) | ((uint32_t)bytes[offset + 1] << 16) |
+                           ((uint32_t)bytes[offset + 2] << 8) | (uint32_t)bytes[offset + 3];
+        if (offered == version) {
+            return NO;
+        }
+    }
+    return YES;
+}
+
+@end
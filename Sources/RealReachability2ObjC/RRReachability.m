@@ -8,14 +8,266 @@
 #import "RRReachability.h"
 #import "RRPathMonitor.h"
 #import "RRPingHelper.h"
+#import "RRNAT64Resolver.h"
+#import "RRQUICProber.h"
+#import "RRMTUProber.h"
+#import "RRProbeCoordinator.h"
+#import "RRLogMacros.h"
 #import <Network/Network.h>
 
 NSNotificationName const kRRReachabilityChangedNotification = @"kRRReachabilityChangedNotification";
 NSString * const kRRReachabilityStatusKey = @"kRRReachabilityStatusKey";
 NSString * const kRRConnectionTypeKey = @"kRRConnectionTypeKey";
 NSString * const kRRSecondaryReachableKey = @"kRRSecondaryReachableKey";
+NSString * const kRRProbeFailureReasonKey = @"kRRProbeFailureReasonKey";
 static const NSTimeInterval kRRPeriodicProbeInterval = 5.0;
+/// Upper bound for the periodic interval multiplier applied after persistent failures
+static const NSUInteger kRRMaxPeriodicBackoffFactor = 8;
+/// Slack added to the watchdog deadline on top of the probers' own timeouts
+static const NSTimeInterval kRRWatchdogGracePeriod = 2.0;
 static NSString * const kRRDefaultHTTPProbeURLString = @"https://www.gstatic.com/generate_204";
+static NSString * const kRRDefaultQUICHost = @"www.gstatic.com";
+static const uint16_t kRRDefaultQUICPort = 443;
+
+/// A cancelled probe was shared with an engine that suspended; engines still monitoring ask again.
+static BOOL RRProbeFailureReasonWarrantsRetry(RRProbeFailureReason reason) {
+    return RRProbeFailureReasonIsTransient(reason) || reason == RRProbeFailureReasonCancelled;
+}
+
+static BOOL RRProbeModeSupportsHTTP(RRProbeMode probeMode) {
+    return probeMode == RRProbeModeParallel || probeMode == RRProbeModeHTTPOnly;
+}
+
+/// Whether two states differ in anything that triggers a change delivery
+static BOOL RRReachabilityStateChanged(RRReachabilityState lhs, RRReachabilityState rhs) {
+    return lhs.status != rhs.status
+        || lhs.connectionType != rhs.connectionType
+        || lhs.secondaryReachable != rhs.secondaryReachable;
+}
+
+#pragma mark - RRProbeProfile
+
+@implementation RRProbeProfile
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        _probeMode = RRProbeModeParallel;
+        _timeout = 5.0;
+        _periodicProbeInterval = kRRPeriodicProbeInterval;
+        _httpProbeURL = [NSURL URLWithString:kRRDefaultHTTPProbeURLString];
+        _icmpHost = @"8.8.8.8";
+        _quicHost = kRRDefaultQUICHost;
+        _quicPort = kRRDefaultQUICPort;
+        _includesQUICInParallel = NO;
+    }
+    return self;
+}
+
+- (id)copyWithZone:(NSZone *)zone {
+    RRProbeProfile *copy = [[[self class] allocWithZone:zone] init];
+    copy.probeMode = self.probeMode;
+    copy.timeout = self.timeout;
+    copy.periodicProbeInterval = self.periodicProbeInterval;
+    copy.httpProbeURL = self.httpProbeURL;
+    copy.icmpHost = self.icmpHost;
+    copy.quicHost = self.quicHost;
+    copy.quicPort = self.quicPort;
+    copy.includesQUICInParallel = self.includesQUICInParallel;
+    return copy;
+}
+
+@end
+
+#pragma mark - RRProbeOutcome
+
+/// Result of one reachability probe, as passed through the probe scheduler
+@interface RRProbeOutcome : NSObject
+
+@property (nonatomic, assign, readonly) BOOL reachable;
+@property (nonatomic, assign, readonly) BOOL secondaryReachable;
+@property (nonatomic, assign, readonly) RRProbeFailureReason failureReason;
+
+- (instancetype)initWithReachable:(BOOL)reachable secondaryReachable:(BOOL)secondaryReachable failureReason:(RRProbeFailureReason)failureReason;
+
+@end
+
+@implementation RRProbeOutcome
+
+- (instancetype)initWithReachable:(BOOL)reachable secondaryReachable:(BOOL)secondaryReachable failureReason:(RRProbeFailureReason)failureReason {
+    self = [super init];
+    if (self) {
+        _reachable = reachable;
+        _secondaryReachable = secondaryReachable;
+        _failureReason = failureReason;
+    }
+    return self;
+}
+
+@end
+
+#pragma mark - RRProbeResources
+
+/// The ping, UDP flow and HTTP tasks one probe has started. The probers are shared by
+/// concurrent probes, so the watchdog releases a hung probe through this rather than
+/// cancelling the probers outright.
+@interface RRProbeResources : NSObject
+
+/// Registers how to release one resource; runs it at once if the probe was already cancelled
+- (void)addCancelHandler:(dispatch_block_t)handler;
+
+/// Releases every registered resource; later calls do nothing
+- (void)cancel;
+
+@end
+
+@implementation RRProbeResources {
+    NSMutableArray<dispatch_block_t> *_cancelHandlers;
+    BOOL _cancelled;
+}
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        _cancelHandlers = [NSMutableArray array];
+    }
+    return self;
+}
+
+- (void)addCancelHandler:(dispatch_block_t)handler {
+    @synchronized(self) {
+        if (!_cancelled) {
+            [_cancelHandlers addObject:[handler copy]];
+            return;
+        }
+    }
+    handler();
+}
+
+- (void)cancel {
+    NSArray<dispatch_block_t> *handlers;
+    @synchronized(self) {
+        if (_cancelled) {
+            return;
+        }
+        _cancelled = YES;
+        handlers = [_cancelHandlers copy];
+        [_cancelHandlers removeAllObjects];
+    }
+    for (dispatch_block_t handler in handlers) {
+        handler();
+    }
+}
+
+@end
+
+#pragma mark - RRReachabilityObserver
+
+/// Undelivered changes kept per observer
+enum { kRRObserverMailboxCapacity = 8 };
+
+/// A registered block and the changes queued for it. Held by the registry; the public token
+/// only points at it, so dropping the token can unregister it.
+@interface RRReachabilityObserver : NSObject
+
+@property (nonatomic, strong, readonly, nullable) dispatch_queue_t queue;
+@property (nonatomic, copy, readonly) RRReachabilityObserverBlock block;
+
+- (instancetype)initWithQueue:(nullable dispatch_queue_t)queue block:(RRReachabilityObserverBlock)block;
+- (void)deliverState:(RRReachabilityState)state;
+- (void)drain;
+- (void)cancel;
+
+@end
+
+static void RRReachabilityObserverDrain(void *context) {
+    RRReachabilityObserver *observer = (__bridge_transfer RRReachabilityObserver *)context;
+    [observer drain];
+}
+
+@implementation RRReachabilityObserver {
+    RRReachabilityState _mailbox[kRRObserverMailboxCapacity];
+    NSUInteger _mailboxStart;
+    NSUInteger _mailboxCount;
+    BOOL _drainScheduled;
+    BOOL _cancelled;
+}
+
+- (instancetype)initWithQueue:(dispatch_queue_t)queue block:(RRReachabilityObserverBlock)block {
+    self = [super init];
+    if (self) {
+        _queue = queue;
+        _block = [block copy];
+    }
+    return self;
+}
+
+/// Called on the main queue. Main-queue observers run inline; others get the state copied
+/// into the mailbox and, if no drain is pending, one dispatch_async_f with no block to allocate.
+- (void)deliverState:(RRReachabilityState)state {
+    if (self.queue == nil) {
+        BOOL cancelled;
+        @synchronized(self) {
+            cancelled = _cancelled;
+        }
+        if (!cancelled) {
+            self.block(state);
+        }
+        return;
+    }
+
+    BOOL scheduleDrain = NO;
+    @synchronized(self) {
+        if (_cancelled) {
+            return;
+        }
+        if (_mailboxCount == kRRObserverMailboxCapacity) {
+            _mailboxStart = (_mailboxStart + 1) % kRRObserverMailboxCapacity;
+            _mailboxCount -= 1;
+        }
+        _mailbox[(_mailboxStart + _mailboxCount) % kRRObserverMailboxCapacity] = state;
+        _mailboxCount += 1;
+        if (!_drainScheduled) {
+            _drainScheduled = YES;
+            scheduleDrain = YES;
+        }
+    }
+
+    if (scheduleDrain) {
+        dispatch_async_f(self.queue, (__bridge_retained void *)self, RRReachabilityObserverDrain);
+    }
+}
+
+- (void)drain {
+    while (YES) {
+        RRReachabilityState state;
+        @synchronized(self) {
+            if (_cancelled || _mailboxCount == 0) {
+                _drainScheduled = NO;
+                return;
+            }
+            state = _mailbox[_mailboxStart];
+            _mailboxStart = (_mailboxStart + 1) % kRRObserverMailboxCapacity;
+            _mailboxCount -= 1;
+        }
+        self.block(state);
+    }
+}
+
+- (void)cancel {
+    @synchronized(self) {
+        _cancelled = YES;
+        _mailboxCount = 0;
+    }
+}
+
+@end
+
+@interface RRReachabilityObservation ()
+- (instancetype)initWithReachability:(RRReachability *)reachability observer:(RRReachabilityObserver *)observer;
+@end
+
+#pragma mark - RRReachability
 
 @interface RRReachability ()
 
@@ -24,28 +276,80 @@ static NSString * const kRRDefaultHTTPProbeURLString = @"https://www.gstatic.com
 @property (nonatomic, assign, readwrite) RRReachabilityStatus currentStatus;
 @property (nonatomic, assign, readwrite) RRConnectionType connectionType;
 @property (nonatomic, assign, readwrite) BOOL isSecondaryReachable;
+@property (nonatomic, assign, readwrite) RRProbeFailureReason lastFailureReason;
+@property (nonatomic, assign, readwrite) NSUInteger watchdogFireCount;
 @property (nonatomic, assign, readwrite) BOOL isNotifierRunning;
+@property (nonatomic, assign, readwrite) BOOL isNotifierSuspended;
+@property (nonatomic, strong, nullable) NSDate *lastStatusDate;
+@property (nonatomic, copy, nullable) void (^catchUpCompletion)(RRReachabilityStatus status);
+@property (nonatomic, assign, readwrite) NSUInteger deliveredStatusChangeCount;
+@property (nonatomic, assign, readwrite) NSUInteger mergedStatusChangeCount;
 @property (nonatomic, strong) dispatch_queue_t probeQueue;
-@property (nonatomic, strong) RRPingHelper *pingHelper;
+/// One ping helper per ICMP target and timeout, so probes to different targets never share a ping;
+/// guarded by @synchronized(self)
+@property (nonatomic, strong) NSMutableDictionary<NSString *, RRPingHelper *> *pingHelpers;
+@property (nonatomic, strong) RRQUICProber *quicProber;
+@property (nonatomic, strong) RRMTUProber *mtuProber;
+@property (nonatomic, strong) RRNAT64Resolver *nat64Resolver;
+/// Resources of the probes this engine is running; guarded by @synchronized(self)
+@property (nonatomic, strong) NSMutableSet<RRProbeResources *> *activeProbeResources;
 @property (nonatomic, strong, nullable) dispatch_source_t periodicProbeTimer;
 @property (nonatomic, assign) BOOL probeInFlight;
 @property (nonatomic, assign) BOOL hasPendingProbe;
 @property (nonatomic, assign) RRConnectionType pendingProbeConnectionType;
+@property (nonatomic, assign) RRProbePriority pendingProbePriority;
+@property (nonatomic, strong, readwrite) RRProbeScheduler *probeScheduler;
+@property (nonatomic, assign, readwrite) NSUInteger requestedProbeCount;
+@property (nonatomic, assign, readwrite) NSUInteger performedProbeCount;
 @property (nonatomic, assign) NSUInteger probeSequence;
+@property (nonatomic, assign) NSUInteger periodicBackoffFactor;
+@property (nonatomic, assign) NSTimeInterval periodicProbeTimerInterval;
+/// Profile overrides keyed by RRConnectionType
+@property (nonatomic, strong) NSMutableDictionary<NSNumber *, RRProbeProfile *> *probeProfiles;
+/// Registered block observers; replaced on registration changes so delivery can iterate a snapshot
+@property (atomic, copy) NSArray<RRReachabilityObserver *> *observers;
+
+/// Delivery window state; main queue only
+@property (nonatomic, assign) BOOL deliveryWindowOpen;
+@property (nonatomic, assign) NSUInteger deliveryWindowGeneration;
+@property (nonatomic, assign) BOOL hasPendingState;
+@property (nonatomic, assign) RRReachabilityState pendingState;
+@property (nonatomic, assign) RRReachabilityState lastDeliveredState;
+
+- (void)removeObserver:(RRReachabilityObserver *)observer;
+- (void)submitStateForDelivery:(RRReachabilityState)state;
+- (void)deliverChangedState:(RRReachabilityState)state;
+- (void)closeDeliveryWindow;
+- (void)notifyObserversOfState:(RRReachabilityState)state;
 
+- (BOOL)isMonitoring;
+- (void)finishCatchUpIfNeeded;
 - (void)startPeriodicProbeIfNeeded;
 - (void)stopPeriodicProbeIfNeeded;
 - (void)handlePeriodicProbeTick;
 - (void)handleUnsatisfiedPathWithConnectionType:(RRConnectionType)type;
-- (void)triggerProbeForConnectionType:(RRConnectionType)type;
-- (void)runProbeWithConnectionType:(RRConnectionType)type token:(NSUInteger)token;
-- (void)performProbeForConnectionType:(RRConnectionType)type completion:(void (^)(BOOL reachable, BOOL secondaryReachable))completion;
-- (void)performHTTPProbeAllowingCellular:(BOOL)allowCellular completion:(void (^)(BOOL reachable))completion;
-- (void)performParallelProbeAllowingCellular:(BOOL)allowCellular completion:(void (^)(BOOL reachable))completion;
+- (void)triggerProbeForConnectionType:(RRConnectionType)type priority:(RRProbePriority)priority;
+- (void)runProbeWithConnectionType:(RRConnectionType)type token:(NSUInteger)token priority:(RRProbePriority)priority;
+- (void)runProbeWithConnectionType:(RRConnectionType)type token:(NSUInteger)token priority:(RRProbePriority)priority retryTransientFailure:(BOOL)retryTransientFailure;
+- (void)applyPeriodicBackoffForFailureReason:(RRProbeFailureReason)failureReason;
+- (NSTimeInterval)currentPeriodicProbeInterval;
+- (void)rearmPeriodicProbeTimerIfIntervalChanged;
+- (RRProbeProfile *)effectiveProbeProfileForConnectionType:(RRConnectionType)type;
+- (void)performScheduledProbeForConnectionType:(RRConnectionType)type priority:(RRProbePriority)priority completion:(void (^)(BOOL reachable, BOOL secondaryReachable, RRProbeFailureReason failureReason))completion;
+- (NSString *)sharedProbeKeyForConnectionType:(RRConnectionType)type;
+- (void)performProbeForConnectionType:(RRConnectionType)type completion:(void (^)(BOOL reachable, BOOL secondaryReachable, RRProbeFailureReason failureReason))completion;
+- (void)performProbeForConnectionType:(RRConnectionType)type profile:(RRProbeProfile *)profile resources:(RRProbeResources *)resources completion:(void (^)(BOOL reachable, BOOL secondaryReachable, RRProbeFailureReason failureReason))completion;
+- (void)performProbeWithProfile:(RRProbeProfile *)profile resources:(RRProbeResources *)resources completion:(void (^)(BOOL reachable, RRProbeFailureReason failureReason))completion;
+- (void)performHTTPProbeWithProfile:(RRProbeProfile *)profile allowingCellular:(BOOL)allowCellular resources:(RRProbeResources *)resources completion:(void (^)(BOOL reachable, RRProbeFailureReason failureReason))completion;
+- (void)performParallelProbeWithProfile:(RRProbeProfile *)profile allowingCellular:(BOOL)allowCellular resources:(RRProbeResources *)resources completion:(void (^)(BOOL reachable, RRProbeFailureReason failureReason))completion;
+- (void)performICMPProbeWithProfile:(RRProbeProfile *)profile resources:(RRProbeResources *)resources completion:(void (^)(BOOL reachable, RRProbeFailureReason failureReason))completion;
+- (void)performQUICProbeWithProfile:(RRProbeProfile *)profile resources:(RRProbeResources *)resources completion:(void (^)(BOOL reachable, RRProbeFailureReason failureReason))completion;
 - (BOOL)probeModeSupportsHTTP;
 - (BOOL)validateCellularFallbackConfiguration;
+- (BOOL)validateCellularFallbackConfigurationForProbeMode:(RRProbeMode)probeMode;
 - (BOOL)shouldAttemptCellularFallbackForConnectionType:(RRConnectionType)type;
 - (void)updateStatus:(RRReachabilityStatus)status connectionType:(RRConnectionType)type secondaryReachable:(BOOL)secondaryReachable;
+- (void)updateStatus:(RRReachabilityStatus)status connectionType:(RRConnectionType)type secondaryReachable:(BOOL)secondaryReachable failureReason:(RRProbeFailureReason)failureReason;
 - (NSURL *)probeURLByAppendingNonce:(NSURL *)url;
 - (BOOL)isSuccessfulHTTPProbeResponse:(NSHTTPURLResponse *)response expectedURL:(NSURL *)expectedURL;
 
@@ -62,31 +366,58 @@ static NSString * const kRRDefaultHTTPProbeURLString = @"https://www.gstatic.com
     return instance;
 }
 
++ (NSUInteger)globalRequestedProbeCount {
+    return [RRProbeCoordinator sharedCoordinator].requestedProbeCount;
+}
+
++ (NSUInteger)globalPerformedProbeCount {
+    return [RRProbeCoordinator sharedCoordinator].performedProbeCount;
+}
+
 - (instancetype)init {
     self = [super init];
     if (self) {
         _currentStatus = RRReachabilityStatusUnknown;
         _connectionType = RRConnectionTypeNone;
         _isSecondaryReachable = NO;
+        _lastFailureReason = RRProbeFailureReasonNone;
         _probeMode = RRProbeModeParallel;
         _timeout = 5.0;
         _httpProbeURL = [NSURL URLWithString:kRRDefaultHTTPProbeURLString];
         _icmpHost = @"8.8.8.8";
         _icmpPort = 53;  // Note: Port is not used for real ICMP ping, kept for API compatibility
+        _quicHost = kRRDefaultQUICHost;
+        _quicPort = kRRDefaultQUICPort;
+        _includesQUICInParallel = NO;
         _allowCellularFallback = NO;
         _periodicProbeEnabled = YES;
         _isNotifierRunning = NO;
+        _isNotifierSuspended = NO;
         _probeInFlight = NO;
         _hasPendingProbe = NO;
         _pendingProbeConnectionType = RRConnectionTypeNone;
+        _pendingProbePriority = RRProbePriorityPeriodic;
         _probeSequence = 0;
+        _periodicBackoffFactor = 1;
+        _periodicProbeTimerInterval = 0;
+        _probeProfiles = [NSMutableDictionary dictionary];
+        _observers = @[];
+        _postsChangeNotifications = YES;
         _probeQueue = dispatch_queue_create("com.realreachability2.probe", DISPATCH_QUEUE_CONCURRENT);
         
         _pathMonitor = [[RRPathMonitor alloc] init];
         
-        _pingHelper = [[RRPingHelper alloc] init];
-        _pingHelper.host = _icmpHost;
-        _pingHelper.timeout = _timeout;
+        _pingHelpers = [NSMutableDictionary dictionary];
+        
+        _quicProber = [[RRQUICProber alloc] init];
+        
+        _mtuProber = [[RRMTUProber alloc] init];
+        
+        _nat64Resolver = [[RRNAT64Resolver alloc] init];
+        _activeProbeResources = [NSMutableSet set];
+        
+        // One reachability probe and one MTU discovery fit side by side.
+        _probeScheduler = [[RRProbeScheduler alloc] initWithMaximumConcurrentOperations:2];
         
         [self setupURLSession];
     }
@@ -124,14 +455,20 @@ static NSString * const kRRDefaultHTTPProbeURLString = @"https://www.gstatic.com
     }
     
     self.isNotifierRunning = YES;
+    [[RRProbeCoordinator sharedCoordinator] registerEngine:self];
     
     __weak typeof(self) weakSelf = self;
     self.pathMonitor.pathUpdateHandler = ^(BOOL satisfied, RRConnectionType type) {
         __strong typeof(weakSelf) strongSelf = weakSelf;
         if (!strongSelf) return;
 
+        // A different link may use a different profile interval.
+        [strongSelf rearmPeriodicProbeTimerIfIntervalChanged];
+
         if (satisfied) {
-            [strongSelf triggerProbeForConnectionType:type];
+            // The first update after resuming is the catch-up probe, which must not queue behind others.
+            RRProbePriority priority = strongSelf.catchUpCompletion ? RRProbePriorityUserInitiated : RRProbePriorityPathChange;
+            [strongSelf triggerProbeForConnectionType:type priority:priority];
         } else {
             [strongSelf handleUnsatisfiedPathWithConnectionType:type];
         }
@@ -161,23 +498,69 @@ static NSString * const kRRDefaultHTTPProbeURLString = @"https://www.gstatic.com
     }
     
     self.isNotifierRunning = NO;
+    [[RRProbeCoordinator sharedCoordinator] unregisterEngine:self];
     [self stopPeriodicProbeIfNeeded];
     self.pathMonitor.pathUpdateHandler = nil;
     [self.pathMonitor stopMonitoring];
+    [self flushStatusDelivery];
     
     @synchronized(self) {
+        self.isNotifierSuspended = NO;
         self.probeSequence += 1;
         self.probeInFlight = NO;
         self.hasPendingProbe = NO;
         self.pendingProbeConnectionType = RRConnectionTypeNone;
     }
+    [self finishCatchUpIfNeeded];
+}
+
+- (void)setProbeProfile:(RRProbeProfile *)profile forConnectionType:(RRConnectionType)type {
+    @synchronized(self) {
+        self.probeProfiles[@(type)] = [profile copy];
+    }
+    
+    dispatch_async(dispatch_get_main_queue(), ^{
+        [self rearmPeriodicProbeTimerIfIntervalChanged];
+    });
+    
+    if (type == RRConnectionTypeWiFi && self.allowCellularFallback) {
+        [self validateCellularFallbackConfiguration];
+    }
+}
+
+- (RRProbeProfile *)probeProfileForConnectionType:(RRConnectionType)type {
+    @synchronized(self) {
+        return [self.probeProfiles[@(type)] copy];
+    }
+}
+
+- (RRProbeProfile *)activeProbeProfile {
+    return [self effectiveProbeProfileForConnectionType:self.pathMonitor.connectionType];
+}
+
+- (RRProbeProfile *)effectiveProbeProfileForConnectionType:(RRConnectionType)type {
+    RRProbeProfile *override = [self probeProfileForConnectionType:type];
+    if (override) {
+        return override;
+    }
+    
+    RRProbeProfile *profile = [[RRProbeProfile alloc] init];
+    profile.probeMode = self.probeMode;
+    profile.timeout = self.timeout;
+    profile.periodicProbeInterval = kRRPeriodicProbeInterval;
+    profile.httpProbeURL = self.httpProbeURL;
+    profile.icmpHost = self.icmpHost;
+    profile.quicHost = self.quicHost;
+    profile.quicPort = self.quicPort;
+    profile.includesQUICInParallel = self.includesQUICInParallel;
+    return profile;
 }
 
 - (void)setPeriodicProbeEnabled:(BOOL)periodicProbeEnabled {
     _periodicProbeEnabled = periodicProbeEnabled;
     
     dispatch_async(dispatch_get_main_queue(), ^{
-        if (!self.isNotifierRunning) {
+        if (![self isMonitoring]) {
             return;
         }
         
@@ -191,7 +574,7 @@ static NSString * const kRRDefaultHTTPProbeURLString = @"https://www.gstatic.com
 }
 
 - (void)startPeriodicProbeIfNeeded {
-    if (!self.periodicProbeEnabled || !self.isNotifierRunning || self.periodicProbeTimer != nil) {
+    if (!self.periodicProbeEnabled || ![self isMonitoring] || self.periodicProbeTimer != nil) {
         return;
     }
     
@@ -200,9 +583,12 @@ static NSString * const kRRDefaultHTTPProbeURLString = @"https://www.gstatic.com
         return;
     }
     
-    uint64_t interval = (uint64_t)(kRRPeriodicProbeInterval * NSEC_PER_SEC);
+    // The first fire lands on the coordinator's shared clock, so engines in the process tick together.
+    NSTimeInterval seconds = [self currentPeriodicProbeInterval];
+    uint64_t interval = (uint64_t)(seconds * NSEC_PER_SEC);
+    NSTimeInterval delay = [[RRProbeCoordinator sharedCoordinator] delayUntilNextTickForInterval:seconds];
     dispatch_source_set_timer(timer,
-                              dispatch_time(DISPATCH_TIME_NOW, interval),
+                              dispatch_time(DISPATCH_TIME_NOW, (int64_t)(delay * NSEC_PER_SEC)),
                               interval,
                               (uint64_t)(0.2 * NSEC_PER_SEC));
     
@@ -214,6 +600,7 @@ static NSString * const kRRDefaultHTTPProbeURLString = @"https://www.gstatic.com
     });
     
     self.periodicProbeTimer = timer;
+    self.periodicProbeTimerInterval = seconds;
     dispatch_resume(timer);
 }
 
@@ -226,8 +613,37 @@ static NSString * const kRRDefaultHTTPProbeURLString = @"https://www.gstatic.com
     self.periodicProbeTimer = nil;
 }
 
+- (void)applyPeriodicBackoffForFailureReason:(RRProbeFailureReason)failureReason {
+    NSUInteger factor = 1;
+    if (RRProbeFailureReasonWarrantsBackoff(failureReason)) {
+        factor = MIN(self.periodicBackoffFactor * 2, kRRMaxPeriodicBackoffFactor);
+    }
+    
+    if (factor == self.periodicBackoffFactor) {
+        return;
+    }
+    
+    self.periodicBackoffFactor = factor;
+    [self rearmPeriodicProbeTimerIfIntervalChanged];
+}
+
+- (NSTimeInterval)currentPeriodicProbeInterval {
+    RRProbeProfile *profile = [self effectiveProbeProfileForConnectionType:self.pathMonitor.connectionType];
+    return MAX(profile.periodicProbeInterval, 0.0) * self.periodicBackoffFactor;
+}
+
+- (void)rearmPeriodicProbeTimerIfIntervalChanged {
+    if (!self.periodicProbeTimer || self.periodicProbeTimerInterval == [self currentPeriodicProbeInterval]) {
+        return;
+    }
+    
+    // Re-arm the timer so the new interval takes effect from now on.
+    [self stopPeriodicProbeIfNeeded];
+    [self startPeriodicProbeIfNeeded];
+}
+
 - (void)handlePeriodicProbeTick {
-    if (!self.isNotifierRunning || !self.periodicProbeEnabled) {
+    if (![self isMonitoring] || !self.periodicProbeEnabled) {
         return;
     }
     
@@ -237,10 +653,12 @@ static NSString * const kRRDefaultHTTPProbeURLString = @"https://www.gstatic.com
         return;
     }
     
-    [self triggerProbeForConnectionType:type];
+    [self triggerProbeForConnectionType:type priority:RRProbePriorityPeriodic];
 }
 
 - (void)handleUnsatisfiedPathWithConnectionType:(RRConnectionType)type {
+    [self.nat64Resolver invalidate];
+    
     @synchronized(self) {
         self.probeSequence += 1;
         self.probeInFlight = NO;
@@ -248,18 +666,23 @@ static NSString * const kRRDefaultHTTPProbeURLString = @"https://www.gstatic.com
         self.pendingProbeConnectionType = RRConnectionTypeNone;
     }
     
-    [self updateStatus:RRReachabilityStatusNotReachable connectionType:type secondaryReachable:NO];
+    [self updateStatus:RRReachabilityStatusNotReachable
+        connectionType:type
+    secondaryReachable:NO
+         failureReason:RRProbeFailureReasonNoRoute];
+    [self finishCatchUpIfNeeded];
 }
 
-- (void)triggerProbeForConnectionType:(RRConnectionType)type {
+- (void)triggerProbeForConnectionType:(RRConnectionType)type priority:(RRProbePriority)priority {
     NSUInteger token = 0;
     
     @synchronized(self) {
-        if (!self.isNotifierRunning) {
+        if (![self isMonitoring]) {
             return;
         }
         
         if (self.probeInFlight) {
+            self.pendingProbePriority = self.hasPendingProbe ? MAX(self.pendingProbePriority, priority) : priority;
             self.hasPendingProbe = YES;
             self.pendingProbeConnectionType = type;
             return;
@@ -270,27 +693,46 @@ static NSString * const kRRDefaultHTTPProbeURLString = @"https://www.gstatic.com
         token = self.probeSequence;
     }
     
-    [self runProbeWithConnectionType:type token:token];
+    [self runProbeWithConnectionType:type token:token priority:priority];
 }
 
-- (void)runProbeWithConnectionType:(RRConnectionType)type token:(NSUInteger)token {
+- (void)runProbeWithConnectionType:(RRConnectionType)type token:(NSUInteger)token priority:(RRProbePriority)priority {
+    [self runProbeWithConnectionType:type token:token priority:priority retryTransientFailure:YES];
+}
+
+- (void)runProbeWithConnectionType:(RRConnectionType)type token:(NSUInteger)token priority:(RRProbePriority)priority retryTransientFailure:(BOOL)retryTransientFailure {
     __weak typeof(self) weakSelf = self;
-    [self performProbeForConnectionType:type completion:^(BOOL reachable, BOOL secondaryReachable) {
+    [self performScheduledProbeForConnectionType:type priority:priority completion:^(BOOL reachable, BOOL secondaryReachable, RRProbeFailureReason failureReason) {
         __strong typeof(weakSelf) strongSelf = weakSelf;
         if (!strongSelf) return;
         
         dispatch_async(dispatch_get_main_queue(), ^{
+            // A transient failure (for example a connection reset) is retried once right away
+            // instead of being reported and waiting for the next scheduled probe.
+            if (!reachable && retryTransientFailure && RRProbeFailureReasonWarrantsRetry(failureReason)) {
+                BOOL isCurrent = NO;
+                @synchronized(strongSelf) {
+                    isCurrent = [strongSelf isMonitoring] && (token == strongSelf.probeSequence);
+                }
+                if (isCurrent) {
+                    [strongSelf runProbeWithConnectionType:type token:token priority:priority retryTransientFailure:NO];
+                    return;
+                }
+            }
+            
             BOOL shouldApplyResult = NO;
             BOOL shouldRunPendingProbe = NO;
             RRConnectionType nextType = RRConnectionTypeNone;
+            RRProbePriority nextPriority = RRProbePriorityPeriodic;
             NSUInteger nextToken = 0;
             
             @synchronized(strongSelf) {
-                shouldApplyResult = strongSelf.isNotifierRunning && (token == strongSelf.probeSequence);
+                shouldApplyResult = [strongSelf isMonitoring] && (token == strongSelf.probeSequence);
                 
-                if (strongSelf.hasPendingProbe && strongSelf.isNotifierRunning && strongSelf.pathMonitor.isSatisfied) {
+                if (strongSelf.hasPendingProbe && [strongSelf isMonitoring] && strongSelf.pathMonitor.isSatisfied) {
                     shouldRunPendingProbe = YES;
                     nextType = strongSelf.pendingProbeConnectionType;
+                    nextPriority = strongSelf.pendingProbePriority;
                     strongSelf.hasPendingProbe = NO;
                     strongSelf.probeSequence += 1;
                     nextToken = strongSelf.probeSequence;
@@ -304,11 +746,16 @@ static NSString * const kRRDefaultHTTPProbeURLString = @"https://www.gstatic.com
             
             if (shouldApplyResult) {
                 RRReachabilityStatus status = reachable ? RRReachabilityStatusReachable : RRReachabilityStatusNotReachable;
-                [strongSelf updateStatus:status connectionType:type secondaryReachable:secondaryReachable];
+                [strongSelf applyPeriodicBackoffForFailureReason:failureReason];
+                [strongSelf updateStatus:status
+                          connectionType:type
+                      secondaryReachable:secondaryReachable
+                           failureReason:failureReason];
+                [strongSelf finishCatchUpIfNeeded];
             }
             
             if (shouldRunPendingProbe) {
-                [strongSelf runProbeWithConnectionType:nextType token:nextToken];
+                [strongSelf runProbeWithConnectionType:nextType token:nextToken priority:nextPriority];
             }
         });
     }];
@@ -319,6 +766,11 @@ static NSString * const kRRDefaultHTTPProbeURLString = @"https://www.gstatic.com
 }
 
 - (void)updateStatus:(RRReachabilityStatus)status connectionType:(RRConnectionType)type secondaryReachable:(BOOL)secondaryReachable {
+    RRProbeFailureReason failureReason = (status == RRReachabilityStatusReachable) ? RRProbeFailureReasonNone : RRProbeFailureReasonUnknown;
+    [self updateStatus:status connectionType:type secondaryReachable:secondaryReachable failureReason:failureReason];
+}
+
+- (void)updateStatus:(RRReachabilityStatus)status connectionType:(RRConnectionType)type secondaryReachable:(BOOL)secondaryReachable failureReason:(RRProbeFailureReason)failureReason {
     dispatch_async(dispatch_get_main_queue(), ^{
         BOOL statusChanged = (self.currentStatus != status);
         BOOL connectionTypeChanged = (self.connectionType != type);
@@ -327,127 +779,475 @@ static NSString * const kRRDefaultHTTPProbeURLString = @"https://www.gstatic.com
         self.currentStatus = status;
         self.connectionType = type;
         self.isSecondaryReachable = secondaryReachable;
+        self.lastFailureReason = failureReason;
+        self.lastStatusDate = [NSDate date];
         
         if (shouldNotify) {
-            NSDictionary *userInfo = @{
-                kRRReachabilityStatusKey: @(status),
-                kRRConnectionTypeKey: @(type),
-                kRRSecondaryReachableKey: @(secondaryReachable)
+            RRReachabilityState state = {
+                .status = status,
+                .connectionType = type,
+                .secondaryReachable = secondaryReachable,
+                .failureReason = failureReason
             };
-            
-            [[NSNotificationCenter defaultCenter] postNotificationName:kRRReachabilityChangedNotification
-                                                                object:self
-                                                              userInfo:userInfo];
+            [self submitStateForDelivery:state];
+        }
+    });
+}
+
+#pragma mark - Suspend and Resume
+
+- (BOOL)isMonitoring {
+    @synchronized(self) {
+        return self.isNotifierRunning && !self.isNotifierSuspended;
+    }
+}
+
+- (NSTimeInterval)statusAge {
+    NSDate *lastStatusDate = self.lastStatusDate;
+    return lastStatusDate ? -[lastStatusDate timeIntervalSinceNow] : -1;
+}
+
+- (void)suspend {
+    @synchronized(self) {
+        if (!self.isNotifierRunning || self.isNotifierSuspended) {
+            return;
+        }
+        self.isNotifierSuspended = YES;
+        self.probeSequence += 1;
+        self.probeInFlight = NO;
+        self.hasPendingProbe = NO;
+        self.pendingProbeConnectionType = RRConnectionTypeNone;
+    }
+    
+    [[RRProbeCoordinator sharedCoordinator] unregisterEngine:self];
+    [self stopPeriodicProbeIfNeeded];
+    [self.pathMonitor stopMonitoring];
+    
+    // Every probe in flight completes with RRProbeFailureReasonCancelled, which clears its
+    // scheduler and coordinator entries. This engine drops the outcome for its stale token;
+    // a catch-up probe or another engine that shared the run asks again.
+    NSArray<RRProbeResources *> *inFlight;
+    @synchronized(self) {
+        inFlight = self.activeProbeResources.allObjects;
+    }
+    for (RRProbeResources *resources in inFlight) {
+        [resources cancel];
+    }
+    [self.mtuProber cancel];
+    
+    // A resume before the catch-up probe finished still gets its answer.
+    [self finishCatchUpIfNeeded];
+    // A change held by the delivery window goes out now rather than after the idle period.
+    [self flushStatusDelivery];
+    RRLogInfo(@"engine", @"Notifier suspended");
+}
+
+- (void)resumeWithCompletion:(void (^)(NSTimeInterval, RRReachabilityStatus))completion {
+    BOOL wasSuspended = NO;
+    @synchronized(self) {
+        wasSuspended = self.isNotifierRunning && self.isNotifierSuspended;
+        self.isNotifierSuspended = NO;
+    }
+    
+    NSTimeInterval staleness = self.statusAge;
+    if (!wasSuspended) {
+        if (completion) {
+            dispatch_async(dispatch_get_main_queue(), ^{
+                completion(staleness, self.currentStatus);
+            });
         }
+        return;
+    }
+    
+    RRLogInfo(@"engine", @"Notifier resumed; status was %.0fs old", staleness);
+    void (^previous)(RRReachabilityStatus) = self.catchUpCompletion;
+    self.catchUpCompletion = ^(RRReachabilityStatus status) {
+        if (previous) {
+            previous(status);
+        }
+        if (completion) {
+            completion(staleness, status);
+        }
+    };
+    
+    // The restarted monitor reports the current path at once; that update runs the catch-up probe.
+    [[RRProbeCoordinator sharedCoordinator] registerEngine:self];
+    [self.pathMonitor startMonitoring];
+    [self startPeriodicProbeIfNeeded];
+}
+
+/// Reports the status to a pending resume once the catch-up probe's outcome has been applied.
+/// Status updates land on the main queue asynchronously, so the report is queued behind them.
+- (void)finishCatchUpIfNeeded {
+    void (^catchUpCompletion)(RRReachabilityStatus) = self.catchUpCompletion;
+    if (!catchUpCompletion) {
+        return;
+    }
+    self.catchUpCompletion = nil;
+    
+    dispatch_async(dispatch_get_main_queue(), ^{
+        // Resuming is exactly when a stale status must not wait out the delivery window.
+        [self flushStatusDelivery];
+        catchUpCompletion(self.currentStatus);
     });
 }
 
+#pragma mark - Delivery Window
+
+- (void)submitStateForDelivery:(RRReachabilityState)state {
+    if (self.deliveryWindowOpen) {
+        if (self.hasPendingState) {
+            self.mergedStatusChangeCount += 1;
+        }
+        self.pendingState = state;
+        self.hasPendingState = YES;
+        return;
+    }
+    [self deliverChangedState:state];
+}
+
+/// Notifies observers and, with a window configured, holds later changes until it closes
+- (void)deliverChangedState:(RRReachabilityState)state {
+    self.lastDeliveredState = state;
+    self.deliveredStatusChangeCount += 1;
+
+    if (self.statusDeliveryWindow > 0) {
+        self.deliveryWindowOpen = YES;
+        NSUInteger generation = ++self.deliveryWindowGeneration;
+        __weak typeof(self) weakSelf = self;
+        dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(self.statusDeliveryWindow * NSEC_PER_SEC)), dispatch_get_main_queue(), ^{
+            __strong typeof(weakSelf) strongSelf = weakSelf;
+            if (strongSelf && strongSelf.deliveryWindowGeneration == generation) {
+                [strongSelf closeDeliveryWindow];
+            }
+        });
+    }
+
+    [self notifyObserversOfState:state];
+}
+
+/// Delivers the held change if the burst ended somewhere other than where it started
+- (void)closeDeliveryWindow {
+    self.deliveryWindowOpen = NO;
+    self.deliveryWindowGeneration += 1;
+    if (!self.hasPendingState) {
+        return;
+    }
+
+    self.hasPendingState = NO;
+    RRReachabilityState pending = self.pendingState;
+    if (!RRReachabilityStateChanged(pending, self.lastDeliveredState)) {
+        self.mergedStatusChangeCount += 1;
+        return;
+    }
+    [self deliverChangedState:pending];
+}
+
+- (void)flushStatusDelivery {
+    if ([NSThread isMainThread]) {
+        [self closeDeliveryWindow];
+        return;
+    }
+    dispatch_async(dispatch_get_main_queue(), ^{
+        [self closeDeliveryWindow];
+    });
+}
+
+#pragma mark - Observers
+
+- (RRReachabilityObservation *)addObserverWithQueue:(dispatch_queue_t)queue block:(RRReachabilityObserverBlock)block {
+    RRReachabilityObserver *observer = [[RRReachabilityObserver alloc] initWithQueue:queue block:block];
+    @synchronized(self) {
+        self.observers = [self.observers arrayByAddingObject:observer];
+    }
+    return [[RRReachabilityObservation alloc] initWithReachability:self observer:observer];
+}
+
+- (void)removeObserver:(RRReachabilityObserver *)observer {
+    [observer cancel];
+    @synchronized(self) {
+        NSMutableArray<RRReachabilityObserver *> *observers = [self.observers mutableCopy];
+        [observers removeObjectIdenticalTo:observer];
+        self.observers = observers;
+    }
+}
+
+/// Called on the main queue for every change. Block observers get the struct as is; the
+/// notification, if enabled, is the only place a dictionary is built.
+- (void)notifyObserversOfState:(RRReachabilityState)state {
+    for (RRReachabilityObserver *observer in self.observers) {
+        [observer deliverState:state];
+    }
+
+    if (self.postsChangeNotifications) {
+        NSDictionary *userInfo = @{
+            kRRReachabilityStatusKey: @(state.status),
+            kRRConnectionTypeKey: @(state.connectionType),
+            kRRSecondaryReachableKey: @(state.secondaryReachable),
+            kRRProbeFailureReasonKey: @(state.failureReason)
+        };
+        
+        [[NSNotificationCenter defaultCenter] postNotificationName:kRRReachabilityChangedNotification
+                                                            object:self
+                                                          userInfo:userInfo];
+    }
+}
+
 - (void)checkReachabilityWithCompletion:(void (^)(RRReachabilityStatus, RRConnectionType))completion {
+    [self checkReachabilityWithDetailedCompletion:^(RRReachabilityStatus status, RRConnectionType type, RRProbeFailureReason failureReason) {
+        completion(status, type);
+    }];
+}
+
+- (void)checkReachabilityWithDetailedCompletion:(void (^)(RRReachabilityStatus, RRConnectionType, RRProbeFailureReason))completion {
     if (!self.pathMonitor.isSatisfied) {
         dispatch_async(dispatch_get_main_queue(), ^{
             self.isSecondaryReachable = NO;
-            completion(RRReachabilityStatusNotReachable, RRConnectionTypeNone);
+            self.lastFailureReason = RRProbeFailureReasonNoRoute;
+            completion(RRReachabilityStatusNotReachable, RRConnectionTypeNone, RRProbeFailureReasonNoRoute);
         });
         return;
     }
     
     RRConnectionType type = self.pathMonitor.connectionType;
     
-    [self performProbeForConnectionType:type completion:^(BOOL reachable, BOOL secondaryReachable) {
+    void (^finish)(BOOL, BOOL, RRProbeFailureReason) = ^(BOOL reachable, BOOL secondaryReachable, RRProbeFailureReason failureReason) {
         dispatch_async(dispatch_get_main_queue(), ^{
             self.isSecondaryReachable = secondaryReachable;
+            self.lastFailureReason = failureReason;
             RRReachabilityStatus status = reachable ? RRReachabilityStatusReachable : RRReachabilityStatusNotReachable;
-            completion(status, type);
+            completion(status, type, failureReason);
         });
+    };
+    
+    [self performScheduledProbeForConnectionType:type priority:RRProbePriorityUserInitiated completion:^(BOOL reachable, BOOL secondaryReachable, RRProbeFailureReason failureReason) {
+        if (!reachable && RRProbeFailureReasonWarrantsRetry(failureReason)) {
+            [self performScheduledProbeForConnectionType:type priority:RRProbePriorityUserInitiated completion:finish];
+            return;
+        }
+        finish(reachable, secondaryReachable, failureReason);
+    }];
+}
+
+- (void)discoverPathMTUWithCompletion:(void (^)(NSUInteger, RRProbeFailureReason))completion {
+    if (!self.pathMonitor.isSatisfied) {
+        dispatch_async(dispatch_get_main_queue(), ^{
+            completion(0, RRProbeFailureReasonNoRoute);
+        });
+        return;
+    }
+    
+    NSString *networkKey = self.pathMonitor.networkFingerprint;
+    [self.probeScheduler scheduleOperationForKey:@"pathMTU" priority:RRProbePriorityBackgroundDiagnostic operation:^RRProbeCancelBlock(RRProbeOperationCompletion done) {
+        self.mtuProber.host = self.activeProbeProfile.icmpHost;
+        self.mtuProber.packetCapture = self.packetCapture;
+        [self.mtuProber discoverPathMTUForNetworkKey:networkKey completion:^(NSUInteger pathMTU, RRProbeFailureReason failureReason) {
+            done(@[@(pathMTU), @(failureReason)]);
+        }];
+        return ^{
+            [self.mtuProber cancel];
+        };
+    } completion:^(NSArray<NSNumber *> *result) {
+        // The MTU prober reports on the main queue.
+        completion(result[0].unsignedIntegerValue, (RRProbeFailureReason)result[1].integerValue);
+    }];
+}
+
+- (NSUInteger)pathMTU {
+    return [self.mtuProber cachedPathMTUForNetworkKey:self.pathMonitor.networkFingerprint];
+}
+
+/// Runs the probe through the probe scheduler; concurrent requests for the same link share one run,
+/// and an identical probe in flight on another engine is shared through the coordinator.
+/// Reachability probes share the ping helper and QUIC prober, so they cannot be cancelled and
+/// are never preempted; they only piggyback or queue.
+- (void)performScheduledProbeForConnectionType:(RRConnectionType)type priority:(RRProbePriority)priority completion:(void (^)(BOOL reachable, BOOL secondaryReachable, RRProbeFailureReason failureReason))completion {
+    [self.probeScheduler scheduleOperationForKey:@(type) priority:priority operation:^RRProbeCancelBlock(RRProbeOperationCompletion done) {
+        @synchronized(self) {
+            self.requestedProbeCount += 1;
+        }
+        [[RRProbeCoordinator sharedCoordinator] performProbeForKey:[self sharedProbeKeyForConnectionType:type] priority:priority operation:^RRProbeCancelBlock(RRProbeOperationCompletion sharedDone) {
+            @synchronized(self) {
+                self.performedProbeCount += 1;
+            }
+            [self performProbeForConnectionType:type completion:^(BOOL reachable, BOOL secondaryReachable, RRProbeFailureReason failureReason) {
+                sharedDone([[RRProbeOutcome alloc] initWithReachable:reachable secondaryReachable:secondaryReachable failureReason:failureReason]);
+            }];
+            return nil;
+        } completion:done];
+        return nil;
+    } completion:^(RRProbeOutcome *outcome) {
+        completion(outcome.reachable, outcome.secondaryReachable, outcome.failureReason);
     }];
 }
 
-- (void)performProbeForConnectionType:(RRConnectionType)type completion:(void (^)(BOOL reachable, BOOL secondaryReachable))completion {
+/// Identifies a probe whose outcome any engine can reuse: the effective profile, fallback policy
+/// and network. The class is part of it because subclasses may probe differently.
+- (NSString *)sharedProbeKeyForConnectionType:(RRConnectionType)type {
+    RRProbeProfile *profile = [self effectiveProbeProfileForConnectionType:type];
+    return [NSString stringWithFormat:@"%@|%ld|%ld|%.3f|%@|%@|%@|%u|%d|%d|%@",
+            NSStringFromClass([self class]), (long)type, (long)profile.probeMode, profile.timeout,
+            profile.httpProbeURL.absoluteString, profile.icmpHost, profile.quicHost, profile.quicPort,
+            profile.includesQUICInParallel, self.allowCellularFallback, self.pathMonitor.networkFingerprint];
+}
+
+- (void)performProbeForConnectionType:(RRConnectionType)type completion:(void (^)(BOOL reachable, BOOL secondaryReachable, RRProbeFailureReason failureReason))completion {
+    // Resolve the profile once, so the whole probe runs with one consistent strategy
+    // even if the link or the profiles change while it is in flight.
+    RRProbeProfile *profile = [self effectiveProbeProfileForConnectionType:type];
+    
+    // Hard deadline independent of the probers' own timers, so a prober that never
+    // calls back cannot leave probeInFlight set and freeze monitoring. It covers a
+    // primary and a fallback HTTP probe back to back, plus a grace period.
+    NSTimeInterval deadline = profile.timeout * 2 + kRRWatchdogGracePeriod;
+    RRProbeResources *resources = [[RRProbeResources alloc] init];
+    @synchronized(self) {
+        [self.activeProbeResources addObject:resources];
+    }
+    __block BOOL finished = NO;
+    void (^finishOnce)(BOOL, BOOL, RRProbeFailureReason) = ^(BOOL reachable, BOOL secondaryReachable, RRProbeFailureReason failureReason) {
+        @synchronized(self) {
+            if (finished) {
+                return;
+            }
+            finished = YES;
+            [self.activeProbeResources removeObject:resources];
+        }
+        completion(reachable, secondaryReachable, failureReason);
+    };
+    
+    __weak typeof(self) weakSelf = self;
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(deadline * NSEC_PER_SEC)), self.probeQueue, ^{
+        __strong typeof(weakSelf) strongSelf = weakSelf;
+        if (!strongSelf) return;
+        
+        BOOL fired = NO;
+        @synchronized(strongSelf) {
+            fired = !finished;
+            if (fired) {
+                strongSelf.watchdogFireCount += 1;
+            }
+        }
+        if (!fired) {
+            return;
+        }
+        
+        RRLogWarning(@"engine", @"Watchdog force-completed a probe after %.1fs", deadline);
+        // Release only this probe's ping, UDP flow and HTTP tasks; a concurrent probe
+        // sharing the same probers keeps running.
+        [resources cancel];
+        finishOnce(NO, NO, RRProbeFailureReasonWatchdog);
+    });
+    
+    [self performProbeForConnectionType:type profile:profile resources:resources completion:finishOnce];
+}
+
+- (void)performProbeForConnectionType:(RRConnectionType)type profile:(RRProbeProfile *)profile resources:(RRProbeResources *)resources completion:(void (^)(BOOL reachable, BOOL secondaryReachable, RRProbeFailureReason failureReason))completion {
     BOOL shouldAttemptFallback = [self shouldAttemptCellularFallbackForConnectionType:type];
     if (shouldAttemptFallback) {
-        if (![self validateCellularFallbackConfiguration]) {
-            completion(NO, NO);
+        if (![self validateCellularFallbackConfigurationForProbeMode:profile.probeMode]) {
+            completion(NO, NO, RRProbeFailureReasonInvalidConfiguration);
             return;
         }
         
-        [self performHTTPProbeAllowingCellular:NO completion:^(BOOL primaryReachable) {
+        [self performHTTPProbeWithProfile:profile allowingCellular:NO resources:resources completion:^(BOOL primaryReachable, RRProbeFailureReason primaryFailureReason) {
             if (primaryReachable) {
-                completion(YES, NO);
+                completion(YES, NO, RRProbeFailureReasonNone);
                 return;
             }
             
-            [self performHTTPProbeAllowingCellular:YES completion:^(BOOL fallbackReachable) {
-                completion(fallbackReachable, fallbackReachable);
+            [self performHTTPProbeWithProfile:profile allowingCellular:YES resources:resources completion:^(BOOL fallbackReachable, RRProbeFailureReason fallbackFailureReason) {
+                completion(fallbackReachable, fallbackReachable, fallbackFailureReason);
             }];
         }];
         return;
     }
     
     // Wi-Fi primary probing should not silently route through cellular when fallback is disabled.
-    if (type == RRConnectionTypeWiFi && [self probeModeSupportsHTTP] && !self.allowCellularFallback) {
-        if (self.probeMode == RRProbeModeHTTPOnly) {
-            [self performHTTPProbeAllowingCellular:NO completion:^(BOOL reachable) {
-                completion(reachable, NO);
+    if (type == RRConnectionTypeWiFi && RRProbeModeSupportsHTTP(profile.probeMode) && !self.allowCellularFallback) {
+        if (profile.probeMode == RRProbeModeHTTPOnly) {
+            [self performHTTPProbeWithProfile:profile allowingCellular:NO resources:resources completion:^(BOOL reachable, RRProbeFailureReason failureReason) {
+                completion(reachable, NO, failureReason);
             }];
             return;
         }
         
-        if (self.probeMode == RRProbeModeParallel) {
-            [self performParallelProbeAllowingCellular:NO completion:^(BOOL reachable) {
-                completion(reachable, NO);
+        if (profile.probeMode == RRProbeModeParallel) {
+            [self performParallelProbeWithProfile:profile allowingCellular:NO resources:resources completion:^(BOOL reachable, RRProbeFailureReason failureReason) {
+                completion(reachable, NO, failureReason);
             }];
             return;
         }
     }
     
-    [self performProbeWithCompletion:^(BOOL reachable) {
-        completion(reachable, NO);
+    [self performProbeWithProfile:profile resources:resources completion:^(BOOL reachable, RRProbeFailureReason failureReason) {
+        completion(reachable, NO, failureReason);
     }];
 }
 
-- (void)performProbeWithCompletion:(void (^)(BOOL reachable))completion {
-    switch (self.probeMode) {
+- (void)performProbeWithProfile:(RRProbeProfile *)profile resources:(RRProbeResources *)resources completion:(void (^)(BOOL reachable, RRProbeFailureReason failureReason))completion {
+    switch (profile.probeMode) {
         case RRProbeModeParallel:
-            [self performParallelProbeWithCompletion:completion];
+            [self performParallelProbeWithProfile:profile allowingCellular:YES resources:resources completion:completion];
             break;
         case RRProbeModeHTTPOnly:
-            [self performHTTPProbeWithCompletion:completion];
+            [self performHTTPProbeWithProfile:profile allowingCellular:YES resources:resources completion:completion];
             break;
         case RRProbeModeICMPOnly:
-            [self performICMPProbeWithCompletion:completion];
+            [self performICMPProbeWithProfile:profile resources:resources completion:completion];
+            break;
+        case RRProbeModeQUICOnly:
+            [self performQUICProbeWithProfile:profile resources:resources completion:completion];
             break;
     }
 }
 
-- (void)performParallelProbeWithCompletion:(void (^)(BOOL reachable))completion {
-    [self performParallelProbeAllowingCellular:YES completion:completion];
-}
-
-- (void)performParallelProbeAllowingCellular:(BOOL)allowCellular completion:(void (^)(BOOL reachable))completion {
-    __block BOOL httpResult = NO;
-    __block BOOL icmpResult = NO;
-    __block BOOL httpDone = NO;
-    __block BOOL icmpDone = NO;
+- (void)performParallelProbeWithProfile:(RRProbeProfile *)profile allowingCellular:(BOOL)allowCellular resources:(RRProbeResources *)resources completion:(void (^)(BOOL reachable, RRProbeFailureReason failureReason))completion {
+    BOOL includesQUIC = profile.includesQUICInParallel;
+    __block NSUInteger pendingBranches = includesQUIC ? 3 : 2;
+    __block RRProbeFailureReason httpFailureReason = RRProbeFailureReasonUnknown;
+    __block RRProbeFailureReason icmpFailureReason = RRProbeFailureReasonUnknown;
+    __block RRProbeFailureReason quicFailureReason = RRProbeFailureReasonUnknown;
     __block BOOL completionCalled = NO;
     
     dispatch_semaphore_t lock = dispatch_semaphore_create(1);
     
-    void (^checkCompletion)(void) = ^{
+    // Each branch is tagged with the single-probe mode it runs.
+    void (^branchCompleted)(RRProbeMode, BOOL, RRProbeFailureReason) = ^(RRProbeMode branch, BOOL reachable, RRProbeFailureReason failureReason) {
         dispatch_semaphore_wait(lock, DISPATCH_TIME_FOREVER);
+        pendingBranches -= 1;
+        switch (branch) {
+            case RRProbeModeHTTPOnly:
+                httpFailureReason = failureReason;
+                break;
+            case RRProbeModeICMPOnly:
+                icmpFailureReason = failureReason;
+                break;
+            default:
+                quicFailureReason = failureReason;
+                break;
+        }
         
-        // If either succeeds, return immediately
-        if ((httpResult || icmpResult) && !completionCalled) {
+        // If any branch succeeds, return immediately
+        if (reachable && !completionCalled) {
             completionCalled = YES;
             dispatch_semaphore_signal(lock);
-            completion(YES);
+            completion(YES, RRProbeFailureReasonNone);
             return;
         }
         
-        // If both are done and neither succeeded
-        if (httpDone && icmpDone && !completionCalled) {
+        // If all are done and none succeeded, report the HTTP reason (the more specific one)
+        if (pendingBranches == 0 && !completionCalled) {
             completionCalled = YES;
+            RRProbeFailureReason failureReason = httpFailureReason;
+            if (failureReason == RRProbeFailureReasonUnknown) {
+                failureReason = icmpFailureReason;
+            }
+            if (failureReason == RRProbeFailureReasonUnknown && includesQUIC) {
+                failureReason = quicFailureReason;
+            }
             dispatch_semaphore_signal(lock);
-            completion(NO);
+            completion(NO, failureReason);
             return;
         }
         
@@ -456,38 +1256,35 @@ static NSString * const kRRDefaultHTTPProbeURLString = @"https://www.gstatic.com
     
     // HTTP Probe
     dispatch_async(self.probeQueue, ^{
-        [self performHTTPProbeAllowingCellular:allowCellular completion:^(BOOL reachable) {
-            dispatch_semaphore_wait(lock, DISPATCH_TIME_FOREVER);
-            httpResult = reachable;
-            httpDone = YES;
-            dispatch_semaphore_signal(lock);
-            checkCompletion();
+        [self performHTTPProbeWithProfile:profile allowingCellular:allowCellular resources:resources completion:^(BOOL reachable, RRProbeFailureReason failureReason) {
+            branchCompleted(RRProbeModeHTTPOnly, reachable, failureReason);
         }];
     });
     
     // ICMP Probe
     dispatch_async(self.probeQueue, ^{
-        [self performICMPProbeWithCompletion:^(BOOL reachable) {
-            dispatch_semaphore_wait(lock, DISPATCH_TIME_FOREVER);
-            icmpResult = reachable;
-            icmpDone = YES;
-            dispatch_semaphore_signal(lock);
-            checkCompletion();
+        [self performICMPProbeWithProfile:profile resources:resources completion:^(BOOL reachable, RRProbeFailureReason failureReason) {
+            branchCompleted(RRProbeModeICMPOnly, reachable, failureReason);
         }];
     });
+    
+    // QUIC Probe
+    if (includesQUIC) {
+        dispatch_async(self.probeQueue, ^{
+            [self performQUICProbeWithProfile:profile resources:resources completion:^(BOOL reachable, RRProbeFailureReason failureReason) {
+                branchCompleted(RRProbeModeQUICOnly, reachable, failureReason);
+            }];
+        });
+    }
 }
 
-- (void)performHTTPProbeWithCompletion:(void (^)(BOOL reachable))completion {
-    [self performHTTPProbeAllowingCellular:YES completion:completion];
-}
-
-- (void)performHTTPProbeAllowingCellular:(BOOL)allowCellular completion:(void (^)(BOOL reachable))completion {
-    NSURL *baseURL = self.httpProbeURL;
+- (void)performHTTPProbeWithProfile:(RRProbeProfile *)profile allowingCellular:(BOOL)allowCellular resources:(RRProbeResources *)resources completion:(void (^)(BOOL reachable, RRProbeFailureReason failureReason))completion {
+    NSURL *baseURL = profile.httpProbeURL;
     NSURL *probeURL = [self probeURLByAppendingNonce:baseURL];
     NSMutableURLRequest *request = [NSMutableURLRequest requestWithURL:probeURL];
     request.HTTPMethod = @"HEAD";
     request.cachePolicy = NSURLRequestReloadIgnoringLocalAndRemoteCacheData;
-    request.timeoutInterval = self.timeout;
+    request.timeoutInterval = profile.timeout;
     request.allowsCellularAccess = allowCellular;
     [request setValue:@"no-cache" forHTTPHeaderField:@"Cache-Control"];
     [request setValue:@"no-cache" forHTTPHeaderField:@"Pragma"];
@@ -495,47 +1292,36 @@ static NSString * const kRRDefaultHTTPProbeURLString = @"https://www.gstatic.com
     NSURLSessionDataTask *task = [self.session dataTaskWithRequest:request
                                                  completionHandler:^(NSData *data, NSURLResponse *response, NSError *error) {
         if (error) {
-#if DEBUG
-            NSLog(@"[RRReachability][HTTPProbe] failed allowCellular=%@ error=%@",
-                  allowCellular ? @"YES" : @"NO",
-                  error);
-#endif
-            completion(NO);
+            RRLogDebug(@"http", @"failed allowCellular=%@ error=%@",
+                       allowCellular ? @"YES" : @"NO",
+                       error);
+            completion(NO, RRProbeFailureReasonFromError(error));
             return;
         }
         
         if (![response isKindOfClass:[NSHTTPURLResponse class]]) {
-#if DEBUG
-            NSLog(@"[RRReachability][HTTPProbe] failed allowCellular=%@ reason=non-http-response response=%@",
-                  allowCellular ? @"YES" : @"NO",
-                  response);
-#endif
-            completion(NO);
+            RRLogDebug(@"http", @"failed allowCellular=%@ reason=non-http-response response=%@",
+                       allowCellular ? @"YES" : @"NO",
+                       response);
+            completion(NO, RRProbeFailureReasonHTTPMismatch);
             return;
         }
         
         NSHTTPURLResponse *httpResponse = (NSHTTPURLResponse *)response;
         BOOL success = [self isSuccessfulHTTPProbeResponse:httpResponse expectedURL:baseURL];
-#if DEBUG
-        if (success) {
-            NSLog(@"[RRReachability][HTTPProbe] success allowCellular=%@ status=%ld responseURL=%@ expectedURL=%@",
-                  allowCellular ? @"YES" : @"NO",
-                  (long)httpResponse.statusCode,
-                  httpResponse.URL.absoluteString,
-                  baseURL.absoluteString);
-        }
-        if (!success) {
-            NSLog(@"[RRReachability][HTTPProbe] failed allowCellular=%@ status=%ld responseURL=%@ expectedURL=%@",
-                  allowCellular ? @"YES" : @"NO",
-                  (long)httpResponse.statusCode,
-                  httpResponse.URL.absoluteString,
-                  baseURL.absoluteString);
-        }
-#endif
-        completion(success);
+        RRLogDebug(@"http", @"%@ allowCellular=%@ status=%ld responseURL=%@ expectedURL=%@",
+                   success ? @"success" : @"failed",
+                   allowCellular ? @"YES" : @"NO",
+                   (long)httpResponse.statusCode,
+                   httpResponse.URL.absoluteString,
+                   baseURL.absoluteString);
+        completion(success, success ? RRProbeFailureReasonNone : RRProbeFailureReasonHTTPMismatch);
     }];
     
     [task resume];
+    [resources addCancelHandler:^{
+        [task cancel];
+    }];
 }
 
 - (NSURL *)probeURLByAppendingNonce:(NSURL *)url {
@@ -591,19 +1377,25 @@ static NSString * const kRRDefaultHTTPProbeURLString = @"https://www.gstatic.com
 }
 
 - (BOOL)probeModeSupportsHTTP {
-    return self.probeMode == RRProbeModeParallel || self.probeMode == RRProbeModeHTTPOnly;
+    return RRProbeModeSupportsHTTP(self.probeMode);
 }
 
 - (BOOL)validateCellularFallbackConfiguration {
+    // Cellular fallback only applies on Wi-Fi, so it is checked against the Wi-Fi profile.
+    RRProbeProfile *wifiProfile = [self effectiveProbeProfileForConnectionType:RRConnectionTypeWiFi];
+    return [self validateCellularFallbackConfigurationForProbeMode:wifiProfile.probeMode];
+}
+
+- (BOOL)validateCellularFallbackConfigurationForProbeMode:(RRProbeMode)probeMode {
     if (!self.allowCellularFallback) {
         return YES;
     }
     
-    if ([self probeModeSupportsHTTP]) {
+    if (RRProbeModeSupportsHTTP(probeMode)) {
         return YES;
     }
     
-    NSLog(@"[RRReachability] Configuration error: allowCellularFallback requires HTTP participation (probeMode must be RRProbeModeParallel or RRProbeModeHTTPOnly).");
+    RRLogError(@"engine", @"Configuration error: allowCellularFallback requires HTTP participation (probeMode must be RRProbeModeParallel or RRProbeModeHTTPOnly).");
     return NO;
 }
 
@@ -611,14 +1403,119 @@ static NSString * const kRRDefaultHTTPProbeURLString = @"https://www.gstatic.com
     return self.allowCellularFallback && (type == RRConnectionTypeWiFi);
 }
 
-- (void)performICMPProbeWithCompletion:(void (^)(BOOL reachable))completion {
-    // Use real ICMP ping via RRPingHelper
-    self.pingHelper.host = self.icmpHost;
-    self.pingHelper.timeout = self.timeout;
+- (void)performICMPProbeWithProfile:(RRProbeProfile *)profile resources:(RRProbeResources *)resources completion:(void (^)(BOOL reachable, RRProbeFailureReason failureReason))completion {
+    NSString *host = profile.icmpHost;
+    NSTimeInterval timeout = profile.timeout;
     
-    [self.pingHelper pingWithBlock:^(BOOL isSuccess, NSTimeInterval latency) {
-        completion(isSuccess);
+    // On IPv6-only paths an IPv4 literal is unroutable; rewrite it into the
+    // network's NAT64 address space instead of waiting out the timeout.
+    BOOL isIPv6OnlyPath = self.pathMonitor.supportsIPv6 && !self.pathMonitor.supportsIPv4;
+    if (isIPv6OnlyPath && [RRNAT64Resolver isIPv4Literal:host]) {
+        // Two Wi-Fi networks can have different NAT64 prefixes; key by the attached network.
+        NSString *networkKey = self.pathMonitor.networkFingerprint;
+        dispatch_async(self.probeQueue, ^{
+            RRNAT64Prefix *prefix = [self.nat64Resolver prefixForNetworkKey:networkKey];
+            NSString *target = [prefix synthesizedHostForIPv4Literal:host] ?: host;
+            [self performICMPProbeToHost:target timeout:timeout resources:resources completion:completion];
+        });
+        return;
+    }
+    
+    [self performICMPProbeToHost:host timeout:timeout resources:resources completion:completion];
+}
+
+/// The ping helper for one target; concurrent probes of the same target and timeout share its ping.
+- (RRPingHelper *)pingHelperForHost:(NSString *)host timeout:(NSTimeInterval)timeout {
+    NSString *key = [NSString stringWithFormat:@"%@|%.3f", host, timeout];
+    @synchronized(self) {
+        RRPingHelper *pingHelper = self.pingHelpers[key];
+        if (!pingHelper) {
+            pingHelper = [[RRPingHelper alloc] init];
+            pingHelper.host = host;
+            pingHelper.timeout = timeout;
+            self.pingHelpers[key] = pingHelper;
+        }
+        pingHelper.packetCapture = self.packetCapture;
+        return pingHelper;
+    }
+}
+
+- (void)performICMPProbeToHost:(NSString *)host timeout:(NSTimeInterval)timeout resources:(RRProbeResources *)resources completion:(void (^)(BOOL reachable, RRProbeFailureReason failureReason))completion {
+    RRPingHelper *pingHelper = [self pingHelperForHost:host timeout:timeout];
+    id pingToken = [pingHelper pingWithDetailedBlock:^(BOOL isSuccess, NSTimeInterval latency, RRProbeFailureReason failureReason) {
+        completion(isSuccess, failureReason);
     }];
+    [resources addCancelHandler:^{
+        // RRPingFoundation lives on the main thread
+        dispatch_async(dispatch_get_main_queue(), ^{
+            [pingHelper cancelPing:pingToken];
+        });
+    }];
+}
+
+- (void)performQUICProbeWithProfile:(RRProbeProfile *)profile resources:(RRProbeResources *)resources completion:(void (^)(BOOL reachable, RRProbeFailureReason failureReason))completion {
+    // Shared across profiles; the target is captured when the probe starts.
+    @synchronized(self.quicProber) {
+        self.quicProber.host = profile.quicHost;
+        self.quicProber.port = profile.quicPort;
+        self.quicProber.timeout = profile.timeout;
+        
+        RRQUICProber *quicProber = self.quicProber;
+        id probe = [quicProber probeWithCompletion:^(BOOL isSuccess, NSTimeInterval latency, RRProbeFailureReason failureReason) {
+            completion(isSuccess, failureReason);
+        }];
+        if (probe) {
+            [resources addCancelHandler:^{
+                [quicProber cancelProbe:probe];
+            }];
+        }
+    }
+}
+
+@end
+
+#pragma mark - RRReachabilityObservation
+
+@implementation RRReachabilityObservation {
+    __weak RRReachability *_reachability;
+    RRReachabilityObserver *_observer;
+}
+
+- (instancetype)initWithReachability:(RRReachability *)reachability observer:(RRReachabilityObserver *)observer {
+    self = [super init];
+    if (self) {
+        _reachability = reachability;
+        _observer = observer;
+    }
+    return self;
+}
+
+- (void)dealloc {
+    [self invalidate];
+}
+
+- (BOOL)isValid {
+    @synchronized(self) {
+        return _observer != nil;
+    }
+}
+
+- (void)invalidate {
+    RRReachabilityObserver *observer;
+    @synchronized(self) {
+        observer = _observer;
+        _observer = nil;
+    }
+    if (observer == nil) {
+        return;
+    }
+
+    RRReachability *reachability = _reachability;
+    if (reachability != nil) {
+        [reachability removeObserver:observer];
+    } else {
+        [observer cancel];
+    }
 }
 
 @end
@@ -0,0 +1,137 @@
+//
+//  RRLog.h
+//  RealReachability2ObjC
+//
+//  Created by RealReachability2 on 2026.
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/// Severity of a log record
+typedef NS_ENUM(NSInteger, RRLogLevel) {
+    RRLogLevelDebug,
+    RRLogLevelInfo,
+    RRLogLevelNotice,
+    RRLogLevelWarning,
+    RRLogLevelError,
+    /// Threshold only: disables logging
+    RRLogLevelOff
+};
+
+/// Display name of a level ("debug", "info", ...)
+FOUNDATION_EXPORT NSString *RRLogLevelName(RRLogLevel level);
+
+/// One formatted log record
+@interface RRLogRecord : NSObject
+
+@property (nonatomic, strong, readonly) NSDate *date;
+@property (nonatomic, assign, readonly) RRLogLevel level;
+
+/// Component the record comes from ("engine", "http", ...); rate limits apply per subsystem
+@property (nonatomic, copy, readonly) NSString *subsystem;
+@property (nonatomic, copy, readonly) NSString *message;
+
+/// Single-line rendering used by the text sinks
+@property (nonatomic, copy, readonly) NSString *formattedMessage;
+
+- (instancetype)initWithDate:(NSDate *)date
+                       level:(RRLogLevel)level
+                   subsystem:(NSString *)subsystem
+                     message:(NSString *)message NS_DESIGNATED_INITIALIZER;
+- (instancetype)init NS_UNAVAILABLE;
+
+@end
+
+/// Destination for log records. Called on the logging thread, so sinks should not block.
+@protocol RRLogSink <NSObject>
+- (void)writeRecord:(RRLogRecord *)record;
+@end
+
+/// Leveled logging for the library.
+///
+/// Call sites check a compile-time floor and then one atomically read threshold before any
+/// argument is evaluated or formatted. Debug records are compiled out of release builds unless
+/// the library is built with RR_LOG_VERBOSE defined; RR_LOG_QUIET also compiles out info and notice.
+@interface RRLogger : NSObject
+
+/// Runtime threshold (default: RRLogLevelDebug in DEBUG builds, RRLogLevelNotice otherwise).
+/// RRLogLevelOff disables logging.
+@property (class, nonatomic, assign) RRLogLevel minimumLevel;
+
+/// Most records each subsystem may emit per second; 0 means unlimited (default: 50).
+/// Dropped records are summarized in one notice when the next second starts.
+@property (class, nonatomic, assign) NSUInteger maximumRecordsPerSecond;
+
+/// Adds a sink; records go to every sink in order. The default sink is an RROSLogSink.
++ (void)addSink:(id<RRLogSink>)sink;
+
+/// Removes a sink added earlier, or the default one
++ (void)removeSink:(id<RRLogSink>)sink;
+
+/// Removes every sink, including the default one
++ (void)removeAllSinks;
+
+/// Whether a record at `level` passes the runtime threshold
++ (BOOL)isLevelEnabled:(RRLogLevel)level;
+
+/// Formats and dispatches a record, subject to the threshold and rate limit.
+/// Library code uses the RRLog* macros instead, which skip argument evaluation when disabled.
++ (void)logWithLevel:(RRLogLevel)level
+           subsystem:(NSString *)subsystem
+              format:(NSString *)format, ... NS_FORMAT_FUNCTION(3, 4);
+
+@end
+
+/// Keeps the most recent records in fixed, preallocated slots. Writers claim a slot with one
+/// atomic increment and publish it with a sequence number, so logging never takes a lock;
+/// snapshots skip slots that are being overwritten. Messages are truncated to 255 UTF-8 bytes.
+@interface RRRingBufferLogSink : NSObject <RRLogSink>
+
+/// Records kept before the oldest is overwritten
+@property (nonatomic, assign, readonly) NSUInteger capacity;
+
+/// Retained records, oldest first
+@property (nonatomic, copy, readonly) NSArray<RRLogRecord *> *records;
+
+- (instancetype)initWithCapacity:(NSUInteger)capacity NS_DESIGNATED_INITIALIZER;
+
+/// A ring with 256 slots
+- (instancetype)init;
+
+@end
+
+/// Writes formatted records to standard error
+@interface RRStandardErrorLogSink : NSObject <RRLogSink>
+@end
+
+/// Appends formatted records to a file on a background queue
+@interface RRFileLogSink : NSObject <RRLogSink>
+
+/// The file written to
+@property (nonatomic, copy, readonly) NSURL *fileURL;
+
+/// Opens (creating if needed) a file for appending; nil if it cannot be opened for writing.
+- (nullable instancetype)initWithFileURL:(NSURL *)fileURL NS_DESIGNATED_INITIALIZER;
+- (instancetype)init NS_UNAVAILABLE;
+
+/// Waits until every record written so far is in the file
+- (void)flush;
+
+@end
+
+/// Forwards records to the unified logging system, one category per subsystem
+@interface RROSLogSink : NSObject <RRLogSink>
+
+/// Subsystem identifier shown in Console
+@property (nonatomic, copy, readonly) NSString *subsystem;
+
+- (instancetype)initWithSubsystem:(NSString *)subsystem NS_DESIGNATED_INITIALIZER;
+
+/// A sink for the "com.realreachability2" subsystem
+- (instancetype)init;
+
+@end
+
+NS_ASSUME_NONNULL_END
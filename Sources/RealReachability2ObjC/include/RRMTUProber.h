@@ -0,0 +1,74 @@
+//
+//  RRMTUProber.h
+//  RealReachability2ObjC
+//
+//  Created by RealReachability2 on 2026.
+//
+
+#import <Foundation/Foundation.h>
+#import "RRProbeFailureReason.h"
+#import "RRPacketCapture.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+/// Completion block type for path MTU discovery
+typedef void (^RRMTUDiscoveryCompletionBlock)(NSUInteger pathMTU, RRProbeFailureReason failureReason);
+
+/// Completion block type for a single MTU probe
+typedef void (^RRMTUProbeCompletionBlock)(BOOL fits, RRProbeFailureReason failureReason);
+
+/// Discovers the path MTU to a host with ICMP echoes that must not be fragmented.
+/// Catches blackholed large packets (broken PMTUD on VPNs and tunnels) that small pings never hit.
+/// Each round probes several sizes in parallel and narrows the range to the gap between the
+/// largest size that got through and the smallest that did not. Results are cached per network.
+API_AVAILABLE(ios(12.0), macos(10.14))
+@interface RRMTUProber : NSObject
+
+/// The host to probe (default: 8.8.8.8)
+@property (nonatomic, copy) NSString *host;
+
+/// Timeout for each probe in seconds (default: 1.0). A probe is resent once halfway through.
+@property (nonatomic, assign) NSTimeInterval timeout;
+
+/// Smallest MTU searched (default: 1280, the IPv6 minimum)
+@property (nonatomic, assign) NSUInteger minimumMTU;
+
+/// Largest MTU searched (default: 1500, Ethernet)
+@property (nonatomic, assign) NSUInteger maximumMTU;
+
+/// Sizes probed in parallel per round (default: 4)
+@property (nonatomic, assign) NSUInteger parallelProbes;
+
+/// Records the packets of subsequent probes when set (default: nil); large probes are truncated
+/// to the capture's snap length.
+@property (nonatomic, strong, nullable) RRPacketCapture *packetCapture;
+
+/// Discovers the path MTU, or returns the cached value for the network.
+/// @param networkKey Identifies the current network; nil skips the cache.
+/// @param completion Called on the main queue with the MTU in bytes (IP header included), or 0 and
+///        the failure reason if not even `minimumMTU` got through.
+- (void)discoverPathMTUForNetworkKey:(nullable NSString *)networkKey
+                          completion:(RRMTUDiscoveryCompletionBlock)completion;
+
+/// The cached path MTU for a network, or 0 if it was not discovered yet.
+- (NSUInteger)cachedPathMTUForNetworkKey:(NSString *)networkKey;
+
+/// Drops all cached results, for example when the network goes away
+- (void)invalidate;
+
+/// Cancels a discovery in flight; its completion reports RRProbeFailureReasonCancelled.
+- (void)cancel;
+
+/// Sends one don't-fragment echo whose IP packet is `mtu` bytes. Called on the main thread;
+/// overridable so the search can be exercised without a real path.
+/// @param mtu IP packet size in bytes.
+/// @param completion Called on the main thread; `fits` is NO if the echo was too big or lost.
+- (void)probeMTU:(NSUInteger)mtu completion:(RRMTUProbeCompletionBlock)completion;
+
+/// Up to `count` distinct sizes spread evenly over [low, high], both ends included;
+/// every size in the range once it holds no more than `count` values.
++ (NSArray<NSNumber *> *)candidateMTUsFrom:(NSUInteger)low to:(NSUInteger)high count:(NSUInteger)count;
+
+@end
+
+NS_ASSUME_NONNULL_END
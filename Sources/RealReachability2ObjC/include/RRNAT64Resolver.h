@@ -0,0 +1,69 @@
+//
+//  RRNAT64Resolver.h
+//  RealReachability2ObjC
+//
+//  Created by RealReachability2 on 2026.
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/// Resolves a host name to its IPv6 (AAAA) addresses; each element is 16 raw bytes
+typedef NSArray<NSData *> * _Nonnull (^RRNAT64AddressResolver)(NSString *hostName);
+
+/// A NAT64 prefix (RFC 6052) discovered through DNS64 (RFC 7050)
+API_AVAILABLE(ios(12.0), macos(10.14))
+@interface RRNAT64Prefix : NSObject
+
+- (instancetype)init NS_UNAVAILABLE;
+
+/// Creates a prefix from 16 raw bytes; bytes past the prefix length are ignored.
+/// @param prefixData 16 bytes of IPv6 address.
+/// @param prefixLength Prefix length in bits (32, 40, 48, 56, 64 or 96).
+/// @returns The prefix, or nil if the length is not allowed by RFC 6052.
+- (nullable instancetype)initWithPrefixData:(NSData *)prefixData prefixLength:(NSUInteger)prefixLength NS_DESIGNATED_INITIALIZER;
+
+/// Extracts the prefix from a synthesized AAAA record of `ipv4only.arpa`.
+/// @param address 16 bytes of IPv6 address.
+/// @returns The prefix, or nil if no well-known IPv4 address is embedded.
++ (nullable instancetype)prefixFromSynthesizedAddress:(NSData *)address;
+
+/// Prefix bytes (16 bytes, everything past the prefix is zero)
+@property (nonatomic, copy, readonly) NSData *prefixData;
+
+/// Prefix length in bits
+@property (nonatomic, assign, readonly) NSUInteger prefixLength;
+
+/// Synthesizes an IPv6 literal for an IPv4 literal host.
+/// @param host IPv4 literal such as `8.8.8.8`.
+/// @returns IPv6 literal, or nil if `host` is not an IPv4 literal.
+- (nullable NSString *)synthesizedHostForIPv4Literal:(NSString *)host;
+
+@end
+
+/// Discovers and caches the NAT64 prefix once per network
+API_AVAILABLE(ios(12.0), macos(10.14))
+@interface RRNAT64Resolver : NSObject
+
+/// Creates a resolver that uses the system resolver via `getaddrinfo`
+- (instancetype)init;
+
+/// Creates a resolver with a custom AAAA lookup (for example a local DNS stand-in)
+- (instancetype)initWithAddressResolver:(RRNAT64AddressResolver)addressResolver NS_DESIGNATED_INITIALIZER;
+
+/// Returns the NAT64 prefix for a network, discovering it on first use.
+/// This may block on DNS; call it off the main thread.
+/// @param networkKey Identifies the current network; results are cached per key.
+/// @returns The prefix, or nil if the network has no DNS64/NAT64.
+- (nullable RRNAT64Prefix *)prefixForNetworkKey:(NSString *)networkKey;
+
+/// Drops all cached results, for example when the network goes away
+- (void)invalidate;
+
+/// Whether `host` is an IPv4 literal
++ (BOOL)isIPv4Literal:(NSString *)host;
+
+@end
+
+NS_ASSUME_NONNULL_END
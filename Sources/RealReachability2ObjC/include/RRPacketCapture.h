@@ -0,0 +1,61 @@
+//
+//  RRPacketCapture.h
+//  RealReachability2ObjC
+//
+//  Created by RealReachability2 on 2026.
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/// Which way a captured packet travelled
+typedef NS_ENUM(NSInteger, RRPacketDirection) {
+    RRPacketDirectionInbound,
+    RRPacketDirectionOutbound
+};
+
+/// Bounded in-memory capture of ICMP probe packets, exportable as pcapng for Wireshark.
+///
+/// Attach one to an RRPingFoundation, RRPingHelper, RRMTUProber or RRReachability to record every
+/// echo request sent and every packet read from the probe socket, including the ones rejected as
+/// unexpected. Storage for `capacity` packets of `snapLength` bytes is allocated up front; the
+/// oldest packet is overwritten when it is full. Without a capture attached, the probe path only
+/// checks for nil.
+@interface RRPacketCapture : NSObject
+
+/// Packets kept before the oldest is overwritten
+@property (nonatomic, assign, readonly) NSUInteger capacity;
+
+/// Bytes kept per packet, counting the IP header (at least 48); longer packets are truncated
+@property (nonatomic, assign, readonly) NSUInteger snapLength;
+
+/// Packets currently held
+@property (nonatomic, assign, readonly) NSUInteger packetCount;
+
+/// Packets recorded since creation or the last -clear, including overwritten ones
+@property (nonatomic, assign, readonly) NSUInteger totalPacketCount;
+
+- (instancetype)initWithCapacity:(NSUInteger)capacity snapLength:(NSUInteger)snapLength NS_DESIGNATED_INITIALIZER;
+
+/// A capture of 256 packets of 256 bytes
+- (instancetype)init;
+
+/// Records an ICMP packet exchanged with a peer. Called by the probe sockets.
+/// @param packet ICMP message as sent, or as read from the socket (IPv4 reads include the IP header).
+/// @param direction Whether the packet was sent or received.
+/// @param peerAddress `struct sockaddr_in` or `struct sockaddr_in6` of the remote host.
+- (void)recordPacket:(NSData *)packet direction:(RRPacketDirection)direction peerAddress:(NSData *)peerAddress;
+
+/// The held packets as a pcapng file, oldest first.
+/// Interface 0 carries IPv4 packets and interface 1 IPv6 packets, both as raw IP. Outbound packets
+/// and IPv6 replies are read from the socket without an IP header, so one is synthesized from the
+/// socket address; the local address in it is unspecified.
+- (NSData *)pcapngData;
+
+/// Drops every held packet
+- (void)clear;
+
+@end
+
+NS_ASSUME_NONNULL_END
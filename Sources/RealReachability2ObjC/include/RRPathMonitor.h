@@ -36,6 +36,15 @@ API_AVAILABLE(ios(12.0))
 /// Current connection type
 @property (nonatomic, readonly) RRConnectionType connectionType;
 
+/// Whether the current path can route IPv4 traffic
+@property (nonatomic, readonly) BOOL supportsIPv4;
+
+/// Whether the current path can route IPv6 traffic
+@property (nonatomic, readonly) BOOL supportsIPv6;
+
+/// Identifies the attached network (connection type, interfaces and gateways) for per-network caches
+@property (nonatomic, copy, readonly) NSString *networkFingerprint;
+
 /// Handler for path updates
 @property (nonatomic, copy, nullable) RRPathUpdateHandler pathUpdateHandler;
 
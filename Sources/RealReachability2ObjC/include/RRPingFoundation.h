@@ -11,6 +11,7 @@
 
 #import <Foundation/Foundation.h>
 #import <sys/socket.h>
+#import "RRPacketCapture.h"
 
 #if TARGET_OS_EMBEDDED || TARGET_IPHONE_SIMULATOR
 #import <CFNetwork/CFNetwork.h>
@@ -83,6 +84,14 @@ API_AVAILABLE(ios(12.0), macos(10.14))
 /// You should set this value before starting the object.
 @property (nonatomic, assign, readwrite) RRPingFoundationAddressStyle addressStyle;
 
+/// Sets the don't-fragment flag on outgoing pings, so a ping larger than the path MTU is
+/// dropped (or refused locally with EMSGSIZE) instead of being fragmented.
+/// You should set this value before starting the object.
+@property (nonatomic, assign, readwrite) BOOL dontFragment;
+
+/// Records sent and received packets when set (default: nil, no capture).
+@property (nonatomic, strong, readwrite, nullable) RRPacketCapture *packetCapture;
+
 /// The address being pinged.
 /// The contents of the NSData is a (struct sockaddr) of some form. The
 /// value is nil while the object is stopped and remains nil on start until
@@ -9,28 +9,48 @@
 //
 
 #import <Foundation/Foundation.h>
+#import "RRProbeFailureReason.h"
+#import "RRPacketCapture.h"
 
 NS_ASSUME_NONNULL_BEGIN
 
 /// Completion block type for ping operations
 typedef void (^RRPingCompletionBlock)(BOOL isSuccess, NSTimeInterval latency);
 
+/// Completion block type for ping operations that also reports why the ping failed
+typedef void (^RRPingDetailedCompletionBlock)(BOOL isSuccess, NSTimeInterval latency, RRProbeFailureReason failureReason);
+
 /// Helper class for ICMP ping operations
 /// Provides a simple block-based API for pinging hosts.
 API_AVAILABLE(ios(12.0), macos(10.14))
 @interface RRPingHelper : NSObject
 
 /// The host to ping. You MUST set this before calling pingWithBlock:.
+/// Changing it ends a ping in flight, whose callers get RRProbeFailureReasonCancelled.
 @property (nonatomic, copy, nullable) NSString *host;
 
 /// Ping timeout in seconds. Default is 2 seconds.
 @property (nonatomic, assign) NSTimeInterval timeout;
 
+/// Records the packets of subsequent pings when set (default: nil).
+@property (nonatomic, strong, nullable) RRPacketCapture *packetCapture;
+
 /// Triggers a ping action with a completion block.
 /// @param completion Async completion block called with success status and latency (in seconds).
 ///        Latency is 0 if ping failed.
 - (void)pingWithBlock:(RRPingCompletionBlock)completion;
 
+/// Triggers a ping action with a completion block that also receives the failure reason.
+/// @param completion Async completion block; failureReason is RRProbeFailureReasonNone on success.
+/// @return A token for cancelPing: that identifies this caller, or nil if completion is nil.
+- (nullable id)pingWithDetailedBlock:(RRPingDetailedCompletionBlock)completion;
+
+/// Withdraws one caller of pingWithDetailedBlock:, whose completion reports RRProbeFailureReasonCancelled.
+/// Other callers keep waiting for the ping; it is stopped only once nobody waits for it.
+/// Call on the main thread, like cancel.
+/// @param token The token pingWithDetailedBlock: returned.
+- (void)cancelPing:(id)token;
+
 /// Cancels any ongoing ping operation.
 - (void)cancel;
 
@@ -0,0 +1,67 @@
+//
+//  RRPingMulti.h
+//  RealReachability2ObjC
+//
+//  Created by RealReachability2 on 2026.
+//
+
+#import <Foundation/Foundation.h>
+#import "RRPingHelper.h"
+#import "RRPacketCapture.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+/// Identifies a ping added to an RRPingMulti; 0 is never a valid handle
+typedef NSUInteger RRPingHandle;
+
+/// ICMP pinger driven by the host application's own event loop (epoll, kqueue, libuv, asio,
+/// a dispatch source...), in the style of the curl multi and c-ares interfaces. It creates no
+/// thread, run loop source or timer and never blocks:
+///
+/// 1. Add pings with `-addPingToAddress:timeout:completion:`.
+/// 2. Watch every descriptor in `fileDescriptors` for readability and call
+///    `-handleReadableFileDescriptor:` when one is readable.
+/// 3. Arm one timer for `nextTimeoutInterval` and call `-handleTimeout` when it fires.
+///
+/// Completions run synchronously inside those calls, on the caller's thread. Hosts must be
+/// numeric IPv4 or IPv6 addresses, because name resolution would block; resolve names with the
+/// host loop's own resolver first. All pings share one ICMP socket per address family, opened on
+/// first use and kept open (so the descriptor set stays stable) until the object is deallocated.
+API_AVAILABLE(ios(12.0), macos(10.14))
+@interface RRPingMulti : NSObject
+
+/// Records sent and received packets when set (default: nil).
+@property (nonatomic, strong, nullable) RRPacketCapture *packetCapture;
+
+/// Pings sent and not yet completed
+@property (nonatomic, assign, readonly) NSUInteger activePingCount;
+
+/// Sockets to watch for readability
+@property (nonatomic, copy, readonly) NSIndexSet *fileDescriptors;
+
+/// Seconds until the earliest ping deadline, 0 if one has passed, or -1 with no ping active
+@property (nonatomic, assign, readonly) NSTimeInterval nextTimeoutInterval;
+
+/// Sends one echo request to `address`.
+/// @param address Numeric IPv4 or IPv6 address
+/// @param timeout Seconds to wait for the reply
+/// @param completion Called once with the outcome; latency is in seconds, 0 on failure
+/// @returns The ping's handle, or 0 if it could not be sent; `completion` has then already been
+///          called with the reason (invalid configuration for a non-numeric address)
+- (RRPingHandle)addPingToAddress:(NSString *)address
+                         timeout:(NSTimeInterval)timeout
+                      completion:(RRPingDetailedCompletionBlock)completion;
+
+/// Completes an active ping as cancelled; does nothing for a finished or unknown handle
+- (void)cancelPing:(RRPingHandle)handle;
+
+/// Reads every datagram queued on `fileDescriptor` and completes the pings they answer.
+/// Suitable for edge-triggered notification: the socket is drained.
+- (void)handleReadableFileDescriptor:(int)fileDescriptor;
+
+/// Completes every ping whose deadline has passed as timed out
+- (void)handleTimeout;
+
+@end
+
+NS_ASSUME_NONNULL_END
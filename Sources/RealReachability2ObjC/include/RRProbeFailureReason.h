@@ -0,0 +1,49 @@
+//
+//  RRProbeFailureReason.h
+//  RealReachability2ObjC
+//
+//  Created by RealReachability2 on 2026.
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/// Why a probe failed
+typedef NS_ENUM(NSInteger, RRProbeFailureReason) {
+    /// The probe succeeded
+    RRProbeFailureReasonNone,
+    /// Name resolution failed (for example NXDOMAIN or no DNS server)
+    RRProbeFailureReasonDNS,
+    /// The target actively refused the connection
+    RRProbeFailureReasonConnectionRefused,
+    /// An established connection was reset or lost mid-probe
+    RRProbeFailureReasonConnectionReset,
+    /// TLS handshake or certificate validation failed
+    RRProbeFailureReasonTLS,
+    /// No answer arrived before the probe timeout
+    RRProbeFailureReasonTimeout,
+    /// A response arrived but was not the expected one (for example a captive portal redirect)
+    RRProbeFailureReasonHTTPMismatch,
+    /// The local stack has no route for the probe (not connected, network unreachable)
+    RRProbeFailureReasonNoRoute,
+    /// The probe was cancelled before it finished
+    RRProbeFailureReasonCancelled,
+    /// The probe could not run with the current configuration
+    RRProbeFailureReasonInvalidConfiguration,
+    /// Any other failure
+    RRProbeFailureReasonUnknown,
+    /// The probe did not complete by the engine's hard deadline and was force-completed
+    RRProbeFailureReasonWatchdog
+};
+
+/// Whether a failure is worth retrying immediately (for example a connection reset)
+FOUNDATION_EXPORT BOOL RRProbeFailureReasonIsTransient(RRProbeFailureReason reason);
+
+/// Whether a failure will persist until the environment changes, so probing should back off
+FOUNDATION_EXPORT BOOL RRProbeFailureReasonWarrantsBackoff(RRProbeFailureReason reason);
+
+/// Maps an NSURLErrorDomain or POSIX/CFNetwork error to a failure reason
+FOUNDATION_EXPORT RRProbeFailureReason RRProbeFailureReasonFromError(NSError * _Nullable error);
+
+NS_ASSUME_NONNULL_END
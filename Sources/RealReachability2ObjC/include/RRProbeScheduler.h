@@ -0,0 +1,71 @@
+//
+//  RRProbeScheduler.h
+//  RealReachability2ObjC
+//
+//  Created by RealReachability2 on 2026.
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/// Admission class of probe work; higher classes are started first and may preempt lower ones
+typedef NS_ENUM(NSInteger, RRProbePriority) {
+    /// Diagnostics nobody is waiting on, such as path MTU discovery
+    RRProbePriorityBackgroundDiagnostic = 0,
+    /// Periodic re-probes of the current link
+    RRProbePriorityPeriodic,
+    /// Probes triggered by a path update
+    RRProbePriorityPathChange,
+    /// Checks an app is waiting on, such as -checkReachabilityWithCompletion:
+    RRProbePriorityUserInitiated
+};
+
+/// Cancels an operation in flight
+typedef void (^RRProbeCancelBlock)(void);
+
+/// Reports an operation's result; called exactly once, on any queue
+typedef void (^RRProbeOperationCompletion)(id _Nullable result);
+
+/// Starts probe work and returns a block that cancels it, or nil if it cannot be cancelled
+typedef RRProbeCancelBlock _Nullable (^RRProbeOperationBlock)(RRProbeOperationCompletion completion);
+
+/// Runs keyed probe work with bounded concurrency and priority admission.
+///
+/// A request for work that is already running or queued shares its result and raises its priority
+/// instead of starting a duplicate. When every slot is busy, a request of a higher class cancels the
+/// lowest running cancellable Periodic or BackgroundDiagnostic operation and takes its slot; the
+/// preempted operation is requeued and restarted from scratch, and its cancelled run is ignored.
+/// Queued work starts in priority order, first come first served within a class.
+@interface RRProbeScheduler : NSObject
+
+/// Operations allowed to run at once
+@property (nonatomic, assign, readonly) NSUInteger maximumConcurrentOperations;
+
+/// Operations started, counting restarts after preemption
+@property (nonatomic, assign, readonly) NSUInteger startedOperationCount;
+
+/// Requests answered by an operation already running or queued for the same key
+@property (nonatomic, assign, readonly) NSUInteger piggybackedRequestCount;
+
+/// Running operations cancelled and requeued to make room for higher-priority work
+@property (nonatomic, assign, readonly) NSUInteger preemptedOperationCount;
+
+- (instancetype)initWithMaximumConcurrentOperations:(NSUInteger)maximumConcurrentOperations NS_DESIGNATED_INITIALIZER;
+
+/// A scheduler running two operations at once
+- (instancetype)init;
+
+/// Runs `operation` for `key`, or joins the run already admitted for it.
+/// @param key Identifies the work; requests with equal keys share one run.
+/// @param priority Admission class; joining raises the run's class to the highest requested.
+/// @param operation Started when admitted. Ignored if the key is already running or queued.
+/// @param completion Called with the result on the queue the operation completed on.
+- (void)scheduleOperationForKey:(id<NSCopying>)key
+                       priority:(RRProbePriority)priority
+                      operation:(RRProbeOperationBlock)operation
+                     completion:(void (^)(id _Nullable result))completion;
+
+@end
+
+NS_ASSUME_NONNULL_END
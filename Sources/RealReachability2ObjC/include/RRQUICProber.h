@@ -0,0 +1,61 @@
+//
+//  RRQUICProber.h
+//  RealReachability2ObjC
+//
+//  Created by RealReachability2 on 2026.
+//
+
+#import <Foundation/Foundation.h>
+#import "RRProbeFailureReason.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+/// Completion block type for QUIC probes
+typedef void (^RRQUICProbeCompletionBlock)(BOOL isSuccess, NSTimeInterval latency, RRProbeFailureReason failureReason);
+
+/// Checks that UDP traffic (and with it HTTP/3) gets through.
+/// Sends one QUIC Initial packet with a reserved version to the target's UDP port and
+/// treats a Version Negotiation reply as success: one packet each way, no handshake.
+API_AVAILABLE(ios(12.0), macos(10.14))
+@interface RRQUICProber : NSObject
+
+/// The host to probe (default: www.gstatic.com)
+@property (nonatomic, copy) NSString *host;
+
+/// The UDP port to probe (default: 443)
+@property (nonatomic, assign) uint16_t port;
+
+/// Probe timeout in seconds (default: 5.0)
+@property (nonatomic, assign) NSTimeInterval timeout;
+
+/// Sends the probe. Each call uses its own UDP flow.
+/// @param completion Called once on a private queue; failureReason is RRProbeFailureReasonNone on success.
+///        Latency is in seconds, 0 if the probe failed.
+/// @return A handle for cancelProbe:, or nil if the probe failed at once for lack of a target.
+- (nullable id)probeWithCompletion:(RRQUICProbeCompletionBlock)completion;
+
+/// Cancels one probe, leaving the others in flight running; its completion reports RRProbeFailureReasonCancelled.
+/// @param probe The handle probeWithCompletion: returned.
+- (void)cancelProbe:(id)probe;
+
+/// Cancels all probes in flight; their completions report RRProbeFailureReasonCancelled.
+- (void)cancel;
+
+/// Builds a long-header Initial packet padded to the 1200-byte minimum datagram size.
+/// @param version A version from the reserved 0x?a?a?a?a space.
+/// @param destinationConnectionID Destination connection ID (at most 20 bytes).
+/// @param sourceConnectionID Source connection ID (at most 20 bytes).
++ (NSData *)probePacketWithVersion:(uint32_t)version
+           destinationConnectionID:(NSData *)destinationConnectionID
+                sourceConnectionID:(NSData *)sourceConnectionID;
+
+/// Whether a packet is a Version Negotiation reply to a probe: version 0, connection IDs echoed
+/// back swapped, and a non-empty version list that does not offer the probed version.
++ (BOOL)isVersionNegotiationPacket:(NSData *)packet
+                     probedVersion:(uint32_t)version
+           destinationConnectionID:(NSData *)destinationConnectionID
+                sourceConnectionID:(NSData *)sourceConnectionID;
+
+@end
+
+NS_ASSUME_NONNULL_END
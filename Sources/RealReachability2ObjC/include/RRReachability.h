@@ -7,6 +7,9 @@
 
 #import <Foundation/Foundation.h>
 #import "RRPathMonitor.h"
+#import "RRProbeFailureReason.h"
+#import "RRPacketCapture.h"
+#import "RRProbeScheduler.h"
 
 NS_ASSUME_NONNULL_BEGIN
 
@@ -22,6 +25,9 @@ FOUNDATION_EXPORT NSString * const kRRConnectionTypeKey;
 /// Key for the secondary-link reachability flag in the notification userInfo
 FOUNDATION_EXPORT NSString * const kRRSecondaryReachableKey;
 
+/// Key for the failure reason of the probe that produced the status in the notification userInfo
+FOUNDATION_EXPORT NSString * const kRRProbeFailureReasonKey;
+
 /// Reachability status
 typedef NS_ENUM(NSInteger, RRReachabilityStatus) {
     /// Network status is unknown
@@ -39,9 +45,69 @@ typedef NS_ENUM(NSInteger, RRProbeMode) {
     /// Use only HTTP HEAD probe
     RRProbeModeHTTPOnly,
     /// Use only ICMP ping probe
-    RRProbeModeICMPOnly
+    RRProbeModeICMPOnly,
+    /// Use only a QUIC version negotiation probe over UDP (detects networks that block HTTP/3)
+    RRProbeModeQUICOnly
 };
 
+/// Probe strategy for one connection type
+API_AVAILABLE(ios(12.0))
+@interface RRProbeProfile : NSObject <NSCopying>
+
+/// Probe mode (default: RRProbeModeParallel)
+@property (nonatomic, assign) RRProbeMode probeMode;
+
+/// Timeout for probe requests in seconds (default: 5.0)
+@property (nonatomic, assign) NSTimeInterval timeout;
+
+/// Interval between periodic probes in seconds (default: 5.0)
+@property (nonatomic, assign) NSTimeInterval periodicProbeInterval;
+
+/// HTTP probe URL (default: https://www.gstatic.com/generate_204)
+@property (nonatomic, strong) NSURL *httpProbeURL;
+
+/// ICMP ping host (default: 8.8.8.8)
+@property (nonatomic, copy) NSString *icmpHost;
+
+/// QUIC probe host (default: www.gstatic.com)
+@property (nonatomic, copy) NSString *quicHost;
+
+/// QUIC probe UDP port (default: 443)
+@property (nonatomic, assign) uint16_t quicPort;
+
+/// Adds the QUIC probe as a third branch of RRProbeModeParallel (default: NO)
+@property (nonatomic, assign) BOOL includesQUICInParallel;
+
+@end
+
+/// Snapshot of the reachability state delivered to block observers
+typedef struct {
+    RRReachabilityStatus status;
+    RRConnectionType connectionType;
+    /// Whether the status is reachable through the secondary fallback link
+    BOOL secondaryReachable;
+    /// Why the probe that produced the status failed; RRProbeFailureReasonNone on success
+    RRProbeFailureReason failureReason;
+} RRReachabilityState;
+
+/// Block observer of reachability changes
+typedef void (^RRReachabilityObserverBlock)(RRReachabilityState state);
+
+/// Registration of a block observer. The observer is removed when this token is invalidated or
+/// deallocated, so keep a strong reference for as long as changes should be delivered.
+API_AVAILABLE(ios(12.0))
+@interface RRReachabilityObservation : NSObject
+
+/// Whether the observer is still registered
+@property (nonatomic, readonly, getter=isValid) BOOL valid;
+
+/// Removes the observer; changes already queued for it are dropped. Safe to call more than once.
+- (void)invalidate;
+
+- (instancetype)init NS_UNAVAILABLE;
+
+@end
+
 /// Main reachability class with notification-based API
 API_AVAILABLE(ios(12.0))
 @interface RRReachability : NSObject
@@ -58,6 +124,12 @@ API_AVAILABLE(ios(12.0))
 /// Whether network is reachable through secondary fallback link (for example, cellular fallback while on Wi-Fi)
 @property (nonatomic, readonly) BOOL isSecondaryReachable;
 
+/// Why the most recent probe failed (RRProbeFailureReasonNone after a successful probe)
+@property (nonatomic, readonly) RRProbeFailureReason lastFailureReason;
+
+/// Number of probes the watchdog had to force-complete because a prober never called back
+@property (nonatomic, readonly) NSUInteger watchdogFireCount;
+
 /// Probe mode (default: RRProbeModeParallel)
 @property (nonatomic, assign) RRProbeMode probeMode;
 
@@ -73,8 +145,17 @@ API_AVAILABLE(ios(12.0))
 /// ICMP ping port (default: 53)
 @property (nonatomic, assign) uint16_t icmpPort;
 
+/// QUIC probe host (default: www.gstatic.com)
+@property (nonatomic, copy) NSString *quicHost;
+
+/// QUIC probe UDP port (default: 443)
+@property (nonatomic, assign) uint16_t quicPort;
+
+/// Adds the QUIC probe as a third branch of RRProbeModeParallel (default: NO)
+@property (nonatomic, assign) BOOL includesQUICInParallel;
+
 /// Enables cellular fallback when primary Wi-Fi probe fails (default: NO).
-/// Requires HTTP participation (.parallel or .httpOnly). Invalid with .icmpOnly.
+/// Requires HTTP participation (.parallel or .httpOnly). Invalid with .icmpOnly or .quicOnly.
 /// When enabled on Wi-Fi, probing uses HTTP primary/fallback checks and updates isSecondaryReachable.
 /// When disabled on Wi-Fi, primary HTTP probing keeps cellular access disabled.
 @property (nonatomic, assign) BOOL allowCellularFallback;
@@ -83,6 +164,19 @@ API_AVAILABLE(ios(12.0))
 /// When disabled, monitoring falls back to path-change-driven probing only.
 @property (nonatomic, assign) BOOL periodicProbeEnabled;
 
+/// Sets the probe profile for a connection type (for example ICMP-only on wired, sparse probing on cellular).
+/// Connection types without a profile use the top-level properties above.
+/// The profile is copied; the switch applies to the next probe on that link.
+/// @param profile The profile, or nil to remove the override.
+/// @param type The connection type it applies to.
+- (void)setProbeProfile:(nullable RRProbeProfile *)profile forConnectionType:(RRConnectionType)type;
+
+/// Returns the profile override for a connection type, or nil if it uses the top-level properties
+- (nullable RRProbeProfile *)probeProfileForConnectionType:(RRConnectionType)type;
+
+/// Profile in effect for the current connection type (an override, or one built from the top-level properties)
+@property (nonatomic, readonly) RRProbeProfile *activeProbeProfile;
+
 /// Starts the reachability notifier
 /// Posts kRRReachabilityChangedNotification when status, connection type, or secondary fallback state changes
 - (void)startNotifier;
@@ -90,13 +184,100 @@ API_AVAILABLE(ios(12.0))
 /// Stops the reachability notifier
 - (void)stopNotifier;
 
-/// Performs a one-time reachability check
+/// Pauses the running notifier while the app is idle: stops the periodic timer and the path
+/// monitor, cancels probes in flight and closes the ping, QUIC and path MTU sockets and the HTTP
+/// session's connections. The last status is kept and ages meanwhile (see `statusAge`).
+/// Does nothing unless the notifier is running and not suspended. Call on the main queue.
+- (void)suspend;
+
+/// Resumes a suspended notifier. Restarts the path monitor and periodic timer and probes the
+/// fresh path right away at RRProbePriorityUserInitiated instead of waiting for the next tick.
+/// Call on the main queue.
+/// @param completion Called on the main queue once the catch-up probe's outcome is applied, with
+///        how many seconds old the status was when resuming (-1 if none was known) and the status
+///        now. Without a suspended notifier it is called with the current status and no probe runs.
+- (void)resumeWithCompletion:(nullable void (^)(NSTimeInterval staleness, RRReachabilityStatus status))completion;
+
+/// Whether the notifier is running but suspended
+@property (nonatomic, readonly) BOOL isNotifierSuspended;
+
+/// Seconds since a probe or path update last set the status, or -1 before the first one
+@property (nonatomic, readonly) NSTimeInterval statusAge;
+
+/// Performs a one-time reachability check. Runs at RRProbePriorityUserInitiated, so it joins a probe
+/// of the same link already in flight instead of starting a second one.
 /// @param completion Callback with the reachability status and connection type
 - (void)checkReachabilityWithCompletion:(void (^)(RRReachabilityStatus status, RRConnectionType type))completion;
 
+/// Performs a one-time reachability check and reports why it failed
+/// @param completion Callback with the reachability status, connection type and failure reason
+- (void)checkReachabilityWithDetailedCompletion:(void (^)(RRReachabilityStatus status, RRConnectionType type, RRProbeFailureReason failureReason))completion;
+
+/// Discovers the path MTU to the active profile's ICMP host with don't-fragment pings.
+/// Results are cached per network (connection type, interfaces and gateways). Runs at
+/// RRProbePriorityBackgroundDiagnostic and is preempted, then restarted, when reachability
+/// probes need its slot.
+/// @param completion Called on the main queue with the MTU in bytes, or 0 and the failure reason.
+- (void)discoverPathMTUWithCompletion:(void (^)(NSUInteger pathMTU, RRProbeFailureReason failureReason))completion;
+
+/// Path MTU discovered for the current network, or 0 if not discovered yet
+@property (nonatomic, readonly) NSUInteger pathMTU;
+
+/// Records the packets of ICMP and path MTU probes when set (default: nil, no capture).
+/// Takes effect from the next probe.
+@property (nonatomic, strong, nullable) RRPacketCapture *packetCapture;
+
 /// Whether the notifier is currently running
 @property (nonatomic, readonly) BOOL isNotifierRunning;
 
+/// Admits reachability probes and path MTU discovery by priority. Path updates probe at
+/// RRProbePriorityPathChange and the periodic timer at RRProbePriorityPeriodic; its counts show how
+/// often requests piggybacked on work in flight or preempted it.
+@property (nonatomic, strong, readonly) RRProbeScheduler *probeScheduler;
+
+/// Probes this engine requested. Engines in one process share a coordinator: identical probes
+/// (same profile, link and network) in flight at once run as one network operation, and periodic
+/// timers fire on a shared clock so they line up.
+@property (nonatomic, readonly) NSUInteger requestedProbeCount;
+
+/// Probes this engine ran itself; the rest reused an identical probe another engine had in flight
+@property (nonatomic, readonly) NSUInteger performedProbeCount;
+
+/// Probes requested by every engine in the process
+@property (class, nonatomic, readonly) NSUInteger globalRequestedProbeCount;
+
+/// Network operations performed for those requests, over every engine in the process
+@property (class, nonatomic, readonly) NSUInteger globalPerformedProbeCount;
+
+/// Registers a block called with the new state whenever status, connection type, or secondary
+/// fallback state changes. Delivery passes a plain struct and allocates nothing per change.
+/// Each observer keeps the 8 most recent undelivered changes; if its queue falls further
+/// behind, the oldest are dropped so the latest state always arrives.
+/// @param queue Queue the block runs on; nil means the main queue, where it runs inline with the change.
+/// @param block Called once per change, in order.
+/// @returns A token that removes the observer when invalidated or deallocated.
+- (RRReachabilityObservation *)addObserverWithQueue:(nullable dispatch_queue_t)queue
+                                              block:(RRReachabilityObserverBlock)block;
+
+/// Posts kRRReachabilityChangedNotification on changes (default: YES). Apps that only use block
+/// observers can turn it off to skip building the userInfo dictionary on every change.
+@property (nonatomic, assign) BOOL postsChangeNotifications;
+
+/// Seconds over which changes are merged before reaching block observers and the notification
+/// (default: 0, every change delivered). The first change after a quiet period is delivered at
+/// once; later ones inside the window are merged, and only the net transition is delivered when
+/// it closes. Set on the main queue.
+@property (nonatomic, assign) NSTimeInterval statusDeliveryWindow;
+
+/// Delivers a change held by `statusDeliveryWindow` now, for transitions that must not wait
+- (void)flushStatusDelivery;
+
+/// Changes delivered to observers
+@property (nonatomic, readonly) NSUInteger deliveredStatusChangeCount;
+
+/// Changes merged away by `statusDeliveryWindow`
+@property (nonatomic, readonly) NSUInteger mergedStatusChangeCount;
+
 @end
 
 NS_ASSUME_NONNULL_END
@@ -18,3 +18,11 @@ FOUNDATION_EXPORT const unsigned char RealReachability2ObjCVersionString[];
 #import "RRPathMonitor.h"
 #import "RRPingFoundation.h"
 #import "RRPingHelper.h"
+#import "RRNAT64Resolver.h"
+#import "RRProbeFailureReason.h"
+#import "RRQUICProber.h"
+#import "RRMTUProber.h"
+#import "RRLog.h"
+#import "RRPacketCapture.h"
+#import "RRProbeScheduler.h"
+#import "RRPingMulti.h"
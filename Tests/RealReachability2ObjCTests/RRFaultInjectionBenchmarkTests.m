@@ -0,0 +1,569 @@
+//
+//  RRFaultInjectionBenchmarkTests.m
+//  RealReachability2ObjCTests
+//
+//  Runs RRReachability against a loopback probe target that fails on demand (blackhole,
+//  reset, latency spike, loss ramp, captive redirect) and measures how quickly outages and
+//  recoveries are noticed. Results are written as JSON in the same schema as the Swift suite;
+//  set RR_BENCHMARK_OUTPUT to the directory the report should go to.
+//
+
+#import <XCTest/XCTest.h>
+#import "RealReachability2ObjC.h"
+#import <netinet/in.h>
+#import <sys/socket.h>
+#import <unistd.h>
+
+/// How the probe target misbehaves
+typedef NS_ENUM(NSInteger, RRInjectedFault) {
+    /// Answers every probe
+    RRInjectedFaultNone,
+    /// Accepts connections and reads requests but never answers
+    RRInjectedFaultBlackhole,
+    /// Aborts the connection with a TCP reset on every request
+    RRInjectedFaultReset,
+    /// Answers every probe after `parameter` seconds
+    RRInjectedFaultDelay,
+    /// Drops a share of requests that grows linearly to all of them over `parameter` seconds
+    RRInjectedFaultLossRamp,
+    /// Redirects probes to a sign-in page, like a captive portal
+    RRInjectedFaultCaptiveRedirect
+};
+
+#pragma mark - RRBenchmarkPathMonitor
+
+/// Reports a satisfied Wi-Fi path, so the benchmark does not depend on the host's network
+@interface RRBenchmarkPathMonitor : RRPathMonitor
+@end
+
+@implementation RRBenchmarkPathMonitor
+
+- (BOOL)isSatisfied {
+    return YES;
+}
+
+- (RRConnectionType)connectionType {
+    return RRConnectionTypeWiFi;
+}
+
+- (NSString *)networkFingerprint {
+    return @"wifi|benchmark|";
+}
+
+- (void)startMonitoring {
+    dispatch_async(dispatch_get_main_queue(), ^{
+        if (self.pathUpdateHandler) {
+            self.pathUpdateHandler(YES, RRConnectionTypeWiFi);
+        }
+    });
+}
+
+- (void)stopMonitoring {}
+
+@end
+
+#pragma mark - RRFaultInjectingHTTPServer
+
+/// One accepted connection; only touched on the server's queue
+@interface RRFaultConnection : NSObject
+@property (nonatomic, assign) int fd;
+@property (nonatomic, strong) dispatch_source_t source;
+@property (nonatomic, strong) NSMutableData *buffer;
+/// Left unanswered by the current fault; further requests are ignored
+@property (nonatomic, assign) BOOL stalled;
+@end
+
+@implementation RRFaultConnection
+@end
+
+/// Loopback HTTP stand-in for the probe target that fails on demand
+@interface RRFaultInjectingHTTPServer : NSObject
+@property (nonatomic, assign, readonly) uint16_t port;
+/// Probe requests received, answered or not (sign-in page fetches are not counted)
+@property (nonatomic, assign, readonly) NSUInteger probeRequestCount;
+- (BOOL)start;
+- (void)stop;
+/// Switches to a new fault; connections the previous one left hanging are closed
+/// @param parameter Delay for RRInjectedFaultDelay, ramp duration for RRInjectedFaultLossRamp
+- (void)injectFault:(RRInjectedFault)fault parameter:(NSTimeInterval)parameter;
+@end
+
+@implementation RRFaultInjectingHTTPServer {
+    dispatch_queue_t _queue;
+    dispatch_source_t _acceptSource;
+    NSMutableSet<RRFaultConnection *> *_connections;
+    RRInjectedFault _fault;
+    NSTimeInterval _faultParameter;
+    NSTimeInterval _faultStart;
+    double _lossCredit;
+    NSUInteger _probeRequestCount;
+}
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        _queue = dispatch_queue_create("com.realreachability2.tests.faultinjection", DISPATCH_QUEUE_SERIAL);
+        _connections = [NSMutableSet set];
+        _fault = RRInjectedFaultNone;
+    }
+    return self;
+}
+
+- (BOOL)start {
+    int listenSocket = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (listenSocket < 0) {
+        return NO;
+    }
+
+    struct sockaddr_in address = {0};
+    address.sin_len = sizeof(address);
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t length = sizeof(address);
+    if (bind(listenSocket, (struct sockaddr *)&address, sizeof(address)) != 0 ||
+        listen(listenSocket, 16) != 0 ||
+        getsockname(listenSocket, (struct sockaddr *)&address, &length) != 0) {
+        close(listenSocket);
+        return NO;
+    }
+    _port = ntohs(address.sin_port);
+
+    __weak typeof(self) weakSelf = self;
+    _acceptSource = dispatch_source_create(DISPATCH_SOURCE_TYPE_READ, listenSocket, 0, _queue);
+    dispatch_source_set_event_handler(_acceptSource, ^{
+        int fd = accept(listenSocket, NULL, NULL);
+        __strong typeof(weakSelf) strongSelf = weakSelf;
+        if (fd < 0) {
+            return;
+        }
+        if (!strongSelf) {
+            close(fd);
+            return;
+        }
+        [strongSelf watchConnectionWithDescriptor:fd];
+    });
+    dispatch_source_set_cancel_handler(_acceptSource, ^{
+        close(listenSocket);
+    });
+    dispatch_resume(_acceptSource);
+    return YES;
+}
+
+- (void)stop {
+    dispatch_sync(_queue, ^{
+        if (self->_acceptSource) {
+            dispatch_source_cancel(self->_acceptSource);
+            self->_acceptSource = nil;
+        }
+        for (RRFaultConnection *connection in [self->_connections copy]) {
+            [self closeConnection:connection];
+        }
+    });
+}
+
+- (NSUInteger)probeRequestCount {
+    __block NSUInteger count = 0;
+    dispatch_sync(_queue, ^{
+        count = self->_probeRequestCount;
+    });
+    return count;
+}
+
+- (void)injectFault:(RRInjectedFault)fault parameter:(NSTimeInterval)parameter {
+    dispatch_sync(_queue, ^{
+        self->_fault = fault;
+        self->_faultParameter = parameter;
+        self->_faultStart = [NSProcessInfo processInfo].systemUptime;
+        self->_lossCredit = 0;
+        for (RRFaultConnection *connection in [self->_connections copy]) {
+            if (connection.stalled) {
+                [self closeConnection:connection];
+            }
+        }
+    });
+}
+
+- (void)watchConnectionWithDescriptor:(int)fd {
+    int noSigPipe = 1;
+    setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &noSigPipe, sizeof(noSigPipe));
+
+    RRFaultConnection *connection = [[RRFaultConnection alloc] init];
+    connection.fd = fd;
+    connection.buffer = [NSMutableData data];
+    connection.source = dispatch_source_create(DISPATCH_SOURCE_TYPE_READ, fd, 0, _queue);
+    [_connections addObject:connection];
+
+    __weak typeof(self) weakSelf = self;
+    __weak RRFaultConnection *weakConnection = connection;
+    dispatch_source_set_event_handler(connection.source, ^{
+        __strong typeof(weakSelf) strongSelf = weakSelf;
+        __strong RRFaultConnection *strongConnection = weakConnection;
+        if (strongSelf && strongConnection) {
+            [strongSelf readFromConnection:strongConnection];
+        }
+    });
+    dispatch_source_set_cancel_handler(connection.source, ^{
+        close(fd);
+    });
+    dispatch_resume(connection.source);
+}
+
+- (void)closeConnection:(RRFaultConnection *)connection {
+    if (![_connections containsObject:connection]) {
+        return;
+    }
+    [_connections removeObject:connection];
+    dispatch_source_cancel(connection.source);
+}
+
+- (void)readFromConnection:(RRFaultConnection *)connection {
+    uint8_t bytes[4096];
+    ssize_t received = read(connection.fd, bytes, sizeof(bytes));
+    if (received <= 0) {
+        [self closeConnection:connection];
+        return;
+    }
+    if (connection.stalled) {
+        return;
+    }
+    [connection.buffer appendBytes:bytes length:(NSUInteger)received];
+
+    NSData *terminator = [@"\r\n\r\n" dataUsingEncoding:NSUTF8StringEncoding];
+    while (!connection.stalled && [_connections containsObject:connection]) {
+        NSRange headerEnd = [connection.buffer rangeOfData:terminator options:0 range:NSMakeRange(0, connection.buffer.length)];
+        if (headerEnd.location == NSNotFound) {
+            return;
+        }
+        NSString *head = [[NSString alloc] initWithData:[connection.buffer subdataWithRange:NSMakeRange(0, headerEnd.location)]
+                                               encoding:NSUTF8StringEncoding];
+        [connection.buffer replaceBytesInRange:NSMakeRange(0, NSMaxRange(headerEnd)) withBytes:NULL length:0];
+
+        NSArray<NSString *> *requestLine = [[head componentsSeparatedByString:@"\r\n"].firstObject componentsSeparatedByString:@" "];
+        if (requestLine.count < 2) {
+            [self closeConnection:connection];
+            return;
+        }
+        [self handleRequestWithMethod:requestLine[0] path:requestLine[1] onConnection:connection];
+    }
+}
+
+/// Answers one request as the current fault dictates; called on the server's queue
+- (void)handleRequestWithMethod:(NSString *)method path:(NSString *)path onConnection:(RRFaultConnection *)connection {
+    BOOL isPortal = [path hasPrefix:@"/portal"];
+    BOOL dropped = NO;
+    if (!isPortal) {
+        _probeRequestCount += 1;
+        if (_fault == RRInjectedFaultLossRamp) {
+            // Drops are spread evenly: the credit accumulates the current loss rate.
+            NSTimeInterval elapsed = [NSProcessInfo processInfo].systemUptime - _faultStart;
+            _lossCredit += _faultParameter > 0 ? MIN(elapsed / _faultParameter, 1.0) : 1.0;
+            if (_lossCredit >= 1) {
+                _lossCredit -= 1;
+                dropped = YES;
+            }
+        }
+    }
+
+    switch (_fault) {
+        case RRInjectedFaultBlackhole:
+            connection.stalled = YES;
+            break;
+        case RRInjectedFaultReset: {
+            // A zero linger time makes close() abort the connection with a reset.
+            struct linger resetOnClose = {.l_onoff = 1, .l_linger = 0};
+            setsockopt(connection.fd, SOL_SOCKET, SO_LINGER, &resetOnClose, sizeof(resetOnClose));
+            [self closeConnection:connection];
+            break;
+        }
+        case RRInjectedFaultDelay: {
+            NSString *response = [self responseForMethod:method status:@"204 No Content" headers:@"" body:@""];
+            dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(_faultParameter * NSEC_PER_SEC)), _queue, ^{
+                if ([self->_connections containsObject:connection]) {
+                    [self sendResponse:response onConnection:connection];
+                }
+            });
+            break;
+        }
+        case RRInjectedFaultCaptiveRedirect:
+            if (isPortal) {
+                [self sendResponse:[self responseForMethod:method status:@"200 OK" headers:@"" body:@"<html><body>Sign in to continue</body></html>"]
+                      onConnection:connection];
+            } else {
+                [self sendResponse:[self responseForMethod:method status:@"302 Found" headers:@"Location: /portal\r\n" body:@""]
+                      onConnection:connection];
+            }
+            break;
+        case RRInjectedFaultLossRamp:
+        case RRInjectedFaultNone:
+            if (dropped) {
+                connection.stalled = YES;
+            } else {
+                [self sendResponse:[self responseForMethod:method status:(isPortal ? @"200 OK" : @"204 No Content") headers:@"" body:@""]
+                      onConnection:connection];
+            }
+            break;
+    }
+}
+
+/// An HTTP/1.1 response; HEAD responses announce the body without sending it
+- (NSString *)responseForMethod:(NSString *)method status:(NSString *)status headers:(NSString *)headers body:(NSString *)body {
+    NSUInteger length = [body lengthOfBytesUsingEncoding:NSUTF8StringEncoding];
+    return [NSString stringWithFormat:@"HTTP/1.1 %@\r\n%@Content-Length: %lu\r\n\r\n%@",
+            status, headers, (unsigned long)length, [method isEqualToString:@"HEAD"] ? @"" : body];
+}
+
+- (void)sendResponse:(NSString *)response onConnection:(RRFaultConnection *)connection {
+    NSData *data = [response dataUsingEncoding:NSUTF8StringEncoding];
+    if (send(connection.fd, data.bytes, data.length, 0) < 0) {
+        [self closeConnection:connection];
+    }
+}
+
+@end
+
+#pragma mark - RRFaultInjectionBenchmarkTests
+
+/// A change between reachable and not reachable, at the uptime it was delivered
+@interface RRStatusTransition : NSObject
+@property (nonatomic, assign) NSTimeInterval time;
+@property (nonatomic, assign) BOOL reachable;
+@end
+
+@implementation RRStatusTransition
+@end
+
+@interface RRFaultInjectionBenchmarkTests : XCTestCase
+@end
+
+@implementation RRFaultInjectionBenchmarkTests
+
+- (BOOL)setUpWithError:(NSError **)error {
+    // Timing measurements on shared runners are noise; run locally
+    XCTSkipIf([[NSProcessInfo processInfo].environment[@"CI"] isEqualToString:@"true"],
+              @"Skipping time-to-detect benchmark on CI environment");
+    return YES;
+}
+
+/// Uptime of the first change to the given state at or after `after`, or -1
+- (NSTimeInterval)firstTransitionToReachable:(BOOL)reachable after:(NSTimeInterval)after inTimeline:(NSArray<RRStatusTransition *> *)timeline {
+    for (RRStatusTransition *transition in timeline) {
+        if (transition.time >= after && transition.reachable == reachable) {
+            return transition.time;
+        }
+    }
+    return -1;
+}
+
+/// Runs the main run loop until the change shows up; the result is the time it was delivered,
+/// so the polling period does not skew the measurement.
+- (NSTimeInterval)waitForTransitionToReachable:(BOOL)reachable
+                                         after:(NSTimeInterval)after
+                                       timeout:(NSTimeInterval)timeout
+                                    inTimeline:(NSArray<RRStatusTransition *> *)timeline {
+    NSTimeInterval deadline = [NSProcessInfo processInfo].systemUptime + timeout;
+    NSTimeInterval time = -1;
+    while ((time = [self firstTransitionToReachable:reachable after:after inTimeline:timeline]) < 0 &&
+           [NSProcessInfo processInfo].systemUptime < deadline) {
+        [[NSRunLoop mainRunLoop] runUntilDate:[NSDate dateWithTimeIntervalSinceNow:0.01]];
+    }
+    return time;
+}
+
+- (void)spinFor:(NSTimeInterval)seconds {
+    [[NSRunLoop mainRunLoop] runUntilDate:[NSDate dateWithTimeIntervalSinceNow:seconds]];
+}
+
+/// Brings a fresh engine up against a healthy target, injects the fault, clears it once the
+/// outage was reported (or after a while, for faults that are not outages) and watches the
+/// engine settle.
+- (NSDictionary *)runFault:(RRInjectedFault)fault
+                 parameter:(NSTimeInterval)parameter
+                      name:(NSString *)name
+             expectsOutage:(BOOL)expectsOutage
+         configurationName:(NSString *)configurationName
+                   timeout:(NSTimeInterval)timeout
+                  interval:(NSTimeInterval)interval {
+    RRFaultInjectingHTTPServer *server = [[RRFaultInjectingHTTPServer alloc] init];
+    XCTAssertTrue([server start]);
+    NSURL *url = [NSURL URLWithString:[NSString stringWithFormat:@"http://127.0.0.1:%u/generate_204", server.port]];
+
+    RRReachability *reachability = [[RRReachability alloc] init];
+    [reachability setValue:[[RRBenchmarkPathMonitor alloc] init] forKey:@"pathMonitor"];
+    reachability.probeMode = RRProbeModeHTTPOnly;
+    reachability.timeout = timeout;
+    reachability.httpProbeURL = url;
+    RRProbeProfile *profile = [[RRProbeProfile alloc] init];
+    profile.probeMode = RRProbeModeHTTPOnly;
+    profile.timeout = timeout;
+    profile.periodicProbeInterval = interval;
+    profile.httpProbeURL = url;
+    [reachability setProbeProfile:profile forConnectionType:RRConnectionTypeWiFi];
+
+    NSMutableArray<RRStatusTransition *> *timeline = [NSMutableArray array];
+    RRReachabilityObservation *observation = [reachability addObserverWithQueue:nil block:^(RRReachabilityState state) {
+        BOOL reachable = (state.status == RRReachabilityStatusReachable);
+        if (state.status == RRReachabilityStatusUnknown || (timeline.count > 0 && timeline.lastObject.reachable == reachable)) {
+            return;
+        }
+        RRStatusTransition *transition = [[RRStatusTransition alloc] init];
+        transition.time = [NSProcessInfo processInfo].systemUptime;
+        transition.reachable = reachable;
+        [timeline addObject:transition];
+    }];
+    [reachability startNotifier];
+
+    NSTimeInterval detectionBudget = timeout * 4 + interval * 8 + 2;
+    NSTimeInterval baseline = [self waitForTransitionToReachable:YES after:0 timeout:5 inTimeline:timeline];
+    XCTAssertGreaterThanOrEqual(baseline, 0, @"%@/%@: the healthy target was not reported reachable", configurationName, name);
+    [self spinFor:interval * 2];
+
+    NSTimeInterval faultStart = [NSProcessInfo processInfo].systemUptime;
+    NSUInteger requestsBefore = server.probeRequestCount;
+    [server injectFault:fault parameter:parameter];
+
+    NSTimeInterval down = -1;
+    if (expectsOutage) {
+        NSTimeInterval budget = detectionBudget + (fault == RRInjectedFaultLossRamp ? parameter : 0);
+        down = [self waitForTransitionToReachable:NO after:faultStart timeout:budget inTimeline:timeline];
+        [self spinFor:interval * 2];
+    } else {
+        [self spinFor:interval * 6];
+        down = [self firstTransitionToReachable:NO after:faultStart inTimeline:timeline];
+    }
+
+    NSTimeInterval faultEnd = [NSProcessInfo processInfo].systemUptime;
+    [server injectFault:RRInjectedFaultNone parameter:0];
+    NSTimeInterval up = -1;
+    if (down >= 0) {
+        up = [self waitForTransitionToReachable:YES after:faultEnd timeout:detectionBudget inTimeline:timeline];
+    }
+    NSUInteger probesSpent = server.probeRequestCount - requestsBefore;
+    [self spinFor:interval * 2];
+
+    [observation invalidate];
+    [reachability stopNotifier];
+    [server stop];
+
+    NSInteger transitions = 0;
+    for (RRStatusTransition *transition in timeline) {
+        if (transition.time > baseline) {
+            transitions += 1;
+        }
+    }
+    NSInteger expectedTransitions = (down >= 0 ? 1 : 0) + (up >= 0 ? 1 : 0);
+
+    NSMutableDictionary *result = [@{
+        @"engine": @"objc",
+        @"configuration": configurationName,
+        @"timeout": @(timeout),
+        @"periodicProbeInterval": @(interval),
+        @"fault": name,
+        @"expectsOutage": @(expectsOutage),
+        @"falseTransitions": @(transitions - expectedTransitions),
+        @"probesSpent": @(probesSpent)
+    } mutableCopy];
+    // Like the Swift report, times that were never reported are omitted.
+    if (down >= 0) {
+        result[@"timeToDetectDown"] = @(down - faultStart);
+    }
+    if (up >= 0) {
+        result[@"timeToDetectUp"] = @(up - faultEnd);
+    }
+    return result;
+}
+
+- (void)testTimeToDetectUnderInjectedFaults {
+    NSArray<NSArray *> *configurations = @[
+        @[@"fast", @0.5, @0.5],
+        @[@"standard", @1.0, @1.0]
+    ];
+
+    NSMutableArray<NSDictionary *> *results = [NSMutableArray array];
+    for (NSArray *configuration in configurations) {
+        NSString *configurationName = configuration[0];
+        NSTimeInterval timeout = [configuration[1] doubleValue];
+        NSTimeInterval interval = [configuration[2] doubleValue];
+        NSArray<NSArray *> *scenarios = @[
+            @[@"blackhole", @(RRInjectedFaultBlackhole), @0, @YES],
+            @[@"reset", @(RRInjectedFaultReset), @0, @YES],
+            @[@"latency-spike", @(RRInjectedFaultDelay), @(timeout * 0.5), @NO],
+            @[@"loss-ramp", @(RRInjectedFaultLossRamp), @(interval * 4), @YES],
+            @[@"captive-redirect", @(RRInjectedFaultCaptiveRedirect), @0, @YES]
+        ];
+
+        for (NSArray *scenario in scenarios) {
+            NSString *name = scenario[0];
+            BOOL expectsOutage = [scenario[3] boolValue];
+            NSDictionary *result = [self runFault:(RRInjectedFault)[scenario[1] integerValue]
+                                        parameter:[scenario[2] doubleValue]
+                                             name:name
+                                    expectsOutage:expectsOutage
+                                configurationName:configurationName
+                                          timeout:timeout
+                                         interval:interval];
+            [results addObject:result];
+
+            if (expectsOutage) {
+                XCTAssertNotNil(result[@"timeToDetectDown"], @"%@/%@: outage not detected", configurationName, name);
+                XCTAssertNotNil(result[@"timeToDetectUp"], @"%@/%@: recovery not detected", configurationName, name);
+            } else {
+                XCTAssertNil(result[@"timeToDetectDown"], @"%@/%@: reported an outage that was not one", configurationName, name);
+            }
+            [self assertResultWithinSchedule:result
+                                   lossRamp:[scenario[1] integerValue] == RRInjectedFaultLossRamp
+                                    timeout:timeout
+                                   interval:interval];
+        }
+    }
+
+    NSDictionary *report = @{
+        @"suite": @"fault-injection-time-to-detect",
+        @"schemaVersion": @1,
+        @"generatedAt": [[[NSISO8601DateFormatter alloc] init] stringFromDate:[NSDate date]],
+        @"platform": [NSProcessInfo processInfo].operatingSystemVersionString,
+        @"results": results
+    };
+    NSError *error = nil;
+    NSData *json = [NSJSONSerialization dataWithJSONObject:report
+                                                   options:NSJSONWritingPrettyPrinted | NSJSONWritingSortedKeys
+                                                     error:&error];
+    XCTAssertNotNil(json, @"%@", error);
+
+    NSString *directory = [NSProcessInfo processInfo].environment[@"RR_BENCHMARK_OUTPUT"] ?: NSTemporaryDirectory();
+    NSString *path = [directory stringByAppendingPathComponent:@"RealReachability2-fault-benchmark-objc.json"];
+    XCTAssertTrue([json writeToFile:path atomically:YES]);
+}
+
+/// Holds a result to what the periodic schedule allows. A change is reported within two
+/// intervals plus two probe timeouts (the tick, then a retry after a transient failure).
+/// The fault window costs at most two probes per interval, plus a few for in-flight work.
+- (void)assertResultWithinSchedule:(NSDictionary *)result
+                          lossRamp:(BOOL)lossRamp
+                           timeout:(NSTimeInterval)timeout
+                          interval:(NSTimeInterval)interval {
+    NSString *label = [NSString stringWithFormat:@"%@/%@", result[@"configuration"], result[@"fault"]];
+    BOOL expectsOutage = [result[@"expectsOutage"] boolValue];
+    NSNumber *down = result[@"timeToDetectDown"];
+    NSNumber *up = result[@"timeToDetectUp"];
+    NSTimeInterval reportBound = interval * 2 + timeout * 2 + 1;
+
+    NSTimeInterval window = interval * 6;
+    if (expectsOutage && down && up) {
+        window = down.doubleValue + interval * 2 + up.doubleValue;
+        XCTAssertLessThanOrEqual(up.doubleValue, reportBound, @"%@: recovery reported late", label);
+        // Drops ramp up gradually, so the first failing probe can come late and the status may flap.
+        if (!lossRamp) {
+            XCTAssertLessThanOrEqual(down.doubleValue, reportBound, @"%@: outage reported late", label);
+            XCTAssertEqual([result[@"falseTransitions"] integerValue], 0, @"%@: status flapped", label);
+        }
+    } else if (!expectsOutage) {
+        XCTAssertEqual([result[@"falseTransitions"] integerValue], 0, @"%@: status flapped", label);
+    }
+
+    NSInteger probesSpent = [result[@"probesSpent"] integerValue];
+    NSInteger probeBudget = (NSInteger)ceil(window / interval) * 2 + 4;
+    XCTAssertGreaterThanOrEqual(probesSpent, expectsOutage ? 2 : 3, @"%@: the target was not probed through the fault", label);
+    XCTAssertLessThanOrEqual(probesSpent, probeBudget, @"%@: probed more than the schedule allows", label);
+}
+
+@end
@@ -7,16 +7,33 @@
 
 #import <XCTest/XCTest.h>
 #import "RealReachability2ObjC.h"
+#import <arpa/inet.h>
+#import <netinet/in.h>
+#import <sys/select.h>
+#import <sys/socket.h>
+#import <unistd.h>
 
 @interface RRReachabilityTests : XCTestCase
 
 @end
 
+/// Engine-private record of the resources one probe has started
+@interface RRProbeResources : NSObject
+- (void)addCancelHandler:(dispatch_block_t)handler;
+@end
+
 @interface RRReachability (TestHooks)
 - (void)updateStatus:(RRReachabilityStatus)status connectionType:(RRConnectionType)type;
 - (void)updateStatus:(RRReachabilityStatus)status connectionType:(RRConnectionType)type secondaryReachable:(BOOL)secondaryReachable;
-- (void)performProbeWithCompletion:(void (^)(BOOL reachable))completion;
-- (void)performHTTPProbeAllowingCellular:(BOOL)allowCellular completion:(void (^)(BOOL reachable))completion;
+- (void)updateStatus:(RRReachabilityStatus)status connectionType:(RRConnectionType)type secondaryReachable:(BOOL)secondaryReachable failureReason:(RRProbeFailureReason)failureReason;
+- (void)performProbeWithProfile:(RRProbeProfile *)profile resources:(RRProbeResources *)resources completion:(void (^)(BOOL reachable, RRProbeFailureReason failureReason))completion;
+- (void)performHTTPProbeWithProfile:(RRProbeProfile *)profile allowingCellular:(BOOL)allowCellular resources:(RRProbeResources *)resources completion:(void (^)(BOOL reachable, RRProbeFailureReason failureReason))completion;
+- (void)performParallelProbeWithProfile:(RRProbeProfile *)profile allowingCellular:(BOOL)allowCellular resources:(RRProbeResources *)resources completion:(void (^)(BOOL reachable, RRProbeFailureReason failureReason))completion;
+- (void)performICMPProbeWithProfile:(RRProbeProfile *)profile resources:(RRProbeResources *)resources completion:(void (^)(BOOL reachable, RRProbeFailureReason failureReason))completion;
+- (void)performQUICProbeWithProfile:(RRProbeProfile *)profile resources:(RRProbeResources *)resources completion:(void (^)(BOOL reachable, RRProbeFailureReason failureReason))completion;
+- (void)notifyObserversOfState:(RRReachabilityState)state;
+- (void)performProbeForConnectionType:(RRConnectionType)type completion:(void (^)(BOOL reachable, BOOL secondaryReachable, RRProbeFailureReason failureReason))completion;
+- (void)performICMPProbeToHost:(NSString *)host timeout:(NSTimeInterval)timeout resources:(RRProbeResources *)resources completion:(void (^)(BOOL reachable, RRProbeFailureReason failureReason))completion;
 @end
 
 @interface RRPathMonitorFake : RRPathMonitor
@@ -38,14 +55,36 @@
 
 @interface RRReachabilityProbeStub : RRReachability
 @property (nonatomic, assign) BOOL stubProbeReachable;
+@property (nonatomic, assign) RRProbeFailureReason stubFailureReason;
+@property (nonatomic, assign) NSUInteger probeCount;
+@property (nonatomic, strong) RRProbeProfile *lastProfile;
 @end
 
 @implementation RRReachabilityProbeStub
 
-- (void)performProbeWithCompletion:(void (^)(BOOL reachable))completion {
+- (void)performProbeWithProfile:(RRProbeProfile *)profile resources:(RRProbeResources *)resources completion:(void (^)(BOOL reachable, RRProbeFailureReason failureReason))completion {
+    self.probeCount += 1;
+    self.lastProfile = profile;
     if (completion) {
-        completion(self.stubProbeReachable);
+        completion(self.stubProbeReachable, self.stubProbeReachable ? RRProbeFailureReasonNone : self.stubFailureReason);
+    }
+}
+
+@end
+
+/// Answers after a short delay, so probes from several engines overlap
+@interface RRReachabilitySlowProbeStub : RRReachabilityProbeStub
+@end
+
+@implementation RRReachabilitySlowProbeStub
+
+- (void)performProbeWithProfile:(RRProbeProfile *)profile resources:(RRProbeResources *)resources completion:(void (^)(BOOL reachable, RRProbeFailureReason failureReason))completion {
+    @synchronized(self) {
+        self.probeCount += 1;
     }
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(0.1 * NSEC_PER_SEC)), dispatch_get_main_queue(), ^{
+        completion(YES, RRProbeFailureReasonNone);
+    });
 }
 
 @end
@@ -57,16 +96,252 @@
 
 @implementation RRReachabilityHTTPProbeCaptureStub
 
-- (void)performHTTPProbeAllowingCellular:(BOOL)allowCellular completion:(void (^)(BOOL reachable))completion {
+- (void)performHTTPProbeWithProfile:(RRProbeProfile *)profile allowingCellular:(BOOL)allowCellular resources:(RRProbeResources *)resources completion:(void (^)(BOOL reachable, RRProbeFailureReason failureReason))completion {
     self.didPerformHTTPProbe = YES;
     self.lastAllowsCellular = allowCellular;
     if (completion) {
-        completion(YES);
+        completion(YES, RRProbeFailureReasonNone);
     }
 }
 
 @end
 
+@interface RRReachabilityHungProbeStub : RRReachability
+@end
+
+@implementation RRReachabilityHungProbeStub
+
+- (void)performProbeWithProfile:(RRProbeProfile *)profile resources:(RRProbeResources *)resources completion:(void (^)(BOOL reachable, RRProbeFailureReason failureReason))completion {
+    // Never calls back, like a prober whose callback got lost
+}
+
+@end
+
+/// Hangs its first probe and holds later ones until the test answers them, recording whose resources get released
+@interface RRReachabilityOneHungProbeStub : RRReachability
+@property (nonatomic, strong) NSMutableArray<NSNumber *> *releasedProbes;
+@property (nonatomic, copy) void (^heldCompletion)(BOOL reachable, RRProbeFailureReason failureReason);
+@property (nonatomic, assign) NSUInteger probeCount;
+@end
+
+@implementation RRReachabilityOneHungProbeStub
+
+- (void)performProbeWithProfile:(RRProbeProfile *)profile resources:(RRProbeResources *)resources completion:(void (^)(BOOL reachable, RRProbeFailureReason failureReason))completion {
+    NSUInteger probeIndex;
+    @synchronized(self) {
+        probeIndex = self.probeCount;
+        self.probeCount += 1;
+    }
+    [resources addCancelHandler:^{
+        @synchronized(self) {
+            [self.releasedProbes addObject:@(probeIndex)];
+        }
+    }];
+    if (probeIndex > 0) {
+        self.heldCompletion = completion;
+    }
+}
+
+@end
+
+/// Fails the HTTP and ICMP branches so only the QUIC branch can make a parallel probe succeed
+@interface RRReachabilityParallelBranchStub : RRReachability
+@property (nonatomic, assign) NSUInteger quicProbeCount;
+@end
+
+@implementation RRReachabilityParallelBranchStub
+
+- (void)performHTTPProbeWithProfile:(RRProbeProfile *)profile allowingCellular:(BOOL)allowCellular resources:(RRProbeResources *)resources completion:(void (^)(BOOL reachable, RRProbeFailureReason failureReason))completion {
+    completion(NO, RRProbeFailureReasonTimeout);
+}
+
+- (void)performICMPProbeWithProfile:(RRProbeProfile *)profile resources:(RRProbeResources *)resources completion:(void (^)(BOOL reachable, RRProbeFailureReason failureReason))completion {
+    completion(NO, RRProbeFailureReasonTimeout);
+}
+
+- (void)performQUICProbeWithProfile:(RRProbeProfile *)profile resources:(RRProbeResources *)resources completion:(void (^)(BOOL reachable, RRProbeFailureReason failureReason))completion {
+    @synchronized(self) {
+        self.quicProbeCount += 1;
+    }
+    completion(YES, RRProbeFailureReasonNone);
+}
+
+@end
+
+/// IPv6-only path whose network fingerprint the test switches, as when roaming between networks
+@interface RRIPv6OnlyPathMonitorFake : RRPathMonitorFake
+@property (nonatomic, copy) NSString *fakeFingerprint;
+@end
+
+@implementation RRIPv6OnlyPathMonitorFake
+
+- (BOOL)supportsIPv4 {
+    return NO;
+}
+
+- (BOOL)supportsIPv6 {
+    return YES;
+}
+
+- (NSString *)networkFingerprint {
+    return self.fakeFingerprint;
+}
+
+@end
+
+/// Records the hosts ICMP probes were sent to instead of pinging them
+@interface RRReachabilityICMPTargetStub : RRReachability
+@property (nonatomic, strong) NSMutableArray<NSString *> *pingedHosts;
+@end
+
+@implementation RRReachabilityICMPTargetStub
+
+- (void)performICMPProbeToHost:(NSString *)host timeout:(NSTimeInterval)timeout resources:(RRProbeResources *)resources completion:(void (^)(BOOL reachable, RRProbeFailureReason failureReason))completion {
+    @synchronized(self) {
+        [self.pingedHosts addObject:host];
+    }
+    completion(YES, RRProbeFailureReasonNone);
+}
+
+@end
+
+/// Simulates a path that blackholes packets above `pathLimit`, answering asynchronously
+@interface RRMTUProberPathStub : RRMTUProber
+@property (nonatomic, assign) NSUInteger pathLimit;
+@property (nonatomic, strong) NSMutableArray<NSNumber *> *probedMTUs;
+@property (nonatomic, assign) NSUInteger inFlight;
+@property (nonatomic, assign) NSUInteger peakInFlight;
+@end
+
+@implementation RRMTUProberPathStub
+
+- (void)probeMTU:(NSUInteger)mtu completion:(RRMTUProbeCompletionBlock)completion {
+    if (!self.probedMTUs) {
+        self.probedMTUs = [NSMutableArray array];
+    }
+    [self.probedMTUs addObject:@(mtu)];
+    self.inFlight += 1;
+    self.peakInFlight = MAX(self.peakInFlight, self.inFlight);
+    
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(0.01 * NSEC_PER_SEC)), dispatch_get_main_queue(), ^{
+        self.inFlight -= 1;
+        BOOL fits = mtu <= self.pathLimit;
+        completion(fits, fits ? RRProbeFailureReasonNone : RRProbeFailureReasonTimeout);
+    });
+}
+
+@end
+
+/// Local UDP stand-in for a QUIC server that answers every datagram with Version Negotiation
+@interface RRQUICResponder : NSObject
+@property (nonatomic, assign, readonly) uint16_t port;
+@property (nonatomic, assign, readonly) NSUInteger receivedDatagramCount;
+@property (nonatomic, copy, nullable) NSData *replyOverride;
+- (BOOL)start;
+- (void)stop;
++ (nullable NSData *)replyToProbe:(NSData *)probe supportedVersions:(NSArray<NSNumber *> *)versions;
+@end
+
+@implementation RRQUICResponder {
+    int _socket;
+    dispatch_source_t _source;
+    NSUInteger _receivedDatagramCount;
+}
+
+- (BOOL)start {
+    _socket = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (_socket < 0) {
+        return NO;
+    }
+    
+    struct sockaddr_in address = {0};
+    address.sin_len = sizeof(address);
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t length = sizeof(address);
+    if (bind(_socket, (struct sockaddr *)&address, sizeof(address)) != 0 ||
+        getsockname(_socket, (struct sockaddr *)&address, &length) != 0) {
+        close(_socket);
+        return NO;
+    }
+    _port = ntohs(address.sin_port);
+    
+    int fd = _socket;
+    __weak typeof(self) weakSelf = self;
+    _source = dispatch_source_create(DISPATCH_SOURCE_TYPE_READ, fd, 0, dispatch_get_global_queue(QOS_CLASS_DEFAULT, 0));
+    dispatch_source_set_event_handler(_source, ^{
+        uint8_t buffer[2048];
+        struct sockaddr_storage peer;
+        socklen_t peerLength = sizeof(peer);
+        ssize_t received = recvfrom(fd, buffer, sizeof(buffer), 0, (struct sockaddr *)&peer, &peerLength);
+        __strong typeof(weakSelf) strongSelf = weakSelf;
+        if (received <= 0 || !strongSelf) {
+            return;
+        }
+        
+        @synchronized(strongSelf) {
+            strongSelf->_receivedDatagramCount += 1;
+        }
+        NSData *probe = [NSData dataWithBytes:buffer length:(NSUInteger)received];
+        NSData *reply = strongSelf.replyOverride ?: [RRQUICResponder replyToProbe:probe supportedVersions:@[@1]];
+        if (reply) {
+            sendto(fd, reply.bytes, reply.length, 0, (struct sockaddr *)&peer, peerLength);
+        }
+    });
+    dispatch_source_set_cancel_handler(_source, ^{
+        close(fd);
+    });
+    dispatch_resume(_source);
+    return YES;
+}
+
+- (void)stop {
+    if (_source) {
+        dispatch_source_cancel(_source);
+        _source = nil;
+    }
+}
+
+- (NSUInteger)receivedDatagramCount {
+    @synchronized(self) {
+        return _receivedDatagramCount;
+    }
+}
+
++ (NSData *)replyToProbe:(NSData *)probe supportedVersions:(NSArray<NSNumber *> *)versions {
+    const uint8_t *bytes = probe.bytes;
+    if (probe.length < 7) {
+        return nil;
+    }
+    NSUInteger destinationLength = bytes[5];
+    if (probe.length < 7 + destinationLength) {
+        return nil;
+    }
+    NSUInteger sourceLength = bytes[6 + destinationLength];
+    if (probe.length < 7 + destinationLength + sourceLength) {
+        return nil;
+    }
+    NSData *destination = [probe subdataWithRange:NSMakeRange(6, destinationLength)];
+    NSData *source = [probe subdataWithRange:NSMakeRange(7 + destinationLength, sourceLength)];
+    
+    NSMutableData *reply = [NSMutableData data];
+    uint8_t header[5] = {0x80, 0, 0, 0, 0};
+    [reply appendBytes:header length:sizeof(header)];
+    uint8_t length = (uint8_t)source.length;
+    [reply appendBytes:&length length:1];
+    [reply appendData:source];
+    length = (uint8_t)destination.length;
+    [reply appendBytes:&length length:1];
+    [reply appendData:destination];
+    for (NSNumber *version in versions) {
+        uint32_t networkVersion = CFSwapInt32HostToBig(version.unsignedIntValue);
+        [reply appendBytes:&networkVersion length:sizeof(networkVersion)];
+    }
+    return reply;
+}
+
+@end
+
 @implementation RRReachabilityTests
 
 - (void)drainMainQueue {
@@ -163,6 +438,12 @@
     XCTAssertEqual(reachability.probeMode, RRProbeModeICMPOnly, @"Should be able to set ICMP only mode");
 }
 
+- (void)testSetProbeModeQUICOnly {
+    RRReachability *reachability = [[RRReachability alloc] init];
+    reachability.probeMode = RRProbeModeQUICOnly;
+    XCTAssertEqual(reachability.probeMode, RRProbeModeQUICOnly, @"Should be able to set QUIC only mode");
+}
+
 - (void)testSwitchBetweenProbeModes {
     RRReachability *reachability = [[RRReachability alloc] init];
     
@@ -267,6 +548,28 @@
     [self waitForExpectationsWithTimeout:1.0 handler:nil];
 }
 
+- (void)testICMPOnlyWithAllowCellularFallbackReportsInvalidConfiguration {
+    RRReachabilityProbeStub *reachability = [[RRReachabilityProbeStub alloc] init];
+    RRPathMonitorFake *fakeMonitor = [[RRPathMonitorFake alloc] init];
+    
+    [reachability setValue:fakeMonitor forKey:@"pathMonitor"];
+    [fakeMonitor setValue:@(YES) forKey:@"isSatisfied"];
+    [fakeMonitor setValue:@(RRConnectionTypeWiFi) forKey:@"connectionType"];
+    
+    reachability.probeMode = RRProbeModeICMPOnly;
+    reachability.allowCellularFallback = YES;
+    
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Invalid fallback configuration should be reported as such"];
+    [reachability checkReachabilityWithDetailedCompletion:^(RRReachabilityStatus status, RRConnectionType type, RRProbeFailureReason failureReason) {
+        XCTAssertEqual(status, RRReachabilityStatusNotReachable);
+        XCTAssertEqual(failureReason, RRProbeFailureReasonInvalidConfiguration);
+        XCTAssertEqual(reachability.lastFailureReason, RRProbeFailureReasonInvalidConfiguration);
+        [expectation fulfill];
+    }];
+    
+    [self waitForExpectationsWithTimeout:1.0 handler:nil];
+}
+
 - (void)testHTTPOnlyProbeDisablesCellularOnWiFiWhenFallbackDisabled {
     RRReachabilityHTTPProbeCaptureStub *reachability = [[RRReachabilityHTTPProbeCaptureStub alloc] init];
     RRPathMonitorFake *fakeMonitor = [[RRPathMonitorFake alloc] init];
@@ -313,6 +616,185 @@
     [self waitForExpectationsWithTimeout:1.0 handler:nil];
 }
 
+#pragma mark - Probe Profile Tests
+
+- (void)testProbeProfileDefaults {
+    RRProbeProfile *profile = [[RRProbeProfile alloc] init];
+    XCTAssertEqual(profile.probeMode, RRProbeModeParallel);
+    XCTAssertEqual(profile.timeout, 5.0);
+    XCTAssertEqual(profile.periodicProbeInterval, 5.0);
+    XCTAssertEqualObjects(profile.httpProbeURL.absoluteString, @"https://www.gstatic.com/generate_204");
+    XCTAssertEqualObjects(profile.icmpHost, @"8.8.8.8");
+    XCTAssertEqualObjects(profile.quicHost, @"www.gstatic.com");
+    XCTAssertEqual(profile.quicPort, 443);
+    XCTAssertFalse(profile.includesQUICInParallel);
+}
+
+- (void)testSetProbeProfileStoresCopy {
+    RRReachability *reachability = [[RRReachability alloc] init];
+    RRProbeProfile *profile = [[RRProbeProfile alloc] init];
+    profile.probeMode = RRProbeModeICMPOnly;
+    
+    [reachability setProbeProfile:profile forConnectionType:RRConnectionTypeWired];
+    profile.probeMode = RRProbeModeHTTPOnly;
+    
+    XCTAssertEqual([reachability probeProfileForConnectionType:RRConnectionTypeWired].probeMode, RRProbeModeICMPOnly);
+    XCTAssertNil([reachability probeProfileForConnectionType:RRConnectionTypeCellular]);
+    
+    [reachability setProbeProfile:nil forConnectionType:RRConnectionTypeWired];
+    XCTAssertNil([reachability probeProfileForConnectionType:RRConnectionTypeWired]);
+}
+
+- (void)testProbeUsesProfileOfCurrentConnectionType {
+    RRReachabilityProbeStub *reachability = [[RRReachabilityProbeStub alloc] init];
+    RRPathMonitorFake *fakeMonitor = [[RRPathMonitorFake alloc] init];
+    [reachability setValue:fakeMonitor forKey:@"pathMonitor"];
+    [fakeMonitor setValue:@(YES) forKey:@"isSatisfied"];
+    reachability.stubProbeReachable = YES;
+    
+    RRProbeProfile *wiredProfile = [[RRProbeProfile alloc] init];
+    wiredProfile.probeMode = RRProbeModeICMPOnly;
+    wiredProfile.timeout = 1.0;
+    [reachability setProbeProfile:wiredProfile forConnectionType:RRConnectionTypeWired];
+    
+    [fakeMonitor setValue:@(RRConnectionTypeWired) forKey:@"connectionType"];
+    XCTestExpectation *wiredExpectation = [self expectationWithDescription:@"Wired probe should use the wired profile"];
+    [reachability checkReachabilityWithCompletion:^(RRReachabilityStatus status, RRConnectionType type) {
+        XCTAssertEqual(reachability.lastProfile.probeMode, RRProbeModeICMPOnly);
+        XCTAssertEqual(reachability.lastProfile.timeout, 1.0);
+        [wiredExpectation fulfill];
+    }];
+    [self waitForExpectationsWithTimeout:1.0 handler:nil];
+    
+    [fakeMonitor setValue:@(RRConnectionTypeCellular) forKey:@"connectionType"];
+    XCTestExpectation *cellularExpectation = [self expectationWithDescription:@"Cellular probe should fall back to top-level settings"];
+    [reachability checkReachabilityWithCompletion:^(RRReachabilityStatus status, RRConnectionType type) {
+        XCTAssertEqual(reachability.lastProfile.probeMode, reachability.probeMode);
+        XCTAssertEqual(reachability.lastProfile.timeout, reachability.timeout);
+        [cellularExpectation fulfill];
+    }];
+    [self waitForExpectationsWithTimeout:1.0 handler:nil];
+}
+
+#pragma mark - Failure Reason Tests
+
+- (void)testProbeFailureReasonFromURLErrors {
+    XCTAssertEqual(RRProbeFailureReasonFromError([NSError errorWithDomain:NSURLErrorDomain code:NSURLErrorCannotFindHost userInfo:nil]), RRProbeFailureReasonDNS);
+    XCTAssertEqual(RRProbeFailureReasonFromError([NSError errorWithDomain:NSURLErrorDomain code:NSURLErrorCannotConnectToHost userInfo:nil]), RRProbeFailureReasonConnectionRefused);
+    XCTAssertEqual(RRProbeFailureReasonFromError([NSError errorWithDomain:NSURLErrorDomain code:NSURLErrorNetworkConnectionLost userInfo:nil]), RRProbeFailureReasonConnectionReset);
+    XCTAssertEqual(RRProbeFailureReasonFromError([NSError errorWithDomain:NSURLErrorDomain code:NSURLErrorServerCertificateUntrusted userInfo:nil]), RRProbeFailureReasonTLS);
+    XCTAssertEqual(RRProbeFailureReasonFromError([NSError errorWithDomain:NSURLErrorDomain code:NSURLErrorTimedOut userInfo:nil]), RRProbeFailureReasonTimeout);
+    XCTAssertEqual(RRProbeFailureReasonFromError([NSError errorWithDomain:NSURLErrorDomain code:NSURLErrorNotConnectedToInternet userInfo:nil]), RRProbeFailureReasonNoRoute);
+    XCTAssertEqual(RRProbeFailureReasonFromError([NSError errorWithDomain:NSURLErrorDomain code:NSURLErrorCancelled userInfo:nil]), RRProbeFailureReasonCancelled);
+    XCTAssertEqual(RRProbeFailureReasonFromError(nil), RRProbeFailureReasonUnknown);
+}
+
+- (void)testProbeFailureReasonFromPOSIXErrors {
+    XCTAssertEqual(RRProbeFailureReasonFromError([NSError errorWithDomain:NSPOSIXErrorDomain code:EHOSTUNREACH userInfo:nil]), RRProbeFailureReasonNoRoute);
+    XCTAssertEqual(RRProbeFailureReasonFromError([NSError errorWithDomain:NSPOSIXErrorDomain code:ECONNREFUSED userInfo:nil]), RRProbeFailureReasonConnectionRefused);
+    XCTAssertEqual(RRProbeFailureReasonFromError([NSError errorWithDomain:NSPOSIXErrorDomain code:ECONNRESET userInfo:nil]), RRProbeFailureReasonConnectionReset);
+}
+
+- (void)testProbeFailureReasonClassification {
+    XCTAssertTrue(RRProbeFailureReasonIsTransient(RRProbeFailureReasonConnectionReset));
+    XCTAssertFalse(RRProbeFailureReasonIsTransient(RRProbeFailureReasonTimeout));
+    XCTAssertTrue(RRProbeFailureReasonWarrantsBackoff(RRProbeFailureReasonDNS));
+    XCTAssertFalse(RRProbeFailureReasonWarrantsBackoff(RRProbeFailureReasonHTTPMismatch));
+}
+
+- (void)testCheckReachabilityRetriesTransientFailureOnce {
+    RRReachabilityProbeStub *reachability = [[RRReachabilityProbeStub alloc] init];
+    RRPathMonitorFake *fakeMonitor = [[RRPathMonitorFake alloc] init];
+    
+    [reachability setValue:fakeMonitor forKey:@"pathMonitor"];
+    [fakeMonitor setValue:@(YES) forKey:@"isSatisfied"];
+    [fakeMonitor setValue:@(RRConnectionTypeCellular) forKey:@"connectionType"];
+    
+    reachability.probeMode = RRProbeModeICMPOnly;
+    reachability.stubProbeReachable = NO;
+    reachability.stubFailureReason = RRProbeFailureReasonConnectionReset;
+    
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Transient failure should be retried once"];
+    [reachability checkReachabilityWithDetailedCompletion:^(RRReachabilityStatus status, RRConnectionType type, RRProbeFailureReason failureReason) {
+        XCTAssertEqual(status, RRReachabilityStatusNotReachable);
+        XCTAssertEqual(failureReason, RRProbeFailureReasonConnectionReset);
+        XCTAssertEqual(reachability.probeCount, 2);
+        [expectation fulfill];
+    }];
+    
+    [self waitForExpectationsWithTimeout:1.0 handler:nil];
+}
+
+- (void)testCheckReachabilityReportsNoRouteWhenPathUnsatisfied {
+    RRReachability *reachability = [[RRReachability alloc] init];
+    RRPathMonitorFake *fakeMonitor = [[RRPathMonitorFake alloc] init];
+    [reachability setValue:fakeMonitor forKey:@"pathMonitor"];
+    [fakeMonitor setValue:@(NO) forKey:@"isSatisfied"];
+    
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Unsatisfied path should report no route"];
+    [reachability checkReachabilityWithDetailedCompletion:^(RRReachabilityStatus status, RRConnectionType type, RRProbeFailureReason failureReason) {
+        XCTAssertEqual(status, RRReachabilityStatusNotReachable);
+        XCTAssertEqual(failureReason, RRProbeFailureReasonNoRoute);
+        [expectation fulfill];
+    }];
+    
+    [self waitForExpectationsWithTimeout:1.0 handler:nil];
+}
+
+- (void)testWatchdogForceCompletesHungProbe {
+    RRReachabilityHungProbeStub *reachability = [[RRReachabilityHungProbeStub alloc] init];
+    RRPathMonitorFake *fakeMonitor = [[RRPathMonitorFake alloc] init];
+    [reachability setValue:fakeMonitor forKey:@"pathMonitor"];
+    [fakeMonitor setValue:@(YES) forKey:@"isSatisfied"];
+    [fakeMonitor setValue:@(RRConnectionTypeWired) forKey:@"connectionType"];
+    
+    reachability.probeMode = RRProbeModeICMPOnly;
+    reachability.timeout = 0.1;
+    XCTAssertEqual(reachability.watchdogFireCount, 0);
+    
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Hung probe should be force-completed by the watchdog"];
+    [reachability checkReachabilityWithDetailedCompletion:^(RRReachabilityStatus status, RRConnectionType type, RRProbeFailureReason failureReason) {
+        XCTAssertEqual(status, RRReachabilityStatusNotReachable);
+        XCTAssertEqual(failureReason, RRProbeFailureReasonWatchdog);
+        XCTAssertEqual(reachability.watchdogFireCount, 1);
+        [expectation fulfill];
+    }];
+    
+    [self waitForExpectationsWithTimeout:5.0 handler:nil];
+}
+
+- (void)testWatchdogReleasesOnlyTheHungProbesResources {
+    RRReachabilityOneHungProbeStub *reachability = [[RRReachabilityOneHungProbeStub alloc] init];
+    reachability.releasedProbes = [NSMutableArray array];
+    RRProbeProfile *hungProfile = [[RRProbeProfile alloc] init];
+    hungProfile.probeMode = RRProbeModeICMPOnly;
+    hungProfile.timeout = 0.1;
+    RRProbeProfile *slowProfile = [[RRProbeProfile alloc] init];
+    slowProfile.probeMode = RRProbeModeICMPOnly;
+    slowProfile.timeout = 5.0;
+    [reachability setProbeProfile:hungProfile forConnectionType:RRConnectionTypeWired];
+    [reachability setProbeProfile:slowProfile forConnectionType:RRConnectionTypeWiFi];
+    
+    XCTestExpectation *hungFinished = [self expectationWithDescription:@"Hung probe should be force-completed"];
+    [reachability performProbeForConnectionType:RRConnectionTypeWired completion:^(BOOL reachable, BOOL secondaryReachable, RRProbeFailureReason failureReason) {
+        XCTAssertEqual(failureReason, RRProbeFailureReasonWatchdog);
+        [hungFinished fulfill];
+    }];
+    XCTestExpectation *slowFinished = [self expectationWithDescription:@"Concurrent probe should finish on its own"];
+    [reachability performProbeForConnectionType:RRConnectionTypeWiFi completion:^(BOOL reachable, BOOL secondaryReachable, RRProbeFailureReason failureReason) {
+        XCTAssertTrue(reachable);
+        XCTAssertEqual(failureReason, RRProbeFailureReasonNone);
+        [slowFinished fulfill];
+    }];
+    
+    [self waitForExpectations:@[hungFinished] timeout:5.0];
+    XCTAssertEqualObjects(reachability.releasedProbes, @[@0], @"Only the hung probe's resources should be released");
+    
+    reachability.heldCompletion(YES, RRProbeFailureReasonNone);
+    [self waitForExpectations:@[slowFinished] timeout:1.0];
+    XCTAssertEqual(reachability.watchdogFireCount, 1);
+}
+
 #pragma mark - Notifier Lifecycle Tests
 
 - (void)testNotifierNotRunningInitially {
@@ -415,6 +897,7 @@
     XCTAssertEqual(RRProbeModeParallel, 0);
     XCTAssertEqual(RRProbeModeHTTPOnly, 1);
     XCTAssertEqual(RRProbeModeICMPOnly, 2);
+    XCTAssertEqual(RRProbeModeQUICOnly, 3);
 }
 
 #pragma mark - RRPingFoundation Tests
@@ -474,6 +957,127 @@
     XCTAssertNil(ping, @"Ping foundation should not initialize with empty host");
 }
 
+#pragma mark - RRNAT64Resolver Tests
+
+- (NSData *)wellKnownNAT64Address {
+    const uint8_t bytes[16] = {0x00, 0x64, 0xff, 0x9b, 0, 0, 0, 0, 0, 0, 0, 0, 192, 0, 0, 171};
+    return [NSData dataWithBytes:bytes length:sizeof(bytes)];
+}
+
+- (void)testNAT64PrefixDiscoveryAndSynthesis {
+    RRNAT64Prefix *prefix = [RRNAT64Prefix prefixFromSynthesizedAddress:[self wellKnownNAT64Address]];
+    XCTAssertNotNil(prefix);
+    XCTAssertEqual(prefix.prefixLength, 96);
+    XCTAssertEqualObjects([prefix synthesizedHostForIPv4Literal:@"8.8.8.8"], @"64:ff9b::808:808");
+    XCTAssertNil([prefix synthesizedHostForIPv4Literal:@"dns.google"]);
+}
+
+- (void)testNAT64ResolverDiscoversOncePerNetwork {
+    __block NSUInteger queryCount = 0;
+    NSData *address = [self wellKnownNAT64Address];
+    RRNAT64Resolver *resolver = [[RRNAT64Resolver alloc] initWithAddressResolver:^NSArray<NSData *> *(NSString *hostName) {
+        XCTAssertEqualObjects(hostName, @"ipv4only.arpa");
+        queryCount += 1;
+        return @[address];
+    }];
+    
+    RRNAT64Prefix *first = [resolver prefixForNetworkKey:@"0"];
+    RRNAT64Prefix *second = [resolver prefixForNetworkKey:@"0"];
+    XCTAssertEqualObjects(first, second);
+    XCTAssertEqual(queryCount, 1, @"Prefix should be discovered once per network");
+    
+    [resolver invalidate];
+    [resolver prefixForNetworkKey:@"0"];
+    XCTAssertEqual(queryCount, 2, @"Invalidation should force rediscovery");
+}
+
+- (void)testNAT64ResolverCachesAbsenceOfDNS64 {
+    __block NSUInteger queryCount = 0;
+    RRNAT64Resolver *resolver = [[RRNAT64Resolver alloc] initWithAddressResolver:^NSArray<NSData *> *(NSString *hostName) {
+        queryCount += 1;
+        return @[];
+    }];
+    
+    XCTAssertNil([resolver prefixForNetworkKey:@"1"]);
+    XCTAssertNil([resolver prefixForNetworkKey:@"1"]);
+    XCTAssertEqual(queryCount, 1);
+}
+
+- (void)testNAT64ResolverSharesLookupInFlightWithoutBlockingOtherNetworks {
+    __block NSUInteger queryCount = 0;
+    NSData *address = [self wellKnownNAT64Address];
+    dispatch_semaphore_t slowNetwork = dispatch_semaphore_create(0);
+    RRNAT64Resolver *resolver = [[RRNAT64Resolver alloc] initWithAddressResolver:^NSArray<NSData *> *(NSString *hostName) {
+        NSUInteger query;
+        @synchronized(self) {
+            queryCount += 1;
+            query = queryCount;
+        }
+        if (query == 1) {
+            dispatch_semaphore_wait(slowNetwork, dispatch_time(DISPATCH_TIME_NOW, (int64_t)(5 * NSEC_PER_SEC)));
+        }
+        return @[address];
+    }];
+    
+    NSMutableArray<XCTestExpectation *> *slowLookups = [NSMutableArray array];
+    for (NSUInteger i = 0; i < 3; i++) {
+        XCTestExpectation *resolved = [self expectationWithDescription:[NSString stringWithFormat:@"slow %lu", (unsigned long)i]];
+        [slowLookups addObject:resolved];
+        dispatch_async(dispatch_get_global_queue(QOS_CLASS_UTILITY, 0), ^{
+            XCTAssertNotNil([resolver prefixForNetworkKey:@"slow"]);
+            [resolved fulfill];
+        });
+    }
+    [NSThread sleepForTimeInterval:0.1];
+    
+    XCTestExpectation *otherNetwork = [self expectationWithDescription:@"another network resolves meanwhile"];
+    dispatch_async(dispatch_get_global_queue(QOS_CLASS_UTILITY, 0), ^{
+        XCTAssertNotNil([resolver prefixForNetworkKey:@"fast"]);
+        [otherNetwork fulfill];
+    });
+    [self waitForExpectations:@[otherNetwork] timeout:1.0];
+    
+    dispatch_semaphore_signal(slowNetwork);
+    [self waitForExpectations:slowLookups timeout:2.0];
+    XCTAssertEqual(queryCount, 2u, @"callers for the network being discovered share its lookup");
+}
+
+- (void)testNAT64PrefixIsDiscoveredPerNetworkNotPerConnectionType {
+    __block NSUInteger queryCount = 0;
+    NSData *address = [self wellKnownNAT64Address];
+    RRNAT64Resolver *resolver = [[RRNAT64Resolver alloc] initWithAddressResolver:^NSArray<NSData *> *(NSString *hostName) {
+        @synchronized(self) {
+            queryCount += 1;
+        }
+        return @[address];
+    }];
+    RRIPv6OnlyPathMonitorFake *monitor = [[RRIPv6OnlyPathMonitorFake alloc] init];
+    RRReachabilityICMPTargetStub *reachability = [[RRReachabilityICMPTargetStub alloc] init];
+    reachability.pingedHosts = [NSMutableArray array];
+    [reachability setValue:resolver forKey:@"nat64Resolver"];
+    [reachability setValue:monitor forKey:@"pathMonitor"];
+    RRProbeProfile *profile = [[RRProbeProfile alloc] init];
+    profile.icmpHost = @"8.8.8.8";
+
+    for (NSString *fingerprint in @[@"wifi|en0|fe80::1", @"wifi|en0|fe80::1", @"wifi|en0|fe80::2"]) {
+        monitor.fakeFingerprint = fingerprint;
+        XCTestExpectation *probed = [self expectationWithDescription:fingerprint];
+        [reachability performICMPProbeWithProfile:profile resources:nil completion:^(BOOL reachable, RRProbeFailureReason failureReason) {
+            [probed fulfill];
+        }];
+        [self waitForExpectations:@[probed] timeout:1.0];
+    }
+
+    XCTAssertEqual(queryCount, 2u, @"two Wi-Fi networks need two discoveries; the same one is cached");
+    XCTAssertEqualObjects(reachability.pingedHosts.lastObject, @"64:ff9b::808:808");
+}
+
+- (void)testNAT64IPv4LiteralDetection {
+    XCTAssertTrue([RRNAT64Resolver isIPv4Literal:@"8.8.8.8"]);
+    XCTAssertFalse([RRNAT64Resolver isIPv4Literal:@"2001:4860:4860::8888"]);
+    XCTAssertFalse([RRNAT64Resolver isIPv4Literal:@"dns.google"]);
+}
+
 #pragma mark - RRPingHelper Tests
 
 - (void)testPingHelperInitialization {
@@ -506,6 +1110,1001 @@
     // Test passes if no crash
 }
 
+- (void)testPingHelperHostChangeCancelsPingInFlight {
+    RRPingHelper *helper = [[RRPingHelper alloc] init];
+    helper.host = @"192.0.2.1";
+    helper.timeout = 5.0;
+    
+    XCTestExpectation *cancelled = [self expectationWithDescription:@"the waiter of the old host's ping completes"];
+    [helper pingWithDetailedBlock:^(BOOL isSuccess, NSTimeInterval latency, RRProbeFailureReason failureReason) {
+        XCTAssertFalse(isSuccess);
+        XCTAssertEqual(failureReason, RRProbeFailureReasonCancelled);
+        [cancelled fulfill];
+    }];
+    helper.host = @"192.0.2.2";
+    
+    [self waitForExpectations:@[cancelled] timeout:1.0];
+}
+
+- (void)testConcurrentICMPProbesToDifferentHostsUseTheirOwnPing {
+    RRReachability *reachability = [[RRReachability alloc] init];
+    NSArray<NSString *> *hosts = @[@"192.0.2.1", @"192.0.2.2"];
+    
+    NSMutableArray<XCTestExpectation *> *expectations = [NSMutableArray array];
+    for (NSString *host in hosts) {
+        XCTestExpectation *done = [self expectationWithDescription:host];
+        [expectations addObject:done];
+        [reachability performICMPProbeToHost:host timeout:0.5 resources:[[RRProbeResources alloc] init] completion:^(BOOL reachable, RRProbeFailureReason failureReason) {
+            XCTAssertNotEqual(failureReason, RRProbeFailureReasonCancelled, @"a probe to another host must not end this one");
+            [done fulfill];
+        }];
+    }
+    
+    NSDictionary<NSString *, RRPingHelper *> *pingHelpers = [reachability valueForKey:@"pingHelpers"];
+    XCTAssertEqual(pingHelpers.count, 2u);
+    NSMutableSet<NSString *> *pingedHosts = [NSMutableSet set];
+    for (RRPingHelper *helper in pingHelpers.allValues) {
+        [pingedHosts addObject:helper.host];
+    }
+    XCTAssertEqualObjects(pingedHosts, [NSSet setWithArray:hosts]);
+    
+    [self waitForExpectations:expectations timeout:3.0];
+}
+
+#pragma mark - RRQUICProber Tests
+
+- (void)testQUICProberDefaults {
+    RRQUICProber *prober = [[RRQUICProber alloc] init];
+    XCTAssertEqualObjects(prober.host, @"www.gstatic.com");
+    XCTAssertEqual(prober.port, 443);
+    XCTAssertEqual(prober.timeout, 5.0);
+}
+
+- (void)testQUICProbePacketLayout {
+    uint8_t dcid[8] = {1, 2, 3, 4, 5, 6, 7, 8};
+    uint8_t scid[8] = {9, 10, 11, 12, 13, 14, 15, 16};
+    NSData *packet = [RRQUICProber probePacketWithVersion:0x1A2A3A4A
+                                  destinationConnectionID:[NSData dataWithBytes:dcid length:8]
+                                       sourceConnectionID:[NSData dataWithBytes:scid length:8]];
+    const uint8_t *bytes = packet.bytes;
+    
+    XCTAssertEqual(packet.length, 1200, @"Initial packets must be padded to 1200 bytes to get a reply");
+    XCTAssertEqual(bytes[0] & 0xC0, 0xC0, @"Long header with fixed bit");
+    XCTAssertEqual(bytes[1], 0x1A);
+    XCTAssertEqual(bytes[4], 0x4A);
+    XCTAssertEqual(bytes[5], 8);
+    XCTAssertEqual(memcmp(bytes + 6, dcid, 8), 0);
+    XCTAssertEqual(bytes[14], 8);
+    XCTAssertEqual(memcmp(bytes + 15, scid, 8), 0);
+}
+
+- (void)testQUICVersionNegotiationValidation {
+    uint8_t dcidBytes[8] = {1, 2, 3, 4, 5, 6, 7, 8};
+    uint8_t scidBytes[8] = {9, 10, 11, 12, 13, 14, 15, 16};
+    NSData *dcid = [NSData dataWithBytes:dcidBytes length:8];
+    NSData *scid = [NSData dataWithBytes:scidBytes length:8];
+    uint32_t version = 0x1A2A3A4A;
+    NSData *probe = [RRQUICProber probePacketWithVersion:version destinationConnectionID:dcid sourceConnectionID:scid];
+    
+    NSData *reply = [RRQUICResponder replyToProbe:probe supportedVersions:@[@1]];
+    XCTAssertTrue([RRQUICProber isVersionNegotiationPacket:reply probedVersion:version destinationConnectionID:dcid sourceConnectionID:scid]);
+    XCTAssertFalse([RRQUICProber isVersionNegotiationPacket:reply probedVersion:version destinationConnectionID:scid sourceConnectionID:dcid],
+                   @"Connection IDs must be echoed back swapped");
+    
+    NSData *offeringProbedVersion = [RRQUICResponder replyToProbe:probe supportedVersions:@[@1, @(version)]];
+    XCTAssertFalse([RRQUICProber isVersionNegotiationPacket:offeringProbedVersion probedVersion:version destinationConnectionID:dcid sourceConnectionID:scid]);
+    
+    NSMutableData *nonZeroVersion = [reply mutableCopy];
+    ((uint8_t *)nonZeroVersion.mutableBytes)[4] = 1;
+    XCTAssertFalse([RRQUICProber isVersionNegotiationPacket:nonZeroVersion probedVersion:version destinationConnectionID:dcid sourceConnectionID:scid]);
+    
+    XCTAssertFalse([RRQUICProber isVersionNegotiationPacket:[reply subdataWithRange:NSMakeRange(0, 20)] probedVersion:version destinationConnectionID:dcid sourceConnectionID:scid],
+                   @"Truncated replies must be rejected");
+}
+
+- (void)testQUICProberSucceedsAgainstLocalResponder {
+    RRQUICResponder *responder = [[RRQUICResponder alloc] init];
+    XCTAssertTrue([responder start]);
+    
+    RRQUICProber *prober = [[RRQUICProber alloc] init];
+    prober.host = @"127.0.0.1";
+    prober.port = responder.port;
+    prober.timeout = 2.0;
+    
+    XCTestExpectation *expectation = [self expectationWithDescription:@"QUIC probe should complete"];
+    [prober probeWithCompletion:^(BOOL isSuccess, NSTimeInterval latency, RRProbeFailureReason failureReason) {
+        XCTAssertTrue(isSuccess, @"A Version Negotiation reply should count as reachable");
+        XCTAssertEqual(failureReason, RRProbeFailureReasonNone);
+        [expectation fulfill];
+    }];
+    [self waitForExpectationsWithTimeout:3.0 handler:nil];
+    
+    XCTAssertEqual(responder.receivedDatagramCount, 1);
+    [responder stop];
+}
+
+- (void)testQUICProberRejectsUnexpectedReply {
+    RRQUICResponder *responder = [[RRQUICResponder alloc] init];
+    uint8_t garbage[3] = {0x40, 0x01, 0x02};
+    responder.replyOverride = [NSData dataWithBytes:garbage length:sizeof(garbage)];
+    XCTAssertTrue([responder start]);
+    
+    RRQUICProber *prober = [[RRQUICProber alloc] init];
+    prober.host = @"127.0.0.1";
+    prober.port = responder.port;
+    prober.timeout = 2.0;
+    
+    XCTestExpectation *expectation = [self expectationWithDescription:@"QUIC probe should complete"];
+    [prober probeWithCompletion:^(BOOL isSuccess, NSTimeInterval latency, RRProbeFailureReason failureReason) {
+        XCTAssertFalse(isSuccess);
+        XCTAssertEqual(failureReason, RRProbeFailureReasonHTTPMismatch);
+        [expectation fulfill];
+    }];
+    [self waitForExpectationsWithTimeout:3.0 handler:nil];
+    [responder stop];
+}
+
+- (void)testQUICProberCancelCompletesWithCancelled {
+    RRQUICProber *prober = [[RRQUICProber alloc] init];
+    prober.host = @"192.0.2.1";
+    prober.timeout = 5.0;
+    
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Cancelled QUIC probe should complete"];
+    [prober probeWithCompletion:^(BOOL isSuccess, NSTimeInterval latency, RRProbeFailureReason failureReason) {
+        XCTAssertFalse(isSuccess);
+        XCTAssertEqual(failureReason, RRProbeFailureReasonCancelled);
+        [expectation fulfill];
+    }];
+    [prober cancel];
+    [self waitForExpectationsWithTimeout:1.0 handler:nil];
+}
+
+- (void)testQUICProberCancelProbeLeavesOtherProbesRunning {
+    RRQUICProber *prober = [[RRQUICProber alloc] init];
+    prober.host = @"192.0.2.1";
+    prober.timeout = 5.0;
+    
+    XCTestExpectation *cancelled = [self expectationWithDescription:@"Cancelled QUIC probe should complete"];
+    id probe = [prober probeWithCompletion:^(BOOL isSuccess, NSTimeInterval latency, RRProbeFailureReason failureReason) {
+        XCTAssertEqual(failureReason, RRProbeFailureReasonCancelled);
+        [cancelled fulfill];
+    }];
+    prober.timeout = 0.5;
+    XCTestExpectation *timedOut = [self expectationWithDescription:@"Other QUIC probe should run to its own timeout"];
+    [prober probeWithCompletion:^(BOOL isSuccess, NSTimeInterval latency, RRProbeFailureReason failureReason) {
+        XCTAssertNotEqual(failureReason, RRProbeFailureReasonCancelled);
+        [timedOut fulfill];
+    }];
+    
+    [prober cancelProbe:probe];
+    [self waitForExpectations:@[cancelled, timedOut] timeout:2.0 enforceOrder:YES];
+}
+
+- (void)testParallelProbeIncludesQUICBranchOnlyWhenEnabled {
+    RRReachabilityParallelBranchStub *reachability = [[RRReachabilityParallelBranchStub alloc] init];
+    RRProbeProfile *profile = [[RRProbeProfile alloc] init];
+    
+    XCTestExpectation *withoutQUIC = [self expectationWithDescription:@"Parallel probe without QUIC"];
+    [reachability performParallelProbeWithProfile:profile allowingCellular:YES resources:nil completion:^(BOOL reachable, RRProbeFailureReason failureReason) {
+        XCTAssertFalse(reachable);
+        XCTAssertEqual(failureReason, RRProbeFailureReasonTimeout);
+        [withoutQUIC fulfill];
+    }];
+    [self waitForExpectationsWithTimeout:1.0 handler:nil];
+    XCTAssertEqual(reachability.quicProbeCount, 0);
+    
+    profile.includesQUICInParallel = YES;
+    XCTestExpectation *withQUIC = [self expectationWithDescription:@"Parallel probe with QUIC"];
+    [reachability performParallelProbeWithProfile:profile allowingCellular:YES resources:nil completion:^(BOOL reachable, RRProbeFailureReason failureReason) {
+        XCTAssertTrue(reachable, @"The QUIC branch alone should make the parallel probe succeed");
+        [withQUIC fulfill];
+    }];
+    [self waitForExpectationsWithTimeout:1.0 handler:nil];
+    XCTAssertEqual(reachability.quicProbeCount, 1);
+}
+
+- (void)testQUICOnlyModeRunsQUICProbe {
+    RRReachabilityParallelBranchStub *reachability = [[RRReachabilityParallelBranchStub alloc] init];
+    RRProbeProfile *profile = [[RRProbeProfile alloc] init];
+    profile.probeMode = RRProbeModeQUICOnly;
+    
+    XCTestExpectation *expectation = [self expectationWithDescription:@"QUIC-only probe"];
+    [reachability performProbeWithProfile:profile resources:nil completion:^(BOOL reachable, RRProbeFailureReason failureReason) {
+        XCTAssertTrue(reachable);
+        [expectation fulfill];
+    }];
+    [self waitForExpectationsWithTimeout:1.0 handler:nil];
+    XCTAssertEqual(reachability.quicProbeCount, 1);
+}
+
+#pragma mark - RRMTUProber Tests
+
+- (void)testMTUProberDefaults {
+    RRMTUProber *prober = [[RRMTUProber alloc] init];
+    XCTAssertEqualObjects(prober.host, @"8.8.8.8");
+    XCTAssertEqual(prober.minimumMTU, 1280);
+    XCTAssertEqual(prober.maximumMTU, 1500);
+    XCTAssertEqual(prober.parallelProbes, 4);
+}
+
+- (void)testMTUCandidatesSpanRangeIncludingBothEnds {
+    NSArray<NSNumber *> *candidates = [RRMTUProber candidateMTUsFrom:1280 to:1500 count:4];
+    XCTAssertEqualObjects(candidates, (@[@1280, @1353, @1426, @1500]));
+    
+    NSArray<NSNumber *> *narrow = [RRMTUProber candidateMTUsFrom:1400 to:1402 count:4];
+    XCTAssertEqualObjects(narrow, (@[@1400, @1401, @1402]), @"A narrow range is probed exhaustively");
+    
+    XCTAssertEqual([RRMTUProber candidateMTUsFrom:1500 to:1400 count:4].count, 0);
+}
+
+- (void)testMTUProberFindsBlackholeLimitWithParallelRounds {
+    RRMTUProberPathStub *prober = [[RRMTUProberPathStub alloc] init];
+    prober.pathLimit = 1412;
+    
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Path MTU discovered"];
+    [prober discoverPathMTUForNetworkKey:nil completion:^(NSUInteger pathMTU, RRProbeFailureReason failureReason) {
+        XCTAssertEqual(pathMTU, 1412);
+        XCTAssertEqual(failureReason, RRProbeFailureReasonNone);
+        [expectation fulfill];
+    }];
+    [self waitForExpectationsWithTimeout:2.0 handler:nil];
+    
+    XCTAssertEqual(prober.peakInFlight, 4, @"Each round should probe its sizes in parallel");
+    XCTAssertLessThanOrEqual(prober.probedMTUs.count, 20);
+}
+
+- (void)testMTUProberReportsFailureWhenMinimumDoesNotGetThrough {
+    RRMTUProberPathStub *prober = [[RRMTUProberPathStub alloc] init];
+    prober.pathLimit = 0;
+    
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Discovery fails"];
+    [prober discoverPathMTUForNetworkKey:@"wifi" completion:^(NSUInteger pathMTU, RRProbeFailureReason failureReason) {
+        XCTAssertEqual(pathMTU, 0);
+        XCTAssertEqual(failureReason, RRProbeFailureReasonTimeout);
+        [expectation fulfill];
+    }];
+    [self waitForExpectationsWithTimeout:2.0 handler:nil];
+    XCTAssertEqual([prober cachedPathMTUForNetworkKey:@"wifi"], 0, @"Failures are not cached");
+}
+
+- (void)testMTUProberCachesResultPerNetwork {
+    RRMTUProberPathStub *prober = [[RRMTUProberPathStub alloc] init];
+    prober.pathLimit = 1500;
+    
+    XCTestExpectation *first = [self expectationWithDescription:@"First discovery"];
+    [prober discoverPathMTUForNetworkKey:@"wifi|en0" completion:^(NSUInteger pathMTU, RRProbeFailureReason failureReason) {
+        [first fulfill];
+    }];
+    [self waitForExpectationsWithTimeout:2.0 handler:nil];
+    NSUInteger probesAfterFirst = prober.probedMTUs.count;
+    XCTAssertEqual([prober cachedPathMTUForNetworkKey:@"wifi|en0"], 1500);
+    
+    prober.pathLimit = 1400;
+    XCTestExpectation *cached = [self expectationWithDescription:@"Cached discovery"];
+    [prober discoverPathMTUForNetworkKey:@"wifi|en0" completion:^(NSUInteger pathMTU, RRProbeFailureReason failureReason) {
+        XCTAssertEqual(pathMTU, 1500, @"The same network answers from the cache");
+        [cached fulfill];
+    }];
+    [self waitForExpectationsWithTimeout:2.0 handler:nil];
+    XCTAssertEqual(prober.probedMTUs.count, probesAfterFirst);
+    
+    XCTestExpectation *other = [self expectationWithDescription:@"Other network"];
+    [prober discoverPathMTUForNetworkKey:@"wifi|en1" completion:^(NSUInteger pathMTU, RRProbeFailureReason failureReason) {
+        XCTAssertEqual(pathMTU, 1400);
+        [other fulfill];
+    }];
+    [self waitForExpectationsWithTimeout:2.0 handler:nil];
+    
+    [prober invalidate];
+    XCTAssertEqual([prober cachedPathMTUForNetworkKey:@"wifi|en0"], 0);
+}
+
+- (void)testMTUProberOnLoopbackReachesMaximum {
+    RRMTUProber *prober = [[RRMTUProber alloc] init];
+    prober.host = @"127.0.0.1";
+    prober.timeout = 1.0;
+    
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Loopback path MTU"];
+    [prober discoverPathMTUForNetworkKey:nil completion:^(NSUInteger pathMTU, RRProbeFailureReason failureReason) {
+        XCTAssertEqual(pathMTU, 1500, @"Loopback carries far more than an Ethernet MTU without fragmenting");
+        [expectation fulfill];
+    }];
+    [self waitForExpectationsWithTimeout:5.0 handler:nil];
+}
+
+#pragma mark - RRLogger Tests
+
+- (void)resetLoggerAfterTest {
+    RRLogLevel level = RRLogger.minimumLevel;
+    NSUInteger rate = RRLogger.maximumRecordsPerSecond;
+    [self addTeardownBlock:^{
+        [RRLogger removeAllSinks];
+        [RRLogger addSink:[[RROSLogSink alloc] init]];
+        RRLogger.minimumLevel = level;
+        RRLogger.maximumRecordsPerSecond = rate;
+    }];
+    [RRLogger removeAllSinks];
+}
+
+- (void)testRingBufferLogSinkKeepsNewestRecordsInOrder {
+    RRRingBufferLogSink *ring = [[RRRingBufferLogSink alloc] initWithCapacity:3];
+    for (NSInteger i = 0; i < 5; i++) {
+        [ring writeRecord:[[RRLogRecord alloc] initWithDate:[NSDate date]
+                                                      level:RRLogLevelInfo
+                                                  subsystem:@"test"
+                                                    message:[NSString stringWithFormat:@"%ld", (long)i]]];
+    }
+    XCTAssertEqualObjects([ring.records valueForKey:@"message"], (@[@"2", @"3", @"4"]));
+}
+
+- (void)testRingBufferLogSinkTruncatesOnCharacterBoundary {
+    RRRingBufferLogSink *ring = [[RRRingBufferLogSink alloc] initWithCapacity:1];
+    NSString *accented = [@"" stringByPaddingToLength:300 withString:@"\u00e9" startingAtIndex:0];
+    [ring writeRecord:[[RRLogRecord alloc] initWithDate:[NSDate date] level:RRLogLevelInfo subsystem:@"test" message:accented]];
+
+    NSString *stored = ring.records.firstObject.message;
+    XCTAssertNotNil(stored);
+    XCTAssertEqual(stored.length, 127u, @"255 bytes hold 127 two-byte characters");
+}
+
+- (void)testLoggerThresholdGatesRecords {
+    [self resetLoggerAfterTest];
+    RRRingBufferLogSink *ring = [[RRRingBufferLogSink alloc] init];
+    [RRLogger addSink:ring];
+    RRLogger.minimumLevel = RRLogLevelWarning;
+
+    XCTAssertFalse([RRLogger isLevelEnabled:RRLogLevelInfo]);
+    [RRLogger logWithLevel:RRLogLevelInfo subsystem:@"test" format:@"dropped"];
+    [RRLogger logWithLevel:RRLogLevelError subsystem:@"test" format:@"kept %d", 1];
+
+    XCTAssertEqualObjects([ring.records valueForKey:@"message"], (@[@"kept 1"]));
+
+    RRLogger.minimumLevel = RRLogLevelOff;
+    XCTAssertFalse([RRLogger isLevelEnabled:RRLogLevelError]);
+}
+
+- (void)testLoggerRateLimitSummarizesDroppedRecords {
+    [self resetLoggerAfterTest];
+    RRRingBufferLogSink *ring = [[RRRingBufferLogSink alloc] init];
+    [RRLogger addSink:ring];
+    RRLogger.minimumLevel = RRLogLevelDebug;
+    RRLogger.maximumRecordsPerSecond = 2;
+
+    for (NSInteger i = 0; i < 5; i++) {
+        [RRLogger logWithLevel:RRLogLevelWarning subsystem:@"ratelimit" format:@"burst %ld", (long)i];
+    }
+    [RRLogger logWithLevel:RRLogLevelWarning subsystem:@"other" format:@"separate budget"];
+    XCTAssertEqual(ring.records.count, 3u);
+
+    [NSThread sleepForTimeInterval:1.1];
+    [RRLogger logWithLevel:RRLogLevelWarning subsystem:@"ratelimit" format:@"after"];
+
+    NSArray<NSString *> *messages = [ring.records valueForKey:@"message"];
+    XCTAssertEqualObjects([messages subarrayWithRange:NSMakeRange(3, 2)],
+                          (@[@"3 records suppressed by rate limit", @"after"]));
+}
+
+#pragma mark - RRPacketCapture Tests
+
+static uint32_t RRReadUInt32(NSData *data, NSUInteger offset) {
+    const uint8_t *bytes = (const uint8_t *) data.bytes + offset;
+    return (uint32_t) bytes[0] | ((uint32_t) bytes[1] << 8) | ((uint32_t) bytes[2] << 16) | ((uint32_t) bytes[3] << 24);
+}
+
+- (NSData *)socketAddressForIPv4:(NSString *)literal {
+    struct sockaddr_in address = {0};
+    address.sin_len = sizeof(address);
+    address.sin_family = AF_INET;
+    inet_pton(AF_INET, literal.UTF8String, &address.sin_addr);
+    return [NSData dataWithBytes:&address length:sizeof(address)];
+}
+
+- (NSData *)socketAddressForIPv6:(NSString *)literal {
+    struct sockaddr_in6 address = {0};
+    address.sin6_len = sizeof(address);
+    address.sin6_family = AF_INET6;
+    inet_pton(AF_INET6, literal.UTF8String, &address.sin6_addr);
+    return [NSData dataWithBytes:&address length:sizeof(address)];
+}
+
+/// Offsets of the enhanced packet blocks in a pcapng file
+- (NSArray<NSNumber *> *)enhancedPacketBlockOffsetsInData:(NSData *)data {
+    NSMutableArray<NSNumber *> *offsets = [NSMutableArray array];
+    NSUInteger offset = 0;
+    while (offset + 8 <= data.length) {
+        uint32_t length = RRReadUInt32(data, offset + 4);
+        XCTAssertEqual(length % 4, 0u);
+        XCTAssertEqual(RRReadUInt32(data, offset + length - 4), length, @"trailing length mirrors the leading one");
+        if (RRReadUInt32(data, offset) == 6) {
+            [offsets addObject:@(offset)];
+        }
+        offset += length;
+    }
+    XCTAssertEqual(offset, data.length);
+    return offsets;
+}
+
+- (void)testPacketCaptureExportsPcapngWithDirections {
+    RRPacketCapture *capture = [[RRPacketCapture alloc] init];
+    uint8_t echo[12] = { 8, 0, 0, 0, 0x12, 0x34, 0, 1, 'p', 'i', 'n', 'g' };
+    NSData *icmp = [NSData dataWithBytes:echo length:sizeof(echo)];
+
+    [capture recordPacket:icmp direction:RRPacketDirectionOutbound peerAddress:[self socketAddressForIPv4:@"192.0.2.1"]];
+    [capture recordPacket:icmp direction:RRPacketDirectionInbound peerAddress:[self socketAddressForIPv6:@"2001:db8::1"]];
+
+    NSData *data = [capture pcapngData];
+    XCTAssertEqual(RRReadUInt32(data, 0), 0x0A0D0D0Au);
+    XCTAssertEqual(RRReadUInt32(data, 8), 0x1A2B3C4Du);
+    XCTAssertEqual(RRReadUInt32(data, 28), 1u);
+    XCTAssertEqual(RRReadUInt32(data, 36) & 0xFFFF, 228u, @"interface 0 is raw IPv4");
+    XCTAssertEqual(RRReadUInt32(data, 56) & 0xFFFF, 229u, @"interface 1 is raw IPv6");
+
+    NSArray<NSNumber *> *blocks = [self enhancedPacketBlockOffsetsInData:data];
+    XCTAssertEqual(blocks.count, 2u);
+
+    NSUInteger outbound = blocks[0].unsignedIntegerValue;
+    XCTAssertEqual(RRReadUInt32(data, outbound + 8), 0u);
+    XCTAssertEqual(RRReadUInt32(data, outbound + 20), 32u, @"synthesized IPv4 header plus the echo");
+    const uint8_t *ipv4 = (const uint8_t *) data.bytes + outbound + 28;
+    XCTAssertEqual(ipv4[0], 0x45);
+    XCTAssertEqual(ipv4[9], IPPROTO_ICMP);
+    XCTAssertEqual(ipv4[16], 192, @"the peer is the destination of an outbound packet");
+    XCTAssertEqual(RRReadUInt32(data, outbound + 28 + 32 + 4), 2u, @"epb_flags outbound");
+
+    NSUInteger inbound = blocks[1].unsignedIntegerValue;
+    XCTAssertEqual(RRReadUInt32(data, inbound + 8), 1u);
+    XCTAssertEqual(RRReadUInt32(data, inbound + 20), 52u);
+    const uint8_t *ipv6 = (const uint8_t *) data.bytes + inbound + 28;
+    XCTAssertEqual(ipv6[0], 0x60);
+    XCTAssertEqual(ipv6[6], IPPROTO_ICMPV6);
+    XCTAssertEqual(ipv6[8], 0x20, @"the peer is the source of an inbound packet");
+    XCTAssertEqual(RRReadUInt32(data, inbound + 28 + 52 + 4), 1u, @"epb_flags inbound");
+}
+
+- (void)testPacketCaptureKeepsReceivedIPv4HeaderAndTruncates {
+    RRPacketCapture *capture = [[RRPacketCapture alloc] initWithCapacity:4 snapLength:64];
+    NSMutableData *reply = [NSMutableData dataWithLength:120];
+    ((uint8_t *) reply.mutableBytes)[0] = 0x45;
+
+    [capture recordPacket:reply direction:RRPacketDirectionInbound peerAddress:[self socketAddressForIPv4:@"192.0.2.1"]];
+
+    NSData *data = [capture pcapngData];
+    NSUInteger block = [self enhancedPacketBlockOffsetsInData:data].firstObject.unsignedIntegerValue;
+    XCTAssertEqual(RRReadUInt32(data, block + 20), 64u, @"captured length stops at the snap length");
+    XCTAssertEqual(RRReadUInt32(data, block + 24), 120u, @"no second header is added");
+}
+
+- (void)testPacketCaptureRingIsBounded {
+    RRPacketCapture *capture = [[RRPacketCapture alloc] initWithCapacity:2 snapLength:64];
+    NSData *peer = [self socketAddressForIPv4:@"192.0.2.1"];
+    for (uint8_t sequence = 0; sequence < 3; sequence++) {
+        uint8_t echo[8] = { 8, 0, 0, 0, 0, 0, 0, sequence };
+        [capture recordPacket:[NSData dataWithBytes:echo length:sizeof(echo)] direction:RRPacketDirectionOutbound peerAddress:peer];
+    }
+
+    XCTAssertEqual(capture.packetCount, 2u);
+    XCTAssertEqual(capture.totalPacketCount, 3u);
+
+    NSData *data = [capture pcapngData];
+    NSArray<NSNumber *> *blocks = [self enhancedPacketBlockOffsetsInData:data];
+    XCTAssertEqual(blocks.count, 2u);
+    const uint8_t *oldest = (const uint8_t *) data.bytes + blocks[0].unsignedIntegerValue + 28;
+    XCTAssertEqual(oldest[20 + 7], 1, @"the first packet was overwritten");
+
+    [capture clear];
+    XCTAssertEqual(capture.packetCount, 0u);
+    XCTAssertEqual([self enhancedPacketBlockOffsetsInData:[capture pcapngData]].count, 0u);
+}
+
+#pragma mark - Block Observer Tests
+
+- (void)testBlockObserverReceivesStateInline {
+    RRReachability *reachability = [[RRReachability alloc] init];
+    __block NSUInteger calls = 0;
+    __block RRReachabilityState received = {0};
+    RRReachabilityObservation *observation = [reachability addObserverWithQueue:nil block:^(RRReachabilityState state) {
+        XCTAssertTrue([NSThread isMainThread]);
+        calls += 1;
+        received = state;
+    }];
+
+    [reachability updateStatus:RRReachabilityStatusNotReachable
+                connectionType:RRConnectionTypeCellular
+            secondaryReachable:NO
+                 failureReason:RRProbeFailureReasonTimeout];
+    [self drainMainQueue];
+
+    XCTAssertEqual(calls, 1u);
+    XCTAssertEqual(received.status, RRReachabilityStatusNotReachable);
+    XCTAssertEqual(received.connectionType, RRConnectionTypeCellular);
+    XCTAssertFalse(received.secondaryReachable);
+    XCTAssertEqual(received.failureReason, RRProbeFailureReasonTimeout);
+    XCTAssertTrue(observation.isValid);
+}
+
+- (void)testBlockObserverRunsOnItsQueueInOrder {
+    RRReachability *reachability = [[RRReachability alloc] init];
+    dispatch_queue_t queue = dispatch_queue_create("com.realreachability2.tests.observer", DISPATCH_QUEUE_SERIAL);
+    static void *kQueueKey = &kQueueKey;
+    dispatch_queue_set_specific(queue, kQueueKey, kQueueKey, NULL);
+
+    NSMutableArray<NSNumber *> *types = [NSMutableArray array];
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Both changes delivered"];
+    expectation.expectedFulfillmentCount = 2;
+    RRReachabilityObservation *observation = [reachability addObserverWithQueue:queue block:^(RRReachabilityState state) {
+        XCTAssertEqual(dispatch_get_specific(kQueueKey), kQueueKey);
+        [types addObject:@(state.connectionType)];
+        [expectation fulfill];
+    }];
+
+    [reachability updateStatus:RRReachabilityStatusReachable connectionType:RRConnectionTypeWiFi];
+    [reachability updateStatus:RRReachabilityStatusReachable connectionType:RRConnectionTypeCellular];
+
+    [self waitForExpectationsWithTimeout:1.0 handler:nil];
+    XCTAssertEqualObjects(types, (@[@(RRConnectionTypeWiFi), @(RRConnectionTypeCellular)]));
+    [observation invalidate];
+}
+
+- (void)testReleasingObservationRemovesObserver {
+    RRReachability *reachability = [[RRReachability alloc] init];
+    __block NSUInteger calls = 0;
+    @autoreleasepool {
+        (void)[reachability addObserverWithQueue:nil block:^(RRReachabilityState state) {
+            calls += 1;
+        }];
+    }
+
+    RRReachabilityObservation *invalidated = [reachability addObserverWithQueue:nil block:^(RRReachabilityState state) {
+        calls += 1;
+    }];
+    [invalidated invalidate];
+    XCTAssertFalse(invalidated.isValid);
+
+    [reachability updateStatus:RRReachabilityStatusReachable connectionType:RRConnectionTypeWiFi];
+    [self drainMainQueue];
+    XCTAssertEqual(calls, 0u);
+}
+
+- (void)testChangeNotificationCanBeDisabled {
+    RRReachability *reachability = [[RRReachability alloc] init];
+    reachability.postsChangeNotifications = NO;
+
+    XCTestExpectation *notification = [self expectationForNotification:kRRReachabilityChangedNotification object:reachability handler:nil];
+    notification.inverted = YES;
+    XCTestExpectation *block = [self expectationWithDescription:@"Block observer still called"];
+    RRReachabilityObservation *observation = [reachability addObserverWithQueue:nil block:^(RRReachabilityState state) {
+        [block fulfill];
+    }];
+
+    [reachability updateStatus:RRReachabilityStatusReachable connectionType:RRConnectionTypeWiFi];
+    [self waitForExpectations:@[notification, block] timeout:0.5];
+    [observation invalidate];
+}
+
+/// Side-by-side cost of one change delivered to ten subscribers through each mechanism
+- (void)testPerformanceBlockObserverDelivery {
+    RRReachability *reachability = [[RRReachability alloc] init];
+    reachability.postsChangeNotifications = NO;
+    __block NSUInteger delivered = 0;
+    NSMutableArray<RRReachabilityObservation *> *observations = [NSMutableArray array];
+    for (NSUInteger i = 0; i < 10; i++) {
+        [observations addObject:[reachability addObserverWithQueue:nil block:^(RRReachabilityState state) {
+            delivered += state.status;
+        }]];
+    }
+
+    [self measureBlock:^{
+        for (NSUInteger i = 0; i < 10000; i++) {
+            RRReachabilityState state = { .status = RRReachabilityStatusReachable, .connectionType = RRConnectionTypeWiFi };
+            [reachability notifyObserversOfState:state];
+        }
+    }];
+    XCTAssertGreaterThan(delivered, 0u);
+}
+
+- (void)testPerformanceNotificationDelivery {
+    RRReachability *reachability = [[RRReachability alloc] init];
+    __block NSUInteger delivered = 0;
+    NSMutableArray *observers = [NSMutableArray array];
+    for (NSUInteger i = 0; i < 10; i++) {
+        [observers addObject:[[NSNotificationCenter defaultCenter] addObserverForName:kRRReachabilityChangedNotification
+                                                                               object:reachability
+                                                                                queue:nil
+                                                                           usingBlock:^(NSNotification *notification) {
+            delivered += [notification.userInfo[kRRReachabilityStatusKey] integerValue];
+        }]];
+    }
+
+    [self measureBlock:^{
+        for (NSUInteger i = 0; i < 10000; i++) {
+            RRReachabilityState state = { .status = RRReachabilityStatusReachable, .connectionType = RRConnectionTypeWiFi };
+            [reachability notifyObserversOfState:state];
+        }
+    }];
+    XCTAssertGreaterThan(delivered, 0u);
+
+    for (id observer in observers) {
+        [[NSNotificationCenter defaultCenter] removeObserver:observer];
+    }
+}
+
+#pragma mark - Delivery Window Tests
+
+- (void)testDeliveryWindowMergesBurstIntoNetTransition {
+    RRReachability *reachability = [[RRReachability alloc] init];
+    reachability.statusDeliveryWindow = 0.2;
+    NSMutableArray<NSNumber *> *types = [NSMutableArray array];
+    RRReachabilityObservation *observation = [reachability addObserverWithQueue:nil block:^(RRReachabilityState state) {
+        [types addObject:@(state.connectionType)];
+    }];
+
+    [reachability updateStatus:RRReachabilityStatusReachable connectionType:RRConnectionTypeWiFi];
+    [reachability updateStatus:RRReachabilityStatusNotReachable connectionType:RRConnectionTypeNone];
+    [reachability updateStatus:RRReachabilityStatusReachable connectionType:RRConnectionTypeCellular];
+    [self drainMainQueue];
+    XCTAssertEqualObjects(types, (@[@(RRConnectionTypeWiFi)]), @"the first change is not delayed");
+
+    XCTestExpectation *notification = [self expectationForNotification:kRRReachabilityChangedNotification object:reachability handler:nil];
+    [self waitForExpectations:@[notification] timeout:2.0];
+    XCTAssertEqualObjects(types, (@[@(RRConnectionTypeWiFi), @(RRConnectionTypeCellular)]));
+    XCTAssertEqual(reachability.deliveredStatusChangeCount, 2u);
+    XCTAssertEqual(reachability.mergedStatusChangeCount, 1u);
+    [observation invalidate];
+}
+
+- (void)testFlushDeliversHeldChangeAndDropsNoOpBurst {
+    RRReachability *reachability = [[RRReachability alloc] init];
+    reachability.statusDeliveryWindow = 10.0;
+    __block NSUInteger calls = 0;
+    RRReachabilityObservation *observation = [reachability addObserverWithQueue:nil block:^(RRReachabilityState state) {
+        calls += 1;
+    }];
+
+    [reachability updateStatus:RRReachabilityStatusReachable connectionType:RRConnectionTypeWiFi];
+    [reachability updateStatus:RRReachabilityStatusNotReachable connectionType:RRConnectionTypeWiFi];
+    [self drainMainQueue];
+    [reachability flushStatusDelivery];
+    XCTAssertEqual(calls, 2u, @"flush delivers the held change at once");
+
+    [reachability updateStatus:RRReachabilityStatusReachable connectionType:RRConnectionTypeWiFi];
+    [reachability updateStatus:RRReachabilityStatusNotReachable connectionType:RRConnectionTypeWiFi];
+    [self drainMainQueue];
+    [reachability flushStatusDelivery];
+    XCTAssertEqual(calls, 2u, @"a burst back to the delivered state is not a transition");
+    XCTAssertEqual(reachability.mergedStatusChangeCount, 2u);
+    [observation invalidate];
+}
+
+#pragma mark - Probe Scheduler Tests
+
+- (void)testProbeSchedulerPiggybacksOnWorkInFlight {
+    RRProbeScheduler *scheduler = [[RRProbeScheduler alloc] initWithMaximumConcurrentOperations:2];
+    __block NSUInteger runs = 0;
+    __block RRProbeOperationCompletion pending = nil;
+    RRProbeOperationBlock operation = ^RRProbeCancelBlock(RRProbeOperationCompletion done) {
+        runs += 1;
+        pending = done;
+        return nil;
+    };
+    NSMutableArray *results = [NSMutableArray array];
+
+    [scheduler scheduleOperationForKey:@(RRConnectionTypeWiFi) priority:RRProbePriorityPeriodic operation:operation completion:^(id result) {
+        [results addObject:result];
+    }];
+    [scheduler scheduleOperationForKey:@(RRConnectionTypeWiFi) priority:RRProbePriorityUserInitiated operation:operation completion:^(id result) {
+        [results addObject:result];
+    }];
+    XCTAssertEqual(runs, 1u, @"the check joins the periodic probe in flight");
+
+    pending(@YES);
+    XCTAssertEqualObjects(results, (@[@YES, @YES]));
+    XCTAssertEqual(scheduler.startedOperationCount, 1u);
+    XCTAssertEqual(scheduler.piggybackedRequestCount, 1u);
+}
+
+- (void)testProbeSchedulerPreemptsCancellableBackgroundWork {
+    RRProbeScheduler *scheduler = [[RRProbeScheduler alloc] initWithMaximumConcurrentOperations:1];
+    NSMutableArray<NSString *> *events = [NSMutableArray array];
+    NSMutableArray<RRProbeOperationCompletion> *pending = [NSMutableArray array];
+    __block id backgroundResult = nil;
+
+    [scheduler scheduleOperationForKey:@"pathMTU" priority:RRProbePriorityBackgroundDiagnostic operation:^RRProbeCancelBlock(RRProbeOperationCompletion done) {
+        [events addObject:@"mtu"];
+        [pending addObject:done];
+        return ^{
+            [events addObject:@"mtu cancelled"];
+        };
+    } completion:^(id result) {
+        backgroundResult = result;
+    }];
+
+    __block id checkResult = nil;
+    [scheduler scheduleOperationForKey:@(RRConnectionTypeWiFi) priority:RRProbePriorityUserInitiated operation:^RRProbeCancelBlock(RRProbeOperationCompletion done) {
+        [events addObject:@"check"];
+        done(@"reachable");
+        return nil;
+    } completion:^(id result) {
+        checkResult = result;
+    }];
+
+    XCTAssertEqualObjects(checkResult, @"reachable", @"the check does not wait behind background work");
+    XCTAssertEqualObjects(events, (@[@"mtu", @"mtu cancelled", @"check", @"mtu"]), @"preempted work restarts once the slot frees");
+    XCTAssertEqual(pending.count, 2u);
+
+    pending[0](@"cancelled");
+    XCTAssertNil(backgroundResult, @"the preempted run is ignored");
+    pending[1](@1500);
+    XCTAssertEqualObjects(backgroundResult, @1500);
+    XCTAssertEqual(scheduler.startedOperationCount, 3u);
+    XCTAssertEqual(scheduler.preemptedOperationCount, 1u);
+}
+
+- (void)testProbeSchedulerQueuesByPriorityBehindUncancellableWork {
+    RRProbeScheduler *scheduler = [[RRProbeScheduler alloc] initWithMaximumConcurrentOperations:1];
+    NSMutableArray<NSString *> *events = [NSMutableArray array];
+    __block RRProbeOperationCompletion pending = nil;
+    RRProbeOperationBlock (^record)(NSString *) = ^RRProbeOperationBlock(NSString *name) {
+        return ^RRProbeCancelBlock(RRProbeOperationCompletion done) {
+            [events addObject:name];
+            done(name);
+            return nil;
+        };
+    };
+
+    [scheduler scheduleOperationForKey:@"periodic" priority:RRProbePriorityPeriodic operation:^RRProbeCancelBlock(RRProbeOperationCompletion done) {
+        [events addObject:@"periodic"];
+        pending = done;
+        return nil;
+    } completion:^(id result) {}];
+    [scheduler scheduleOperationForKey:@"diagnostic" priority:RRProbePriorityBackgroundDiagnostic operation:record(@"diagnostic") completion:^(id result) {}];
+    [scheduler scheduleOperationForKey:@"path" priority:RRProbePriorityPathChange operation:record(@"path") completion:^(id result) {}];
+    XCTAssertEqualObjects(events, (@[@"periodic"]), @"an operation without a cancel block is never preempted");
+
+    pending(@YES);
+    XCTAssertEqualObjects(events, (@[@"periodic", @"path", @"diagnostic"]));
+    XCTAssertEqual(scheduler.preemptedOperationCount, 0u);
+}
+
+- (void)testReachabilityExposesProbeScheduler {
+    RRReachability *reachability = [[RRReachability alloc] init];
+    XCTAssertNotNil(reachability.probeScheduler);
+    XCTAssertEqual(reachability.probeScheduler.maximumConcurrentOperations, 2u);
+    XCTAssertEqual(reachability.probeScheduler.startedOperationCount, 0u);
+}
+
+#pragma mark - Probe Coordinator Tests
+
+- (void)testIdenticalProbesFromTwoEnginesShareOneOperation {
+    NSUInteger globalRequested = RRReachability.globalRequestedProbeCount;
+    NSUInteger globalPerformed = RRReachability.globalPerformedProbeCount;
+    NSMutableArray<RRReachabilitySlowProbeStub *> *engines = [NSMutableArray array];
+    NSMutableArray<XCTestExpectation *> *expectations = [NSMutableArray array];
+
+    for (NSUInteger i = 0; i < 2; i++) {
+        RRReachabilitySlowProbeStub *reachability = [[RRReachabilitySlowProbeStub alloc] init];
+        RRPathMonitorFake *fakeMonitor = [[RRPathMonitorFake alloc] init];
+        [reachability setValue:fakeMonitor forKey:@"pathMonitor"];
+        [fakeMonitor setValue:@(YES) forKey:@"isSatisfied"];
+        [fakeMonitor setValue:@(RRConnectionTypeWiFi) forKey:@"connectionType"];
+        reachability.probeMode = RRProbeModeICMPOnly;
+        [engines addObject:reachability];
+
+        XCTestExpectation *expectation = [self expectationWithDescription:@"Both engines get the shared result"];
+        [expectations addObject:expectation];
+        [reachability checkReachabilityWithCompletion:^(RRReachabilityStatus status, RRConnectionType type) {
+            XCTAssertEqual(status, RRReachabilityStatusReachable);
+            [expectation fulfill];
+        }];
+    }
+    [self waitForExpectations:expectations timeout:2.0];
+
+    XCTAssertEqual(engines[0].requestedProbeCount, 1u);
+    XCTAssertEqual(engines[1].requestedProbeCount, 1u);
+    XCTAssertEqual(engines[0].performedProbeCount + engines[1].performedProbeCount, 1u);
+    XCTAssertEqual(engines[0].probeCount + engines[1].probeCount, 1u, @"one network operation for both engines");
+    XCTAssertEqual(RRReachability.globalRequestedProbeCount - globalRequested, 2u);
+    XCTAssertEqual(RRReachability.globalPerformedProbeCount - globalPerformed, 1u);
+}
+
+- (void)testProbesWithDifferentTargetsAreNotShared {
+    NSMutableArray<RRReachabilitySlowProbeStub *> *engines = [NSMutableArray array];
+    NSMutableArray<XCTestExpectation *> *expectations = [NSMutableArray array];
+
+    for (NSString *host in @[@"1.1.1.1", @"8.8.8.8"]) {
+        RRReachabilitySlowProbeStub *reachability = [[RRReachabilitySlowProbeStub alloc] init];
+        RRPathMonitorFake *fakeMonitor = [[RRPathMonitorFake alloc] init];
+        [reachability setValue:fakeMonitor forKey:@"pathMonitor"];
+        [fakeMonitor setValue:@(YES) forKey:@"isSatisfied"];
+        [fakeMonitor setValue:@(RRConnectionTypeWiFi) forKey:@"connectionType"];
+        reachability.probeMode = RRProbeModeICMPOnly;
+        reachability.icmpHost = host;
+        [engines addObject:reachability];
+
+        XCTestExpectation *expectation = [self expectationWithDescription:@"Each engine probes its own host"];
+        [expectations addObject:expectation];
+        [reachability checkReachabilityWithCompletion:^(RRReachabilityStatus status, RRConnectionType type) {
+            [expectation fulfill];
+        }];
+    }
+    [self waitForExpectations:expectations timeout:2.0];
+
+    XCTAssertEqual(engines[0].performedProbeCount, 1u);
+    XCTAssertEqual(engines[1].performedProbeCount, 1u);
+}
+
+#pragma mark - RRPingMulti Tests
+
+- (void)testPingMultiRejectsHostNamesWithoutBlocking {
+    RRPingMulti *multi = [[RRPingMulti alloc] init];
+    __block RRProbeFailureReason reason = RRProbeFailureReasonNone;
+    __block BOOL called = NO;
+
+    RRPingHandle handle = [multi addPingToAddress:@"example.com" timeout:1.0 completion:^(BOOL isSuccess, NSTimeInterval latency, RRProbeFailureReason failureReason) {
+        XCTAssertFalse(isSuccess);
+        reason = failureReason;
+        called = YES;
+    }];
+
+    XCTAssertEqual(handle, 0u);
+    XCTAssertTrue(called, @"A rejected ping completes before the call returns");
+    XCTAssertEqual(reason, RRProbeFailureReasonInvalidConfiguration);
+    XCTAssertEqual(multi.fileDescriptors.count, 0u);
+    XCTAssertEqual(multi.nextTimeoutInterval, -1);
+}
+
+- (void)testPingMultiTimesOutAndCancelsWhenDrivenByHost {
+    RRPingMulti *multi = [[RRPingMulti alloc] init];
+    NSMutableArray<NSNumber *> *reasons = [NSMutableArray array];
+    RRPingDetailedCompletionBlock record = ^(BOOL isSuccess, NSTimeInterval latency, RRProbeFailureReason failureReason) {
+        [reasons addObject:@(failureReason)];
+    };
+
+    // TEST-NET-1 never answers
+    RRPingHandle expiring = [multi addPingToAddress:@"192.0.2.1" timeout:0.05 completion:record];
+    RRPingHandle cancelled = [multi addPingToAddress:@"192.0.2.1" timeout:10.0 completion:record];
+    XCTAssertNotEqual(expiring, 0u);
+    XCTAssertNotEqual(cancelled, 0u);
+    XCTAssertEqual(multi.fileDescriptors.count, 1u, @"Pings of one family share a socket");
+    XCTAssertGreaterThan(multi.nextTimeoutInterval, 0);
+    XCTAssertLessThanOrEqual(multi.nextTimeoutInterval, 0.05);
+
+    [multi cancelPing:cancelled];
+    [multi cancelPing:cancelled];
+    XCTAssertEqualObjects(reasons, @[@(RRProbeFailureReasonCancelled)]);
+
+    [multi handleTimeout];
+    XCTAssertEqual(reasons.count, 1u, @"Nothing expires before its deadline");
+    usleep(60000);
+    XCTAssertEqual(multi.nextTimeoutInterval, 0);
+    [multi handleTimeout];
+
+    XCTAssertEqualObjects(reasons, (@[@(RRProbeFailureReasonCancelled), @(RRProbeFailureReasonTimeout)]));
+    XCTAssertEqual(multi.activePingCount, 0u);
+    XCTAssertEqual(multi.nextTimeoutInterval, -1);
+}
+
+- (void)testPingMultiOnLoopbackWithSelectLoop {
+    RRPingMulti *multi = [[RRPingMulti alloc] init];
+    __block BOOL done = NO;
+    __block BOOL succeeded = NO;
+    [multi addPingToAddress:@"127.0.0.1" timeout:2.0 completion:^(BOOL isSuccess, NSTimeInterval latency, RRProbeFailureReason failureReason) {
+        succeeded = isSuccess;
+        done = YES;
+    }];
+
+    // A minimal host event loop on this thread
+    while (!done) {
+        fd_set readable;
+        FD_ZERO(&readable);
+        int maxFD = -1;
+        NSIndexSet *fileDescriptors = multi.fileDescriptors;
+        for (NSUInteger fd = fileDescriptors.firstIndex; fd != NSNotFound; fd = [fileDescriptors indexGreaterThanIndex:fd]) {
+            FD_SET((int) fd, &readable);
+            maxFD = MAX(maxFD, (int) fd);
+        }
+        NSTimeInterval timeout = multi.nextTimeoutInterval;
+        struct timeval tv = {(time_t) timeout, (suseconds_t) ((timeout - floor(timeout)) * 1000000)};
+        if (select(maxFD + 1, &readable, NULL, NULL, &tv) > 0) {
+            for (NSUInteger fd = fileDescriptors.firstIndex; fd != NSNotFound; fd = [fileDescriptors indexGreaterThanIndex:fd]) {
+                if (FD_ISSET((int) fd, &readable)) {
+                    [multi handleReadableFileDescriptor:(int) fd];
+                }
+            }
+        } else {
+            [multi handleTimeout];
+        }
+    }
+
+    XCTAssertTrue(succeeded);
+}
+
+#pragma mark - Suspend and Resume Tests
+
+- (void)testSuspendStopsProbingAndResumeRunsCatchUpProbe {
+    RRReachabilityProbeStub *reachability = [[RRReachabilityProbeStub alloc] init];
+    RRPathMonitorFake *fakeMonitor = [[RRPathMonitorFake alloc] init];
+    reachability.stubProbeReachable = YES;
+    reachability.periodicProbeEnabled = NO;
+    [reachability setValue:fakeMonitor forKey:@"pathMonitor"];
+    [reachability startNotifier];
+
+    [fakeMonitor triggerPathSatisfied:YES connectionType:RRConnectionTypeWiFi];
+    XCTestExpectation *initial = [self expectationForNotification:kRRReachabilityChangedNotification object:reachability handler:nil];
+    [self waitForExpectations:@[initial] timeout:1.0];
+    XCTAssertEqual(reachability.probeCount, 1u);
+    XCTAssertGreaterThanOrEqual(reachability.statusAge, 0);
+
+    [reachability suspend];
+    XCTAssertTrue(reachability.isNotifierRunning);
+    XCTAssertTrue(reachability.isNotifierSuspended);
+    [fakeMonitor triggerPathSatisfied:YES connectionType:RRConnectionTypeWiFi];
+    [self drainMainQueue];
+    XCTAssertEqual(reachability.probeCount, 1u, @"a suspended notifier does not probe");
+
+    [NSThread sleepForTimeInterval:0.1];
+    XCTestExpectation *resumed = [self expectationWithDescription:@"resume reports after the catch-up probe"];
+    __block NSTimeInterval reportedStaleness = -1;
+    __block RRReachabilityStatus reportedStatus = RRReachabilityStatusUnknown;
+    [reachability resumeWithCompletion:^(NSTimeInterval staleness, RRReachabilityStatus status) {
+        reportedStaleness = staleness;
+        reportedStatus = status;
+        [resumed fulfill];
+    }];
+    XCTAssertFalse(reachability.isNotifierSuspended);
+    // The fake monitor does not report on start; deliver the fresh path a real monitor would.
+    [fakeMonitor triggerPathSatisfied:YES connectionType:RRConnectionTypeWiFi];
+    [self waitForExpectations:@[resumed] timeout:1.0];
+
+    XCTAssertEqual(reachability.probeCount, 2u);
+    XCTAssertGreaterThanOrEqual(reportedStaleness, 0.1);
+    XCTAssertEqual(reportedStatus, RRReachabilityStatusReachable);
+    XCTAssertLessThan(reachability.statusAge, reportedStaleness, @"the catch-up probe refreshed the status");
+    [reachability stopNotifier];
+    XCTAssertFalse(reachability.isNotifierSuspended);
+}
+
+- (void)testSuspendDuringRealProbeDoesNotLeaveCatchUpWaitingForWatchdog {
+    RRReachability *reachability = [[RRReachability alloc] init];
+    RRPathMonitorFake *fakeMonitor = [[RRPathMonitorFake alloc] init];
+    [reachability setValue:fakeMonitor forKey:@"pathMonitor"];
+    reachability.periodicProbeEnabled = NO;
+    reachability.probeMode = RRProbeModeICMPOnly;
+    // TEST-NET-1 never answers, so the ping is still in flight when the notifier suspends.
+    reachability.icmpHost = @"192.0.2.1";
+    reachability.timeout = 1.0;
+    [reachability startNotifier];
+    [fakeMonitor triggerPathSatisfied:YES connectionType:RRConnectionTypeWired];
+    
+    [reachability suspend];
+    XCTestExpectation *resumed = [self expectationWithDescription:@"catch-up probe reports before the watchdog deadline"];
+    [reachability resumeWithCompletion:^(NSTimeInterval staleness, RRReachabilityStatus status) {
+        [resumed fulfill];
+    }];
+    [fakeMonitor triggerPathSatisfied:YES connectionType:RRConnectionTypeWired];
+    
+    // The watchdog would fire at timeout * 2 + 2s = 4s.
+    [self waitForExpectations:@[resumed] timeout:3.5];
+    XCTAssertNotEqual(reachability.lastFailureReason, RRProbeFailureReasonWatchdog);
+    XCTAssertNotEqual(reachability.lastFailureReason, RRProbeFailureReasonCancelled, @"the catch-up probe asks again instead of reporting the cancelled run");
+    XCTAssertEqual(reachability.watchdogFireCount, 0u);
+    [reachability stopNotifier];
+}
+
+- (void)testResumeWithoutSuspendReportsCurrentStatus {
+    RRReachability *reachability = [[RRReachability alloc] init];
+    XCTAssertEqual(reachability.statusAge, -1);
+    [reachability suspend];
+    XCTAssertFalse(reachability.isNotifierSuspended, @"only a running notifier can be suspended");
+
+    XCTestExpectation *resumed = [self expectationWithDescription:@"resume reports at once"];
+    [reachability resumeWithCompletion:^(NSTimeInterval staleness, RRReachabilityStatus status) {
+        XCTAssertEqual(staleness, -1);
+        XCTAssertEqual(status, RRReachabilityStatusUnknown);
+        [resumed fulfill];
+    }];
+    [self waitForExpectations:@[resumed] timeout:1.0];
+}
+
 #pragma mark - Notification Tests
 
 - (void)testNotificationNameDefined {
@@ -520,6 +2119,7 @@
     XCTAssertEqualObjects(kRRReachabilityStatusKey, @"kRRReachabilityStatusKey");
     XCTAssertEqualObjects(kRRConnectionTypeKey, @"kRRConnectionTypeKey");
     XCTAssertEqualObjects(kRRSecondaryReachableKey, @"kRRSecondaryReachableKey");
+    XCTAssertEqualObjects(kRRProbeFailureReasonKey, @"kRRProbeFailureReasonKey");
 }
 
 - (void)testNotificationPostedWhenStatusChanges {
@@ -629,6 +2229,29 @@
     [[NSNotificationCenter defaultCenter] removeObserver:observer];
 }
 
+- (void)testNotificationUserInfoContainsFailureReason {
+    RRReachability *reachability = [[RRReachability alloc] init];
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Notification userInfo should contain the failure reason"];
+    
+    id observer = [[NSNotificationCenter defaultCenter] addObserverForName:kRRReachabilityChangedNotification
+                                                                    object:reachability
+                                                                     queue:[NSOperationQueue mainQueue]
+                                                                usingBlock:^(NSNotification *notification) {
+        NSNumber *failureReason = notification.userInfo[kRRProbeFailureReasonKey];
+        XCTAssertEqual(failureReason.integerValue, RRProbeFailureReasonDNS);
+        XCTAssertEqual(reachability.lastFailureReason, RRProbeFailureReasonDNS);
+        [expectation fulfill];
+    }];
+    
+    [reachability updateStatus:RRReachabilityStatusNotReachable
+                connectionType:RRConnectionTypeWiFi
+            secondaryReachable:NO
+                 failureReason:RRProbeFailureReasonDNS];
+    
+    [self waitForExpectationsWithTimeout:1.0 handler:nil];
+    [[NSNotificationCenter defaultCenter] removeObserver:observer];
+}
+
 - (void)testNotificationPostedWhenConnectionTypeChangesViaPathHandler {
     RRReachabilityProbeStub *reachability = [[RRReachabilityProbeStub alloc] init];
     RRPathMonitorFake *fakeMonitor = [[RRPathMonitorFake alloc] init];
@@ -0,0 +1,117 @@
+//
+//  ConnectivityPredictorSimulationTests.swift
+//  RealReachability2
+//
+//  Replays simulated days with recurring outages (commute tunnels) to measure
+//  what predictive scheduling saves in probes and gains in detection latency.
+//
+
+import XCTest
+@testable import RealReachability2
+
+@available(iOS 13.0, macOS 10.15, *)
+final class ConnectivityPredictorSimulationTests: XCTestCase {
+    private struct SimulationResult {
+        var probes = 0
+        var detectionLatencies: [TimeInterval] = []
+
+        var meanDetectionLatency: TimeInterval {
+            detectionLatencies.isEmpty ? 0 : detectionLatencies.reduce(0, +) / Double(detectionLatencies.count)
+        }
+    }
+
+    private let network = "wifi|en0|192.168.1.1"
+    private let baseInterval: TimeInterval = 60
+    private let day: TimeInterval = 86_400
+
+    /// Daily outages as (start, duration) in seconds since midnight: 08:10:25 and 18:10:25 for 12 minutes
+    private let dailyOutages: [(start: TimeInterval, duration: TimeInterval)] = [
+        (8 * 3600 + 10 * 60 + 25, 12 * 60),
+        (18 * 3600 + 10 * 60 + 25, 12 * 60)
+    ]
+
+    private var utcCalendar: Calendar {
+        var calendar = Calendar(identifier: .gregorian)
+        calendar.timeZone = TimeZone(identifier: "UTC")!
+        return calendar
+    }
+
+    /// Monday 2026-01-05 00:00:00 UTC
+    private var epoch: Date {
+        Date(timeIntervalSince1970: 1_767_571_200)
+    }
+
+    private func outageWindows(days: Range<Int>) -> [Range<TimeInterval>] {
+        days.flatMap { dayIndex in
+            dailyOutages.map { outage in
+                let start = Double(dayIndex) * day + outage.start
+                return start..<(start + outage.duration)
+            }
+        }
+    }
+
+    /// Probes from the start of the first day to the end of the last one on a simulated clock,
+    /// recording each result into the predictor (if any) and sleeping for the delay the engine's
+    /// periodic scheduler computes, aligned on a coordinator started at the epoch.
+    private func simulate(days: Range<Int>, predictor: ConnectivityPredictor?) -> SimulationResult {
+        let windows = outageWindows(days: days)
+        let coordinator = ProbeCoordinator(epoch: epoch)
+        let untrained = ConnectivityPredictor(calendar: utcCalendar)
+        var detected = Set<Int>()
+        var result = SimulationResult()
+
+        var time = Double(days.lowerBound) * day
+        let end = Double(days.upperBound) * day
+        while time < end {
+            let date = epoch.addingTimeInterval(time)
+            let outageIndex = windows.firstIndex { $0.contains(time) }
+            result.probes += 1
+
+            if let outageIndex, !detected.contains(outageIndex) {
+                detected.insert(outageIndex)
+                result.detectionLatencies.append(time - windows[outageIndex].lowerBound)
+            }
+
+            predictor?.record(reachable: outageIndex == nil, network: network, at: date)
+            time += RealReachability.periodicProbeDelay(interval: baseInterval, backoff: 1,
+                                                        network: predictor == nil ? nil : network,
+                                                        predictor: predictor ?? untrained,
+                                                        coordinator: coordinator, now: date)
+        }
+
+        XCTAssertEqual(detected.count, windows.count, "Every outage should be detected")
+        return result
+    }
+
+    func testPredictiveSchedulingSavesProbesAndDetectsOutagesSooner() {
+        let predictor = ConnectivityPredictor(calendar: utcCalendar)
+
+        // Two weeks of history to learn from
+        _ = simulate(days: 0..<14, predictor: predictor)
+
+        let fixed = simulate(days: 14..<15, predictor: nil)
+        let predictive = simulate(days: 14..<15, predictor: predictor)
+
+        let saved = 1 - Double(predictive.probes) / Double(fixed.probes)
+        let fastestInterval = baseInterval * ConnectivityPredictor.outageIntervalMultiplier
+
+        XCTAssertEqual(fixed.probes, Int(day / baseInterval))
+        XCTAssertGreaterThanOrEqual(saved, 0.35, "Stable periods should be probed less often")
+        XCTAssertLessThanOrEqual(saved, 1 - 1 / ConnectivityPredictor.stableIntervalMultiplier,
+                                 "No period is probed less often than the stable multiplier allows")
+        XCTAssertEqual(predictive.detectionLatencies.count, dailyOutages.count)
+        XCTAssertLessThan(predictive.detectionLatencies.max() ?? .infinity, fastestInterval,
+                          "Outages should be caught within one sped-up interval")
+        XCTAssertLessThanOrEqual(predictive.meanDetectionLatency, 10)
+        XCTAssertGreaterThanOrEqual(fixed.meanDetectionLatency - predictive.meanDetectionLatency, 20)
+    }
+
+    func testPredictorStaysNeutralWithoutHistory() {
+        let predictor = ConnectivityPredictor(calendar: utcCalendar)
+
+        let fixed = simulate(days: 0..<1, predictor: nil)
+        let firstDay = simulate(days: 0..<1, predictor: predictor)
+
+        XCTAssertEqual(firstDay.probes, fixed.probes, "An untrained model should not change the schedule")
+    }
+}
@@ -0,0 +1,445 @@
+//
+//  FaultInjectionBenchmarkTests.swift
+//  RealReachability2
+//
+//  Runs RealReachability against a loopback probe target that fails on demand (blackhole,
+//  reset, latency spike, loss ramp, captive redirect) and measures how quickly outages and
+//  recoveries are noticed. Results are written as JSON so configurations and versions can be
+//  compared; set RR_BENCHMARK_OUTPUT to the directory the report should go to.
+//
+
+import XCTest
+import Network
+@testable import RealReachability2
+
+@available(iOS 13.0, macOS 10.15, *)
+final class FaultInjectionBenchmarkTests: XCTestCase {
+    /// Engine settings under test
+    private struct BenchmarkConfiguration {
+        let name: String
+        let timeout: TimeInterval
+        let periodicProbeInterval: TimeInterval
+    }
+
+    /// One way for the probe target to fail
+    private struct FaultScenario {
+        let name: String
+        let fault: InjectedFault
+
+        /// Whether the fault is an outage; a latency spike within the timeout is not
+        let expectsOutage: Bool
+    }
+
+    /// Measurements of one scenario under one configuration; times are in seconds
+    private struct ScenarioResult: Encodable {
+        let engine: String
+        let configuration: String
+        let timeout: TimeInterval
+        let periodicProbeInterval: TimeInterval
+        let fault: String
+        let expectsOutage: Bool
+
+        /// From fault onset to the first not-reachable status (omitted if never reported)
+        let timeToDetectDown: TimeInterval?
+
+        /// From the fault clearing to the first reachable status after it (omitted if never reported)
+        let timeToDetectUp: TimeInterval?
+
+        /// Status changes beyond the expected down and up
+        let falseTransitions: Int
+
+        /// Probe requests the target received from fault onset until recovery was reported
+        let probesSpent: Int
+    }
+
+    private struct BenchmarkReport: Encodable {
+        let suite: String
+        let schemaVersion: Int
+        let generatedAt: String
+        let platform: String
+        let results: [ScenarioResult]
+    }
+
+    private let configurations = [
+        BenchmarkConfiguration(name: "fast", timeout: 0.5, periodicProbeInterval: 0.5),
+        BenchmarkConfiguration(name: "standard", timeout: 1.0, periodicProbeInterval: 1.0)
+    ]
+
+    override func setUpWithError() throws {
+        // Timing measurements on shared runners are noise; run locally
+        if ProcessInfo.processInfo.environment["CI"] == "true" {
+            throw XCTSkip("Skipping time-to-detect benchmark on CI environment")
+        }
+    }
+
+    private func scenarios(for configuration: BenchmarkConfiguration) -> [FaultScenario] {
+        [
+            FaultScenario(name: "blackhole", fault: .blackhole, expectsOutage: true),
+            FaultScenario(name: "reset", fault: .reset, expectsOutage: true),
+            FaultScenario(name: "latency-spike", fault: .delay(configuration.timeout * 0.5), expectsOutage: false),
+            FaultScenario(name: "loss-ramp", fault: .lossRamp(duration: configuration.periodicProbeInterval * 4), expectsOutage: true),
+            FaultScenario(name: "captive-redirect", fault: .captiveRedirect, expectsOutage: true)
+        ]
+    }
+
+    func testTimeToDetectUnderInjectedFaults() async throws {
+        var results: [ScenarioResult] = []
+        for configuration in configurations {
+            for scenario in scenarios(for: configuration) {
+                let result = try await run(scenario, configuration: configuration)
+                results.append(result)
+
+                let label = "\(configuration.name)/\(scenario.name)"
+                if scenario.expectsOutage {
+                    XCTAssertNotNil(result.timeToDetectDown, "\(label): outage not detected")
+                    XCTAssertNotNil(result.timeToDetectUp, "\(label): recovery not detected")
+                } else {
+                    XCTAssertNil(result.timeToDetectDown, "\(label): reported an outage that was not one")
+                }
+                assertWithinSchedule(result, scenario: scenario, configuration: configuration)
+            }
+        }
+
+        let formatter = ISO8601DateFormatter()
+        let report = BenchmarkReport(suite: "fault-injection-time-to-detect",
+                                     schemaVersion: 1,
+                                     generatedAt: formatter.string(from: Date()),
+                                     platform: ProcessInfo.processInfo.operatingSystemVersionString,
+                                     results: results)
+        let encoder = JSONEncoder()
+        encoder.outputFormatting = [.prettyPrinted, .sortedKeys]
+        let json = try encoder.encode(report)
+
+        let directory = ProcessInfo.processInfo.environment["RR_BENCHMARK_OUTPUT"] ?? NSTemporaryDirectory()
+        let path = (directory as NSString).appendingPathComponent("RealReachability2-fault-benchmark-swift.json")
+        try json.write(to: URL(fileURLWithPath: path))
+    }
+
+    /// Holds a result to what the periodic schedule allows. A change is reported within two
+    /// intervals plus two probe timeouts (the tick, then a retry after a transient failure).
+    /// The fault window costs at most two probes per interval, plus a few for in-flight work.
+    private func assertWithinSchedule(_ result: ScenarioResult, scenario: FaultScenario, configuration: BenchmarkConfiguration) {
+        let label = "\(configuration.name)/\(scenario.name)"
+        let interval = configuration.periodicProbeInterval
+        let reportBound = interval * 2 + configuration.timeout * 2 + 1
+
+        var window = interval * 6
+        if scenario.expectsOutage, let down = result.timeToDetectDown, let up = result.timeToDetectUp {
+            window = down + interval * 2 + up
+            XCTAssertLessThanOrEqual(up, reportBound, "\(label): recovery reported late")
+            if case .lossRamp = scenario.fault {
+                // Drops ramp up gradually, so the first failing probe can come late and the status may flap.
+            } else {
+                XCTAssertLessThanOrEqual(down, reportBound, "\(label): outage reported late")
+                XCTAssertEqual(result.falseTransitions, 0, "\(label): status flapped")
+            }
+        } else if !scenario.expectsOutage {
+            XCTAssertEqual(result.falseTransitions, 0, "\(label): status flapped")
+        }
+
+        let probeBudget = Int((window / interval).rounded(.up)) * 2 + 4
+        XCTAssertGreaterThanOrEqual(result.probesSpent, scenario.expectsOutage ? 2 : 3,
+                                    "\(label): the target was not probed through the fault")
+        XCTAssertLessThanOrEqual(result.probesSpent, probeBudget, "\(label): probed more than the schedule allows")
+    }
+
+    /// Brings a fresh engine up against a healthy target, injects the fault, clears it once the
+    /// outage was reported (or after a while, for faults that are not outages) and watches the
+    /// engine settle.
+    private func run(_ scenario: FaultScenario, configuration: BenchmarkConfiguration) async throws -> ScenarioResult {
+        let server = FaultInjectingHTTPServer()
+        guard let port = await server.start() else {
+            throw XCTSkip("Could not start the loopback probe target")
+        }
+        defer { server.stop() }
+
+        let url = URL(string: "http://127.0.0.1:\(port)/generate_204")!
+        let profile = ProbeProfile(probeMode: .httpOnly,
+                                   timeout: configuration.timeout,
+                                   periodicProbeInterval: configuration.periodicProbeInterval,
+                                   httpProbeURL: url)
+        let profiles = Dictionary(uniqueKeysWithValues: [ConnectionType.wifi, .cellular, .wired, .other].map { ($0, profile) })
+        let reachability = RealReachability(configuration: ReachabilityConfiguration(probeMode: .httpOnly,
+                                                                                     timeout: configuration.timeout,
+                                                                                     httpProbeURL: url,
+                                                                                     profiles: profiles),
+                                            nat64Resolver: NAT64PrefixResolver(),
+                                            connectivityPredictor: ConnectivityPredictor(),
+                                            probeCoordinator: ProbeCoordinator())
+        let timeline = StatusTimeline()
+        let observer = Task {
+            for await status in reachability.statusStream {
+                timeline.record(status)
+            }
+        }
+        defer {
+            observer.cancel()
+            reachability.stopNotifier()
+        }
+
+        let interval = configuration.periodicProbeInterval
+        let detectionBudget = configuration.timeout * 4 + interval * 8 + 2
+        guard let baseline = await timeline.waitForTransition(toReachable: true, after: 0, timeout: 5) else {
+            // Without a satisfied path the engine never probes, even on loopback.
+            throw XCTSkip("Needs a satisfied network path")
+        }
+        try await Task.sleep(nanoseconds: UInt64(interval * 2 * 1_000_000_000))
+
+        let faultStart = ProcessInfo.processInfo.systemUptime
+        let requestsBefore = server.probeRequestCount
+        server.inject(scenario.fault)
+
+        var down: TimeInterval?
+        if scenario.expectsOutage {
+            var budget = detectionBudget
+            if case .lossRamp(let duration) = scenario.fault {
+                budget += duration
+            }
+            down = await timeline.waitForTransition(toReachable: false, after: faultStart, timeout: budget)
+            try await Task.sleep(nanoseconds: UInt64(interval * 2 * 1_000_000_000))
+        } else {
+            try await Task.sleep(nanoseconds: UInt64(interval * 6 * 1_000_000_000))
+            down = timeline.firstTransition(toReachable: false, after: faultStart)
+        }
+
+        let faultEnd = ProcessInfo.processInfo.systemUptime
+        server.inject(.none)
+        var up: TimeInterval?
+        if down != nil {
+            up = await timeline.waitForTransition(toReachable: true, after: faultEnd, timeout: detectionBudget)
+        }
+        let probesSpent = server.probeRequestCount - requestsBefore
+        try await Task.sleep(nanoseconds: UInt64(interval * 2 * 1_000_000_000))
+
+        let expectedTransitions = (down == nil ? 0 : 1) + (up == nil ? 0 : 1)
+        return ScenarioResult(engine: "swift",
+                              configuration: configuration.name,
+                              timeout: configuration.timeout,
+                              periodicProbeInterval: interval,
+                              fault: scenario.name,
+                              expectsOutage: scenario.expectsOutage,
+                              timeToDetectDown: down.map { $0 - faultStart },
+                              timeToDetectUp: up.map { $0 - faultEnd },
+                              falseTransitions: timeline.transitionCount(after: baseline) - expectedTransitions,
+                              probesSpent: probesSpent)
+    }
+}
+
+// MARK: - Helpers
+
+/// How the probe target misbehaves
+@available(iOS 13.0, macOS 10.15, *)
+private enum InjectedFault {
+    /// Answers every probe
+    case none
+
+    /// Accepts connections and reads requests but never answers
+    case blackhole
+
+    /// Aborts the connection with a TCP reset on every request
+    case reset
+
+    /// Answers every probe after a delay
+    case delay(TimeInterval)
+
+    /// Drops a share of requests that grows linearly to all of them over `duration`
+    case lossRamp(duration: TimeInterval)
+
+    /// Redirects probes to a sign-in page, like a captive portal
+    case captiveRedirect
+}
+
+/// Reachable and not-reachable statuses with the uptime they arrived at; repeats are dropped
+@available(iOS 13.0, macOS 10.15, *)
+private final class StatusTimeline: @unchecked Sendable {
+    private let lock = NSLock()
+    private var entries: [(time: TimeInterval, reachable: Bool)] = []
+
+    func record(_ status: ReachabilityStatus) {
+        guard status != .unknown else {
+            return
+        }
+        let time = ProcessInfo.processInfo.systemUptime
+        lock.lock()
+        defer { lock.unlock() }
+        if entries.last?.reachable != status.isReachable {
+            entries.append((time, status.isReachable))
+        }
+    }
+
+    /// Time of the first change to the given state at or after `after`
+    func firstTransition(toReachable reachable: Bool, after: TimeInterval) -> TimeInterval? {
+        lock.lock()
+        defer { lock.unlock() }
+        return entries.first { $0.time >= after && $0.reachable == reachable }?.time
+    }
+
+    /// Changes recorded after `after`
+    func transitionCount(after: TimeInterval) -> Int {
+        lock.lock()
+        defer { lock.unlock() }
+        return entries.filter { $0.time > after }.count
+    }
+
+    /// Polls for the first change to the given state; the result is the time it was recorded,
+    /// so the polling period does not skew the measurement.
+    func waitForTransition(toReachable reachable: Bool, after: TimeInterval, timeout: TimeInterval) async -> TimeInterval? {
+        let deadline = ProcessInfo.processInfo.systemUptime + timeout
+        while ProcessInfo.processInfo.systemUptime < deadline {
+            if let time = firstTransition(toReachable: reachable, after: after) {
+                return time
+            }
+            try? await Task.sleep(nanoseconds: 10_000_000)
+        }
+        return firstTransition(toReachable: reachable, after: after)
+    }
+}
+
+/// Loopback HTTP stand-in for the probe target that fails on demand
+@available(iOS 13.0, macOS 10.15, *)
+private final class FaultInjectingHTTPServer: @unchecked Sendable {
+    private let queue = DispatchQueue(label: "com.realreachability2.tests.faultinjection")
+    private let lock = NSLock()
+    private var listener: NWListener?
+    private var fault: InjectedFault = .none
+    private var faultStart: TimeInterval = 0
+    private var lossCredit = 0.0
+    private var probeRequests = 0
+
+    /// Connections left unanswered by the current fault, only touched on `queue`
+    private var stalled: [NWConnection] = []
+
+    /// Probe requests received, answered or not (sign-in page fetches are not counted)
+    var probeRequestCount: Int {
+        lock.lock()
+        defer { lock.unlock() }
+        return probeRequests
+    }
+
+    /// Switches to a new fault; connections the previous one left hanging are closed
+    func inject(_ fault: InjectedFault) {
+        lock.lock()
+        self.fault = fault
+        faultStart = ProcessInfo.processInfo.systemUptime
+        lossCredit = 0
+        lock.unlock()
+
+        queue.async { [self] in
+            stalled.forEach { $0.cancel() }
+            stalled = []
+        }
+    }
+
+    /// Starts listening on an ephemeral loopback port
+    /// - Returns: The port, or nil if the listener could not start
+    func start() async -> UInt16? {
+        guard let listener = try? NWListener(using: .tcp, on: .any) else {
+            return nil
+        }
+        self.listener = listener
+
+        listener.newConnectionHandler = { [self] connection in
+            connection.start(queue: queue)
+            readRequest(on: connection, buffered: Data())
+        }
+
+        return await withCheckedContinuation { continuation in
+            var resumed = false
+            listener.stateUpdateHandler = { state in
+                guard !resumed else { return }
+                switch state {
+                case .ready:
+                    resumed = true
+                    continuation.resume(returning: listener.port?.rawValue)
+                case .failed, .cancelled:
+                    resumed = true
+                    continuation.resume(returning: nil)
+                default:
+                    break
+                }
+            }
+            listener.start(queue: queue)
+        }
+    }
+
+    func stop() {
+        listener?.cancel()
+        listener = nil
+        inject(.none)
+    }
+
+    private func readRequest(on connection: NWConnection, buffered: Data) {
+        connection.receive(minimumIncompleteLength: 1, maximumLength: 65_536) { [self] data, _, isComplete, error in
+            var buffered = buffered
+            if let data {
+                buffered.append(data)
+            }
+            guard let headerEnd = buffered.range(of: Data("\r\n\r\n".utf8)) else {
+                if error == nil, !isComplete {
+                    readRequest(on: connection, buffered: buffered)
+                }
+                return
+            }
+
+            let head = String(decoding: buffered[..<headerEnd.lowerBound], as: UTF8.self)
+            let requestLine = head.prefix { $0 != "\r" }.split(separator: " ")
+            guard requestLine.count >= 2 else {
+                connection.cancel()
+                return
+            }
+            let rest = Data(buffered[headerEnd.upperBound...])
+            handle(method: String(requestLine[0]), path: String(requestLine[1]), on: connection, rest: rest)
+        }
+    }
+
+    /// Answers one request as the current fault dictates; called on `queue`
+    private func handle(method: String, path: String, on connection: NWConnection, rest: Data) {
+        let isPortal = path.hasPrefix("/portal")
+        lock.lock()
+        let fault = self.fault
+        var dropped = false
+        if !isPortal {
+            probeRequests += 1
+            if case .lossRamp(let duration) = fault {
+                // Drops are spread evenly: the credit accumulates the current loss rate.
+                let elapsed = ProcessInfo.processInfo.systemUptime - faultStart
+                lossCredit += duration > 0 ? min(elapsed / duration, 1) : 1
+                if lossCredit >= 1 {
+                    lossCredit -= 1
+                    dropped = true
+                }
+            }
+        }
+        lock.unlock()
+
+        let answer = { [self] (response: String) in
+            connection.send(content: Data(response.utf8), completion: .idempotent)
+            readRequest(on: connection, buffered: rest)
+        }
+
+        switch fault {
+        case .blackhole:
+            stalled.append(connection)
+        case .reset:
+            // Skips the orderly close; the peer sees the connection aborted.
+            connection.forceCancel()
+        case .delay(let seconds):
+            queue.asyncAfter(deadline: .now() + seconds) {
+                answer(Self.response(method: method, status: "204 No Content"))
+            }
+        case .lossRamp where dropped:
+            stalled.append(connection)
+        case .captiveRedirect where isPortal:
+            answer(Self.response(method: method, status: "200 OK", body: "<html><body>Sign in to continue</body></html>"))
+        case .captiveRedirect:
+            answer(Self.response(method: method, status: "302 Found", headers: "Location: /portal\r\n"))
+        case .none, .lossRamp:
+            answer(Self.response(method: method, status: isPortal ? "200 OK" : "204 No Content"))
+        }
+    }
+
+    /// An HTTP/1.1 response; HEAD responses announce the body without sending it
+    private static func response(method: String, status: String, headers: String = "", body: String = "") -> String {
+        "HTTP/1.1 \(status)\r\n\(headers)Content-Length: \(body.utf8.count)\r\n\r\n\(method == "HEAD" ? "" : body)"
+    }
+}
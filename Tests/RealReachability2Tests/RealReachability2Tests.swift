@@ -6,6 +6,7 @@
 //
 
 import XCTest
+import Network
 @testable import RealReachability2
 
 @available(iOS 13.0, macOS 10.15, *)
@@ -115,6 +116,32 @@ final class RealReachability2Tests: XCTestCase {
         XCTAssertEqual(config.timeout, 0.5)
     }
     
+    func testConfigurationProfileFallsBackToTopLevelSettings() {
+        let config = ReachabilityConfiguration(probeMode: .httpOnly, timeout: 7.0, icmpHost: "1.1.1.1")
+        let profile = config.profile(for: .cellular)
+        XCTAssertEqual(profile.probeMode, .httpOnly)
+        XCTAssertEqual(profile.timeout, 7.0)
+        XCTAssertEqual(profile.icmpHost, "1.1.1.1")
+        XCTAssertEqual(profile.periodicProbeInterval, 5.0)
+    }
+    
+    func testConfigurationProfilePerConnectionType() {
+        let wired = ProbeProfile(probeMode: .icmpOnly, timeout: 1.0, periodicProbeInterval: 2.0)
+        let cellular = ProbeProfile(probeMode: .httpOnly, periodicProbeInterval: 60.0)
+        let config = ReachabilityConfiguration(profiles: [.wired: wired, .cellular: cellular])
+        
+        XCTAssertEqual(config.profile(for: .wired), wired)
+        XCTAssertEqual(config.profile(for: .cellular), cellular)
+        XCTAssertEqual(config.profile(for: .wifi).probeMode, .parallel)
+    }
+    
+    func testActiveProfileBeforeFirstProbe() {
+        let config = ReachabilityConfiguration(probeMode: .icmpOnly, timeout: 3.0)
+        let reachability = RealReachability(configuration: config)
+        XCTAssertEqual(reachability.activeProfile.probeMode, .icmpOnly)
+        XCTAssertEqual(reachability.activeProfile.timeout, 3.0)
+    }
+    
     // MARK: - HTTPProber Tests
     
     func testHTTPProberDefaultURL() {
@@ -148,6 +175,123 @@ final class RealReachability2Tests: XCTestCase {
         }
     }
     
+    func testPinnedHTTPProbeConnectsToCachedAddressWithHostHeader() async throws {
+        let server = ThrottledHTTPServer(bytesPerSecond: 1_000_000)
+        defer { server.stop() }
+        let port = try XCTUnwrap(await server.start())
+        
+        let lookups = QueryCounter()
+        let cache = PinnedAddressCache(hostName: "probe.test") { hostName in
+            lookups.record(hostName)
+            return [ResolvedAddress(address: "127.0.0.1", ttl: 300)]
+        }
+        let prober = HTTPProber(url: URL(string: "http://probe.test:\(port)/ping")!, timeout: 3.0, addressCache: cache)
+        
+        let first = await prober.probeWithDetails()
+        let second = await prober.probeWithDetails()
+        
+        XCTAssertTrue(first.success)
+        XCTAssertTrue(second.success)
+        XCTAssertEqual(lookups.names, ["probe.test"], "The host should be resolved once within its TTL")
+        XCTAssertEqual(server.hostHeaders, ["probe.test:\(port)", "probe.test:\(port)"])
+    }
+    
+    func testPinnedAddressCacheRefreshesOnExpiryAndInvalidation() async throws {
+        let lookups = QueryCounter()
+        let cache = PinnedAddressCache(hostName: "probe.test", minimumTTL: 0) { hostName in
+            lookups.record(hostName)
+            return [ResolvedAddress(address: "192.0.2.\(lookups.names.count)", ttl: 0)]
+        }
+        
+        let first = await cache.address()
+        XCTAssertEqual(first, "192.0.2.1")
+        
+        // Expired: the stale address is served while a refresh runs in the background.
+        let stale = await cache.address()
+        XCTAssertEqual(stale, "192.0.2.1")
+        for _ in 0..<100 where lookups.names.count < 2 {
+            try await Task.sleep(nanoseconds: 10_000_000)
+        }
+        XCTAssertEqual(lookups.names.count, 2)
+        
+        cache.invalidate()
+        let refreshed = await cache.address()
+        XCTAssertEqual(refreshed, "192.0.2.3")
+    }
+    
+    func testPinnedAddressCacheInvalidationDiscardsLookupInFlight() async throws {
+        let lookups = QueryCounter()
+        let cache = PinnedAddressCache(hostName: "probe.test") { hostName in
+            lookups.record(hostName)
+            if lookups.names.count == 1 {
+                // The previous network's answer arrives after the link change.
+                try? await Task.sleep(nanoseconds: 200_000_000)
+                return [ResolvedAddress(address: "192.0.2.1", ttl: 300)]
+            }
+            return [ResolvedAddress(address: "198.51.100.1", ttl: 300)]
+        }
+        
+        cache.prefetch()
+        for _ in 0..<100 where lookups.names.isEmpty {
+            try await Task.sleep(nanoseconds: 1_000_000)
+        }
+        cache.invalidate()
+        cache.prefetch()
+        
+        let current = await cache.address()
+        XCTAssertEqual(current, "198.51.100.1", "A refresh after invalidation should not join the old lookup")
+        
+        try await Task.sleep(nanoseconds: 300_000_000)
+        let later = await cache.address()
+        XCTAssertEqual(later, "198.51.100.1", "The old lookup's answer must not be pinned")
+        XCTAssertEqual(lookups.names.count, 2)
+    }
+    
+    func testPinnedAddressCacheReportsUnresolvableHost() async {
+        let cache = PinnedAddressCache(hostName: "probe.invalid") { _ in [] }
+        let prober = HTTPProber(url: URL(string: "https://probe.invalid/generate_204")!, timeout: 1.0, addressCache: cache)
+        let result = await prober.probeWithDetails()
+        XCTAssertFalse(result.success)
+        XCTAssertEqual(result.failureReason, .dnsFailure)
+    }
+    
+    func testPinnedHTTPSProbeResumesTLSSession() async throws {
+        let responder = try XCTUnwrap(TLSHeadResponder())
+        defer { responder.stop() }
+        let port = try XCTUnwrap(await responder.start())
+        
+        let cache = PinnedAddressCache(hostName: "resume.test") { _ in [ResolvedAddress(address: "127.0.0.1", ttl: 300)] }
+        let prober = HTTPProber(url: URL(string: "https://resume.test:\(port)/generate_204")!,
+                                timeout: 3.0,
+                                addressCache: cache) { _ in true }
+        
+        let first = await prober.probeWithDetails()
+        let second = await prober.probeWithDetails()
+        
+        XCTAssertTrue(first.success)
+        XCTAssertEqual(first.tlsHandshake, .full)
+        XCTAssertTrue(second.success)
+        XCTAssertEqual(second.tlsHandshake, .resumed, "The second connection should resume the ticket from the first")
+        XCTAssertEqual(prober.tlsHandshakeCounts, TLSHandshakeCounts(resumed: 1, full: 1))
+        XCTAssertEqual(responder.connectionCount, 2)
+    }
+    
+    func testPinnedHTTPSProbeRejectsUntrustedCertificate() async throws {
+        let responder = try XCTUnwrap(TLSHeadResponder())
+        defer { responder.stop() }
+        let port = try XCTUnwrap(await responder.start())
+        
+        let cache = PinnedAddressCache(hostName: "untrusted.test") { _ in [ResolvedAddress(address: "127.0.0.1", ttl: 300)] }
+        let prober = HTTPProber(url: URL(string: "https://untrusted.test:\(port)/generate_204")!,
+                                timeout: 3.0,
+                                addressCache: cache) { _ in false }
+        
+        let result = await prober.probeWithDetails()
+        XCTAssertFalse(result.success)
+        XCTAssertEqual(result.failureReason, .tlsFailure)
+        XCTAssertEqual(prober.tlsHandshakeCounts, TLSHandshakeCounts())
+    }
+    
     // MARK: - PingFoundation Tests
     
     func testPingFoundationInitialization() {
@@ -240,159 +384,1576 @@ final class RealReachability2Tests: XCTestCase {
         }
     }
     
-    // MARK: - RealReachability Tests
+    // MARK: - PacketCapture Tests
+
+    private func socketAddress(ipv4 literal: String) -> Data {
+        var address = sockaddr_in()
+        address.sin_len = UInt8(MemoryLayout<sockaddr_in>.size)
+        address.sin_family = sa_family_t(AF_INET)
+        inet_pton(AF_INET, literal, &address.sin_addr)
+        return withUnsafeBytes(of: address) { Data($0) }
+    }
+
+    private func socketAddress(ipv6 literal: String) -> Data {
+        var address = sockaddr_in6()
+        address.sin6_len = UInt8(MemoryLayout<sockaddr_in6>.size)
+        address.sin6_family = sa_family_t(AF_INET6)
+        inet_pton(AF_INET6, literal, &address.sin6_addr)
+        return withUnsafeBytes(of: address) { Data($0) }
+    }
+
+    private func readUInt32(_ data: Data, at offset: Int) -> UInt32 {
+        (0..<4).reduce(UInt32(0)) { $0 | UInt32(data[data.startIndex + offset + $1]) << (8 * $1) }
+    }
+
+    /// Offsets of the enhanced packet blocks, checking every block's framing on the way
+    private func enhancedPacketBlockOffsets(in data: Data) -> [Int] {
+        var offsets: [Int] = []
+        var offset = 0
+        while offset + 8 <= data.count {
+            let length = Int(readUInt32(data, at: offset + 4))
+            XCTAssertEqual(length % 4, 0)
+            XCTAssertEqual(Int(readUInt32(data, at: offset + length - 4)), length)
+            if readUInt32(data, at: offset) == PcapNG.enhancedPacketBlockType {
+                offsets.append(offset)
+            }
+            offset += length
+        }
+        XCTAssertEqual(offset, data.count)
+        return offsets
+    }
+
+    func testPacketCaptureExportsPcapngWithDirections() {
+        let capture = PacketCapture()
+        let echo = Data([8, 0, 0, 0, 0x12, 0x34, 0, 1]) + Data("ping".utf8)
+
+        capture.record(echo, direction: .outbound, peer: socketAddress(ipv4: "192.0.2.1"))
+        capture.record(echo, direction: .inbound, peer: socketAddress(ipv6: "2001:db8::1"))
+
+        let data = capture.pcapngData()
+        XCTAssertEqual(readUInt32(data, at: 0), PcapNG.sectionHeaderBlockType)
+        XCTAssertEqual(readUInt32(data, at: 8), PcapNG.byteOrderMagic)
+        XCTAssertEqual(readUInt32(data, at: 36) & 0xFFFF, UInt32(PcapNG.linkTypeIPv4))
+        XCTAssertEqual(readUInt32(data, at: 56) & 0xFFFF, UInt32(PcapNG.linkTypeIPv6))
+
+        let blocks = enhancedPacketBlockOffsets(in: data)
+        XCTAssertEqual(blocks.count, 2)
+        guard blocks.count == 2 else { return }
+
+        let outbound = blocks[0]
+        XCTAssertEqual(readUInt32(data, at: outbound + 8), 0)
+        XCTAssertEqual(readUInt32(data, at: outbound + 20), 32, "synthesized IPv4 header plus the echo")
+        XCTAssertEqual(data[outbound + 28], 0x45)
+        XCTAssertEqual(data[outbound + 28 + 16], 192, "the peer is the destination of an outbound packet")
+        XCTAssertEqual(readUInt32(data, at: outbound + 28 + 32 + 4), PcapNG.outboundFlag)
+
+        let inbound = blocks[1]
+        XCTAssertEqual(readUInt32(data, at: inbound + 8), 1)
+        XCTAssertEqual(readUInt32(data, at: inbound + 20), 52)
+        XCTAssertEqual(data[inbound + 28], 0x60)
+        XCTAssertEqual(data[inbound + 28 + 8], 0x20, "the peer is the source of an inbound packet")
+        XCTAssertEqual(readUInt32(data, at: inbound + 28 + 52 + 4), PcapNG.inboundFlag)
+    }
+
+    func testPacketCaptureKeepsReceivedIPv4HeaderAndTruncates() {
+        let capture = PacketCapture(capacity: 4, snapLength: 64)
+        var reply = Data(count: 120)
+        reply[0] = 0x45
+
+        capture.record(reply, direction: .inbound, peer: socketAddress(ipv4: "192.0.2.1"))
+
+        let data = capture.pcapngData()
+        guard let block = enhancedPacketBlockOffsets(in: data).first else {
+            return XCTFail("Expected a packet block")
+        }
+        XCTAssertEqual(readUInt32(data, at: block + 20), 64, "captured length stops at the snap length")
+        XCTAssertEqual(readUInt32(data, at: block + 24), 120, "no second header is added")
+    }
+
+    func testPacketCaptureRingIsBounded() {
+        let capture = PacketCapture(capacity: 2, snapLength: 64)
+        let peer = socketAddress(ipv4: "192.0.2.1")
+        for sequence: UInt8 in 0..<3 {
+            capture.record(Data([8, 0, 0, 0, 0, 0, 0, sequence]), direction: .outbound, peer: peer)
+        }
+
+        XCTAssertEqual(capture.packetCount, 2)
+        XCTAssertEqual(capture.totalPacketCount, 3)
+
+        let data = capture.pcapngData()
+        let blocks = enhancedPacketBlockOffsets(in: data)
+        XCTAssertEqual(blocks.count, 2)
+        XCTAssertEqual(blocks.first.map { data[$0 + 28 + 20 + 7] }, 1, "the first packet was overwritten")
+
+        capture.clear()
+        XCTAssertEqual(capture.packetCount, 0)
+        XCTAssertTrue(enhancedPacketBlockOffsets(in: capture.pcapngData()).isEmpty)
+    }
+
+    func testPacketCaptureIsOffByDefault() {
+        XCTAssertNil(ICMPPinger().packetCapture)
+        XCTAssertNil(PingFoundation(hostName: "127.0.0.1").packetCapture)
+
+        let reachability = RealReachability()
+        XCTAssertNil(reachability.packetCapture)
+
+        let capture = PacketCapture()
+        reachability.packetCapture = capture
+        XCTAssertTrue(reachability.packetCapture === capture)
+        XCTAssertTrue(ICMPPinger(packetCapture: capture).packetCapture === capture)
+    }
+
+    // MARK: - QUICProber Tests
     
-    func testSharedInstance() {
-        let instance1 = RealReachability.shared
-        let instance2 = RealReachability.shared
-        XCTAssertTrue(instance1 === instance2)
+    func testQUICProberDefaults() {
+        XCTAssertEqual(QUICProber.defaultHost, "www.gstatic.com")
+        XCTAssertEqual(QUICProber.defaultPort, 443)
+        XCTAssertEqual(ProbeProfile().quicPort, 443)
+        XCTAssertFalse(ReachabilityConfiguration.default.includesQUICInParallel)
     }
     
-    func testRealReachabilityInitialization() {
-        let reachability = RealReachability()
-        XCTAssertNotNil(reachability)
+    func testQUICProbePacketLayout() {
+        let dcid: [UInt8] = [1, 2, 3, 4, 5, 6, 7, 8]
+        let scid: [UInt8] = [9, 10, 11, 12, 13, 14, 15, 16]
+        let packet = [UInt8](QUICVersionNegotiation.probePacket(version: 0x1A2A_3A4A,
+                                                                destinationConnectionID: dcid,
+                                                                sourceConnectionID: scid))
+        
+        XCTAssertEqual(packet.count, 1200, "Initial packets must be padded to 1200 bytes to get a reply")
+        XCTAssertEqual(packet[0] & 0xC0, 0xC0, "Long header with fixed bit")
+        XCTAssertEqual(Array(packet[1..<5]), [0x1A, 0x2A, 0x3A, 0x4A])
+        XCTAssertEqual(packet[5], 8)
+        XCTAssertEqual(Array(packet[6..<14]), dcid)
+        XCTAssertEqual(packet[14], 8)
+        XCTAssertEqual(Array(packet[15..<23]), scid)
     }
     
-    func testRealReachabilityCustomConfiguration() {
-        let config = ReachabilityConfiguration(probeMode: .icmpOnly, timeout: 3.0)
-        let reachability = RealReachability(configuration: config)
-        XCTAssertEqual(reachability.configuration.probeMode, .icmpOnly)
-        XCTAssertEqual(reachability.configuration.timeout, 3.0)
+    func testQUICReservedVersionFollowsGreasePattern() {
+        for _ in 0..<32 {
+            XCTAssertEqual(QUICVersionNegotiation.reservedVersion() & 0x0F0F_0F0F, 0x0A0A_0A0A)
+        }
     }
     
-    func testConfigurationUpdate() {
-        let reachability = RealReachability()
-        XCTAssertEqual(reachability.configuration.probeMode, .parallel)
+    func testQUICVersionNegotiationValidation() {
+        let dcid: [UInt8] = [1, 2, 3, 4, 5, 6, 7, 8]
+        let scid: [UInt8] = [9, 10, 11, 12, 13, 14, 15, 16]
+        let version: UInt32 = 0x1A2A_3A4A
+        let probe = QUICVersionNegotiation.probePacket(version: version, destinationConnectionID: dcid, sourceConnectionID: scid)
         
-        reachability.configuration = ReachabilityConfiguration(probeMode: .httpOnly)
-        XCTAssertEqual(reachability.configuration.probeMode, .httpOnly)
+        let reply = QUICVersionNegotiationResponder.reply(to: probe, supportedVersions: [1])!
+        XCTAssertTrue(QUICVersionNegotiation.isVersionNegotiation(reply, probedVersion: version,
+                                                                  destinationConnectionID: dcid, sourceConnectionID: scid))
+        
+        XCTAssertFalse(QUICVersionNegotiation.isVersionNegotiation(reply, probedVersion: version,
+                                                                   destinationConnectionID: scid, sourceConnectionID: dcid),
+                       "Connection IDs must be echoed back swapped")
+        
+        let offeringProbedVersion = QUICVersionNegotiationResponder.reply(to: probe, supportedVersions: [1, version])!
+        XCTAssertFalse(QUICVersionNegotiation.isVersionNegotiation(offeringProbedVersion, probedVersion: version,
+                                                                   destinationConnectionID: dcid, sourceConnectionID: scid))
+        
+        var nonZeroVersion = [UInt8](reply)
+        nonZeroVersion[4] = 1
+        XCTAssertFalse(QUICVersionNegotiation.isVersionNegotiation(Data(nonZeroVersion), probedVersion: version,
+                                                                   destinationConnectionID: dcid, sourceConnectionID: scid))
+        
+        XCTAssertFalse(QUICVersionNegotiation.isVersionNegotiation(reply.prefix(20), probedVersion: version,
+                                                                   destinationConnectionID: dcid, sourceConnectionID: scid),
+                       "Truncated replies must be rejected")
     }
     
-    func testRealReachabilityWithParallelMode() {
-        let config = ReachabilityConfiguration(probeMode: .parallel)
-        let reachability = RealReachability(configuration: config)
-        XCTAssertEqual(reachability.configuration.probeMode, .parallel)
+    func testQUICProberSucceedsAgainstLocalResponder() async throws {
+        let responder = QUICVersionNegotiationResponder()
+        defer { responder.stop() }
+        let port = try XCTUnwrap(await responder.start())
+        
+        let prober = QUICProber(host: "127.0.0.1", port: port, timeout: 2.0)
+        let result = await prober.probeWithDetails()
+        
+        XCTAssertTrue(result.success, "A Version Negotiation reply should count as reachable")
+        XCTAssertNil(result.failureReason)
+        XCTAssertEqual(responder.receivedDatagramSizes, [1200])
     }
     
-    func testRealReachabilityWithHTTPOnlyMode() {
-        let config = ReachabilityConfiguration(probeMode: .httpOnly)
+    func testQUICProberRejectsUnexpectedReply() async throws {
+        let responder = QUICVersionNegotiationResponder(replyOverride: Data([0x40, 0x01, 0x02]))
+        defer { responder.stop() }
+        let port = try XCTUnwrap(await responder.start())
+        
+        let result = await QUICProber(host: "127.0.0.1", port: port, timeout: 2.0).probeWithDetails()
+        
+        XCTAssertFalse(result.success)
+        XCTAssertEqual(result.failureReason, .httpMismatch)
+    }
+    
+    func testQUICOnlyModeUsesQUICProbe() async throws {
+        let responder = QUICVersionNegotiationResponder()
+        defer { responder.stop() }
+        let port = try XCTUnwrap(await responder.start())
+        
+        let config = ReachabilityConfiguration(
+            probeMode: .quicOnly,
+            timeout: 2.0,
+            quicHost: "127.0.0.1",
+            quicPort: port
+        )
         let reachability = RealReachability(configuration: config)
-        XCTAssertEqual(reachability.configuration.probeMode, .httpOnly)
+        let status = await reachability.check()
+        
+        if status == .notReachable && reachability.lastFailureReason == .noRoute {
+            throw XCTSkip("No satisfied network path in this environment")
+        }
+        XCTAssertTrue(status.isReachable)
+        XCTAssertEqual(responder.receivedDatagramSizes.count, 1)
     }
     
-    func testRealReachabilityWithICMPOnlyMode() {
-        let config = ReachabilityConfiguration(probeMode: .icmpOnly)
+    func testParallelModeIncludesQUICBranchWhenEnabled() async throws {
+        let responder = QUICVersionNegotiationResponder()
+        defer { responder.stop() }
+        let port = try XCTUnwrap(await responder.start())
+        
+        // HTTP and ICMP targets are unreachable, so only the QUIC branch can succeed.
+        let config = ReachabilityConfiguration(
+            probeMode: .parallel,
+            timeout: 2.0,
+            httpProbeURL: URL(string: "https://invalid.invalid/generate_204")!,
+            icmpHost: "192.0.2.1",
+            quicHost: "127.0.0.1",
+            quicPort: port,
+            includesQUICInParallel: true
+        )
         let reachability = RealReachability(configuration: config)
-        XCTAssertEqual(reachability.configuration.probeMode, .icmpOnly)
+        let status = await reachability.check()
+        
+        if responder.receivedDatagramSizes.isEmpty {
+            throw XCTSkip("No satisfied network path in this environment")
+        }
+        XCTAssertTrue(status.isReachable)
     }
     
-    // MARK: - ProbeMode Tests
+    // MARK: - STUNProber Tests
     
-    func testProbeModeValues() {
-        let parallel = ProbeMode.parallel
-        let httpOnly = ProbeMode.httpOnly
-        let icmpOnly = ProbeMode.icmpOnly
+    func testSTUNBindingRequestLayout() {
+        let transactionID = STUNMessage.randomTransactionID()
+        let request = [UInt8](STUNMessage.bindingRequest(transactionID: transactionID))
         
-        XCTAssertNotNil(parallel)
-        XCTAssertNotNil(httpOnly)
-        XCTAssertNotNil(icmpOnly)
+        XCTAssertEqual(request.count, 20)
+        XCTAssertEqual(Array(request[0..<4]), [0x00, 0x01, 0x00, 0x00], "Binding request with no attributes")
+        XCTAssertEqual(Array(request[4..<8]), [0x21, 0x12, 0xA4, 0x42], "Magic cookie")
+        XCTAssertEqual(Array(request[8..<20]), transactionID)
     }
     
-    func testProbeModeDistinct() {
-        // Ensure all probe modes are distinct
-        let modes: [ProbeMode] = [.parallel, .httpOnly, .icmpOnly]
-        for i in 0..<modes.count {
-            for j in (i+1)..<modes.count {
-                XCTAssertTrue(String(describing: modes[i]) != String(describing: modes[j]))
-            }
+    func testSTUNParsesXORMappedAddresses() {
+        let transactionID = STUNMessage.randomTransactionID()
+        for address in [STUNMappedAddress(address: "203.0.113.7", port: 54321),
+                        STUNMappedAddress(address: "2001:db8::1", port: 443)] {
+            let response = STUNResponder.bindingSuccess(transactionID: transactionID, mappedAddress: address)!
+            XCTAssertEqual(STUNMessage.parseResponse(response, transactionID: transactionID), .mapped(address))
         }
     }
     
-    // MARK: - ProbeResult Tests
+    func testSTUNFallsBackToPlainMappedAddress() {
+        let transactionID = STUNMessage.randomTransactionID()
+        let address = STUNMappedAddress(address: "198.51.100.2", port: 3478)
+        let response = STUNResponder.bindingSuccess(transactionID: transactionID, mappedAddress: address, xor: false)!
+        XCTAssertEqual(STUNMessage.parseResponse(response, transactionID: transactionID), .mapped(address))
+    }
     
-    func testProbeResultSuccess() {
-        let result = ProbeResult(success: true, latencyMs: 50.0, error: nil)
+    func testSTUNIgnoresResponsesForOtherTransactions() {
+        let address = STUNMappedAddress(address: "203.0.113.7", port: 54321)
+        let response = STUNResponder.bindingSuccess(transactionID: STUNMessage.randomTransactionID(), mappedAddress: address)!
+        XCTAssertEqual(STUNMessage.parseResponse(response, transactionID: STUNMessage.randomTransactionID()), .unrelated)
+        XCTAssertEqual(STUNMessage.parseResponse(Data([0x01, 0x02]), transactionID: STUNMessage.randomTransactionID()), .unrelated)
+    }
+    
+    func testSTUNRecognizesErrorResponse() {
+        let transactionID = STUNMessage.randomTransactionID()
+        var response = [UInt8](STUNMessage.bindingRequest(transactionID: transactionID))
+        response[0] = 0x01
+        response[1] = 0x11
+        XCTAssertEqual(STUNMessage.parseResponse(Data(response), transactionID: transactionID), .error)
+    }
+    
+    func testSTUNProberReportsMappedAddressFromLocalServer() async throws {
+        let responder = STUNResponder()
+        defer { responder.stop() }
+        let port = try XCTUnwrap(await responder.start())
+        
+        let prober = STUNProber(servers: [STUNServer(host: "127.0.0.1", port: port)], timeout: 2.0)
+        let result = await prober.bindingRequest()
+        
         XCTAssertTrue(result.success)
-        XCTAssertEqual(result.latencyMs, 50.0)
-        XCTAssertNil(result.error)
+        XCTAssertNil(result.failureReason)
+        XCTAssertEqual(result.mappedAddress?.address, "127.0.0.1", "Without NAT the mapped address is the local one")
+        XCTAssertEqual(result.server?.port, port)
+        XCTAssertFalse(result.mappingChanged)
     }
     
-    func testProbeResultFailure() {
-        let error = NSError(domain: "test", code: -1, userInfo: nil)
-        let result = ProbeResult(success: false, latencyMs: 100.0, error: error)
-        XCTAssertFalse(result.success)
-        XCTAssertEqual(result.latencyMs, 100.0)
-        XCTAssertNotNil(result.error)
+    func testSTUNProberRetransmitsOnRTOSchedule() async throws {
+        let responder = STUNResponder(droppedRequests: 2)
+        defer { responder.stop() }
+        let port = try XCTUnwrap(await responder.start())
+        
+        let prober = STUNProber(servers: [STUNServer(host: "127.0.0.1", port: port)],
+                                timeout: 3.0,
+                                initialRTO: 0.1)
+        let result = await prober.bindingRequest()
+        
+        XCTAssertTrue(result.success, "A retransmission should get through after the dropped requests")
+        XCTAssertEqual(responder.requestCount, 3)
+        XCTAssertGreaterThanOrEqual(result.latencyMs ?? 0, 300, "Retransmissions wait 100ms, then 200ms")
     }
     
-    func testProbeResultWithNoLatency() {
-        let result = ProbeResult(success: true, latencyMs: nil, error: nil)
+    func testSTUNProberQueriesServersInParallel() async throws {
+        let silent = STUNResponder(droppedRequests: .max)
+        let answering = STUNResponder()
+        defer {
+            silent.stop()
+            answering.stop()
+        }
+        let silentPort = try XCTUnwrap(await silent.start())
+        let answeringPort = try XCTUnwrap(await answering.start())
+        
+        let prober = STUNProber(servers: [STUNServer(host: "127.0.0.1", port: silentPort),
+                                          STUNServer(host: "127.0.0.1", port: answeringPort)],
+                                timeout: 2.0)
+        let result = await prober.bindingRequest()
+        
         XCTAssertTrue(result.success)
-        XCTAssertNil(result.latencyMs)
+        XCTAssertEqual(result.server?.port, answeringPort)
+        XCTAssertLessThan(result.latencyMs ?? .infinity, 1000, "A silent server must not delay the answer")
     }
     
-    // MARK: - Notifier Lifecycle Tests
+    func testSTUNProberDetectsNATRebinding() async throws {
+        let responder = STUNResponder()
+        defer { responder.stop() }
+        let port = try XCTUnwrap(await responder.start())
+        let prober = STUNProber(servers: [STUNServer(host: "127.0.0.1", port: port)], timeout: 2.0)
+        
+        responder.mappedAddressOverride = STUNMappedAddress(address: "203.0.113.7", port: 40000)
+        let first = await prober.bindingRequest()
+        let unchanged = await prober.bindingRequest()
+        
+        responder.mappedAddressOverride = STUNMappedAddress(address: "203.0.113.7", port: 40001)
+        let rebound = await prober.bindingRequest()
+        
+        XCTAssertFalse(first.mappingChanged)
+        XCTAssertFalse(unchanged.mappingChanged)
+        XCTAssertTrue(rebound.mappingChanged)
+        XCTAssertEqual(rebound.mappedAddress?.port, 40001)
+        XCTAssertEqual(prober.natRebindingCount, 1)
+    }
     
-    func testStartAndStopNotifier() {
-        let reachability = RealReachability()
+    func testSTUNProberKeepsLocalPortAcrossProbes() async throws {
+        let responder = STUNResponder()
+        defer { responder.stop() }
+        let port = try XCTUnwrap(await responder.start())
+        let prober = STUNProber(servers: [STUNServer(host: "127.0.0.1", port: port)], timeout: 2.0)
         
-        // Start notifier
-        reachability.startNotifier()
+        let first = await prober.bindingRequest()
+        let second = await prober.bindingRequest()
         
-        // Should be able to start again (idempotent)
-        reachability.startNotifier()
+        XCTAssertEqual(first.mappedAddress, second.mappedAddress, "Without NAT the mapping only changes if the local port does")
+        XCTAssertFalse(second.mappingChanged)
+    }
+    
+    func testSTUNProberPinsLocalPortPerServerFamily() async throws {
+        let ipv4Server = STUNResponder()
+        let ipv6Server = STUNResponder(droppedRequests: 1)
+        defer { ipv6Server.stop() }
+        let ipv4Port = try XCTUnwrap(await ipv4Server.start())
+        let ipv6Port = try XCTUnwrap(await ipv6Server.start())
+        let prober = STUNProber(servers: [STUNServer(host: "127.0.0.1", port: ipv4Port),
+                                          STUNServer(host: "::1", port: ipv6Port)],
+                                timeout: 2.0,
+                                initialRTO: 0.1)
         
-        // Stop notifier
-        reachability.stopNotifier()
+        let first = await prober.bindingRequest()
+        XCTAssertEqual(first.server?.host, "127.0.0.1")
+        ipv4Server.stop()
         
-        // Should be able to stop again (idempotent)
-        reachability.stopNotifier()
+        let second = await prober.bindingRequest()
+        XCTAssertTrue(second.success, "An IPv6 server must not be bound to the IPv4 server's pinned port")
+        XCTAssertEqual(second.server?.host, "::1")
+        XCTAssertFalse(second.mappingChanged, "A first answer from another server is not a rebinding")
     }
     
-    func testMultipleStartStopCycles() {
-        let reachability = RealReachability()
+    func testSTUNProberWithoutServersIsInvalidConfiguration() async {
+        let result = await STUNProber(servers: []).bindingRequest()
+        XCTAssertFalse(result.success)
+        XCTAssertEqual(result.failureReason, .invalidConfiguration)
+    }
+    
+    // MARK: - BandwidthProber Tests
+    
+    func testBandwidthGoodputExcludesFirstChunk() {
+        let samples = [
+            TransferSample(time: 10.0, bytes: 16_384),
+            TransferSample(time: 11.0, bytes: 141_384),
+            TransferSample(time: 12.0, bytes: 266_384)
+        ]
+        // The first chunk only marks the start of the packet train: 250000 bytes over 2 seconds.
+        XCTAssertEqual(BandwidthProber.goodput(samples) ?? 0, 1_000_000, accuracy: 0.001)
+    }
+    
+    func testBandwidthGoodputNeedsTwoSamples() {
+        XCTAssertNil(BandwidthProber.goodput([]))
+        XCTAssertNil(BandwidthProber.goodput([TransferSample(time: 1.0, bytes: 8192)]))
+    }
+    
+    func testBandwidthProberEstimatesThrottledDownload() async throws {
+        let server = ThrottledHTTPServer(bytesPerSecond: 400_000)
+        defer { server.stop() }
+        let port = try XCTUnwrap(await server.start())
         
-        for _ in 0..<3 {
-            reachability.startNotifier()
-            reachability.stopNotifier()
-        }
-        // Test passes if no crash occurs
+        let prober = BandwidthProber(configuration: BandwidthProbeConfiguration(
+            downloadURL: URL(string: "http://127.0.0.1:\(port)/download")!,
+            downloadBytes: 256 * 1024,
+            timeout: 5.0
+        ))
+        let estimate = await prober.estimate()
+        
+        XCTAssertTrue(estimate.success)
+        XCTAssertEqual(estimate.bytesDownloaded, 256 * 1024)
+        XCTAssertEqual(server.rangeHeaders, ["bytes=0-262143"])
+        let bitsPerSecond = try XCTUnwrap(estimate.downloadBitsPerSecond)
+        XCTAssertEqual(bitsPerSecond, 3_200_000, accuracy: 1_600_000, "Estimate should track the 400 kB/s throttle")
+        XCTAssertNil(estimate.uploadBitsPerSecond, "No upload leg without an upload URL")
     }
     
-    // MARK: - Configuration Mode Switching Tests
+    func testBandwidthProberStopsAtBudgetWhenRangeIsIgnored() async throws {
+        let server = ThrottledHTTPServer(bytesPerSecond: 2_000_000, honorsRange: false, resourceSize: 4 * 1024 * 1024)
+        defer { server.stop() }
+        let port = try XCTUnwrap(await server.start())
+        
+        let prober = BandwidthProber(configuration: BandwidthProbeConfiguration(
+            downloadURL: URL(string: "http://127.0.0.1:\(port)/download")!,
+            downloadBytes: 256 * 1024,
+            byteBudget: 64 * 1024,
+            timeout: 5.0
+        ))
+        let estimate = await prober.estimate()
+        
+        XCTAssertTrue(estimate.success)
+        XCTAssertGreaterThanOrEqual(estimate.bytesDownloaded, 64 * 1024)
+        XCTAssertLessThan(estimate.bytesDownloaded, 4 * 1024 * 1024, "The transfer must be cut at the budget")
+    }
     
-    func testSwitchingBetweenProbeModes() {
-        let reachability = RealReachability()
+    func testBandwidthProberMeasuresUpload() async throws {
+        let server = ThrottledHTTPServer(bytesPerSecond: 2_000_000)
+        defer { server.stop() }
+        let port = try XCTUnwrap(await server.start())
         
-        // Start with parallel
-        XCTAssertEqual(reachability.configuration.probeMode, .parallel)
+        let prober = BandwidthProber(configuration: BandwidthProbeConfiguration(
+            downloadURL: URL(string: "http://127.0.0.1:\(port)/download")!,
+            downloadBytes: 64 * 1024,
+            uploadURL: URL(string: "http://127.0.0.1:\(port)/upload")!,
+            uploadBytes: 16 * 1024,
+            timeout: 5.0
+        ))
+        let estimate = await prober.estimate()
         
-        // Switch to HTTP only
-        reachability.configuration = ReachabilityConfiguration(probeMode: .httpOnly)
-        XCTAssertEqual(reachability.configuration.probeMode, .httpOnly)
+        XCTAssertTrue(estimate.success)
+        XCTAssertEqual(estimate.bytesUploaded, 16 * 1024)
+        XCTAssertEqual(server.uploadedByteCount, 16 * 1024)
+    }
+    
+    func testEstimateBandwidthWithoutConfigurationIsInvalid() async {
+        let reachability = RealReachability(configuration: .default)
+        let estimate = await reachability.estimateBandwidth()
+        XCTAssertFalse(estimate.success)
+        XCTAssertEqual(estimate.failureReason, .invalidConfiguration)
+        XCTAssertNil(reachability.lastBandwidthEstimate)
+    }
+    
+    // MARK: - ResponsivenessProber Tests
+    
+    func testResponsivenessMedianAndRPM() {
+        XCTAssertNil(ResponsivenessProber.median([]))
+        XCTAssertEqual(ResponsivenessProber.median([30, 10, 20]), 20)
+        XCTAssertEqual(ResponsivenessProber.median([40, 10, 20, 30]), 25)
+        XCTAssertEqual(ResponsivenessProber.roundTripsPerMinute(latencyMs: 100), 600)
+        XCTAssertNil(ResponsivenessProber.roundTripsPerMinute(latencyMs: 0))
+    }
+    
+    func testResponsivenessDetectsBufferbloatOnSharedBottleneck() async throws {
+        let server = ThrottledHTTPServer(bytesPerSecond: 1_000_000, resourceSize: 256 * 1024, sharedBottleneck: true)
+        defer { server.stop() }
+        let port = try XCTUnwrap(await server.start())
         
-        // Switch to ICMP only
-        reachability.configuration = ReachabilityConfiguration(probeMode: .icmpOnly)
-        XCTAssertEqual(reachability.configuration.probeMode, .icmpOnly)
+        let prober = ResponsivenessProber(configuration: ResponsivenessConfiguration(
+            loadURL: URL(string: "http://127.0.0.1:\(port)/load")!,
+            parallelStreams: 4,
+            loadDuration: 3.0,
+            byteBudget: 8 * 1024 * 1024,
+            latencyTargets: [.http(URL(string: "http://127.0.0.1:\(port)/ping")!)],
+            idleRounds: 3,
+            sampleInterval: 0.05,
+            timeout: 3.0
+        ))
+        let result = await prober.measure()
         
-        // Switch back to parallel
-        reachability.configuration = ReachabilityConfiguration(probeMode: .parallel)
-        XCTAssertEqual(reachability.configuration.probeMode, .parallel)
+        XCTAssertTrue(result.success)
+        XCTAssertEqual(result.idleSampleCount, 3)
+        XCTAssertGreaterThan(result.loadedSampleCount, 0)
+        XCTAssertGreaterThan(result.bytesTransferred, 0)
+        XCTAssertLessThanOrEqual(result.loadedDuration, 3.0 + 3.0, "The loaded phase is bounded by its duration plus one sample timeout")
+        let increase = try XCTUnwrap(result.latencyIncreaseMs)
+        XCTAssertGreaterThan(increase, 50, "Probes queued behind the load should see the bloated buffer")
+        XCTAssertLessThan(result.roundTripsPerMinute ?? .infinity, result.idleRoundTripsPerMinute ?? 0)
     }
     
-    func testConfigurationUpdateWithCustomValues() {
-        let reachability = RealReachability()
+    func testResponsivenessStopsLoadAtByteBudget() async throws {
+        let server = ThrottledHTTPServer(bytesPerSecond: 4_000_000, resourceSize: 64 * 1024)
+        defer { server.stop() }
+        let port = try XCTUnwrap(await server.start())
         
-        let customURL = URL(string: "https://www.example.com/check")!
-        let config = ReachabilityConfiguration(
-            probeMode: .httpOnly,
-            timeout: 8.0,
-            httpProbeURL: customURL,
-            icmpHost: "1.1.1.1",
-            icmpPort: 443
+        let prober = ResponsivenessProber(configuration: ResponsivenessConfiguration(
+            loadURL: URL(string: "http://127.0.0.1:\(port)/load")!,
+            parallelStreams: 2,
+            loadDuration: 10.0,
+            byteBudget: 256 * 1024,
+            latencyTargets: [.tcp(host: "127.0.0.1", port: port)],
+            idleRounds: 1,
+            sampleInterval: 0.01,
+            timeout: 2.0
+        ))
+        let result = await prober.measure()
+        
+        XCTAssertLessThan(result.loadedDuration, 5.0, "Running out of budget must end the loaded phase early")
+        XCTAssertGreaterThanOrEqual(result.bytesTransferred, 256 * 1024)
+        XCTAssertLessThan(result.bytesTransferred, 512 * 1024)
+    }
+    
+    func testMeasureResponsivenessWithoutConfigurationIsInvalid() async {
+        let result = await RealReachability(configuration: .default).measureResponsiveness()
+        XCTAssertFalse(result.success)
+        XCTAssertEqual(result.failureReason, .invalidConfiguration)
+    }
+    
+    // MARK: - DoHProber Tests
+    
+    func testDNSWireFormatQueryEncoding() throws {
+        let query = try XCTUnwrap(DNSWireFormat.query(name: "example.com.", type: .aaaa, id: 0x1234))
+        XCTAssertEqual([UInt8](query), [
+            0x12, 0x34, 0x01, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+            7, 0x65, 0x78, 0x61, 0x6d, 0x70, 0x6c, 0x65, 3, 0x63, 0x6f, 0x6d, 0,
+            0x00, 0x1c, 0x00, 0x01
+        ])
+        XCTAssertNil(DNSWireFormat.query(name: "a..b", type: .a, id: 1))
+        XCTAssertNil(DNSWireFormat.query(name: String(repeating: "x", count: 64), type: .a, id: 1))
+    }
+    
+    func testDNSWireFormatParsesCompressedAnswers() throws {
+        let question = try XCTUnwrap(DNSWireFormat.query(name: "www.example.com", type: .a, id: 0xBEEF))
+        var response = [UInt8](question)
+        response[2] = 0x81
+        response[3] = 0x80
+        response[7] = 2
+        // CNAME www.example.com -> example.com (pointer into the question), then its A record
+        response += [0xC0, 0x0C, 0x00, 0x05, 0x00, 0x01, 0, 0, 0, 60, 0x00, 0x02, 0xC0, 0x10]
+        response += [0xC0, 0x10, 0x00, 0x01, 0x00, 0x01, 0, 0, 0, 60, 0x00, 0x04, 192, 0, 2, 7]
+        
+        XCTAssertEqual(DNSWireFormat.addresses(inResponse: Data(response), id: 0xBEEF, type: .a), ["192.0.2.7"])
+        XCTAssertNil(DNSWireFormat.addresses(inResponse: Data(response), id: 0xBEEE, type: .a), "Answers to another query are rejected")
+        XCTAssertNil(DNSWireFormat.addresses(inResponse: Data(response.dropLast(3)), id: 0xBEEF, type: .a))
+        
+        response[3] = 0x83
+        XCTAssertEqual(DNSWireFormat.addresses(inResponse: Data(response), id: 0xBEEF, type: .a), [], "NXDOMAIN has no addresses")
+    }
+    
+    func testDoHProberReportsAgreementOverOneConnection() async throws {
+        let responder = DoHResponder(addresses: [[192, 0, 2, 1], [192, 0, 2, 2]])
+        defer { responder.stop() }
+        let port = try XCTUnwrap(await responder.start())
+        
+        let prober = DoHProber(configuration: DNSHealthProbeConfiguration(
+            resolverURL: URL(string: "http://127.0.0.1:\(port)/dns-query")!,
+            queryName: "probe.example",
+            timeout: 3.0
+        )) { name, type in
+            XCTAssertEqual(name, "probe.example")
+            XCTAssertEqual(type, .a)
+            return ["192.0.2.2"]
+        }
+        
+        let first = await prober.probe()
+        let second = await prober.probe()
+        
+        XCTAssertEqual(first.health, .healthy)
+        XCTAssertEqual(first.dohAddresses, ["192.0.2.1", "192.0.2.2"])
+        XCTAssertEqual(first.systemAddresses, ["192.0.2.2"])
+        XCTAssertNotNil(first.dohLatencyMs)
+        XCTAssertNotNil(first.systemLatencyMs)
+        XCTAssertEqual(second.health, .healthy)
+        XCTAssertEqual(responder.queryCount, 2)
+        XCTAssertEqual(responder.connectionCount, 1, "The DoH connection should be kept alive between probes")
+    }
+    
+    func testDoHProberSeparatesSystemResolverFailures() async throws {
+        let responder = DoHResponder(addresses: [[192, 0, 2, 1]])
+        defer { responder.stop() }
+        let port = try XCTUnwrap(await responder.start())
+        let configuration = DNSHealthProbeConfiguration(
+            resolverURL: URL(string: "http://127.0.0.1:\(port)/dns-query")!,
+            queryName: "probe.example",
+            timeout: 3.0
         )
         
-        reachability.configuration = config
+        let blocked = await DoHProber(configuration: configuration) { _, _ in [] }.probe()
+        XCTAssertEqual(blocked.health, .systemResolverFailed)
+        XCTAssertEqual(blocked.systemFailureReason, .dnsFailure)
+        XCTAssertNil(blocked.dohFailureReason)
+        
+        let hijacked = await DoHProber(configuration: configuration) { _, _ in ["198.51.100.9"] }.probe()
+        XCTAssertEqual(hijacked.health, .answersDiffer)
+    }
+    
+    func testCheckDNSHealthWithoutConfigurationReturnsNil() async {
+        let reachability = RealReachability(configuration: .default)
+        let result = await reachability.checkDNSHealth()
+        XCTAssertNil(result)
+        XCTAssertNil(reachability.lastDNSHealth)
+    }
+    
+    // MARK: - Logging Tests
+    
+    /// Routes the global logger to a fresh ring for one test and restores the defaults afterwards
+    private func captureLog(minimumLevel: LogLevel?, maximumRecordsPerSecond: Int = 50) -> RingBufferLogSink {
+        let previousLevel = ReachabilityLog.minimumLevel
+        let previousRate = ReachabilityLog.maximumRecordsPerSecond
+        addTeardownBlock {
+            ReachabilityLog.removeAllSinks()
+            ReachabilityLog.addSink(OSLogSink())
+            ReachabilityLog.minimumLevel = previousLevel
+            ReachabilityLog.maximumRecordsPerSecond = previousRate
+        }
+        
+        let ring = RingBufferLogSink(capacity: 16)
+        ReachabilityLog.removeAllSinks()
+        ReachabilityLog.addSink(ring)
+        ReachabilityLog.minimumLevel = minimumLevel
+        ReachabilityLog.maximumRecordsPerSecond = maximumRecordsPerSecond
+        return ring
+    }
+    
+    func testRingBufferLogSinkKeepsNewestRecordsInOrder() {
+        let ring = RingBufferLogSink(capacity: 3)
+        for i in 0..<5 {
+            ring.write(LogRecord(level: .info, subsystem: .engine, message: "\(i)"))
+        }
+        XCTAssertEqual(ring.records.map(\.message), ["2", "3", "4"])
+    }
+    
+    func testLogThresholdSkipsFormatting() {
+        let ring = captureLog(minimumLevel: .warning)
+        var formatted = false
+        func expensiveMessage() -> String {
+            formatted = true
+            return "expensive"
+        }
+        
+        ReachabilityLog.info(.engine, expensiveMessage())
+        XCTAssertFalse(formatted, "A disabled level must not build its message")
+        
+        ReachabilityLog.error(.engine, expensiveMessage())
+        XCTAssertTrue(formatted)
+        XCTAssertEqual(ring.records.map(\.message), ["expensive"])
+        
+        ReachabilityLog.minimumLevel = nil
+        ReachabilityLog.error(.engine, "dropped")
+        XCTAssertEqual(ring.records.count, 1)
+    }
+    
+    func testLogRateLimitSummarizesDroppedRecords() async throws {
+        let ring = captureLog(minimumLevel: .debug, maximumRecordsPerSecond: 2)
+        let burst = LogSubsystem("ratelimit")
+        
+        for i in 0..<5 {
+            ReachabilityLog.warning(burst, "burst \(i)")
+        }
+        ReachabilityLog.warning(LogSubsystem("ratelimit-other"), "separate budget")
+        XCTAssertEqual(ring.records.count, 3)
+        
+        try await Task.sleep(nanoseconds: 1_100_000_000)
+        ReachabilityLog.warning(burst, "after")
+        XCTAssertEqual(ring.records.suffix(2).map(\.message), ["3 records suppressed by rate limit", "after"])
+    }
+    
+    func testFileLogSinkAppendsFormattedRecords() throws {
+        let url = FileManager.default.temporaryDirectory.appendingPathComponent("rr2-log-\(UUID().uuidString).log")
+        defer { try? FileManager.default.removeItem(at: url) }
+        
+        let sink = try XCTUnwrap(FileLogSink(url: url))
+        sink.write(LogRecord(level: .notice, subsystem: .http, message: "first"))
+        sink.write(LogRecord(level: .error, subsystem: .dns, message: "second"))
+        sink.flush()
+        
+        let lines = try String(contentsOf: url, encoding: .utf8).split(separator: "\n")
+        XCTAssertEqual(lines.count, 2)
+        XCTAssertTrue(lines[0].hasSuffix("[notice] [http] first"))
+        XCTAssertTrue(lines[1].hasSuffix("[error] [dns] second"))
+    }
+    
+    // MARK: - NAT64 Tests
+    
+    private static let wellKnownPrefix96: [UInt8] = [0x00, 0x64, 0xff, 0x9b, 0, 0, 0, 0, 0, 0, 0, 0, 192, 0, 0, 170]
+    
+    func testNAT64PrefixDiscoveryWellKnown96() {
+        let prefix = NAT64Prefix.discover(fromSynthesizedAddress: Self.wellKnownPrefix96)
+        XCTAssertEqual(prefix?.length, 96)
+        XCTAssertEqual(prefix?.synthesizedHost(forIPv4Literal: "8.8.8.8"), "64:ff9b::808:808")
+    }
+    
+    func testNAT64PrefixDiscoveryPrefix64SkipsReservedByte() {
+        // 2001:db8:1:2:00c0:0000:aa00:0 embeds 192.0.0.170 around the reserved u-octet
+        let address: [UInt8] = [0x20, 0x01, 0x0d, 0xb8, 0x00, 0x01, 0x00, 0x02, 0x00, 192, 0, 0, 170, 0, 0, 0]
+        let prefix = NAT64Prefix.discover(fromSynthesizedAddress: address)
+        XCTAssertEqual(prefix?.length, 64)
+        XCTAssertEqual(prefix?.synthesize(ipv4: [1, 1, 1, 1]),
+                       [0x20, 0x01, 0x0d, 0xb8, 0x00, 0x01, 0x00, 0x02, 0x00, 1, 1, 1, 1, 0, 0, 0])
+    }
+    
+    func testNAT64PrefixRejectsNonWellKnownAddress() {
+        let address: [UInt8] = [0x20, 0x01, 0x0d, 0xb8, 0, 0, 0, 0, 0, 0, 0, 0, 8, 8, 8, 8]
+        XCTAssertNil(NAT64Prefix.discover(fromSynthesizedAddress: address))
+    }
+    
+    func testNAT64PrefixIgnoresHostNames() {
+        let prefix = NAT64Prefix.discover(fromSynthesizedAddress: Self.wellKnownPrefix96)
+        XCTAssertNil(prefix?.synthesizedHost(forIPv4Literal: "dns.google"))
+    }
+    
+    func testNAT64ResolverDiscoversOncePerNetwork() async {
+        let queries = QueryCounter()
+        let resolver = NAT64PrefixResolver { hostName in
+            queries.record(hostName)
+            return [Self.wellKnownPrefix96]
+        }
+        
+        let first = await resolver.prefix(forNetwork: "wifi|en0")
+        let second = await resolver.prefix(forNetwork: "wifi|en0")
+        
+        XCTAssertEqual(first?.length, 96)
+        XCTAssertEqual(first, second)
+        XCTAssertEqual(queries.names, [NAT64Prefix.discoveryHostName])
+        
+        resolver.invalidate()
+        _ = await resolver.prefix(forNetwork: "wifi|en0")
+        XCTAssertEqual(queries.names.count, 2, "Invalidation should force rediscovery")
+    }
+    
+    func testNAT64ResolverCachesAbsenceOfDNS64() async {
+        let queries = QueryCounter()
+        let resolver = NAT64PrefixResolver { hostName in
+            queries.record(hostName)
+            return []
+        }
+        
+        let first = await resolver.prefix(forNetwork: "cellular|pdp_ip0")
+        let second = await resolver.prefix(forNetwork: "cellular|pdp_ip0")
+        
+        XCTAssertNil(first)
+        XCTAssertNil(second)
+        XCTAssertEqual(queries.names.count, 1)
+    }
+    
+    // MARK: - RealReachability Tests
+    
+    func testSharedInstance() {
+        let instance1 = RealReachability.shared
+        let instance2 = RealReachability.shared
+        XCTAssertTrue(instance1 === instance2)
+    }
+    
+    func testRealReachabilityInitialization() {
+        let reachability = RealReachability()
+        XCTAssertNotNil(reachability)
+    }
+    
+    func testRealReachabilityCustomConfiguration() {
+        let config = ReachabilityConfiguration(probeMode: .icmpOnly, timeout: 3.0)
+        let reachability = RealReachability(configuration: config)
+        XCTAssertEqual(reachability.configuration.probeMode, .icmpOnly)
+        XCTAssertEqual(reachability.configuration.timeout, 3.0)
+    }
+    
+    func testConfigurationUpdate() {
+        let reachability = RealReachability()
+        XCTAssertEqual(reachability.configuration.probeMode, .parallel)
+        
+        reachability.configuration = ReachabilityConfiguration(probeMode: .httpOnly)
+        XCTAssertEqual(reachability.configuration.probeMode, .httpOnly)
+    }
+    
+    func testRealReachabilityWithParallelMode() {
+        let config = ReachabilityConfiguration(probeMode: .parallel)
+        let reachability = RealReachability(configuration: config)
+        XCTAssertEqual(reachability.configuration.probeMode, .parallel)
+    }
+    
+    func testRealReachabilityWithHTTPOnlyMode() {
+        let config = ReachabilityConfiguration(probeMode: .httpOnly)
+        let reachability = RealReachability(configuration: config)
+        XCTAssertEqual(reachability.configuration.probeMode, .httpOnly)
+    }
+    
+    func testRealReachabilityWithICMPOnlyMode() {
+        let config = ReachabilityConfiguration(probeMode: .icmpOnly)
+        let reachability = RealReachability(configuration: config)
+        XCTAssertEqual(reachability.configuration.probeMode, .icmpOnly)
+    }
+    
+    // MARK: - ProbeMode Tests
+    
+    func testProbeModeValues() {
+        let parallel = ProbeMode.parallel
+        let httpOnly = ProbeMode.httpOnly
+        let icmpOnly = ProbeMode.icmpOnly
+        
+        XCTAssertNotNil(parallel)
+        XCTAssertNotNil(httpOnly)
+        XCTAssertNotNil(icmpOnly)
+    }
+    
+    func testProbeModeDistinct() {
+        // Ensure all probe modes are distinct
+        let modes: [ProbeMode] = [.parallel, .httpOnly, .icmpOnly, .quicOnly]
+        for i in 0..<modes.count {
+            for j in (i+1)..<modes.count {
+                XCTAssertTrue(String(describing: modes[i]) != String(describing: modes[j]))
+            }
+        }
+    }
+    
+    // MARK: - ProbeResult Tests
+    
+    func testProbeResultSuccess() {
+        let result = ProbeResult(success: true, latencyMs: 50.0, error: nil)
+        XCTAssertTrue(result.success)
+        XCTAssertEqual(result.latencyMs, 50.0)
+        XCTAssertNil(result.error)
+    }
+    
+    func testProbeResultFailure() {
+        let error = NSError(domain: "test", code: -1, userInfo: nil)
+        let result = ProbeResult(success: false, latencyMs: 100.0, error: error)
+        XCTAssertFalse(result.success)
+        XCTAssertEqual(result.latencyMs, 100.0)
+        XCTAssertNotNil(result.error)
+    }
+    
+    func testProbeResultWithNoLatency() {
+        let result = ProbeResult(success: true, latencyMs: nil, error: nil)
+        XCTAssertTrue(result.success)
+        XCTAssertNil(result.latencyMs)
+    }
+    
+    func testProbeResultFailureReason() {
+        XCTAssertNil(ProbeResult(success: true, failureReason: .timeout).failureReason)
+        XCTAssertEqual(ProbeResult(success: false, failureReason: .dnsFailure).failureReason, .dnsFailure)
+        XCTAssertEqual(ProbeResult(success: false).failureReason, .unknown)
+    }
+    
+    func testProbeFailureReasonClassification() {
+        XCTAssertTrue(ProbeFailureReason.connectionReset.isTransient)
+        XCTAssertFalse(ProbeFailureReason.timeout.isTransient)
+        XCTAssertTrue(ProbeFailureReason.dnsFailure.warrantsBackoff)
+        XCTAssertFalse(ProbeFailureReason.httpMismatch.warrantsBackoff)
+    }
+    
+    func testHTTPProberMapsURLErrorsToFailureReasons() {
+        func reason(_ code: Int) -> ProbeFailureReason {
+            HTTPProber.failureReason(for: NSError(domain: NSURLErrorDomain, code: code))
+        }
+        XCTAssertEqual(reason(NSURLErrorCannotFindHost), .dnsFailure)
+        XCTAssertEqual(reason(NSURLErrorCannotConnectToHost), .connectionRefused)
+        XCTAssertEqual(reason(NSURLErrorNetworkConnectionLost), .connectionReset)
+        XCTAssertEqual(reason(NSURLErrorServerCertificateUntrusted), .tlsFailure)
+        XCTAssertEqual(reason(NSURLErrorTimedOut), .timeout)
+        XCTAssertEqual(reason(NSURLErrorNotConnectedToInternet), .noRoute)
+        XCTAssertEqual(reason(NSURLErrorCancelled), .cancelled)
+    }
+    
+    func testICMPPingerMapsPOSIXErrorsToFailureReasons() {
+        XCTAssertEqual(ICMPPinger.failureReason(for: NSError(domain: NSPOSIXErrorDomain, code: Int(EHOSTUNREACH))), .noRoute)
+        XCTAssertEqual(ICMPPinger.failureReason(for: NSError(domain: NSPOSIXErrorDomain, code: Int(ECONNRESET))), .connectionReset)
+    }
+    
+    // MARK: - ProbeWatchdog Tests
+    
+    func testWatchdogReturnsOperationResultWhenInTime() async {
+        let result = await ProbeWatchdog.run(deadline: 2.0) {
+            true
+        } onDeadline: {
+            false
+        }
+        XCTAssertTrue(result)
+    }
+    
+    func testWatchdogForceCompletesOperationThatNeverResumes() async {
+        let start = Date()
+        let result = await ProbeWatchdog.run(deadline: 0.2) { () -> ProbeFailureReason? in
+            await withCheckedContinuation { (_: CheckedContinuation<ProbeFailureReason?, Never>) in
+                // Never resumed, like a lost prober callback
+            }
+        } onDeadline: {
+            .watchdog
+        }
+        XCTAssertEqual(result, .watchdog)
+        XCTAssertLessThan(Date().timeIntervalSince(start), 2.0)
+    }
+    
+    func testWatchdogCancelsOperationOfAlreadyCancelledCaller() async {
+        let start = Date()
+        let result = await Task { () -> String in
+            withUnsafeCurrentTask { $0?.cancel() }
+            return await ProbeWatchdog.run(deadline: 5.0) {
+                try? await Task.sleep(nanoseconds: 5_000_000_000)
+                return Task.isCancelled ? "cancelled" : "finished"
+            } onDeadline: {
+                "deadline"
+            }
+        }.value
+        XCTAssertEqual(result, "cancelled", "work tracked after the caller was cancelled is cancelled too")
+        XCTAssertLessThan(Date().timeIntervalSince(start), 2.0)
+    }
+    
+    func testWatchdogFireCountStartsAtZero() {
+        XCTAssertEqual(RealReachability().watchdogFireCount, 0)
+    }
+    
+    // MARK: - ConnectivityPredictor Tests
+    
+    func testPredictorIsNeutralForUnknownNetwork() {
+        let predictor = ConnectivityPredictor()
+        XCTAssertNil(predictor.prediction(network: "unknown", at: Date()))
+        XCTAssertEqual(predictor.intervalMultiplier(network: "unknown", at: Date()), 1)
+    }
+    
+    func testPredictorEvictsLeastRecentlyUsedNetwork() {
+        let predictor = ConnectivityPredictor(maxNetworks: 2)
+        let now = Date()
+        predictor.record(reachable: true, network: "a", at: now)
+        predictor.record(reachable: true, network: "b", at: now)
+        predictor.record(reachable: true, network: "a", at: now)
+        predictor.record(reachable: true, network: "c", at: now)
+        
+        XCTAssertNotNil(predictor.prediction(network: "a", at: now))
+        XCTAssertNil(predictor.prediction(network: "b", at: now), "Least recently used network should be evicted")
+        XCTAssertNotNil(predictor.prediction(network: "c", at: now))
+    }
+    
+    func testPredictiveSchedulingDisabledByDefault() {
+        XCTAssertFalse(ReachabilityConfiguration.default.predictiveSchedulingEnabled)
+    }
+    
+    // MARK: - Status Coalescing Tests
+
+    func testStatusCoalescerDeliversImmediatelyWithoutWindow() {
+        let coalescer = StatusCoalescer<Int>(window: 0)
+        var delivered: [Int] = []
+        coalescer.handler = { delivered.append($0) }
+
+        coalescer.submit(1)
+        coalescer.submit(2)
+
+        XCTAssertEqual(delivered, [1, 2])
+        XCTAssertEqual(coalescer.counts, StatusDeliveryCounts(delivered: 2, merged: 0))
+    }
+
+    func testStatusCoalescerMergesBurstIntoNetTransition() {
+        let coalescer = StatusCoalescer<Int>(window: 0.2)
+        let lock = NSLock()
+        var delivered: [Int] = []
+        let trailing = expectation(description: "Net transition delivered when the window closes")
+        coalescer.handler = { value in
+            lock.lock()
+            delivered.append(value)
+            let count = delivered.count
+            lock.unlock()
+            if count == 2 {
+                trailing.fulfill()
+            }
+        }
+
+        coalescer.submit(1)
+        XCTAssertEqual(delivered, [1], "the first change is not delayed")
+        coalescer.submit(2)
+        coalescer.submit(3)
+        coalescer.submit(4)
+
+        wait(for: [trailing], timeout: 2)
+        lock.lock()
+        XCTAssertEqual(delivered, [1, 4])
+        lock.unlock()
+        XCTAssertEqual(coalescer.counts, StatusDeliveryCounts(delivered: 2, merged: 2))
+    }
+
+    func testStatusCoalescerDropsBurstEndingWhereItStarted() {
+        let coalescer = StatusCoalescer<Int>(window: 10)
+        var delivered: [Int] = []
+        coalescer.handler = { delivered.append($0) }
+
+        coalescer.submit(1)
+        coalescer.submit(2)
+        coalescer.submit(1)
+        coalescer.flush()
+
+        XCTAssertEqual(delivered, [1])
+        XCTAssertEqual(coalescer.counts, StatusDeliveryCounts(delivered: 1, merged: 2))
+    }
+
+    func testStatusCoalescerFlushDeliversHeldChange() {
+        let coalescer = StatusCoalescer<Int>(window: 10)
+        var delivered: [Int] = []
+        coalescer.handler = { delivered.append($0) }
+
+        coalescer.submit(1)
+        coalescer.submit(2)
+        coalescer.flush()
+        XCTAssertEqual(delivered, [1, 2])
+
+        coalescer.reset()
+        coalescer.submit(3)
+        XCTAssertEqual(delivered, [1, 2, 3], "reset closes the window")
+    }
+
+    func testStatusDeliveryWindowDefaultsToOff() {
+        XCTAssertEqual(ReachabilityConfiguration.default.statusDeliveryWindow, 0)
+        let reachability = RealReachability(configuration: ReachabilityConfiguration(statusDeliveryWindow: 0.05))
+        XCTAssertEqual(reachability.statusDeliveryCounts, StatusDeliveryCounts())
+        reachability.flushStatusDelivery()
+    }
+
+    // MARK: - Probe Scheduler Tests
+
+    func testProbeSchedulerPiggybacksOnWorkInFlight() async {
+        let scheduler = ProbeScheduler<String>(maxConcurrentOperations: 2)
+        let runs = QueryCounter()
+        let probe: @Sendable () async -> Int = {
+            runs.record("wifi")
+            try? await Task.sleep(nanoseconds: 100_000_000)
+            return 42
+        }
+
+        async let periodic = scheduler.run("wifi", priority: .periodic, operation: probe)
+        try? await Task.sleep(nanoseconds: 20_000_000)
+        let interactive = await scheduler.run("wifi", priority: .userInitiated, operation: probe)
+        let background = await periodic
+
+        XCTAssertEqual(interactive, 42)
+        XCTAssertEqual(background, 42)
+        XCTAssertEqual(runs.names, ["wifi"])
+        XCTAssertEqual(scheduler.counts, ProbeSchedulerCounts(started: 1, piggybacked: 1, preempted: 0))
+    }
+
+    func testProbeSchedulerPreemptsPeriodicWorkForInteractiveCheck() async {
+        let scheduler = ProbeScheduler<String>(maxConcurrentOperations: 1)
+        let runs = QueryCounter()
+
+        async let periodic = scheduler.run("periodic", priority: .periodic) { () -> String in
+            runs.record("periodic")
+            if runs.names.filter({ $0 == "periodic" }).count == 1 {
+                try? await Task.sleep(nanoseconds: 5_000_000_000)
+            }
+            return Task.isCancelled ? "cancelled" : "finished"
+        }
+        try? await Task.sleep(nanoseconds: 50_000_000)
+
+        let start = Date()
+        let interactive = await scheduler.run("interactive", priority: .userInitiated) { () -> String in
+            runs.record("interactive")
+            return "interactive"
+        }
+        XCTAssertEqual(interactive, "interactive")
+        XCTAssertLessThan(Date().timeIntervalSince(start), 1.0, "the check does not wait behind periodic work")
+
+        let periodicResult = await periodic
+        XCTAssertEqual(periodicResult, "finished", "preempted work restarts instead of reporting its cancelled run")
+        XCTAssertEqual(runs.names, ["periodic", "interactive", "periodic"])
+        XCTAssertEqual(scheduler.counts, ProbeSchedulerCounts(started: 3, piggybacked: 0, preempted: 1))
+    }
+
+    func testProbeSchedulerStartsQueuedWorkByPriority() async {
+        let scheduler = ProbeScheduler<String>(maxConcurrentOperations: 1)
+        let runs = QueryCounter()
+
+        async let pathChange = scheduler.run("path", priority: .pathChange) { () -> Void in
+            runs.record("path")
+            try? await Task.sleep(nanoseconds: 200_000_000)
+        }
+        try? await Task.sleep(nanoseconds: 50_000_000)
+        async let periodic = scheduler.run("periodic", priority: .periodic) { () -> Void in
+            runs.record("periodic")
+        }
+        try? await Task.sleep(nanoseconds: 20_000_000)
+        await scheduler.run("interactive", priority: .userInitiated) { () -> Void in
+            runs.record("interactive")
+        }
+        _ = await (pathChange, periodic)
+
+        XCTAssertEqual(runs.names, ["path", "interactive", "periodic"])
+        XCTAssertEqual(scheduler.counts.preempted, 0, "path-change work is not preemptible")
+    }
+
+    func testProbeSchedulerCancelAllStartsFreshRunsForNewRequests() async {
+        let scheduler = ProbeScheduler<String>(maxConcurrentOperations: 1)
+        let runs = QueryCounter()
+        let probe: @Sendable () async -> String = {
+            runs.record("wifi")
+            try? await Task.sleep(nanoseconds: 5_000_000_000)
+            return Task.isCancelled ? "cancelled" : "finished"
+        }
+
+        async let stale = scheduler.run("wifi", priority: .periodic, operation: probe)
+        async let queued = scheduler.run("cellular", priority: .periodic) { () -> String in
+            Task.isCancelled ? "cancelled" : "finished"
+        }
+        try? await Task.sleep(nanoseconds: 50_000_000)
+
+        let start = Date()
+        scheduler.cancelAll()
+        let staleResults = await [stale, queued]
+        XCTAssertEqual(staleResults, ["cancelled", "cancelled"], "waiting callers get the cancelled runs' results")
+        XCTAssertLessThan(Date().timeIntervalSince(start), 1.0)
+
+        let fresh = await scheduler.run("wifi", priority: .userInitiated) { () -> String in
+            runs.record("wifi")
+            return "fresh"
+        }
+        XCTAssertEqual(fresh, "fresh", "a new request does not join the cancelled run")
+        XCTAssertEqual(runs.names, ["wifi", "wifi"])
+        XCTAssertEqual(scheduler.counts.piggybacked, 0)
+    }
+
+    func testProbeSchedulerCountsStartAtZero() {
+        XCTAssertEqual(RealReachability().probeSchedulerCounts, ProbeSchedulerCounts())
+    }
+
+    // MARK: - Probe Coordinator Tests
+
+    func testProbeCoordinatorAlignsTicksOnSharedClock() {
+        let epoch = Date(timeIntervalSinceReferenceDate: 0)
+        let coordinator = ProbeCoordinator(epoch: epoch)
+
+        XCTAssertEqual(coordinator.delayUntilNextTick(interval: 5, now: epoch.addingTimeInterval(12)), 3, accuracy: 0.001)
+        XCTAssertEqual(coordinator.delayUntilNextTick(interval: 10, now: epoch.addingTimeInterval(12)), 8, accuracy: 0.001)
+        XCTAssertEqual(coordinator.delayUntilNextTick(interval: 5, now: epoch.addingTimeInterval(15)), 5, accuracy: 0.001,
+                       "a tick due now waits for the next one")
+        XCTAssertEqual(coordinator.delayUntilNextTick(interval: 0, now: epoch), 0)
+    }
+
+    func testProbeCoordinatorRunsIdenticalProbesOnce() async {
+        let coordinator = ProbeCoordinator()
+        let runs = QueryCounter()
+        let key = ProbeCoordinator.ProbeKey(profile: ProbeProfile(), network: "wifi|en0|",
+                                            allowsCellularFallback: false, pinsHTTPProbeAddress: false)
+        let probe: @Sendable () async -> Bool = {
+            runs.record("probe")
+            try? await Task.sleep(nanoseconds: 100_000_000)
+            return true
+        }
+
+        async let first = coordinator.perform(key, priority: .periodic, operation: probe)
+        async let second = coordinator.perform(key, priority: .periodic, operation: probe)
+        let results = await [first, second]
+
+        XCTAssertEqual(results, [true, true])
+        XCTAssertEqual(runs.names, ["probe"])
+        XCTAssertEqual(coordinator.counts, ProbeSharingCounts(requested: 2, performed: 1))
+        XCTAssertEqual(coordinator.counts.shared, 1)
+
+        let otherNetwork = ProbeCoordinator.ProbeKey(profile: key.profile, network: "cellular|pdp_ip0|",
+                                                     allowsCellularFallback: false, pinsHTTPProbeAddress: false)
+        _ = await coordinator.perform(otherNetwork, priority: .periodic, operation: probe)
+        XCTAssertEqual(runs.names.count, 2, "a probe on other interfaces is not shared")
+    }
+
+    func testEnginesRegisterWithCoordinatorWhileNotifierRuns() {
+        let coordinator = ProbeCoordinator()
+        let reachability = RealReachability(configuration: ReachabilityConfiguration(periodicProbeEnabled: false),
+                                            nat64Resolver: NAT64PrefixResolver(),
+                                            connectivityPredictor: ConnectivityPredictor(),
+                                            probeCoordinator: coordinator)
+        XCTAssertEqual(reachability.probeSharingCounts, ProbeSharingCounts())
+
+        reachability.startNotifier()
+        XCTAssertEqual(coordinator.registeredEngineCount, 1)
+        reachability.stopNotifier()
+        XCTAssertEqual(coordinator.registeredEngineCount, 0)
+    }
+
+    // MARK: - Sharded Target Monitor Tests
+
+    func testTimerWheelFiresEntriesAfterTheirTicks() {
+        var wheel = TimerWheel<String>(slotCount: 4)
+        wheel.schedule("soon", afterTicks: 1)
+        wheel.schedule("later", afterTicks: 6)
+        wheel.schedule("now", afterTicks: 0)
+
+        XCTAssertEqual(wheel.advance().sorted(), ["now", "soon"], "zero ticks fires on the next advance")
+        for _ in 2...5 {
+            XCTAssertEqual(wheel.advance(), [])
+        }
+        XCTAssertEqual(wheel.advance(), ["later"], "a delay past one turn waits out its extra round")
+        XCTAssertEqual(wheel.count, 0)
+    }
+
+    func testConsistentHashRingOnlyMovesKeysToAddedShard() {
+        let four = ConsistentHashRing(shardCount: 4)
+        let five = ConsistentHashRing(shardCount: 5)
+        let keys = (0..<2000).map { "icmp|10.0.\($0 / 256).\($0 % 256)" }
+
+        var perShard = [Int](repeating: 0, count: 4)
+        var moved = 0
+        for key in keys {
+            let before = four.shard(for: key)
+            let after = five.shard(for: key)
+            perShard[before] += 1
+            if before != after {
+                XCTAssertEqual(after, 4, "a key only moves to the new shard")
+                moved += 1
+            }
+        }
+        XCTAssertGreaterThan(moved, 0)
+        XCTAssertLessThan(moved, keys.count / 3)
+        XCTAssertTrue(perShard.allSatisfy { $0 > keys.count / 8 }, "targets spread over every shard: \(perShard)")
+    }
+
+    func testShardedMonitorIdleShardStealsFromBackloggedShard() async throws {
+        let configuration = ShardedTargetMonitor.Configuration(shardCount: 2,
+                                                               probeInterval: 1,
+                                                               tickInterval: 0.01,
+                                                               maxProbesInFlightPerShard: 1,
+                                                               stealBatchSize: 8)
+        // Shard 0 is slow, shard 1 answers at once and runs out of work.
+        let monitor = ShardedTargetMonitor(configuration: configuration) { _, shard in
+            if shard.index == 0 {
+                try? await Task.sleep(nanoseconds: 50_000_000)
+            }
+            return TargetHealth(reachable: true, latencyMs: 1)
+        }
+        let targets = (0..<80).map { MonitoredTarget(host: "10.0.0.\($0)", kind: .tcp(port: 443)) }
+        monitor.add(targets)
+        XCTAssertEqual(monitor.statistics.targetsPerShard.reduce(0, +), targets.count)
+
+        monitor.start()
+        defer { monitor.stop() }
+        let deadline = Date().addingTimeInterval(5)
+        while monitor.snapshot().count < targets.count, Date() < deadline {
+            try await Task.sleep(nanoseconds: 20_000_000)
+        }
+
+        XCTAssertEqual(Set(monitor.snapshot().keys), Set(targets))
+        XCTAssertGreaterThan(monitor.statistics.stolenTargets, 0)
+        XCTAssertEqual(monitor.statistics.targetsPerShard.reduce(0, +), targets.count, "stealing moves targets, never copies them")
+        XCTAssertEqual(monitor.health(of: targets[0])?.reachable, true)
+
+        monitor.remove([targets[0]])
+        XCTAssertNil(monitor.health(of: targets[0]))
+    }
+
+    func testShardedMonitorProbesReAddedTargetOncePerInterval() async throws {
+        let configuration = ShardedTargetMonitor.Configuration(shardCount: 1,
+                                                               probeInterval: 0.2,
+                                                               tickInterval: 0.01)
+        let probes = QueryCounter()
+        let monitor = ShardedTargetMonitor(configuration: configuration) { target, _ in
+            probes.record(target.host)
+            try? await Task.sleep(nanoseconds: 50_000_000)
+            return TargetHealth(reachable: true, latencyMs: 1)
+        }
+        let target = MonitoredTarget(host: "10.0.0.1", kind: .icmp)
+
+        // Re-added while its first wheel entry is pending...
+        for _ in 0..<3 {
+            monitor.add([target])
+            monitor.remove([target])
+        }
+        monitor.add([target])
+        monitor.start()
+        defer { monitor.stop() }
+
+        // ...and again while its first probe is in flight.
+        let deadline = Date().addingTimeInterval(2)
+        while probes.names.isEmpty, Date() < deadline {
+            try await Task.sleep(nanoseconds: 5_000_000)
+        }
+        monitor.remove([target])
+        monitor.add([target])
+        XCTAssertEqual(monitor.statistics.targetsPerShard, [1])
+
+        let window: TimeInterval = 1
+        let before = probes.names.count
+        try await Task.sleep(nanoseconds: UInt64(window * 1_000_000_000))
+        let count = probes.names.count - before
+        XCTAssertGreaterThan(count, 0)
+        XCTAssertLessThanOrEqual(count, Int(window / configuration.probeInterval) + 1,
+                                 "stale schedule entries must not add probes: \(count) in \(window)s")
+    }
+
+    func testShardedMonitorScalingBenchmark() async throws {
+        // Probes answer at once, so the curve measures the shards' own scheduling throughput.
+        let targets = (0..<4096).map { MonitoredTarget(host: "127.0.\($0 / 256).\($0 % 256)", kind: .icmp) }
+        let window: TimeInterval = 0.5
+
+        for shardCount in [1, 2, 4, 8, 16] {
+            let configuration = ShardedTargetMonitor.Configuration(shardCount: shardCount,
+                                                                   probeInterval: 0.05,
+                                                                   tickInterval: 0.005,
+                                                                   maxProbesInFlightPerShard: 256)
+            let probes = QueryCounter()
+            let monitor = ShardedTargetMonitor(configuration: configuration) { _, shard in
+                probes.record("\(shard.index)")
+                return TargetHealth(reachable: true, latencyMs: 0.1)
+            }
+            monitor.add(targets)
+            monitor.start()
+            try await Task.sleep(nanoseconds: UInt64(window * 1_000_000_000))
+            monitor.stop()
+
+            // Each target is due once per interval; one more round may be in flight when stopping.
+            let intervals = Int((window / configuration.probeInterval).rounded())
+            let completed = monitor.statistics.completedProbes
+            let completionRatio = Double(completed) / Double(targets.count * intervals)
+            XCTAssertGreaterThanOrEqual(completionRatio, 0.1, "\(shardCount) shards: every target is probed within the window")
+            XCTAssertLessThanOrEqual(completed, targets.count * (intervals + 1), "\(shardCount) shards: a target is probed at most once per interval")
+
+            var probesPerShard = [Int](repeating: 0, count: shardCount)
+            for name in probes.names {
+                probesPerShard[Int(name)!] += 1
+            }
+            XCTAssertTrue(probesPerShard.allSatisfy { $0 > 0 }, "\(shardCount) shards: every shard probes its targets: \(probesPerShard)")
+        }
+    }
+
+    // MARK: - Static Probe Engine Tests
+
+    func testStaticEngineFallsBackToCellularAndRecordsStats() async {
+        let http = StubDetailedProber(succeedsOffCellular: false)
+        let stats = CountingProbeStats()
+        let engine = StaticProbeEngine(policy: HTTPOnlyPolicy(http: http), clock: UptimeProbeClock(), stats: stats)
+
+        let outcome = await engine.probeWithCellularFallback()
+
+        XCTAssertTrue(outcome.result.success)
+        XCTAssertTrue(outcome.secondaryReachable)
+        XCTAssertEqual(http.calls.names, ["http cellular=false", "http cellular=true"])
+        XCTAssertEqual(stats.successes, 1)
+        XCTAssertEqual(stats.failures, 0)
+        XCTAssertNotNil(stats.meanProbeMilliseconds)
+        XCTAssertEqual(type(of: engine.policy).probeMode, .httpOnly)
+    }
+
+    func testStaticParallelPolicyReportsHTTPFailureWhenBothBranchesFail() async {
+        let policy = ParallelPolicy(http: StubDetailedProber(succeeds: false, failureReason: .tlsFailure),
+                                    icmp: StubDetailedProber(succeeds: false, failureReason: .timeout))
+        let engine = StaticProbeEngine(policy: policy)
+
+        let result = await engine.probe()
+
+        XCTAssertFalse(result.success)
+        XCTAssertEqual(result.failureReason, .tlsFailure)
+        // ICMPOnlyPolicy offers no probeWithCellularFallback(); calling it is a compile error.
+        XCTAssertEqual(ICMPOnlyPolicy<StubDetailedProber>.probeMode, .icmpOnly)
+    }
+
+    func testStaticEngineBenchmarkAgainstDynamicDispatch() async {
+        let iterations = 20_000
+        let prober = StubDetailedProber(recordsCalls: false)
+
+        let engine = StaticProbeEngine(policy: ICMPOnlyPolicy(icmp: prober))
+        let staticStart = DispatchTime.now().uptimeNanoseconds
+        var staticSuccesses = 0
+        for _ in 0..<iterations {
+            if await engine.probe().success {
+                staticSuccesses += 1
+            }
+        }
+        let staticElapsed = DispatchTime.now().uptimeNanoseconds - staticStart
+
+        // The dynamic path: an existential prober chosen by switching on the mode for every probe.
+        let probers: [ProbeMode: any DetailedProber] = [.icmpOnly: prober, .quicOnly: prober]
+        let mode = ProbeMode.icmpOnly
+        let dynamicStart = DispatchTime.now().uptimeNanoseconds
+        var dynamicSuccesses = 0
+        for _ in 0..<iterations {
+            let result: ProbeResult
+            switch mode {
+            case .icmpOnly, .quicOnly:
+                result = await probers[mode]!.probeWithDetails()
+            case .parallel, .httpOnly:
+                result = ProbeResult(success: false, failureReason: .invalidConfiguration)
+            }
+            if result.success {
+                dynamicSuccesses += 1
+            }
+        }
+        let dynamicElapsed = DispatchTime.now().uptimeNanoseconds - dynamicStart
+
+        XCTAssertEqual(staticSuccesses, iterations)
+        XCTAssertEqual(dynamicSuccesses, iterations)
+        // Unoptimized test builds keep generics unspecialized, so only a clear regression fails.
+        XCTAssertLessThanOrEqual(staticElapsed, dynamicElapsed * 3,
+                                 "static: \(staticElapsed / UInt64(iterations)) ns/probe, dynamic: \(dynamicElapsed / UInt64(iterations)) ns/probe")
+    }
+
+    // MARK: - Probe Operations Tests
+
+    func testProbeOperationPastDeadlineTimesOutWithoutProbing() async {
+        let start = CFAbsoluteTimeGetCurrent()
+        let result = await ProbeOperations.ping("192.0.2.1", deadline: .now() - .milliseconds(1))
+
+        XCTAssertFalse(result.success)
+        XCTAssertEqual(result.failureReason, .timeout)
+        XCTAssertLessThan(CFAbsoluteTimeGetCurrent() - start, 0.1)
+    }
+
+    func testProbeOperationReportsCancellation() async {
+        let result = await Task { () -> ProbeResult in
+            withUnsafeCurrentTask { $0?.cancel() }
+            return await ProbeOperations.connect(to: "127.0.0.1", port: 9, deadline: .now() + 2)
+        }.value
+
+        XCTAssertEqual(result.failureReason, .cancelled)
+    }
+
+    func testProbeOperationResolvesLocalhostBeforeDeadline() async {
+        let resolution = await ProbeOperations.resolve("localhost", deadline: .now() + 2)
+
+        XCTAssertNil(resolution.failureReason)
+        XCTAssertTrue(resolution.addresses.contains("127.0.0.1"), "\(resolution.addresses)")
+        XCTAssertNotNil(resolution.latencyMs)
+    }
+
+    // MARK: - Suspend and Resume Tests
+
+    func testSuspendReleasesNotifierAndResumeCatchesUp() async {
+        let coordinator = ProbeCoordinator()
+        let reachability = RealReachability(configuration: ReachabilityConfiguration(timeout: 1.0, periodicProbeEnabled: false),
+                                            nat64Resolver: NAT64PrefixResolver(),
+                                            connectivityPredictor: ConnectivityPredictor(),
+                                            probeCoordinator: coordinator)
+        reachability.startNotifier()
+
+        reachability.suspend()
+        XCTAssertTrue(reachability.isNotifierSuspended)
+        XCTAssertEqual(coordinator.registeredEngineCount, 0, "a suspended engine takes no part in shared probing")
+        reachability.suspend()
+        XCTAssertTrue(reachability.isNotifierSuspended)
+
+        let report = await reachability.resume()
+        XCTAssertFalse(reachability.isNotifierSuspended)
+        XCTAssertEqual(coordinator.registeredEngineCount, 1)
+        XCTAssertNotEqual(report.status, .unknown, "the catch-up probe settles the status")
+        XCTAssertNotNil(reachability.statusAge)
+
+        reachability.suspend()
+        reachability.stopNotifier()
+        XCTAssertFalse(reachability.isNotifierSuspended, "stopping clears the suspension")
+    }
+
+    func testSuspendMidProbeCancelsItAndResumeProbesAfresh() async {
+        let coordinator = ProbeCoordinator()
+        let reachability = RealReachability(configuration: ReachabilityConfiguration(probeMode: .icmpOnly,
+                                                                                     timeout: 2.0,
+                                                                                     icmpHost: "192.0.2.1",
+                                                                                     periodicProbeEnabled: false),
+                                            nat64Resolver: NAT64PrefixResolver(),
+                                            connectivityPredictor: ConnectivityPredictor(),
+                                            probeCoordinator: coordinator)
+        reachability.startNotifier()
+        let deadline = Date().addingTimeInterval(3)
+        while reachability.probeSchedulerCounts.started == 0 && Date() < deadline {
+            try? await Task.sleep(nanoseconds: 20_000_000)
+        }
+        XCTAssertEqual(reachability.probeSchedulerCounts.started, 1, "the path monitor's first probe is in flight")
+
+        reachability.suspend()
+        _ = await reachability.resume()
+
+        XCTAssertGreaterThanOrEqual(reachability.probeSchedulerCounts.started, 2,
+                                    "the catch-up probe runs afresh instead of joining the cancelled run")
+        XCTAssertGreaterThanOrEqual(coordinator.counts.performed, 2)
+        XCTAssertNotEqual(reachability.lastFailureReason, .cancelled)
+        XCTAssertNotEqual(reachability.lastFailureReason, .watchdog)
+        XCTAssertEqual(reachability.watchdogFireCount, 0)
+        reachability.stopNotifier()
+    }
+
+    func testResumeWithoutSuspendDoesNotProbe() async {
+        let reachability = RealReachability()
+        XCTAssertNil(reachability.statusAge)
+
+        reachability.suspend()
+        XCTAssertFalse(reachability.isNotifierSuspended, "only a running notifier can be suspended")
+        let report = await reachability.resume()
+        XCTAssertEqual(report, ResumeReport(staleness: nil, status: .unknown))
+    }
+
+    // MARK: - Notifier Lifecycle Tests
+
+    func testStartAndStopNotifier() {
+        let reachability = RealReachability()
+        
+        // Start notifier
+        reachability.startNotifier()
+        
+        // Should be able to start again (idempotent)
+        reachability.startNotifier()
+        
+        // Stop notifier
+        reachability.stopNotifier()
+        
+        // Should be able to stop again (idempotent)
+        reachability.stopNotifier()
+    }
+    
+    func testMultipleStartStopCycles() {
+        let reachability = RealReachability()
+        
+        for _ in 0..<3 {
+            reachability.startNotifier()
+            reachability.stopNotifier()
+        }
+        // Test passes if no crash occurs
+    }
+    
+    // MARK: - Configuration Mode Switching Tests
+    
+    func testSwitchingBetweenProbeModes() {
+        let reachability = RealReachability()
+        
+        // Start with parallel
+        XCTAssertEqual(reachability.configuration.probeMode, .parallel)
+        
+        // Switch to HTTP only
+        reachability.configuration = ReachabilityConfiguration(probeMode: .httpOnly)
+        XCTAssertEqual(reachability.configuration.probeMode, .httpOnly)
+        
+        // Switch to ICMP only
+        reachability.configuration = ReachabilityConfiguration(probeMode: .icmpOnly)
+        XCTAssertEqual(reachability.configuration.probeMode, .icmpOnly)
+        
+        // Switch back to parallel
+        reachability.configuration = ReachabilityConfiguration(probeMode: .parallel)
+        XCTAssertEqual(reachability.configuration.probeMode, .parallel)
+    }
+    
+    func testConfigurationUpdateWithCustomValues() {
+        let reachability = RealReachability()
+        
+        let customURL = URL(string: "https://www.example.com/check")!
+        let config = ReachabilityConfiguration(
+            probeMode: .httpOnly,
+            timeout: 8.0,
+            httpProbeURL: customURL,
+            icmpHost: "1.1.1.1",
+            icmpPort: 443
+        )
+        
+        reachability.configuration = config
         
         XCTAssertEqual(reachability.configuration.probeMode, .httpOnly)
         XCTAssertEqual(reachability.configuration.timeout, 8.0)
@@ -401,3 +1962,707 @@ final class RealReachability2Tests: XCTestCase {
         XCTAssertEqual(reachability.configuration.icmpPort, 443)
     }
 }
+
+/// Thread-safe recorder used by DNS stand-ins
+private final class QueryCounter: @unchecked Sendable {
+    private let lock = NSLock()
+    private var recorded: [String] = []
+    
+    var names: [String] {
+        lock.lock()
+        defer { lock.unlock() }
+        return recorded
+    }
+    
+    func record(_ name: String) {
+        lock.lock()
+        recorded.append(name)
+        lock.unlock()
+    }
+}
+
+/// Local UDP stand-in for a QUIC server that answers every datagram with Version Negotiation
+@available(iOS 13.0, macOS 10.15, *)
+private final class QUICVersionNegotiationResponder: @unchecked Sendable {
+    private let queue = DispatchQueue(label: "com.realreachability2.tests.quicresponder")
+    private let replyOverride: Data?
+    private let lock = NSLock()
+    private var listener: NWListener?
+    private var sizes: [Int] = []
+    
+    init(replyOverride: Data? = nil) {
+        self.replyOverride = replyOverride
+    }
+    
+    var receivedDatagramSizes: [Int] {
+        lock.lock()
+        defer { lock.unlock() }
+        return sizes
+    }
+    
+    /// Starts listening on an ephemeral loopback port
+    /// - Returns: The port, or nil if the listener could not start
+    func start() async -> UInt16? {
+        guard let listener = try? NWListener(using: .udp, on: .any) else {
+            return nil
+        }
+        self.listener = listener
+        
+        listener.newConnectionHandler = { [self] connection in
+            connection.start(queue: queue)
+            receive(on: connection)
+        }
+        
+        return await withCheckedContinuation { continuation in
+            var resumed = false
+            listener.stateUpdateHandler = { state in
+                guard !resumed else { return }
+                switch state {
+                case .ready:
+                    resumed = true
+                    continuation.resume(returning: listener.port?.rawValue)
+                case .failed, .cancelled:
+                    resumed = true
+                    continuation.resume(returning: nil)
+                default:
+                    break
+                }
+            }
+            listener.start(queue: queue)
+        }
+    }
+    
+    func stop() {
+        listener?.cancel()
+        listener = nil
+    }
+    
+    private func receive(on connection: NWConnection) {
+        connection.receiveMessage { [self] data, _, _, error in
+            guard let data, error == nil else {
+                return
+            }
+            lock.lock()
+            sizes.append(data.count)
+            lock.unlock()
+            
+            if let reply = replyOverride ?? Self.reply(to: data, supportedVersions: [0x0000_0001]) {
+                connection.send(content: reply, completion: .idempotent)
+            }
+            receive(on: connection)
+        }
+    }
+    
+    /// Builds the Version Negotiation reply a server sends for an unsupported version
+    static func reply(to probe: Data, supportedVersions: [UInt32]) -> Data? {
+        let bytes = [UInt8](probe)
+        guard bytes.count > 6 else { return nil }
+        let dcidLength = Int(bytes[5])
+        guard bytes.count > 6 + dcidLength else { return nil }
+        let dcid = Array(bytes[6..<(6 + dcidLength)])
+        let scidLength = Int(bytes[6 + dcidLength])
+        let scidStart = 7 + dcidLength
+        guard bytes.count >= scidStart + scidLength else { return nil }
+        let scid = Array(bytes[scidStart..<(scidStart + scidLength)])
+        
+        var reply: [UInt8] = [0x80, 0, 0, 0, 0]
+        reply.append(UInt8(scid.count))
+        reply += scid
+        reply.append(UInt8(dcid.count))
+        reply += dcid
+        for version in supportedVersions {
+            reply += withUnsafeBytes(of: version.bigEndian) { Array($0) }
+        }
+        return Data(reply)
+    }
+}
+
+/// Local UDP stand-in for a STUN server that answers binding requests with the requester's address
+@available(iOS 13.0, macOS 10.15, *)
+private final class STUNResponder: @unchecked Sendable {
+    private let queue = DispatchQueue(label: "com.realreachability2.tests.stunresponder")
+    private let lock = NSLock()
+    private var listener: NWListener?
+    private var remainingDrops: Int
+    private var requests = 0
+    private var override: STUNMappedAddress?
+    
+    /// - Parameter droppedRequests: Number of requests to ignore before answering
+    init(droppedRequests: Int = 0) {
+        self.remainingDrops = droppedRequests
+    }
+    
+    var requestCount: Int {
+        lock.lock()
+        defer { lock.unlock() }
+        return requests
+    }
+    
+    /// Mapping to report instead of the requester's address, simulating a NAT
+    var mappedAddressOverride: STUNMappedAddress? {
+        get {
+            lock.lock()
+            defer { lock.unlock() }
+            return override
+        }
+        set {
+            lock.lock()
+            override = newValue
+            lock.unlock()
+        }
+    }
+    
+    /// Starts listening on an ephemeral loopback port
+    /// - Returns: The port, or nil if the listener could not start
+    func start() async -> UInt16? {
+        guard let listener = try? NWListener(using: .udp, on: .any) else {
+            return nil
+        }
+        self.listener = listener
+        
+        listener.newConnectionHandler = { [self] connection in
+            connection.start(queue: queue)
+            receive(on: connection)
+        }
+        
+        return await withCheckedContinuation { continuation in
+            var resumed = false
+            listener.stateUpdateHandler = { state in
+                guard !resumed else { return }
+                switch state {
+                case .ready:
+                    resumed = true
+                    continuation.resume(returning: listener.port?.rawValue)
+                case .failed, .cancelled:
+                    resumed = true
+                    continuation.resume(returning: nil)
+                default:
+                    break
+                }
+            }
+            listener.start(queue: queue)
+        }
+    }
+    
+    func stop() {
+        listener?.cancel()
+        listener = nil
+    }
+    
+    private func receive(on connection: NWConnection) {
+        connection.receiveMessage { [self] data, _, _, error in
+            guard let data, error == nil, data.count >= 20 else {
+                return
+            }
+            
+            lock.lock()
+            requests += 1
+            let drop = remainingDrops > 0
+            if drop {
+                remainingDrops -= 1
+            }
+            let mapped = override ?? Self.mappedAddress(of: connection)
+            lock.unlock()
+            
+            if !drop, let mapped,
+               let reply = Self.bindingSuccess(transactionID: Array(data[8..<20]), mappedAddress: mapped) {
+                connection.send(content: reply, completion: .idempotent)
+            }
+            receive(on: connection)
+        }
+    }
+    
+    private static func mappedAddress(of connection: NWConnection) -> STUNMappedAddress? {
+        guard case .hostPort(let host, let port) = connection.endpoint else {
+            return nil
+        }
+        var literal = "\(host)"
+        if let scope = literal.firstIndex(of: "%") {
+            literal = String(literal[..<scope])
+        }
+        return STUNMappedAddress(address: literal, port: port.rawValue)
+    }
+    
+    /// Builds a binding success response carrying one (XOR-)MAPPED-ADDRESS attribute
+    static func bindingSuccess(transactionID: [UInt8], mappedAddress: STUNMappedAddress, xor: Bool = true) -> Data? {
+        let mask = STUNMessage.bigEndianBytes(STUNMessage.magicCookie) + transactionID
+        guard let value = STUNMessage.encodeAddress(mappedAddress, xorWith: xor ? mask : nil) else {
+            return nil
+        }
+        
+        let attributeType = xor ? STUNMessage.xorMappedAddressAttribute : STUNMessage.mappedAddressAttribute
+        var attribute = STUNMessage.bigEndianBytes(attributeType)
+        attribute += STUNMessage.bigEndianBytes(UInt16(value.count))
+        attribute += value
+        
+        var message = STUNMessage.bigEndianBytes(STUNMessage.bindingSuccessResponse)
+        message += STUNMessage.bigEndianBytes(UInt16(attribute.count))
+        message += STUNMessage.bigEndianBytes(STUNMessage.magicCookie)
+        message += transactionID
+        message += attribute
+        return Data(message)
+    }
+}
+
+/// Local HTTP/1.1 server that paces responses to a fixed rate and swallows uploads.
+/// With a shared bottleneck all connections drain through one FIFO, like a bloated router buffer,
+/// so a load on some connections delays the responses on every other one.
+@available(iOS 13.0, macOS 10.15, *)
+private final class ThrottledHTTPServer: @unchecked Sendable {
+    private static let chunkSize = 8 * 1024
+    
+    private let queue = DispatchQueue(label: "com.realreachability2.tests.throttledhttp")
+    private let bytesPerSecond: Int
+    private let honorsRange: Bool
+    private let resourceSize: Int
+    private let sharedBottleneck: Bool
+    private let lock = NSLock()
+    private var listener: NWListener?
+    private var ranges: [String] = []
+    private var hosts: [String] = []
+    private var uploaded = 0
+    
+    /// Pending output per bottleneck, only touched on `queue`
+    private var backlogs: [ObjectIdentifier: [(NWConnection, Data)]] = [:]
+    private var draining: Set<ObjectIdentifier> = []
+    
+    /// - Parameters:
+    ///   - bytesPerSecond: Pace of responses
+    ///   - honorsRange: Whether `Range: bytes=0-N` shortens the body (otherwise the whole resource is sent)
+    ///   - resourceSize: Size of the resource served to GET requests
+    ///   - sharedBottleneck: Whether all connections share one paced FIFO instead of one each
+    init(bytesPerSecond: Int, honorsRange: Bool = true, resourceSize: Int = 1024 * 1024, sharedBottleneck: Bool = false) {
+        self.bytesPerSecond = bytesPerSecond
+        self.honorsRange = honorsRange
+        self.resourceSize = resourceSize
+        self.sharedBottleneck = sharedBottleneck
+    }
+    
+    var rangeHeaders: [String] {
+        lock.lock()
+        defer { lock.unlock() }
+        return ranges
+    }
+    
+    var hostHeaders: [String] {
+        lock.lock()
+        defer { lock.unlock() }
+        return hosts
+    }
+    
+    var uploadedByteCount: Int {
+        lock.lock()
+        defer { lock.unlock() }
+        return uploaded
+    }
+    
+    /// Starts listening on an ephemeral loopback port
+    /// - Returns: The port, or nil if the listener could not start
+    func start() async -> UInt16? {
+        guard let listener = try? NWListener(using: .tcp, on: .any) else {
+            return nil
+        }
+        self.listener = listener
+        
+        listener.newConnectionHandler = { [self] connection in
+            connection.start(queue: queue)
+            readRequest(on: connection, buffered: Data())
+        }
+        
+        return await withCheckedContinuation { continuation in
+            var resumed = false
+            listener.stateUpdateHandler = { state in
+                guard !resumed else { return }
+                switch state {
+                case .ready:
+                    resumed = true
+                    continuation.resume(returning: listener.port?.rawValue)
+                case .failed, .cancelled:
+                    resumed = true
+                    continuation.resume(returning: nil)
+                default:
+                    break
+                }
+            }
+            listener.start(queue: queue)
+        }
+    }
+    
+    func stop() {
+        listener?.cancel()
+        listener = nil
+    }
+    
+    private func readRequest(on connection: NWConnection, buffered: Data) {
+        connection.receive(minimumIncompleteLength: 1, maximumLength: 65_536) { [self] data, _, isComplete, error in
+            var buffered = buffered
+            if let data {
+                buffered.append(data)
+            }
+            guard let headerEnd = buffered.range(of: Data("\r\n\r\n".utf8)) else {
+                if error == nil, !isComplete {
+                    readRequest(on: connection, buffered: buffered)
+                }
+                return
+            }
+            
+            let head = String(decoding: buffered[..<headerEnd.lowerBound], as: UTF8.self)
+            var headers: [String: String] = [:]
+            for line in head.components(separatedBy: "\r\n").dropFirst() {
+                guard let colon = line.firstIndex(of: ":") else { continue }
+                let name = line[..<colon].lowercased()
+                headers[name] = line[line.index(after: colon)...].trimmingCharacters(in: .whitespaces)
+            }
+            
+            if let host = headers["host"] {
+                lock.lock()
+                hosts.append(host)
+                lock.unlock()
+            }
+            
+            let rest = Data(buffered[headerEnd.upperBound...])
+            if head.hasPrefix("POST") {
+                readUpload(on: connection, received: rest.count, expected: Int(headers["content-length"] ?? "") ?? 0)
+            } else if head.hasPrefix("HEAD") {
+                transmit(Data("HTTP/1.1 200 OK\r\nContent-Length: 0\r\n\r\n".utf8), on: connection)
+                readRequest(on: connection, buffered: rest)
+            } else {
+                serveDownload(on: connection, range: headers["range"])
+                readRequest(on: connection, buffered: rest)
+            }
+        }
+    }
+    
+    private func serveDownload(on connection: NWConnection, range: String?) {
+        var length = resourceSize
+        var status = "200 OK"
+        if let range {
+            lock.lock()
+            ranges.append(range)
+            lock.unlock()
+            
+            if honorsRange, let last = range.split(separator: "-").last.flatMap({ Int($0) }) {
+                length = min(last + 1, resourceSize)
+                status = "206 Partial Content"
+            }
+        }
+        
+        let head = "HTTP/1.1 \(status)\r\nContent-Length: \(length)\r\nContent-Type: application/octet-stream\r\n\r\n"
+        transmit(Data(head.utf8), on: connection)
+        var remaining = length
+        while remaining > 0 {
+            let size = min(Self.chunkSize, remaining)
+            transmit(Data(count: size), on: connection)
+            remaining -= size
+        }
+    }
+    
+    /// Queues output behind the connection's bottleneck; called on `queue`
+    private func transmit(_ data: Data, on connection: NWConnection) {
+        let key = sharedBottleneck ? ObjectIdentifier(self) : ObjectIdentifier(connection)
+        backlogs[key, default: []].append((connection, data))
+        if !draining.contains(key) {
+            draining.insert(key)
+            drain(key)
+        }
+    }
+    
+    private func drain(_ key: ObjectIdentifier) {
+        guard var backlog = backlogs[key], !backlog.isEmpty else {
+            backlogs[key] = nil
+            draining.remove(key)
+            return
+        }
+        let (connection, data) = backlog.removeFirst()
+        backlogs[key] = backlog
+        
+        // Output for connections the client already closed is dropped without taking up the link.
+        var interval: TimeInterval = 0
+        if connection.state == .ready {
+            connection.send(content: data, completion: .idempotent)
+            interval = Double(data.count) / Double(bytesPerSecond)
+        }
+        queue.asyncAfter(deadline: .now() + interval) { [self] in
+            drain(key)
+        }
+    }
+    
+    private func readUpload(on connection: NWConnection, received: Int, expected: Int) {
+        guard received < expected else {
+            lock.lock()
+            uploaded += received
+            lock.unlock()
+            
+            let head = "HTTP/1.1 200 OK\r\nContent-Length: 0\r\nConnection: close\r\n\r\n"
+            connection.send(content: Data(head.utf8), completion: .contentProcessed { _ in
+                connection.cancel()
+            })
+            return
+        }
+        
+        connection.receive(minimumIncompleteLength: 1, maximumLength: 65_536) { [self] data, _, isComplete, error in
+            let total = received + (data?.count ?? 0)
+            if error != nil || (isComplete && total < expected) {
+                return
+            }
+            readUpload(on: connection, received: total, expected: expected)
+        }
+    }
+}
+
+/// Minimal RFC 8484 endpoint on loopback: answers every POSTed query with fixed A records
+private final class DoHResponder: @unchecked Sendable {
+    private let queue = DispatchQueue(label: "com.realreachability2.tests.doh")
+    private let addresses: [[UInt8]]
+    private let lock = NSLock()
+    private var listener: NWListener?
+    private var queries = 0
+    private var connections = 0
+    
+    init(addresses: [[UInt8]]) {
+        self.addresses = addresses
+    }
+    
+    var queryCount: Int {
+        lock.lock()
+        defer { lock.unlock() }
+        return queries
+    }
+    
+    var connectionCount: Int {
+        lock.lock()
+        defer { lock.unlock() }
+        return connections
+    }
+    
+    /// Starts listening on an ephemeral loopback port
+    /// - Returns: The port, or nil if the listener could not start
+    func start() async -> UInt16? {
+        guard let listener = try? NWListener(using: .tcp, on: .any) else {
+            return nil
+        }
+        self.listener = listener
+        
+        listener.newConnectionHandler = { [self] connection in
+            lock.lock()
+            connections += 1
+            lock.unlock()
+            connection.start(queue: queue)
+            readRequest(on: connection, buffered: Data())
+        }
+        
+        return await withCheckedContinuation { continuation in
+            var resumed = false
+            listener.stateUpdateHandler = { state in
+                guard !resumed else { return }
+                switch state {
+                case .ready:
+                    resumed = true
+                    continuation.resume(returning: listener.port?.rawValue)
+                case .failed, .cancelled:
+                    resumed = true
+                    continuation.resume(returning: nil)
+                default:
+                    break
+                }
+            }
+            listener.start(queue: queue)
+        }
+    }
+    
+    func stop() {
+        listener?.cancel()
+        listener = nil
+    }
+    
+    private func readRequest(on connection: NWConnection, buffered: Data) {
+        if let headerEnd = buffered.range(of: Data("\r\n\r\n".utf8)) {
+            let head = String(decoding: buffered[..<headerEnd.lowerBound], as: UTF8.self).lowercased()
+            let length = head.components(separatedBy: "\r\n")
+                .first { $0.hasPrefix("content-length:") }
+                .flatMap { Int($0.dropFirst("content-length:".count).trimmingCharacters(in: .whitespaces)) } ?? 0
+            let bodyStart = headerEnd.upperBound
+            if buffered.count - bodyStart >= length {
+                let query = Data(buffered[bodyStart..<(bodyStart + length)])
+                respond(to: query, on: connection)
+                readRequest(on: connection, buffered: Data(buffered[(bodyStart + length)...]))
+                return
+            }
+        }
+        
+        connection.receive(minimumIncompleteLength: 1, maximumLength: 65_536) { [self] data, _, isComplete, error in
+            guard let data, error == nil, !isComplete || !data.isEmpty else {
+                return
+            }
+            readRequest(on: connection, buffered: buffered + data)
+        }
+    }
+    
+    private func respond(to query: Data, on connection: NWConnection) {
+        lock.lock()
+        queries += 1
+        lock.unlock()
+        
+        // Echo the ID and question, then one A record per address pointing back at the question name.
+        var message = [UInt8](query)
+        guard message.count >= 12 else { return }
+        message[2] = 0x81
+        message[3] = 0x80
+        message[6] = 0
+        message[7] = UInt8(addresses.count)
+        for address in addresses {
+            message += [0xC0, 0x0C, 0x00, 0x01, 0x00, 0x01, 0, 0, 0, 60, 0x00, 0x04] + address
+        }
+        
+        let head = "HTTP/1.1 200 OK\r\nContent-Type: application/dns-message\r\nContent-Length: \(message.count)\r\n\r\n"
+        connection.send(content: Data(head.utf8) + Data(message), completion: .idempotent)
+    }
+}
+
+/// Loopback TLS server with session tickets that answers every request with 204
+private final class TLSHeadResponder: @unchecked Sendable {
+    /// Self-signed P-256 identity for CN=probe.test (PKCS#12, passphrase "test")
+    private static let identityBase64 = """
+        MIIDmgIBAzCCA2AGCSqGSIb3DQEHAaCCA1EEggNNMIIDSTCCAj8GCSqGSIb3DQEHBqCCAjAwggIsAgEAMIICJQYJKoZIhvcNAQcB
+        MBwGCiqGSIb3DQEMAQMwDgQIA1aoBBzT9HkCAggAgIIB+Brw/mROm3adxyqzXMtUAMAY5Qn7iLrr/0DqJJTAsJDZjqT36PcHQ8dP
+        P2me8KSUgAtDadZ1Csq1EoK8BX5CWrjK/67Px5LxjzNnezla01nIlBSqWBQ3YOpHjGdyy+RbdzO8Xx59zPcpH6aU0hDfNJ4OfO1d
+        XybxUDVd0KFkKs8rTWlqLlGKzTymK+nBp468cLWgmpEpEDKjdI1lNAebMnwa1Dxe0DBzb5UiiE7hrWfz7xwTn//RUXZTkYJ1uC7z
+        uUBV+1QxiEz/4lZpCc9ITeBzX/Yt+rDyWIcPmURzPUcOLlt5fzzdtdWj7j4xvkjBSo9inUjvAW7XONNl8s26qlboeD1cZCxOsuKd
+        joucQLqgSYJXZRRMowN8jmGZuI1Zr7xcDU4H7aCZ11epg3oXrZYeSegUS1h5mnZuHtj5/p3QHAqwggkUFls2slvNumONp9IL9IqT
+        Ptq0ZUF1/AuvIhb1ylc9JdLSR/wBFyStyfQTyNBuDraezqez5VD8RbY/s3FnDm6rozq23T09f9gRem0xW0FZUdzsHUmyu5R81oBA
+        wH+tn70nelztZf6zir9b6o7EeGnzQ88cishCThzAfLhzd3n0+nS8RB4qkztOjfnWcftqnutNxfCRyJKd6Ac5aSJS0P0INKU7e55O
+        QQL1utlN2p+0kq4Z8jCCAQIGCSqGSIb3DQEHAaCB9ASB8TCB7jCB6wYLKoZIhvcNAQwKAQKggbQwgbEwHAYKKoZIhvcNAQwBAzAO
+        BAikPk3xqMbcZgICCAAEgZAPbZupDQeEBNaNqXW+swoE3808C2spK90eIag8FL1Gpg3dP+d9GtR2iNUfi1el64g4oneZjXlFOthM
+        pER5gPVQzNDJODrXlHTZ0MJOwfomCMNPA7kpk++2az5Va9uSoSSyqDOlX7JMlxvwhjCuugC3jd2zL2LrwXIxXSu2pRLnCG6Z6fvw
+        qumCxsKeIw+5J8kxJTAjBgkqhkiG9w0BCRUxFgQUz373X3rr94rrGiIaRtFPozt0MtwwMTAhMAkGBSsOAwIaBQAEFLf9hf85sZfQ
+        bnPpo+wfYtNkT0zVBAiZgVHVOT3IdgICCAA=
+        """
+    
+    private let queue = DispatchQueue(label: "com.realreachability2.tests.tls")
+    private let identity: SecIdentity
+    private let lock = NSLock()
+    private var listener: NWListener?
+    private var connections = 0
+    
+    init?() {
+        guard let data = Data(base64Encoded: Self.identityBase64, options: .ignoreUnknownCharacters) else {
+            return nil
+        }
+        var items: CFArray?
+        let options = [kSecImportExportPassphrase as String: "test"] as CFDictionary
+        guard SecPKCS12Import(data as CFData, options, &items) == errSecSuccess,
+              let first = (items as? [[String: Any]])?.first,
+              let identity = first[kSecImportItemIdentity as String] else {
+            return nil
+        }
+        self.identity = identity as! SecIdentity
+    }
+    
+    var connectionCount: Int {
+        lock.lock()
+        defer { lock.unlock() }
+        return connections
+    }
+    
+    /// Starts listening on an ephemeral loopback port
+    /// - Returns: The port, or nil if the listener could not start
+    func start() async -> UInt16? {
+        let tls = NWProtocolTLS.Options()
+        guard let localIdentity = sec_identity_create(identity) else {
+            return nil
+        }
+        sec_protocol_options_set_local_identity(tls.securityProtocolOptions, localIdentity)
+        sec_protocol_options_set_tls_tickets_enabled(tls.securityProtocolOptions, true)
+        guard let listener = try? NWListener(using: NWParameters(tls: tls), on: .any) else {
+            return nil
+        }
+        self.listener = listener
+        
+        listener.newConnectionHandler = { [self] connection in
+            lock.lock()
+            connections += 1
+            lock.unlock()
+            connection.start(queue: queue)
+            readRequest(on: connection, buffered: Data())
+        }
+        
+        return await withCheckedContinuation { continuation in
+            var resumed = false
+            listener.stateUpdateHandler = { state in
+                guard !resumed else { return }
+                switch state {
+                case .ready:
+                    resumed = true
+                    continuation.resume(returning: listener.port?.rawValue)
+                case .failed, .cancelled:
+                    resumed = true
+                    continuation.resume(returning: nil)
+                default:
+                    break
+                }
+            }
+            listener.start(queue: queue)
+        }
+    }
+    
+    func stop() {
+        listener?.cancel()
+        listener = nil
+    }
+    
+    private func readRequest(on connection: NWConnection, buffered: Data) {
+        connection.receive(minimumIncompleteLength: 1, maximumLength: 65_536) { [self] data, _, isComplete, error in
+            var buffered = buffered
+            if let data {
+                buffered.append(data)
+            }
+            if buffered.range(of: Data("\r\n\r\n".utf8)) != nil {
+                let response = "HTTP/1.1 204 No Content\r\nContent-Length: 0\r\nConnection: close\r\n\r\n"
+                connection.send(content: Data(response.utf8), completion: .contentProcessed { _ in
+                    connection.cancel()
+                })
+            } else if error == nil, !isComplete {
+                readRequest(on: connection, buffered: buffered)
+            }
+        }
+    }
+}
+
+/// Detailed prober answering at once from a fixed outcome
+@available(iOS 13.0, macOS 10.15, *)
+private final class StubDetailedProber: CellularSelectableProber, @unchecked Sendable {
+    let calls = QueryCounter()
+    private let succeeds: Bool
+    private let succeedsOffCellular: Bool
+    private let failureReason: ProbeFailureReason
+    private let recordsCalls: Bool
+
+    init(succeeds: Bool = true,
+         succeedsOffCellular: Bool? = nil,
+         failureReason: ProbeFailureReason = .timeout,
+         recordsCalls: Bool = true) {
+        self.succeeds = succeeds
+        self.succeedsOffCellular = succeedsOffCellular ?? succeeds
+        self.failureReason = failureReason
+        self.recordsCalls = recordsCalls
+    }
+
+    func probe() async -> Bool {
+        await probeWithDetails().success
+    }
+
+    func probeWithDetails() async -> ProbeResult {
+        if recordsCalls {
+            calls.record("probe")
+        }
+        return ProbeResult(success: succeeds, latencyMs: 1, failureReason: failureReason)
+    }
+
+    func probeWithDetails(allowsCellularAccess: Bool) async -> ProbeResult {
+        if recordsCalls {
+            calls.record("http cellular=\(allowsCellularAccess)")
+        }
+        let success = allowsCellularAccess ? succeeds : succeedsOffCellular
+        return ProbeResult(success: success, latencyMs: 1, failureReason: failureReason)
+    }
+}